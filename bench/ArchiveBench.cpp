@@ -0,0 +1,88 @@
+// 压缩包书籍基准测试
+// 比较解析中央目录与打开单页的耗时，打开单页的耗时应与压缩包内的页数无关
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include <zlib.h>
+#include "Img.h"
+
+using namespace book;
+
+namespace {
+    constexpr std::size_t pageSize = std::size_t(256U) << 10;
+
+    // 生成包含 pages 个未压缩页面的 ZIP 文件，返回其路径
+    fs::path makeArchive(std::size_t pages) {
+        auto dir = fs::temp_directory_path() / "manga-manager-archive-bench";
+        fs::create_directories(dir);
+        auto path = dir / (std::to_string(pages) + ".cbz");
+        if (fs::exists(path)) return path;
+
+        std::string content(pageSize, '\x5a');
+        auto crc = static_cast<std::uint32_t>(crc32(0UL, reinterpret_cast<const Bytef *>(content.data()),
+            static_cast<uInt>(content.size())));
+        BinaryWriter central;
+        std::ofstream fout(path, std::ios::out | std::ios::binary);
+        std::uint64_t offset = 0U;
+        for (std::size_t i = 0; i < pages; ++i) {
+            auto name = std::to_string(i + 1U) + ".png";
+            BinaryWriter local;
+            local.putFixed(std::uint32_t(0x04034b50U));
+            local.putFixed(std::uint16_t(20U)); local.putFixed(std::uint16_t(0U)); local.putFixed(std::uint16_t(0U));
+            local.putFixed(std::uint32_t(0U)); local.putFixed(crc);
+            local.putFixed(std::uint32_t(pageSize)); local.putFixed(std::uint32_t(pageSize));
+            local.putFixed(std::uint16_t(name.size())); local.putFixed(std::uint16_t(0U));
+            local.putBytes(std::as_bytes(std::span(name.data(), name.size())));
+            fout.write(reinterpret_cast<const char *>(local.getData().data()), local.getSize());
+            fout.write(content.data(), content.size());
+
+            central.putFixed(std::uint32_t(0x02014b50U));
+            central.putFixed(std::uint16_t(20U)); central.putFixed(std::uint16_t(20U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(std::uint16_t(0U));
+            central.putFixed(std::uint32_t(0U)); central.putFixed(crc);
+            central.putFixed(std::uint32_t(pageSize)); central.putFixed(std::uint32_t(pageSize));
+            central.putFixed(std::uint16_t(name.size())); central.putFixed(std::uint16_t(0U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(std::uint16_t(0U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(std::uint32_t(0U));
+            central.putFixed(static_cast<std::uint32_t>(offset));
+            central.putBytes(std::as_bytes(std::span(name.data(), name.size())));
+            offset += local.getSize() + content.size();
+        }
+        fout.write(reinterpret_cast<const char *>(central.getData().data()), central.getSize());
+        BinaryWriter end;
+        end.putFixed(std::uint32_t(0x06054b50U));
+        end.putFixed(std::uint16_t(0U)); end.putFixed(std::uint16_t(0U));
+        end.putFixed(std::uint16_t(pages)); end.putFixed(std::uint16_t(pages));
+        end.putFixed(static_cast<std::uint32_t>(central.getSize())); end.putFixed(static_cast<std::uint32_t>(offset));
+        end.putFixed(std::uint16_t(0U));
+        fout.write(reinterpret_cast<const char *>(end.getData().data()), end.getSize());
+        return path;
+    }
+}
+
+// 解析中央目录，只在登记新书时执行一次
+static void BM_ArchiveIndex(benchmark::State &state) {
+    auto path = makeArchive(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        ImagesManager manager;
+        benchmark::DoNotOptimize(manager.openArchive(path));
+    }
+}
+BENCHMARK(BM_ArchiveIndex)->Arg(16)->Arg(256)->Arg(1024);
+
+// 打开并读取压缩包内的最后一页
+static void BM_ArchivePageView(benchmark::State &state) {
+    ImagesManager manager(makeArchive(static_cast<std::size_t>(state.range(0))));
+    auto last = manager.getSumOfImages() - 1U;
+    for (auto _ : state) {
+        auto view = manager.getImageView(last);
+        auto data = view.getData();
+        unsigned sum = 0U;
+        for (std::size_t i = 0; i < data.size(); i += 4096U) sum += static_cast<unsigned>(data[i]);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * std::int64_t(pageSize));
+}
+BENCHMARK(BM_ArchivePageView)->Arg(16)->Arg(256)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+// 内容寻址存储基准测试
+// 比较单线程计算 XXH64 的吞吐与并行导入一批重复图像的耗时，重复图像导入时不应再复制数据
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include "ContentStore.h"
+#include "Hash.h"
+
+using namespace book;
+
+namespace {
+    constexpr std::size_t pageSize = std::size_t(512U) << 10;
+
+    // 生成 pages 个内容各不相同的图像文件，返回其所在目录
+    fs::path makePages(std::size_t pages) {
+        auto dir = fs::temp_directory_path() / "manga-manager-store-bench" / std::to_string(pages);
+        if (fs::exists(dir)) return dir;
+        fs::create_directories(dir);
+        std::string content(pageSize, '\x5a');
+        for (std::size_t i = 0; i < pages; ++i) {
+            content.replace(0U, 8U, std::to_string(10000000U + i));
+            std::ofstream(dir / (std::to_string(i + 1U) + ".png"), std::ios::out | std::ios::binary) << content;
+        }
+        return dir;
+    }
+
+    std::vector<fs::path> listPages(const fs::path &dir) {
+        std::vector<fs::path> ret;
+        for (const auto &entry : fs::directory_iterator(dir)) ret.emplace_back(entry.path());
+        return ret;
+    }
+}
+
+// 单线程计算 XXH64
+static void BM_XXHash64(benchmark::State &state) {
+    std::string content(static_cast<std::size_t>(state.range(0)), '\x5a');
+    auto data = std::as_bytes(std::span(content.data(), content.size()));
+    for (auto _ : state) benchmark::DoNotOptimize(xxhash64(data));
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XXHash64)->Arg(4 << 10)->Arg(512 << 10)->Arg(8 << 20);
+
+// 导入内容全部已在存储内的一批图像：只计算哈希并比较，不复制
+static void BM_ImportDuplicates(benchmark::State &state) {
+    auto pages = static_cast<std::size_t>(state.range(0));
+    auto dir = makePages(pages);
+    ContentStore store(dir.parent_path() / "objects");
+    auto images = listPages(dir);
+    store.import(images);
+    for (auto _ : state) {
+        images = listPages(dir);
+        benchmark::DoNotOptimize(store.import(images));
+    }
+    state.SetBytesProcessed(state.iterations() * std::int64_t(pages * pageSize));
+}
+BENCHMARK(BM_ImportDuplicates)->Arg(16)->Arg(128)->UseRealTime();
+
+BENCHMARK_MAIN();
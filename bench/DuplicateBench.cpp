@@ -0,0 +1,57 @@
+// 感知哈希重复检测基准测试
+// 比较线性扫描与多索引哈希的单次查找，以及在大量页面中找出全部相似页面对的耗时
+#include <benchmark/benchmark.h>
+#include <random>
+#include "DuplicateIndex.h"
+
+using namespace book;
+
+namespace {
+    // 生成 pages 个随机哈希，每 pagesPerBook 页为一本书
+    DuplicateIndex makeIndex(std::size_t pages, std::size_t pagesPerBook = 200U) {
+        DuplicateIndex index;
+        std::mt19937_64 random(42U);
+        for (std::size_t i = 0; i < pages; ++i) {
+            index.add(PageRef{ static_cast<BookIdType>(i / pagesPerBook + 1U),
+                static_cast<std::uint32_t>(i % pagesPerBook) }, random());
+        }
+        index.reindex();
+        return index;
+    }
+}
+
+// 对全部哈希线性扫描
+static void BM_HammingScan(benchmark::State &state) {
+    auto pages = static_cast<std::size_t>(state.range(0));
+    std::mt19937_64 random(7U);
+    std::vector<std::uint64_t> hashes(pages);
+    for (auto &hash : hashes) hash = random();
+    std::vector<std::uint32_t> out;
+    for (auto _ : state) {
+        out.clear();
+        hammingScan(hashes, random(), 10, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HammingScan)->Arg(1 << 16)->Arg(1 << 20);
+
+// 多索引哈希查找，距离不超过 range(1)
+static void BM_IndexSearch(benchmark::State &state) {
+    auto index = makeIndex(static_cast<std::size_t>(state.range(0)));
+    auto distance = static_cast<int>(state.range(1));
+    std::mt19937_64 random(7U);
+    for (auto _ : state) benchmark::DoNotOptimize(index.search(random(), distance));
+}
+BENCHMARK(BM_IndexSearch)->Args({ 1 << 20, 7 })->Args({ 1 << 20, 10 })->Args({ 1 << 20, 15 });
+
+// 找出全部距离不超过 range(1) 的页面对
+static void BM_FindPairs(benchmark::State &state) {
+    auto index = makeIndex(static_cast<std::size_t>(state.range(0)));
+    auto distance = static_cast<int>(state.range(1));
+    for (auto _ : state) benchmark::DoNotOptimize(index.findPairs(distance));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindPairs)->Args({ 1 << 18, 7 })->Args({ 1 << 18, 10 })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
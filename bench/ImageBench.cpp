@@ -0,0 +1,53 @@
+// ImagesManager 页面读取基准测试
+// 比较 getImageContent（分配并复制）与 getImageView（内存映射）读取单页的耗时
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include "Img.h"
+
+using namespace book;
+
+namespace {
+    // 生成一个大小为 size 字节的测试图像，返回只包含该图像的管理器
+    ImagesManager makeManager(std::size_t size) {
+        auto dir = fs::temp_directory_path() / "manga-manager-image-bench";
+        fs::create_directories(dir);
+        auto path = dir / (std::to_string(size) + ".png");
+        if (!fs::exists(path) || fs::file_size(path) != size) {
+            std::ofstream fout(path, std::ios::out | std::ios::binary);
+            std::string content(size, '\x5a');
+            fout.write(content.data(), content.size());
+        }
+        return ImagesManager(std::vector<fs::path>{ path });
+    }
+
+    // 逐页面累加一个字节，保证内容确实被读取
+    unsigned touch(const std::byte *data, std::size_t size) {
+        unsigned ret = 0U;
+        for (std::size_t i = 0; i < size; i += 4096U) ret += static_cast<unsigned>(data[i]);
+        return ret;
+    }
+}
+
+static void BM_GetImageContent(benchmark::State &state) {
+    auto manager = makeManager(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto content = manager.getImageContent(0);
+        benchmark::DoNotOptimize(touch(reinterpret_cast<const std::byte *>(content->data()), content->size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GetImageContent)->Arg(1 << 20)->Arg(8 << 20)->Arg(20 << 20);
+
+static void BM_GetImageView(benchmark::State &state) {
+    auto manager = makeManager(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto view = manager.getImageView(0);
+        auto data = view.getData();
+        benchmark::DoNotOptimize(touch(data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GetImageView)->Arg(1 << 20)->Arg(8 << 20)->Arg(20 << 20);
+
+BENCHMARK_MAIN();
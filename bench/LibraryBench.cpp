@@ -0,0 +1,83 @@
+// Library 冷启动基准测试
+// 10 万本书（每本 8 个标签）的漫画库从 .data/list.dat 读入的耗时
+// 第二个参数为每本书的页数，用于区分书籍表本身与页面路径的开销
+// 同时对比只映射快照（.data/list.snap）的耗时
+// heapBytes 为读入后新增的堆内存，驻留池内的标签名只在第一次读入时计入
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include "Library.h"
+#include "Snapshot.h"
+
+#ifdef __linux
+#include <malloc.h>
+#endif
+
+using namespace book;
+
+namespace {
+    // 当前已分配的堆内存字节数
+    std::size_t getHeapBytes() {
+#ifdef __linux
+        auto info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+#else
+        return 0U;
+#endif
+    }
+
+    // 生成测试用的漫画库数据文件，返回漫画库根目录
+    fs::path getLibraryRoot(std::size_t sumOfBooks, std::size_t sumOfPages) {
+        auto ret = fs::temp_directory_path() / "manga-manager-library-bench"
+            / (std::to_string(sumOfBooks) + "-" + std::to_string(sumOfPages));
+        Library library(ret);
+        if (fs::exists(library.getSnapshotPath())) return ret;
+
+        auto &tagManager = library.getTagManager();
+        auto groupId = tagManager.createGroupTag("group");
+        for (int i = 0; i < 1000; ++i) tagManager.createBookTag("tag" + std::to_string(i), groupId);
+
+        std::mt19937 rng(3U);
+        std::uniform_int_distribution<TagIdType> dist(1U, 1000U);
+        for (std::size_t i = 0; i < sumOfBooks; ++i) {
+            auto bookPath = ret / ("Manga " + std::to_string(i)) / "capture 1";
+            std::vector<fs::path> images;
+            for (std::size_t page = 1; page <= sumOfPages; ++page) {
+                images.emplace_back(bookPath / (std::to_string(page) + ".jpg"));
+            }
+            TagIdList tags;
+            for (int j = 0; j < 8; ++j) tags.push_back(dist(rng));
+            library.addBook(std::move(images), tags);
+        }
+        library.write();
+        CatalogSnapshot::write(library, library.getSnapshotPath());
+        return ret;
+    }
+}
+
+static void BM_LibraryColdStart(benchmark::State &state) {
+    auto root = getLibraryRoot(static_cast<std::size_t>(state.range(0)),
+        static_cast<std::size_t>(state.range(1)));
+    std::size_t heapBytes = 0U;
+    for (auto _ : state) {
+        auto before = getHeapBytes();
+        Library library(root);
+        benchmark::DoNotOptimize(library.read());
+        heapBytes = getHeapBytes() - before;
+    }
+    state.counters["heapBytes"] = static_cast<double>(heapBytes);
+}
+BENCHMARK(BM_LibraryColdStart)->Args({100000, 0})->Args({100000, 20})->Unit(benchmark::kMillisecond);
+
+static void BM_SnapshotColdStart(benchmark::State &state) {
+    auto root = getLibraryRoot(static_cast<std::size_t>(state.range(0)),
+        static_cast<std::size_t>(state.range(1)));
+    auto path = Library(root).getSnapshotPath();
+    for (auto _ : state) {
+        CatalogSnapshot snapshot(path);
+        benchmark::DoNotOptimize(snapshot.getBook(static_cast<BookIdType>(state.iterations() % 100000U + 1U)).getImagePath(0));
+    }
+}
+BENCHMARK(BM_SnapshotColdStart)->Args({100000, 0})->Args({100000, 20})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
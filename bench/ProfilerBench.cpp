@@ -0,0 +1,32 @@
+// 作用域计时器的开销
+// 参数 0 为采样关闭，1 为开启采样，2 为同时开启追踪
+#include <benchmark/benchmark.h>
+#include "Profiler.h"
+
+using namespace book;
+
+static void BM_ScopedTimer(benchmark::State &state) {
+    auto &profiler = Profiler::global();
+    profiler.reset();
+    Profiler::setEnabled(state.range(0) >= 1);
+    profiler.setTracing(state.range(0) >= 2);
+    for (auto _ : state) {
+        ScopedTimer timer(ProbeId::ImageRead);
+        benchmark::ClobberMemory();
+    }
+    Profiler::setEnabled(false);
+    profiler.setTracing(false);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScopedTimer)->Arg(0)->Arg(1)->Arg(2);
+
+static void BM_ProfilerCount(benchmark::State &state) {
+    Profiler::global().reset();
+    Profiler::setEnabled(state.range(0) != 0);
+    for (auto _ : state) Profiler::count(CounterId::ImageBytesRead, 4096U);
+    Profiler::setEnabled(false);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProfilerCount)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,38 @@
+// LibraryScanner 全库扫描基准测试
+// 参数为线程数，扫描耗时应随线程数增加而下降
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include "Scanner.h"
+
+using namespace book;
+
+namespace {
+    // 生成 200 部漫画 x 5 话 x 40 页的空图像文件目录树
+    const fs::path &getRoot() {
+        static const fs::path root = [] {
+            auto ret = fs::temp_directory_path() / "manga-manager-scan-bench";
+            if (fs::exists(ret)) return ret;
+            for (int manga = 1; manga <= 200; ++manga) {
+                for (int chapter = 1; chapter <= 5; ++chapter) {
+                    auto dir = ret / ("Manga " + std::to_string(manga)) / ("capture " + std::to_string(chapter));
+                    fs::create_directories(dir);
+                    for (int page = 1; page <= 40; ++page) std::ofstream(dir / (std::to_string(page) + ".jpg"));
+                }
+            }
+            return ret;
+        }();
+        return root;
+    }
+}
+
+static void BM_ScanLibrary(benchmark::State &state) {
+    const auto &root = getRoot();
+    ThreadPool pool(static_cast<std::size_t>(state.range(0)));
+    LibraryScanner scanner(&pool);
+    for (auto _ : state) benchmark::DoNotOptimize(scanner.scan(root));
+    state.SetItemsProcessed(state.iterations() * 200 * 5 * 40);
+}
+BENCHMARK(BM_ScanLibrary)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+// 序列化层基准测试
+// CRC32C 吞吐量与 varint 编解码速度
+#include <benchmark/benchmark.h>
+#include <string>
+#include "Serialize.h"
+
+using namespace book;
+
+// 计算 CRC32C，数据量从 4KB 增长到 16MB
+static void BM_Crc32c(benchmark::State &state) {
+    std::string data(static_cast<std::size_t>(state.range(0)), '\x5a');
+    auto bytes = std::as_bytes(std::span(data.data(), data.size()));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(crc32c(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Crc32c)->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+
+// 编码并解码 100 万个 varint
+static void BM_Varint(benchmark::State &state) {
+    constexpr std::uint64_t count = 1000000U;
+    for (auto _ : state) {
+        BinaryWriter out;
+        out.reserve(count * 3U);
+        for (std::uint64_t i = 0; i < count; ++i) out.putVarint(i * 37U);
+        BinaryReader in(out.getData());
+        std::uint64_t value, sum = 0U;
+        while (in.getVarint(value)) sum += value;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Varint);
+
+BENCHMARK_MAIN();
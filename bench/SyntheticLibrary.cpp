@@ -0,0 +1,239 @@
+#include "SyntheticLibrary.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <zlib.h>
+
+using namespace book;
+
+/* 合成漫画库辅助函数 */
+namespace {
+    // 与 README 内的默认标签分组一致，更多的组依次编号
+    constexpr std::array<std::string_view, 5> defaultGroupNames = { "原作", "类型", "作者", "语言", "连载状态" };
+
+    /*
+     * 按 Zipf 分布抽样：第 i 个元素的权重为 1 / (i + 1)^skew
+     * 只依赖 mt19937 的输出，不使用标准库的分布类，保证不同标准库实现生成相同的结果
+     */
+    class ZipfSampler {
+    public:
+        ZipfSampler(std::size_t n, double skew) : m_cdf(n) {
+            double sum = 0.0;
+            for (std::size_t i = 0; i < n; ++i) m_cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1U), skew);
+        }
+
+        std::size_t operator()(std::mt19937 &rng) const {
+            auto u = std::ldexp(static_cast<double>(rng()), -32) * m_cdf.back();
+            auto it = std::upper_bound(m_cdf.begin(), m_cdf.end(), u);
+            return std::min(static_cast<std::size_t>(it - m_cdf.begin()), m_cdf.size() - 1U);
+        }
+
+    private:
+        std::vector<double> m_cdf;  // 累积权重
+    };
+
+    void putBigEndian(std::string &out, std::uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<char>((value >> shift) & 0xFFU));
+    }
+
+    // 生成 size 字节的占位 PNG：合法的文件签名与 IHDR 块，其后以 0 填充
+    std::string makePlaceholderPng(std::uint32_t width, std::uint32_t height, std::size_t size) {
+        std::string ret("\x89PNG\r\n\x1a\n", 8U);
+        putBigEndian(ret, 13U);
+        auto chunk = ret.size();
+        ret.append("IHDR");
+        putBigEndian(ret, width);
+        putBigEndian(ret, height);
+        ret.append("\x08\x02\x00\x00\x00", 5U);    // 8 位 RGB，无隔行
+        auto crc = crc32(0L, reinterpret_cast<const Bytef *>(ret.data() + chunk), static_cast<uInt>(ret.size() - chunk));
+        putBigEndian(ret, static_cast<std::uint32_t>(crc));
+        if (ret.size() < size) ret.resize(size, '\0');
+        return ret;
+    }
+
+    template <typename T>
+    bool parseValue(std::string_view text, T &value) {
+        auto end = text.data() + text.size();
+        auto [ptr, ec] = std::from_chars(text.data(), end, value);
+        return ec == std::errc() && ptr == end;
+    }
+}
+
+/* class SyntheticLibrary */
+/* ===== BEGIN ===== */
+SyntheticLibrary::SyntheticLibrary(const SyntheticOptions &options) : m_options(options) {
+    m_options.m_sumOfGroups = std::max<std::size_t>(m_options.m_sumOfGroups, 1U);
+    m_options.m_tagsPerManga = std::min(m_options.m_tagsPerManga, m_options.m_sumOfTags);
+    std::mt19937 rng(m_options.m_seed);
+
+    m_groupNames.reserve(m_options.m_sumOfGroups);
+    for (std::size_t i = 0; i < m_options.m_sumOfGroups; ++i) {
+        if (i < defaultGroupNames.size()) m_groupNames.emplace_back(defaultGroupNames[i]);
+        else m_groupNames.emplace_back("分组 " + std::to_string(i + 1U));
+    }
+
+    // 各组的大小同样不均匀，靠前的组拥有更多标签
+    ZipfSampler groupSampler(m_options.m_sumOfGroups, 1.0);
+    m_tagNames.reserve(m_options.m_sumOfTags);
+    m_tagGroups.reserve(m_options.m_sumOfTags);
+    for (std::size_t i = 0; i < m_options.m_sumOfTags; ++i) {
+        auto group = groupSampler(rng);
+        m_tagGroups.emplace_back(group);
+        m_tagNames.emplace_back(m_groupNames[group] + "-" + std::to_string(i + 1U));
+    }
+
+    // 标签下标即热度排名，每部漫画不重复地抽取 m_tagsPerManga 个
+    m_mangaTags.resize(m_options.m_sumOfMangas);
+    if (m_options.m_tagsPerManga == 0U) return;
+    ZipfSampler tagSampler(m_options.m_sumOfTags, m_options.m_tagSkew);
+    for (auto &tags : m_mangaTags) {
+        tags.reserve(m_options.m_tagsPerManga);
+        while (tags.size() < m_options.m_tagsPerManga) {
+            auto tag = tagSampler(rng);
+            if (std::find(tags.begin(), tags.end(), tag) == tags.end()) tags.emplace_back(tag);
+        }
+        std::sort(tags.begin(), tags.end());
+    }
+}
+
+const SyntheticOptions &SyntheticLibrary::getOptions() const {
+    return m_options;
+}
+
+std::size_t SyntheticLibrary::getSumOfBooks() const {
+    return m_options.m_sumOfMangas * m_options.m_chaptersPerManga;
+}
+
+std::size_t SyntheticLibrary::getSumOfPages() const {
+    return getSumOfBooks() * m_options.m_pagesPerChapter;
+}
+
+const std::vector<std::string> &SyntheticLibrary::getGroupNames() const {
+    return m_groupNames;
+}
+
+const std::vector<std::string> &SyntheticLibrary::getTagNames() const {
+    return m_tagNames;
+}
+
+const std::vector<std::size_t> &SyntheticLibrary::getMangaTags(std::size_t manga) const {
+    return m_mangaTags[manga];
+}
+
+std::string SyntheticLibrary::describe() const {
+    return std::to_string(m_options.m_sumOfMangas) + " mangas x " + std::to_string(m_options.m_chaptersPerManga)
+        + " chapters x " + std::to_string(m_options.m_pagesPerChapter) + " pages, "
+        + std::to_string(m_options.m_sumOfTags) + " tags in " + std::to_string(m_options.m_sumOfGroups) + " groups, "
+        + std::to_string(m_options.m_tagsPerManga) + " tags per manga, skew " + std::to_string(m_options.m_tagSkew)
+        + ", " + std::to_string(m_options.m_pageSize) + " bytes per page, seed " + std::to_string(m_options.m_seed);
+}
+
+fs::path SyntheticLibrary::getRoot() const {
+    // 只有影响文件内容的选项参与目录名
+    auto name = std::to_string(m_options.m_sumOfMangas) + "-" + std::to_string(m_options.m_chaptersPerManga)
+        + "-" + std::to_string(m_options.m_pagesPerChapter) + "-" + std::to_string(m_options.m_pageSize)
+        + "-" + std::to_string(m_options.m_seed);
+    return fs::temp_directory_path() / "manga-manager-synthetic" / name;
+}
+
+fs::path SyntheticLibrary::getChapterPath(std::size_t manga, std::size_t chapter) const {
+    return getRoot() / ("Manga " + std::to_string(manga + 1U)) / ("capture " + std::to_string(chapter + 1U));
+}
+
+std::vector<fs::path> SyntheticLibrary::getPagePaths(std::size_t manga, std::size_t chapter) const {
+    auto dir = getChapterPath(manga, chapter);
+    std::vector<fs::path> ret;
+    ret.reserve(m_options.m_pagesPerChapter);
+    for (std::size_t page = 1; page <= m_options.m_pagesPerChapter; ++page)
+        ret.emplace_back(dir / (std::to_string(page) + ".png"));
+    return ret;
+}
+
+bool SyntheticLibrary::createFiles() const {
+    auto root = getRoot();
+    // 生成完成后才写入标记，中途失败的目录在下次调用时重新生成
+    auto marker = root / ".data" / "synthetic.done";
+    std::error_code ec;
+    if (fs::exists(marker, ec)) return true;
+    fs::remove_all(root, ec);
+    if (!fs::create_directories(root / ".data", ec)) return false;
+
+    std::mt19937 rng(m_options.m_seed);
+    for (std::size_t manga = 0; manga < m_options.m_sumOfMangas; ++manga) {
+        for (std::size_t chapter = 0; chapter < m_options.m_chaptersPerManga; ++chapter) {
+            if (!fs::create_directories(getChapterPath(manga, chapter), ec)) return false;
+            for (auto &path : getPagePaths(manga, chapter)) {
+                // 尺寸在常见漫画页面尺寸附近浮动
+                auto width = 800U + rng() % 400U, height = 1100U + rng() % 600U;
+                auto content = makePlaceholderPng(width, height, m_options.m_pageSize);
+                std::ofstream file(path, std::ios::binary);
+                if (!file.write(content.data(), static_cast<std::streamsize>(content.size()))) return false;
+            }
+        }
+    }
+    std::ofstream file(marker, std::ios::binary);
+    return static_cast<bool>(file << describe());
+}
+
+TagIdList SyntheticLibrary::createTags(TagManager &manager) const {
+    TagIdList groups;
+    groups.reserve(m_groupNames.size());
+    for (auto &name : m_groupNames) groups.emplace_back(manager.createGroupTag(name));
+    TagIdList ret;
+    ret.reserve(m_tagNames.size());
+    for (std::size_t i = 0; i < m_tagNames.size(); ++i)
+        ret.emplace_back(manager.createBookTag(m_tagNames[i], groups[m_tagGroups[i]]));
+    return ret;
+}
+
+bool SyntheticLibrary::fill(Library &library) const {
+    auto ids = createTags(library.getTagManager());
+    TagIdList tags;
+    for (std::size_t manga = 0; manga < m_options.m_sumOfMangas; ++manga) {
+        tags.clear();
+        for (auto tag : m_mangaTags[manga]) tags.emplace_back(ids[tag]);
+        for (std::size_t chapter = 0; chapter < m_options.m_chaptersPerManga; ++chapter)
+            if (library.addBook(getPagePaths(manga, chapter), tags) == nullBookId) return false;
+    }
+    return true;
+}
+/* ====== END ====== */
+
+bool book::parseSyntheticOptions(int &argc, char **argv, SyntheticOptions &options) {
+    constexpr std::string_view prefix = "--synthetic_";
+    bool ret = true;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        auto eq = arg.find('=');
+        if (!arg.starts_with(prefix) || eq == std::string_view::npos) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        auto name = arg.substr(prefix.size(), eq - prefix.size()), value = arg.substr(eq + 1U);
+        bool ok = false;
+        if (name == "mangas") ok = parseValue(value, options.m_sumOfMangas);
+        else if (name == "chapters") ok = parseValue(value, options.m_chaptersPerManga);
+        else if (name == "pages") ok = parseValue(value, options.m_pagesPerChapter);
+        else if (name == "groups") ok = parseValue(value, options.m_sumOfGroups);
+        else if (name == "tags") ok = parseValue(value, options.m_sumOfTags);
+        else if (name == "tags_per_manga") ok = parseValue(value, options.m_tagsPerManga);
+        else if (name == "skew") ok = parseValue(value, options.m_tagSkew);
+        else if (name == "page_size") ok = parseValue(value, options.m_pageSize);
+        else if (name == "seed") ok = parseValue(value, options.m_seed);
+        else {
+            // 未知的名字留给调用方报告
+            argv[kept++] = argv[i];
+            continue;
+        }
+        ret = ret && ok;
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return ret;
+}
@@ -0,0 +1,86 @@
+#ifndef SYNTHETIC_LIBRARY_H
+#define SYNTHETIC_LIBRARY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Library.h"
+
+namespace book {
+    // 合成漫画库的规模与分布，默认值约为一个中等规模的个人漫画库
+    struct SyntheticOptions {
+        std::size_t m_sumOfMangas = 200U;       // 漫画部数
+        std::size_t m_chaptersPerManga = 5U;    // 每部漫画的话数，每一话登记为一本书
+        std::size_t m_pagesPerChapter = 20U;    // 每话页数
+        std::size_t m_sumOfGroups = 8U;         // 标签组个数
+        std::size_t m_sumOfTags = 2000U;        // 书标签个数
+        std::size_t m_tagsPerManga = 10U;       // 每部漫画的标签个数，同一部漫画的各话标签相同
+        double m_tagSkew = 1.0;                 // 标签热度的 Zipf 指数，0 为均匀分布，越大热门标签越集中
+        std::size_t m_pageSize = 1024U;         // 占位图像文件的字节数
+        std::uint32_t m_seed = 1U;              // 随机种子，选项相同时生成的漫画库完全相同
+    };
+
+    /*
+     * class SyntheticLibrary
+     * 按 SyntheticOptions 确定性地生成测试与基准测试用的漫画库
+     * 构造时只生成标签与各部漫画的标签分配，目录树与占位图像由 createFiles() 按需生成
+     * 目录结构与真实漫画库相同：<根目录>/Manga i/capture j/k.png
+     */
+    class SyntheticLibrary {
+    public:
+        SyntheticLibrary(const SyntheticOptions &options = {});
+
+    private:
+        SyntheticOptions m_options;
+        std::vector<std::string> m_groupNames;          // 标签组名
+        std::vector<std::string> m_tagNames;            // 书标签名
+        std::vector<std::size_t> m_tagGroups;           // 每个书标签所属组的下标
+        std::vector<std::vector<std::size_t>> m_mangaTags;  // 每部漫画的书标签下标
+
+    public:
+        // 获取生成选项
+        const SyntheticOptions &getOptions() const;
+        // 获取书籍总数，即漫画部数与每部话数之积
+        std::size_t getSumOfBooks() const;
+        // 获取页面总数
+        std::size_t getSumOfPages() const;
+        // 获取所有标签组名
+        const std::vector<std::string> &getGroupNames() const;
+        // 获取所有书标签名
+        const std::vector<std::string> &getTagNames() const;
+        // 获取第 manga 部漫画的书标签下标
+        const std::vector<std::size_t> &getMangaTags(std::size_t manga) const;
+        // 用 1 行文字描述生成选项，用于基准测试结果的上下文
+        std::string describe() const;
+
+        // 获取漫画库根目录：系统临时目录下由生成选项决定的子目录，不同选项互不干扰
+        fs::path getRoot() const;
+        // 获取第 manga 部漫画第 chapter 话（均从 0 开始）的目录
+        fs::path getChapterPath(std::size_t manga, std::size_t chapter) const;
+        // 获取第 manga 部漫画第 chapter 话的所有页面路径，按自然顺序排列
+        std::vector<fs::path> getPagePaths(std::size_t manga, std::size_t chapter) const;
+        /*
+         * 在 getRoot() 下生成目录树与占位图像，已经完整生成过时直接返回
+         * 占位图像为带有合法 PNG 头部的 m_pageSize 字节文件，可以被探测出尺寸
+         * 成功返回 true，失败返回 false
+         */
+        bool createFiles() const;
+
+        // 在 manager 内创建所有标签组与书标签，返回书标签下标到ID的映射
+        TagIdList createTags(TagManager &manager) const;
+        /*
+         * 在 library 内创建所有标签，并将每一话登记为一本书，不要求文件存在
+         * 成功返回 true，书籍已满时返回 false
+         */
+        bool fill(Library &library) const;
+    };
+
+    /*
+     * 从命令行读取生成选项，识别出的参数从 argv 中移除，其余参数保持原有顺序
+     * 参数形如 --synthetic_mangas=200，可用的名字见 SyntheticLibrary.cpp
+     * 参数值不合法时返回 false
+     */
+    bool parseSyntheticOptions(int &argc, char **argv, SyntheticOptions &options);
+}
+
+#endif
@@ -0,0 +1,145 @@
+// 基于合成漫画库的端到端基准测试：标签查找与增删、目录扫描、数据文件读写、页面读取
+// 漫画库规模由 --synthetic_* 参数指定（见 SyntheticLibrary.h），相同参数下每次运行的输入完全相同
+// 配合 --benchmark_out=<file> --benchmark_out_format=json 输出结果用于回归比较
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "Scanner.h"
+#include "SyntheticLibrary.h"
+
+using namespace book;
+
+namespace {
+    SyntheticOptions &getOptions() {
+        static SyntheticOptions options;
+        return options;
+    }
+
+    // 第一次使用时按命令行选项生成
+    const SyntheticLibrary &getSynthetic() {
+        static const SyntheticLibrary synthetic(getOptions());
+        return synthetic;
+    }
+
+    // 已生成目录树的漫画库根目录
+    const fs::path &getRoot() {
+        static const fs::path root = [] {
+            getSynthetic().createFiles();
+            return getSynthetic().getRoot();
+        }();
+        return root;
+    }
+
+    // 登记了所有书籍的漫画库，根目录为合成漫画库的根目录
+    const Library &getLibrary() {
+        static const std::unique_ptr<Library> library = [] {
+            auto ret = std::make_unique<Library>(getRoot());
+            getSynthetic().fill(*ret);
+            return ret;
+        }();
+        return *library;
+    }
+
+    // 写出 getLibrary() 的数据文件，返回其路径
+    const fs::path &getDataPath() {
+        static const fs::path path = [] {
+            auto ret = getRoot() / ".data" / "bench.dat";
+            getLibrary().write(ret);
+            return ret;
+        }();
+        return path;
+    }
+}
+
+// 按名字查找书标签，名字按热度排名均匀轮换
+static void BM_SyntheticTagLookup(benchmark::State &state) {
+    auto &names = getSynthetic().getTagNames();
+    TagManager manager;
+    getSynthetic().createTags(manager);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager.getBookTagId(names[i]));
+        if (++i == names.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticTagLookup);
+
+// 在已满载的标签管理器内反复创建并删除一个书标签
+static void BM_SyntheticTagCreateErase(benchmark::State &state) {
+    TagManager manager;
+    getSynthetic().createTags(manager);
+    auto group = manager.getGroupTagId(getSynthetic().getGroupNames().front());
+    for (auto _ : state) {
+        auto id = manager.createBookTag("synthetic bench tag", group);
+        benchmark::DoNotOptimize(manager.eraseBookTag(id));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticTagCreateErase);
+
+// 扫描整个合成漫画库的目录树
+static void BM_SyntheticScan(benchmark::State &state) {
+    const auto &root = getRoot();
+    LibraryScanner scanner;
+    for (auto _ : state) benchmark::DoNotOptimize(scanner.scan(root));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(getSynthetic().getSumOfPages()));
+}
+BENCHMARK(BM_SyntheticScan)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 将整个漫画库编码并写入数据文件
+static void BM_SyntheticSerialize(benchmark::State &state) {
+    const auto &library = getLibrary();
+    auto path = getRoot() / ".data" / "bench-write.dat";
+    for (auto _ : state) benchmark::DoNotOptimize(library.write(path));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(library.getSumOfBooks()));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(path)));
+}
+BENCHMARK(BM_SyntheticSerialize)->Unit(benchmark::kMillisecond);
+
+// 从数据文件读入整个漫画库
+static void BM_SyntheticDeserialize(benchmark::State &state) {
+    const auto &path = getDataPath();
+    for (auto _ : state) {
+        Library library(getRoot());
+        benchmark::DoNotOptimize(library.read(path));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(getLibrary().getSumOfBooks()));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(path)));
+}
+BENCHMARK(BM_SyntheticDeserialize)->Unit(benchmark::kMillisecond);
+
+// 依次读取各书的所有页面；参数为 0 时每次从文件读入，为 1 时经由页面缓存
+static void BM_SyntheticPageRead(benchmark::State &state) {
+    getRoot();
+    const auto &library = getLibrary();
+    auto books = library.getBooks();
+    bool cached = state.range(0) != 0;
+    std::int64_t bytes = 0;
+    for (auto _ : state) {
+        for (auto id : *books) {
+            auto book = library.getBook(id);
+            for (std::size_t i = 0; i < book->getSumOfImages(); ++i) {
+                if (cached) {
+                    auto content = book->getCachedContent(i);
+                    bytes += content ? static_cast<std::int64_t>(content->size()) : 0;
+                } else {
+                    auto content = book->getImageContent(i);
+                    bytes += content ? static_cast<std::int64_t>(content->size()) : 0;
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(getSynthetic().getSumOfPages()));
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_SyntheticPageRead)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+    if (!parseSyntheticOptions(argc, argv, getOptions())) return 1;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::AddCustomContext("synthetic_library", getSynthetic().describe());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// TagManager 标签名查找、按组列出与ID回收基准测试
+// 标签数量从 2^8 增长到接近 maxTagId，查找耗时应保持平稳
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "Tag.h"
+
+using namespace book;
+
+namespace {
+    // 生成第 i 个标签名
+    std::string tagName(std::size_t i) {
+        return "tag-" + std::to_string(i * 2654435761U % 1000003U) + "-" + std::to_string(i);
+    }
+
+    // 创建含有 count 个书标签的管理器，并返回所有标签名
+    std::vector<std::string> fillManager(TagManager &manager, std::size_t count) {
+        std::vector<std::string> names;
+        names.reserve(count);
+        auto groupId = manager.createGroupTag("group");
+        for (std::size_t i = 0; i < count; ++i) {
+            names.emplace_back(tagName(i));
+            manager.createBookTag(names.back(), groupId);
+        }
+        return names;
+    }
+}
+
+// 按标签名查找书标签ID
+static void BM_GetBookTagId(benchmark::State &state) {
+    TagManager manager;
+    auto names = fillManager(manager, static_cast<std::size_t>(state.range(0)));
+    std::mt19937 rng(42U);
+    std::uniform_int_distribution<std::size_t> dist(0, names.size() - 1);
+    for (auto _ : state) {
+        std::string_view name = names[dist(rng)];
+        benchmark::DoNotOptimize(manager.getBookTagId(name));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetBookTagId)->RangeMultiplier(4)->Range(1 << 8, maxTagId - 1);
+
+// 批量导入标签，总耗时应随标签数量线性增长
+static void BM_CreateBookTags(benchmark::State &state) {
+    auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < count; ++i) names.emplace_back(tagName(i));
+    for (auto _ : state) {
+        TagManager manager;
+        auto groupId = manager.createGroupTag("group");
+        for (const auto &name : names) manager.createBookTag(name, groupId);
+        benchmark::DoNotOptimize(manager.getSumOfBookTags());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CreateBookTags)->RangeMultiplier(4)->Range(1 << 8, maxTagId - 1);
+
+// 按组列出标签（侧栏）：64 个组，只取第一个组的数量与标签，耗时应与总标签数无关
+static void BM_GroupMembers(benchmark::State &state) {
+    TagManager manager;
+    std::vector<TagIdType> groups;
+    for (int i = 0; i < 64; ++i) groups.emplace_back(manager.createGroupTag("group " + std::to_string(i)));
+    auto count = static_cast<std::size_t>(state.range(0));
+    for (std::size_t i = 0; i < count; ++i) manager.createBookTag(tagName(i), groups[i % groups.size()]);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager.getSumOfTagsFromGroup(groups[0]));
+        benchmark::DoNotOptimize(manager.getBookTags(groups[0]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GroupMembers)->RangeMultiplier(8)->Range(1 << 8, 1 << 14);
+
+// 删除一半标签后反复删除并重建一个标签，新标签总是取最小的空闲ID
+static void BM_RecycleBookTag(benchmark::State &state) {
+    TagManager manager;
+    auto names = fillManager(manager, static_cast<std::size_t>(state.range(0)));
+    for (std::size_t i = 0; i < names.size(); i += 2) manager.eraseBookTag(manager.getBookTagId(names[i]));
+    auto groupId = manager.getGroupTagId("group");
+    for (auto _ : state) {
+        auto id = manager.createBookTag("recycled", groupId);
+        benchmark::DoNotOptimize(manager.eraseBookTag(id));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecycleBookTag)->RangeMultiplier(8)->Range(1 << 8, 1 << 14);
+
+// 删除一半标签后压缩书标签ID
+static void BM_CompactBookTags(benchmark::State &state) {
+    auto count = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        TagManager manager;
+        auto names = fillManager(manager, count);
+        for (std::size_t i = 0; i < names.size(); i += 2) manager.eraseBookTag(manager.getBookTagId(names[i]));
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(manager.compactBookTags());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CompactBookTags)->RangeMultiplier(8)->Range(1 << 8, 1 << 14)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
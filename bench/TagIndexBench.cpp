@@ -0,0 +1,53 @@
+// TagIndex 多标签查询基准测试
+// 在 20 万本书的索引上执行 AND/OR/NOT 查询
+#include <benchmark/benchmark.h>
+#include <random>
+#include "TagIndex.h"
+
+using namespace book;
+
+namespace {
+    constexpr BookIdType sumOfBooks = 200000U;
+    constexpr TagIdType sumOfTags = 2000U;
+
+    // 构造索引：标签使用频率服从 Zipf 分布，每本书 8 个标签
+    const TagIndex &getIndex() {
+        static const TagIndex index = [] {
+            TagIndex ret;
+            std::mt19937 rng(7U);
+            std::vector<double> weights(sumOfTags);
+            for (std::size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / double(i + 1U);
+            std::discrete_distribution<TagIdType> dist(weights.begin(), weights.end());
+            for (BookIdType id = 1; id <= sumOfBooks; ++id) {
+                TagIdList tags;
+                for (int i = 0; i < 8; ++i) tags.push_back(dist(rng) + 1U);
+                ret.addBook(id, tags);
+            }
+            return ret;
+        }();
+        return index;
+    }
+}
+
+static void BM_QueryAnd(benchmark::State &state) {
+    const auto &index = getIndex();
+    TagQuery query{ {1U, 2U, 3U}, {}, {} };
+    for (auto _ : state) benchmark::DoNotOptimize(index.query(query));
+}
+BENCHMARK(BM_QueryAnd);
+
+static void BM_QueryOrNot(benchmark::State &state) {
+    const auto &index = getIndex();
+    TagQuery query{ {}, {10U, 20U, 30U}, {1U} };
+    for (auto _ : state) benchmark::DoNotOptimize(index.query(query));
+}
+BENCHMARK(BM_QueryOrNot);
+
+static void BM_QueryMixed(benchmark::State &state) {
+    const auto &index = getIndex();
+    TagQuery query{ {1U}, {5U, 6U, 7U}, {2U} };
+    for (auto _ : state) benchmark::DoNotOptimize(index.query(query));
+}
+BENCHMARK(BM_QueryMixed);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+// 书籍标签集合基准测试
+// 10000 本书各 12 个标签，逐本判断是否含有某个标签、统计某个组内的标签数，每本书应在几纳秒内完成
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "Book.h"
+
+using namespace book;
+
+namespace {
+    constexpr std::size_t sumOfBooks = 10000U;
+    constexpr std::size_t sumOfTags = 4096U;
+    constexpr std::size_t sumOfGroups = 32U;
+    constexpr std::size_t tagsPerBook = 12U;
+
+    struct Fixture {
+        TagManager m_manager;
+        std::vector<Book> m_books;
+        std::vector<TagIdType> m_groups;
+        std::vector<TagIdType> m_tags;
+
+        Fixture() {
+            std::mt19937 rng(42U);
+            for (std::size_t i = 0; i < sumOfGroups; ++i) m_groups.emplace_back(m_manager.createGroupTag("group " + std::to_string(i)));
+            for (std::size_t i = 0; i < sumOfTags; ++i) {
+                m_tags.emplace_back(m_manager.createBookTag("tag " + std::to_string(i), m_groups[i % sumOfGroups]));
+            }
+            m_books.reserve(sumOfBooks);
+            for (std::size_t i = 1; i <= sumOfBooks; ++i) {
+                TagIdList tags;
+                while (tags.size() < tagsPerBook) {
+                    auto tagId = m_tags[rng() % sumOfTags];
+                    if (std::ranges::find(tags, tagId) == tags.end()) tags.emplace_back(tagId);
+                }
+                m_books.emplace_back(std::vector<fs::path>(), &m_manager, static_cast<BookIdType>(i), tags);
+            }
+        }
+    };
+
+    Fixture &getFixture() {
+        static Fixture fixture;
+        return fixture;
+    }
+}
+
+// 逐本判断是否含有某个标签
+static void BM_HasTag(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto tagId = fixture.m_tags[i++ % sumOfTags];
+        std::size_t count = 0U;
+        for (const auto &book : fixture.m_books) count += book.hasTag(tagId);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * sumOfBooks);
+}
+BENCHMARK(BM_HasTag);
+
+// 逐本统计某个组内的标签数（分面计数）
+static void BM_SumOfTagsInGroup(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto groupId = fixture.m_groups[i++ % sumOfGroups];
+        std::size_t count = 0U;
+        for (const auto &book : fixture.m_books) count += book.getSumOfTags(groupId);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * sumOfBooks);
+}
+BENCHMARK(BM_SumOfTagsInGroup);
+
+// 单本书上大量标签的增删，参数为标签个数，超过 TagSet::bitsetThreshold 后查找走位图
+static void BM_AddRemoveTag(benchmark::State &state) {
+    auto &fixture = getFixture();
+    auto count = static_cast<std::size_t>(state.range(0));
+    Book book(std::vector<fs::path>(), &fixture.m_manager, 1U, TagIdList(fixture.m_tags.begin(), fixture.m_tags.begin() + count));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto tagId = fixture.m_tags[count + i++ % (sumOfTags - count)];
+        book.addTag(tagId);
+        benchmark::DoNotOptimize(book.hasTag(tagId));
+        book.removeTag(tagId);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddRemoveTag)->Arg(4)->Arg(32)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,120 @@
+// 标签补全基准测试
+// 60k 个书标签分布在 64 个组内，前缀补全与容错补全取前 10 个结果都应在微秒级
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "Tag.h"
+
+using namespace book;
+
+namespace {
+    constexpr std::size_t sumOfTags = 60000U;
+    constexpr std::size_t sumOfGroups = 64U;
+    constexpr std::size_t limit = 10U;
+
+    const char *const syllables[] = {
+        "ka", "shi", "to", "na", "ri", "mo", "yu", "ha", "ne", "ko", "ra", "sa", "ta", "mi", "su", "no",
+    };
+    const char *const hanzi[] = { "少", "年", "恋", "爱", "战", "斗", "日", "常", "魔", "法", "校", "园", "冒", "险", "科", "幻" };
+
+    // 生成第 i 个标签名：拉丁音节组成的名字或中文名字，末尾带编号保证互不相同
+    std::string tagName(std::size_t i, std::mt19937 &rng) {
+        std::string ret;
+        auto length = 2U + rng() % 4U;
+        bool latin = rng() % 4U != 0U;
+        for (unsigned j = 0; j < length; ++j) ret += latin ? syllables[rng() % 16U] : hanzi[rng() % 16U];
+        return ret + " " + std::to_string(i);
+    }
+
+    struct Fixture {
+        TagManager m_manager;
+        std::vector<TagIdType> m_groups;
+        std::vector<std::string> m_names;
+
+        Fixture() {
+            std::mt19937 rng(42U);
+            for (std::size_t i = 0; i < sumOfGroups; ++i) m_groups.emplace_back(m_manager.createGroupTag("group " + std::to_string(i)));
+            for (std::size_t i = 0; i < sumOfTags; ++i) {
+                m_names.emplace_back(tagName(i, rng));
+                m_manager.createBookTag(m_names.back(), m_groups[i % sumOfGroups]);
+            }
+        }
+    };
+
+    Fixture &getFixture() {
+        static Fixture fixture;
+        return fixture;
+    }
+
+    // 随机取一个标签名的前 length 个字节（不截断多字节字符）
+    std::string getPrefix(const std::string &name, std::size_t length) {
+        length = std::min(length, name.size());
+        while (length < name.size() && (static_cast<unsigned char>(name[length]) & 0xc0U) == 0x80U) ++length;
+        return name.substr(0, length);
+    }
+}
+
+// 前缀补全，参数为输入的字节数
+static void BM_SuggestPrefix(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::mt19937 rng(7U);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 256; ++i) queries.emplace_back(getPrefix(fixture.m_names[rng() % sumOfTags], std::size_t(state.range(0))));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.m_manager.suggestBookTags(queries[i++ % queries.size()], limit));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SuggestPrefix)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+// 容错补全，输入为替换了一个字符的前缀，参数为允许的编辑距离
+static void BM_SuggestFuzzy(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::mt19937 rng(7U);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 256; ++i) {
+        auto query = getPrefix(fixture.m_names[rng() % sumOfTags], 6U);
+        if (static_cast<unsigned char>(query[1]) < 0x80U) query[1] = 'z';
+        queries.emplace_back(std::move(query));
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.m_manager.suggestBookTags(queries[i++ % queries.size()], limit,
+            static_cast<unsigned>(state.range(0))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SuggestFuzzy)->Arg(1)->Arg(2);
+
+// 限定在一个组内的前缀补全
+static void BM_SuggestScoped(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::mt19937 rng(7U);
+    std::vector<std::pair<std::string, TagIdType>> queries;
+    for (int i = 0; i < 256; ++i) {
+        queries.emplace_back(getPrefix(fixture.m_names[rng() % sumOfTags], 2U), fixture.m_groups[rng() % sumOfGroups]);
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto &[query, groupId] = queries[i++ % queries.size()];
+        benchmark::DoNotOptimize(fixture.m_manager.suggestBookTags(query, limit, 0U, groupId));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SuggestScoped);
+
+// 创建并删除一个标签，前缀树随之更新
+static void BM_CreateErase(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto id = fixture.m_manager.createBookTag("kashito " + std::to_string(i++), fixture.m_groups[0]);
+        fixture.m_manager.eraseBookTag(id);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateErase);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+// 标签ID宽度基准测试
+// 编码与解码 60000 个书标签与 10000 本书（每本 12 个标签），并以计数器报告内存与编码后的大小
+// 分别以默认的 16 位与 -DBOOK_TAG_ID_BITS=32 构建运行，比较两种宽度下的对象大小与编码后的大小
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "Library.h"
+
+using namespace book;
+
+namespace {
+    constexpr std::size_t sumOfBooks = 10000U;
+    constexpr std::size_t sumOfTags = 60000U;
+    constexpr std::size_t sumOfGroups = 64U;
+    constexpr std::size_t tagsPerBook = 12U;
+
+    struct Fixture {
+        TagManager m_manager;
+        std::vector<Book> m_books;
+
+        Fixture() {
+            std::mt19937 rng(42U);
+            std::vector<TagIdType> groups, tags;
+            for (std::size_t i = 0; i < sumOfGroups; ++i) groups.emplace_back(m_manager.createGroupTag("group " + std::to_string(i)));
+            for (std::size_t i = 0; i < sumOfTags; ++i) {
+                tags.emplace_back(m_manager.createBookTag("tag " + std::to_string(i), groups[i % sumOfGroups]));
+            }
+            m_books.reserve(sumOfBooks);
+            for (std::size_t i = 1; i <= sumOfBooks; ++i) {
+                TagIdList bookTags;
+                for (std::size_t j = 0; j < tagsPerBook; ++j) bookTags.emplace_back(tags[rng() % sumOfTags]);
+                m_books.emplace_back(std::vector<fs::path>(), &m_manager, static_cast<BookIdType>(i), bookTags);
+            }
+        }
+
+        // 编码标签管理器与所有书籍
+        void write(BinaryWriter &out) const {
+            m_manager.write(out);
+            for (const auto &book : m_books) book.write(out);
+        }
+    };
+
+    Fixture &getFixture() {
+        static Fixture fixture;
+        return fixture;
+    }
+
+    // 报告各类型的大小
+    void setCounters(benchmark::State &state, std::size_t encodedSize) {
+        state.counters["tagIdBytes"] = sizeof(TagIdType);
+        state.counters["bookTagBytes"] = sizeof(BookTag);
+        state.counters["tagSetBytes"] = sizeof(TagSet);
+        state.counters["bookBytes"] = sizeof(Book);
+        state.counters["encodedBytes"] = static_cast<double>(encodedSize);
+    }
+}
+
+// 编码
+static void BM_EncodeTags(benchmark::State &state) {
+    auto &fixture = getFixture();
+    std::size_t size = 0U;
+    for (auto _ : state) {
+        BinaryWriter out;
+        fixture.write(out);
+        size = out.getSize();
+        benchmark::DoNotOptimize(size);
+    }
+    setCounters(state, size);
+}
+BENCHMARK(BM_EncodeTags)->Unit(benchmark::kMillisecond);
+
+// 解码
+static void BM_DecodeTags(benchmark::State &state) {
+    auto &fixture = getFixture();
+    BinaryWriter out;
+    fixture.write(out);
+    for (auto _ : state) {
+        BinaryReader in(out.getData());
+        TagManager manager;
+        bool ok = manager.read(in);
+        Book book;
+        for (std::size_t i = 0; ok && i < sumOfBooks; ++i) ok = book.read(in, &manager, Library::fileVersion);
+        if (!ok) state.SkipWithError("decode failed");
+    }
+    setCounters(state, out.getSize());
+}
+BENCHMARK(BM_DecodeTags)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,123 @@
+// TitleIndex 标题搜索基准测试
+// 在 50 万个中日英混合的合成标题上建立索引并执行查询
+#include <benchmark/benchmark.h>
+#include <random>
+#include "TitleIndex.h"
+
+using namespace book;
+
+namespace {
+    constexpr BookIdType sumOfBooks = 500000U;
+
+    // 词表：常用汉字、假名组成的词与英文单词，使用频率服从 Zipf 分布
+    std::vector<std::string> makeWords(std::mt19937 &rng) {
+        std::vector<std::string> ret;
+        auto append = [](std::string &str, char32_t cp) {
+            str.push_back(static_cast<char>(0xe0U | (cp >> 12U)));
+            str.push_back(static_cast<char>(0x80U | ((cp >> 6U) & 0x3fU)));
+            str.push_back(static_cast<char>(0x80U | (cp & 0x3fU)));
+        };
+        for (int i = 0; i < 20000; ++i) {
+            std::string word;
+            auto length = 1U + rng() % 3U;
+            for (unsigned k = 0; k < length; ++k) {
+                auto kana = rng() % 4U == 0U;
+                append(word, kana ? 0x30a1U + rng() % 86U : 0x4e00U + rng() % 3500U);
+            }
+            ret.emplace_back(std::move(word));
+        }
+        for (int i = 0; i < 5000; ++i) {
+            std::string word;
+            auto length = 3U + rng() % 6U;
+            for (unsigned k = 0; k < length; ++k) word.push_back(static_cast<char>('a' + rng() % 26U));
+            ret.emplace_back(std::move(word));
+        }
+        return ret;
+    }
+
+    struct Corpus {
+        TitleIndex m_index;
+        std::vector<std::string> m_titles;
+    };
+
+    // 每个标题由 2 到 6 个词组成，中文词之间不加空格
+    const Corpus &getCorpus() {
+        static const Corpus corpus = [] {
+            Corpus ret;
+            std::mt19937 rng(7U);
+            auto words = makeWords(rng);
+            std::vector<double> weights(words.size());
+            for (std::size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / double(i + 1U);
+            std::discrete_distribution<std::size_t> dist(weights.begin(), weights.end());
+            ret.m_titles.resize(std::size_t(sumOfBooks) + 1U);
+            for (BookIdType id = 1; id <= sumOfBooks; ++id) {
+                auto &title = ret.m_titles[id];
+                auto length = 2U + rng() % 5U;
+                for (unsigned k = 0; k < length; ++k) {
+                    const auto &word = words[dist(rng)];
+                    if (!title.empty() && (word[0] & 0x80) == 0) title.push_back(' ');
+                    title += word;
+                }
+                ret.m_index.addBook(id, title);
+            }
+            return ret;
+        }();
+        return corpus;
+    }
+
+    // 从已有标题中截取查询，保证有结果
+    std::vector<std::string> makeQueries(std::size_t bytes) {
+        const auto &titles = getCorpus().m_titles;
+        std::mt19937 rng(11U);
+        std::vector<std::string> ret;
+        while (ret.size() < 256U) {
+            const auto &title = titles[1U + rng() % sumOfBooks];
+            if (title.size() < bytes || (title[0] & 0x80) == 0) continue;
+            ret.emplace_back(title.substr(0, bytes));
+        }
+        return ret;
+    }
+}
+
+static void BM_Build(benchmark::State &state) {
+    for (auto _ : state) benchmark::DoNotOptimize(&getCorpus());
+    state.counters["bytes"] = double(getCorpus().m_index.getMemoryUsage());
+}
+BENCHMARK(BM_Build)->Iterations(1)->Unit(benchmark::kSecond);
+
+// 按标题开头的 range(0) 字节（每个汉字 3 字节）查询
+static void BM_SearchPrefix(benchmark::State &state) {
+    const auto &index = getCorpus().m_index;
+    auto queries = makeQueries(static_cast<std::size_t>(state.range(0)));
+    std::size_t i = 0U, results = 0U;
+    for (auto _ : state) {
+        auto ret = index.search(queries[i++ % queries.size()], 20U);
+        results += ret.size();
+        benchmark::DoNotOptimize(ret.data());
+    }
+    state.counters["results"] = double(results) / double(state.iterations());
+}
+BENCHMARK(BM_SearchPrefix)->Arg(6)->Arg(9)->Arg(12)->Arg(18);
+
+// 单个常用字
+static void BM_SearchCommonChar(benchmark::State &state) {
+    const auto &index = getCorpus().m_index;
+    auto queries = makeQueries(3U);
+    std::size_t i = 0U;
+    for (auto _ : state) benchmark::DoNotOptimize(index.search(queries[i++ % queries.size()], 20U));
+}
+BENCHMARK(BM_SearchCommonChar);
+
+// 改名：替换一个标题
+static void BM_Rename(benchmark::State &state) {
+    auto &corpus = const_cast<Corpus &>(getCorpus());
+    std::mt19937 rng(3U);
+    for (auto _ : state) {
+        auto a = 1U + rng() % sumOfBooks, b = 1U + rng() % sumOfBooks;
+        corpus.m_index.addBook(a, corpus.m_titles[b]);
+        corpus.m_index.addBook(a, corpus.m_titles[a]);
+    }
+}
+BENCHMARK(BM_Rename);
+
+BENCHMARK_MAIN();
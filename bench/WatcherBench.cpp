@@ -0,0 +1,77 @@
+// LibraryWatcher 增量同步基准测试
+// 没有变化时 poll 只是一次系统调用；一页变化的代价与书籍大小无关，而定时重扫要遍历整个漫画库
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include "Watcher.h"
+
+using namespace book;
+
+namespace {
+    constexpr int sumOfBooks = 200;
+    constexpr int sumOfPages = 40;
+
+    // 生成 200 本 x 40 页的空图像文件目录树，每次都重新生成以免残留上一次的数据文件
+    fs::path makeRoot() {
+        auto ret = fs::temp_directory_path() / "manga-manager-watcher-bench";
+        fs::remove_all(ret);
+        for (int book = 1; book <= sumOfBooks; ++book) {
+            auto dir = ret / ("Manga " + std::to_string(book)) / "capture 1";
+            fs::create_directories(dir);
+            for (int page = 1; page <= sumOfPages; ++page) std::ofstream(dir / (std::to_string(page) + ".jpg"));
+        }
+        return ret;
+    }
+
+    // 登记所有书籍，不打开日志
+    void fillLibrary(Library &library) {
+        for (int book = 1; book <= sumOfBooks; ++book) {
+            library.addBook(library.getRoot() / ("Manga " + std::to_string(book)) / "capture 1");
+        }
+    }
+}
+
+// 没有任何变化时的一次 poll
+static void BM_IdlePoll(benchmark::State &state) {
+    Library library(makeRoot());
+    fillLibrary(library);
+    LibraryWatcher watcher(library);
+    if (!watcher.start()) {
+        state.SkipWithError("inotify unavailable");
+        return;
+    }
+    for (auto _ : state) benchmark::DoNotOptimize(watcher.poll());
+}
+BENCHMARK(BM_IdlePoll);
+
+// 定时重扫的代价：逐个书籍目录与磁盘比对，没有差异
+static void BM_Resync(benchmark::State &state) {
+    Library library(makeRoot());
+    fillLibrary(library);
+    LibraryWatcher watcher(library);
+    for (auto _ : state) benchmark::DoNotOptimize(watcher.resync());
+    state.SetItemsProcessed(state.iterations() * sumOfBooks * sumOfPages);
+}
+BENCHMARK(BM_Resync)->Unit(benchmark::kMillisecond);
+
+// 写入一页并删除，从事件到页面增删生效（静默时间为 0）
+static void BM_PageEvent(benchmark::State &state) {
+    Library library(makeRoot());
+    fillLibrary(library);
+    LibraryWatcher watcher(library, std::chrono::milliseconds(0));
+    if (!watcher.start()) {
+        state.SkipWithError("inotify unavailable");
+        return;
+    }
+    auto page = library.getRoot() / "Manga 1" / "capture 1" / "41.jpg";
+    for (auto _ : state) {
+        std::ofstream(page) << 'x';
+        while (watcher.poll(std::chrono::milliseconds(-1)) == 0U) {}
+        fs::remove(page);
+        while (watcher.poll(std::chrono::milliseconds(-1)) == 0U) {}
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PageEvent)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 压缩包条目的压缩方法，取值与 ZIP 格式一致
+    enum class ArchiveMethod : std::uint16_t {
+        Stored = 0,     // 未压缩，可直接映射
+        Deflate = 8,    // Deflate 压缩，读取时解压
+    };
+
+    // 压缩包内一个图像条目的索引，解析一次后随书籍数据保存
+    struct ArchiveEntry {
+        std::string m_name;                             // 条目在压缩包内的名字
+        std::uint64_t m_offset = 0U;                    // 数据在压缩包内的偏移（已跳过本地文件头）
+        std::uint64_t m_compressedSize = 0U;            // 压缩后的长度
+        std::uint64_t m_size = 0U;                      // 解压后的长度
+        std::uint32_t m_crc = 0U;                       // 解压后内容的 CRC32
+        ArchiveMethod m_method = ArchiveMethod::Stored; // 压缩方法
+
+        bool operator==(const ArchiveEntry &other) const = default;
+    };
+
+    /*
+     * 解析 ZIP 文件内容 data 的中央目录（支持 ZIP64），得到所有图像条目的索引
+     * 目录、加密条目与不支持的压缩方法被跳过，结果按名字自然顺序排列
+     * data 不是合法的 ZIP 文件时返回 false
+     */
+    bool readZipIndex(std::span<const std::byte> data, std::vector<ArchiveEntry> &entries);
+    // 映射 path 指向的 ZIP 文件并解析索引，只访问中央目录与各条目的本地文件头
+    bool readZipIndex(const fs::path &path, std::vector<ArchiveEntry> &entries);
+    /*
+     * 读取压缩包 path 内 entry 的内容，只访问该条目自身的数据
+     * limit 小于条目长度时只读取（解压）开头的 limit 字节，用于探测元数据；读取完整内容时校验 CRC32
+     * 失败返回 nullptr
+     */
+    std::unique_ptr<std::string> readArchiveEntry(const fs::path &path, const ArchiveEntry &entry,
+        std::size_t limit = std::numeric_limits<std::size_t>::max());
+    /*
+     * 以 MappedFile 的形式获取压缩包 path 内 entry 的内容
+     * 未压缩的条目直接映射压缩包内的对应范围，不复制数据；压缩的条目解压到内存
+     * 失败时返回值的 isOpen() 为 false
+     */
+    MappedFile mapArchiveEntry(const fs::path &path, const ArchiveEntry &entry,
+        AccessHint hint = AccessHint::Sequential);
+}
+
+#endif
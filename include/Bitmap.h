@@ -0,0 +1,89 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace book {
+    /*
+     * class IdBitmap
+     * 压缩位图（Roaring 风格），用于储存 32 位无符号整数集合
+     * 按高 16 位分块，每块根据元素个数选择有序数组或 65536 位的位图储存
+     */
+    class IdBitmap {
+    public:
+        using ValueType = std::uint32_t;
+        using ValueList = std::vector<ValueType>;
+
+        // 默认构造函数
+        IdBitmap() = default;
+        // 使用 values 内所有元素初始化位图
+        IdBitmap(const ValueList &values);
+
+    private:
+        static constexpr std::size_t arrayMaxSize = 4096U;                 // 数组块的最大元素个数
+        static constexpr std::size_t bitmapWords = 65536U / 64U;           // 位图块包含的 64 位字个数
+
+        // 位图内的一个块，储存高 16 位相同的所有元素的低 16 位
+        struct Container {
+            std::uint16_t m_key = 0U;               // 高 16 位
+            std::uint32_t m_cardinality = 0U;       // 块内元素个数
+            std::vector<std::uint16_t> m_array;     // 数组形式（有序），元素较少时使用
+            std::vector<std::uint64_t> m_bits;      // 位图形式，元素较多时使用
+
+            bool isBitmap() const;
+            bool contains(std::uint16_t low) const;
+            bool add(std::uint16_t low);
+            bool remove(std::uint16_t low);
+            // 根据元素个数在数组和位图形式之间转换
+            void normalize();
+            void toBitmap();
+            void toArray();
+        };
+
+        std::vector<Container> m_containers;        // 按 m_key 升序排列的块
+
+    public:
+        // 添加元素，返回是否真的添加了新元素
+        bool add(ValueType value);
+        // 删除元素，返回是否真的删除了元素
+        bool remove(ValueType value);
+        // 判断元素是否存在
+        bool contains(ValueType value) const;
+        // 清空位图
+        void clear();
+        // 获取元素个数
+        std::size_t size() const;
+        // 判断是否为空
+        bool empty() const;
+        // 按升序导出所有元素
+        ValueList toList() const;
+
+        // 交集
+        IdBitmap &operator&=(const IdBitmap &other);
+        // 并集
+        IdBitmap &operator|=(const IdBitmap &other);
+        // 差集
+        IdBitmap &operator-=(const IdBitmap &other);
+
+        friend IdBitmap operator&(const IdBitmap &lhs, const IdBitmap &rhs);
+        friend IdBitmap operator|(const IdBitmap &lhs, const IdBitmap &rhs);
+        friend IdBitmap operator-(const IdBitmap &lhs, const IdBitmap &rhs);
+        friend bool operator==(const IdBitmap &lhs, const IdBitmap &rhs);
+
+    private:
+        // 查找 key 对应的块，找不到返回 nullptr
+        const Container *m_findContainer(std::uint16_t key) const;
+        // 块与块之间的运算
+        static Container m_and(const Container &lhs, const Container &rhs);
+        static Container m_or(const Container &lhs, const Container &rhs);
+        static Container m_andNot(const Container &lhs, const Container &rhs);
+    };
+
+    IdBitmap operator&(const IdBitmap &lhs, const IdBitmap &rhs);
+    IdBitmap operator|(const IdBitmap &lhs, const IdBitmap &rhs);
+    IdBitmap operator-(const IdBitmap &lhs, const IdBitmap &rhs);
+    bool operator==(const IdBitmap &lhs, const IdBitmap &rhs);
+}
+
+#endif
@@ -3,17 +3,18 @@
 
 #include <cstdint>
 #include "Tag.h"
+#include "TagSet.h"
 #include "Img.h"
+#include "TagIndex.h"
+#include "TitleIndex.h"
 
 namespace book {
-    using BookIdType = std::uint32_t;
-    constexpr BookIdType nullBookId = 0U;
-
     class Book : public ImagesManager {
     public:
         // 默认构造函数
         Book() = default;
-        // 将 bookPath 目录下所有图像文件加入管理器，tagManager 为标签管理器指针
+        // 将 bookPath 目录下所有图像文件加入管理器，bookPath 为压缩包时管理压缩包内的图像
+        // tagManager 为标签管理器指针
         Book(const fs::path &bookPath, TagManager *tagManager, BookIdType id,
             const TagIdList &tags);
         // 将 srcPath 目录下所有图像文件添加到 destPath 目录下并加入管理器
@@ -28,39 +29,86 @@ namespace book {
         // 如果 removeOldFile 为 true，那么删除 images 所指向的图像文件，即对源文件进行移动
         Book(const std::vector<fs::path> &images, const fs::path &destPath, TagManager *tagManager,
             BookIdType id, const TagIdList &tags, bool removeOldFile = false);
+        // 使用 images 内已经存在的图像文件初始化，不复制或移动文件
+        // tagManager 为标签管理器指针
+        Book(std::vector<fs::path> &&images, TagManager *tagManager, BookIdType id,
+            const TagIdList &tags);
         // 由于需要管理文件，删除了复制构造函数
         Book(const Book &) = delete;
         // 移动构造函数
         Book(Book &&book);
+        // 移动赋值
+        Book &operator=(Book &&book);
 
     private:
-        TagManager *m_tagManager;       // 标签管理器指针，指向该书籍标签所属的标签管理器
-        BookIdType m_bookId;            // 漫画ID
-        TagIdList m_tags;               // 标签列表
+        TagManager *m_tagManager = nullptr;   // 标签管理器指针，指向该书籍标签所属的标签管理器
+        BookIdType m_bookId = nullBookId;     // 漫画ID
+        TagSet m_tags;                  // 标签集合
+        std::string m_title;            // 标题（UTF-8）
+        TagIndex *m_tagIndex = nullptr; // 标签倒排索引指针，为空时不维护索引
+        TitleIndex *m_titleIndex = nullptr; // 标题索引指针，为空时不维护索引
+        Journal *m_journal = nullptr;   // 修改日志，为空时不记录
+        // 各页文件名的自然排序键，供 addPage 二分查找插入位置；修订号与图像路径不一致时重新生成
+        std::vector<std::string> m_pageKeys;
+        std::uint64_t m_pageKeysRevision = 0U;  // m_pageKeys 对应的图像路径修订号
+        bool m_pageKeysSorted = true;           // m_pageKeys 是否有序，页面被手动调换顺序后可能无序
 
     public:
         // 返回书籍ID
         BookIdType getBookId() const;
-        // 获取全部书籍标签ID
-        std::unique_ptr<TagIdList> getTags() const;
-        // 获取属于标签组 groupId 的所有标签
+        // 获取全部书籍标签ID（升序），增删标签后失效
+        std::span<const TagIdType> getTags() const;
+        // 获取属于标签组 groupId 的所有标签（升序）
         std::unique_ptr<TagIdList> getTags(TagIdType groupId) const;
-        // 添加标签
+        // 判断是否含有标签 tagId
+        bool hasTag(TagIdType tagId) const;
+        // 添加标签，已经含有时不重复添加
         void addTag(TagIdType tagId);
         // 删除标签
         void removeTag(TagIdType tagId);
         // 清除所有属于 groupId 组的标签
         void removeTags(TagIdType groupId);
+        // 按重映射表 table（下标为旧ID）改写标签ID，用于书标签ID压缩，不同步索引也不记录日志
+        void remapTags(std::span<const TagIdType> table);
+        // 设置标签倒排索引，并将本书当前所有标签登记到索引内
+        // 之后对标签的增删都会同步到索引
+        void setTagIndex(TagIndex *tagIndex);
+        // 获取标题
+        const std::string &getTitle() const;
+        // 设置标题，同步到标题索引与修改日志
+        void setTitle(std::string_view title);
+        // 设置标题索引，并将本书当前的标题登记到索引内
+        void setTitleIndex(TitleIndex *titleIndex);
+        // 设置修改日志，之后对标签、标题与页面的修改都会追加到日志，为空时不记录
+        void setJournal(Journal *journal);
+        /*
+         * 按文件名自然顺序将图像 imagePath 插入为新的一页，不检查文件是否存在
+         * 管理压缩包或 imagePath 不是图像文件时返回 false
+         */
+        bool addPage(const fs::path &imagePath);
+        /*
+         * 删除第 index 页，removeFile 为 true 时同时删除文件
+         * 成功返回 true，index 不合法时返回 false
+         */
+        bool removePage(std::size_t index, bool removeFile = false);
 
         // 获取标签数量
         std::size_t getSumOfTags() const;
         // 获取属于 groupId 组的标签的数量
         std::size_t getSumOfTags(TagIdType groupId) const;
+        // 获取标签涉及的所有组ID（升序），增删标签后失效
+        std::span<const TagIdType> getTagGroups() const;
+
+        // 从 in 中读取，并设置 tagManager 指针，version 为数据文件版本，标签ID以 idSize 字节储存
+        bool read(BinaryReader &in, TagManager *tagManager, std::uint16_t version, std::size_t idSize = sizeof(TagIdType));
+        // 向 out 中输出
+        bool write(BinaryWriter &out) const;
 
-        // 从文件输入流 in 中读取，并设置 tagManager 指针
-        bool read(std::ifstream &in, TagManager *tagManager);
-        // 向文件输出流 out 中输出
-        bool write(std::ofstream &out) const;
+    private:
+        // 用 tags 初始化标签集合，所属组从标签管理器获取，重复的标签只保留一个
+        void m_setTags(const TagIdList &tags);
+        // 图像路径在上次生成后被修改时重新生成 m_pageKeys
+        void m_refreshPageKeys();
     };
 }
 
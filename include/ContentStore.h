@@ -0,0 +1,74 @@
+#ifndef CONTENT_STORE_H
+#define CONTENT_STORE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ThreadPool.h"
+#include "Transfer.h"
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    /*
+     * class ContentStore
+     * 内容寻址的图像存储，内容相同的图像只保存一份
+     * 对象按内容的 XXH64 哈希存放在 root/<哈希前两位>/<哈希><后缀>，书籍的页面列表直接引用对象路径
+     * 引用数不单独保存，由书籍登记到漫画库时（ImagesManager::setContentStore）累加
+     * 引用数归零的对象在释放时删除，或留给 collect 统一回收
+     */
+    class ContentStore {
+    public:
+        // root 为对象目录，pool 为计算哈希的线程池，为空时使用全局线程池
+        ContentStore(const fs::path &root = fs::path(), ThreadPool *pool = nullptr);
+        // 引用数只在内存中，禁止复制
+        ContentStore(const ContentStore &) = delete;
+        ContentStore &operator=(const ContentStore &) = delete;
+
+    private:
+        fs::path m_root;                                    // 对象目录
+        fs::path::string_type m_prefix;                     // 对象目录加分隔符，用于快速判断路径是否为对象
+        ThreadPool *m_pool;                                 // 计算哈希的线程池
+        std::unordered_map<fs::path::string_type, std::size_t> m_refs;    // 对象路径到引用数
+
+    public:
+        // 获取对象目录
+        const fs::path &getRoot() const;
+        // 判断 path 是否为本存储内的对象路径（只比较路径，不访问文件）
+        bool isObject(const fs::path &path) const;
+        // 获取哈希为 hash、后缀为 extension 的对象路径
+        fs::path getObjectPath(std::uint64_t hash, const fs::path &extension) const;
+
+        /*
+         * 将 images 内的图像导入存储，成功后 images 内的路径替换为对象路径
+         * 在线程池上并行计算哈希，内容已在存储内（或在本批次内重复）的图像不再复制
+         * removeSource 为 true 时移动图像，内容重复的源文件在全部成功后删除
+         * 哈希相同但内容不同时视为失败；失败时新对象全部回滚，images 不变，返回 false
+         * 导入本身不增加引用数，引用在书籍登记到漫画库时计入
+         */
+        bool import(std::vector<fs::path> &images, bool removeSource = false,
+            const TransferEngine *engine = nullptr);
+        // 对象的引用数加一，不是对象路径时忽略
+        void retain(const fs::path &object);
+        /*
+         * 对象的引用数减一，不是对象路径时忽略，返回引用数是否归零
+         * 归零且 removeUnused 为 true 时删除对象文件；否则留给 collect 回收
+         */
+        bool release(const fs::path &object, bool removeUnused = true);
+        // 获取对象的引用数
+        std::size_t getRefCount(const fs::path &object) const;
+        // 获取被引用的对象个数
+        std::size_t getSumOfObjects() const;
+        // 清空所有引用数，不删除文件
+        void clearRefs();
+        /*
+         * 删除对象目录内引用数为 0 的对象，返回删除的个数
+         * 用于回收以 removeUnused = false 释放或崩溃后遗留的对象
+         */
+        std::size_t collect();
+    };
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef DUPLICATE_INDEX_H
+#define DUPLICATE_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Library.h"
+#include "PerceptualHash.h"
+#include "ThreadPool.h"
+
+namespace book {
+    // 页面在漫画库中的位置
+    struct PageRef {
+        BookIdType m_book = nullBookId;     // 书籍ID
+        std::uint32_t m_page = 0U;          // 页码（从 0 开始）
+        bool operator==(const PageRef &other) const = default;
+    };
+
+    // 一对相似页面，m_first < m_second 为页面在索引内的下标
+    struct PagePair {
+        std::uint32_t m_first = 0U;
+        std::uint32_t m_second = 0U;
+        std::uint32_t m_distance = 0U;      // 感知哈希的汉明距离
+    };
+
+    // 一对相似书籍，m_first < m_second
+    struct BookSimilarity {
+        BookIdType m_first = nullBookId;
+        BookIdType m_second = nullBookId;
+        std::uint32_t m_sharedPages = 0U;   // 能在另一本书中找到相似页面的页数，取两本书中较小者
+        double m_score = 0.0;               // m_sharedPages 除以两本书中可计算哈希的页数的较小者
+    };
+
+    /*
+     * 在 hashes 内线性查找与 query 的汉明距离不超过 maxDistance 的哈希，将下标追加到 out
+     * 内层循环无分支，编译器可以向量化 popcount
+     */
+    void hammingScan(std::span<const std::uint64_t> hashes, std::uint64_t query, int maxDistance,
+        std::vector<std::uint32_t> &out);
+
+    /*
+     * class DuplicateIndex
+     * 页面感知哈希（dHash）的重复检测索引，用于找出字节不同但内容相同的页面与书籍
+     * 哈希、页面位置、页面路径键分别按列连续存放，每页 24 字节，分段桶另占每页 48 字节
+     * 查找使用多索引哈希：64 位哈希分为 4 段 16 位，每段按段值分桶
+     * 距离不超过 d 的两个哈希至少有一段的距离不超过 d / 4，只需枚举该半径内的桶再逐个验证
+     * 索引保存在 .data/phash.dat，update 时路径未变的页面不重新解码
+     */
+    class DuplicateIndex {
+    public:
+        static constexpr std::array<char, 4> fileMagic = { 'M', 'M', 'P', 'H' };   // 数据文件标识
+        static constexpr std::uint16_t fileVersion = 1U;                            // 数据文件格式版本
+        static constexpr int sumOfSegments = 4;                                     // 多索引哈希的段数
+        static constexpr int maxIndexedDistance = 4 * sumOfSegments - 1;           // 超过此距离时查找退化为线性扫描
+
+        DuplicateIndex() = default;
+
+    private:
+        std::vector<std::uint64_t> m_hashes;    // 感知哈希
+        std::vector<PageRef> m_pages;           // 页面位置，与 m_hashes 下标一致
+        std::vector<std::uint64_t> m_keys;      // 页面路径的 XXH64，与 m_hashes 下标一致
+        std::vector<std::uint64_t> m_failedKeys;    // 无法计算哈希的页面路径的 XXH64，已排序
+        // 每段的桶：m_buckets[k] 内 [m_offsets[k][v], m_offsets[k][v + 1]) 为第 k 段值为 v 的页面下标
+        std::array<std::vector<std::uint32_t>, sumOfSegments> m_offsets;
+        std::array<std::vector<std::uint32_t>, sumOfSegments> m_buckets;
+        // 与 m_buckets 一致排列的哈希副本，扫描桶时顺序读取，不随机访问 m_hashes
+        std::array<std::vector<std::uint64_t>, sumOfSegments> m_bucketHashes;
+
+    public:
+        // 清空索引
+        void clear();
+        // 获取索引内的页面数
+        std::size_t getSumOfPages() const;
+        // 获取第 index 个页面的感知哈希
+        std::uint64_t getHash(std::size_t index) const;
+        // 获取第 index 个页面的位置
+        const PageRef &getPage(std::size_t index) const;
+        // 添加一个页面，key 为页面路径的 XXH64；添加后需调用 reindex 才能被查找到
+        void add(const PageRef &page, std::uint64_t hash, std::uint64_t key = 0U);
+        // 重建分段桶，O(n)
+        void reindex();
+        /*
+         * 与漫画库同步：在线程池上并行解码新页面并计算哈希，路径未变的页面沿用原有的哈希
+         * 已删除书籍的页面从索引内移除，之后自动 reindex
+         * 返回新计算哈希的页面数（包括计算失败的页面）
+         */
+        std::size_t update(const Library &library, ThreadPool *pool = nullptr);
+
+        // 查找与 hash 的距离不超过 maxDistance 的页面，返回按下标排序的页面下标
+        std::vector<std::uint32_t> search(std::uint64_t hash, int maxDistance) const;
+        // 在线程池上并行找出所有距离不超过 maxDistance 的页面对，每对只出现一次，按下标排序
+        // 会阻塞等待线程池，不能在同一线程池的工作线程内调用（update、findSimilarBooks 同理）
+        std::vector<PagePair> findPairs(int maxDistance, ThreadPool *pool = nullptr) const;
+        /*
+         * 将相似页面汇总为书籍之间的相似度，只返回得分不低于 minScore 的书籍对
+         * 同一本书内的相似页面不计入，结果按得分从高到低排序
+         */
+        std::vector<BookSimilarity> findSimilarBooks(int maxDistance, double minScore = 0.5,
+            ThreadPool *pool = nullptr) const;
+
+        // 写入 path，整个文件只写入一次
+        bool write(const fs::path &path) const;
+        // 从 path 读入并 reindex，失败时清空并返回 false
+        bool read(const fs::path &path);
+
+    private:
+        // 在第 segment 段值为 [firstValue, lastValue) 的桶内查找相似页面对，追加到 out
+        void m_findPairs(int segment, std::uint32_t firstValue, std::uint32_t lastValue, int maxDistance,
+            std::vector<PagePair> &out) const;
+        // 线性查找第 first 到 last 个页面与下标更大的页面组成的相似页面对，追加到 out
+        void m_scanPairs(std::size_t first, std::size_t last, int maxDistance, std::vector<PagePair> &out) const;
+        // 枚举与 16 位段值 value 的距离不超过 radius 的所有段值，对每个段值调用 visit
+        template<typename Visitor>
+        static void m_forEachNeighbor(std::uint32_t value, int radius, Visitor &&visit);
+    };
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    /*
+     * class XXHash64
+     * XXH64 哈希的流式计算，结果与官方实现一致
+     * 速度接近内存带宽，用于内容寻址存储中识别相同的图像
+     */
+    class XXHash64 {
+    public:
+        XXHash64(std::uint64_t seed = 0U);
+
+    private:
+        std::array<std::uint64_t, 4> m_acc;         // 四路累加器
+        std::array<std::byte, 32> m_buffer{};       // 不足一个条带的剩余数据
+        std::size_t m_bufferSize = 0U;
+        std::uint64_t m_totalSize = 0U;
+        std::uint64_t m_seed;
+
+    public:
+        // 追加数据
+        void update(std::span<const std::byte> data);
+        // 获取当前已追加数据的哈希值，不影响之后继续追加
+        std::uint64_t digest() const;
+    };
+
+    // 计算 data 的 XXH64 哈希值
+    std::uint64_t xxhash64(std::span<const std::byte> data, std::uint64_t seed = 0U);
+    // 计算 path 指向文件内容的 XXH64 哈希值，失败返回 false
+    bool xxhash64File(const fs::path &path, std::uint64_t &hash);
+    // 将哈希值格式化为 16 位小写十六进制字符串
+    std::string toHex(std::uint64_t hash);
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef ID_ALLOCATOR_H
+#define ID_ALLOCATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace book {
+    /*
+     * class IdAllocator
+     * 空闲ID集合（分层位图），用于回收被删除的ID并优先重新分配最小的空闲ID
+     * 第 0 层每一位表示一个ID是否空闲，上一层每一位表示下一层对应的 64 位字是否非零，最高层只有一个字
+     * 取最小空闲ID时自顶向下每层只做一次 find-first-set，16 位ID共三层
+     */
+    class IdAllocator {
+    public:
+        using ValueType = std::uint32_t;
+        using ValueList = std::vector<ValueType>;
+        static constexpr ValueType nullId = 0U;     // 空ID，不会被记为空闲
+
+        // 默认构造函数
+        IdAllocator() = default;
+
+    private:
+        std::vector<std::vector<std::uint64_t>> m_levels;   // 各层位图，下标 0 为最底层
+        std::size_t m_size = 0U;                            // 空闲ID个数
+
+    public:
+        // 将 id 记为空闲，已经空闲或为 nullId 时返回 false
+        bool release(ValueType id);
+        // 取出最小的空闲ID，没有空闲ID时返回 nullId
+        ValueType acquire();
+        // 判断 id 是否空闲
+        bool isFree(ValueType id) const;
+        // 清空
+        void clear();
+        // 获取空闲ID个数
+        std::size_t size() const;
+        // 判断是否没有空闲ID
+        bool empty() const;
+        // 按升序导出所有空闲ID
+        ValueList toList() const;
+        // 占用的字节数（不含对象本身）
+        std::size_t getMemoryUsage() const;
+
+    private:
+        // 扩充各层，使其能够表示 id
+        void m_grow(ValueType id);
+    };
+}
+
+#endif
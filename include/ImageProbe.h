@@ -0,0 +1,49 @@
+#ifndef IMAGE_PROBE_H
+#define IMAGE_PROBE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 图像格式
+    enum class ImageFormat : std::uint8_t {
+        Unknown = 0,    // 尚未探测
+        Invalid,        // 探测失败（文件不存在或格式无法识别）
+        Jpeg,
+        Png,
+        Gif,
+        Webp,
+    };
+
+    // 图像元数据
+    struct ImageInfo {
+        std::uint32_t m_width = 0U;                     // 宽度（像素）
+        std::uint32_t m_height = 0U;                    // 高度（像素）
+        ImageFormat m_format = ImageFormat::Unknown;    // 格式
+
+        // 是否已经探测过（无论成功与否）
+        bool isProbed() const { return m_format != ImageFormat::Unknown; }
+        // 是否探测成功
+        bool isValid() const { return m_format != ImageFormat::Unknown && m_format != ImageFormat::Invalid; }
+        bool operator==(const ImageInfo &other) const = default;
+    };
+
+    /*
+     * 从文件头部 header 中解析图像元数据
+     * 支持 PNG（IHDR）、GIF（逻辑屏幕描述符）、WebP（VP8/VP8L/VP8X）
+     * 以及 SOF 位于 header 范围内的 JPEG
+     * 无法解析时返回格式为 Invalid 的结果
+     */
+    ImageInfo probeImage(std::span<const std::byte> header);
+    /*
+     * 只读取文件头部探测图像元数据
+     * JPEG 按段跳读直到遇到 SOF 标记，不读取图像数据
+     */
+    ImageInfo probeImageFile(const fs::path &path);
+}
+
+#endif
@@ -7,20 +7,39 @@
 #include <optional>
 #include <string>
 #include <memory>
+#include "MappedFile.h"
+#include "PageCache.h"
+#include "ImageProbe.h"
+#include "Serialize.h"
+#include "Transfer.h"
+#include "Archive.h"
+#include "PathArena.h"
 
 namespace book {
     namespace fs = std::filesystem; // 给 std::filesystem 起个别名
 
     constexpr std::array<std::string_view, 4> IMG_TYPES = {
         ".jpg", ".png", ".gif", ".webp" };      // 合法的图像文件后缀
+    constexpr std::array<std::string_view, 2> ARCHIVE_TYPES = {
+        ".cbz", ".zip" };                       // 合法的压缩包文件后缀
 
     class ImagesManager;
+    class ContentStore;
+
+    // 判断 path 的后缀是否为合法的图像文件后缀（不区分大小写）
+    bool isImageFile(const fs::path &path);
+    // 判断 path 的后缀是否为合法的压缩包文件后缀（不区分大小写）
+    bool isArchiveFile(const fs::path &path);
+    // 生成文件名 name 的自然排序键，按键的字典序比较即为自然顺序（"2.png" 排在 "10.png" 之前）
+    std::string makeNaturalKey(std::string_view name);
+    // 按文件名自然顺序对 paths 排序，每个路径的排序键只计算一次
+    void sortNatural(std::vector<fs::path> &paths);
 
     class ImagesManager {
     public:
         // 默认构造函数
         ImagesManager() = default;
-        // 将 path 下所有图像文件都归入管理器
+        // 将 path 下所有图像文件都归入管理器；path 为压缩包时改为管理压缩包内的图像
         ImagesManager(const fs::path &path);
         // 使用 images 内储存的所有的图像路径初始化管理器
         ImagesManager(const std::vector<fs::path> &images);
@@ -30,47 +49,121 @@ namespace book {
         ImagesManager(const ImagesManager &) = delete;
         // 移动构造函数
         ImagesManager(ImagesManager &&man);
+        // 移动赋值
+        ImagesManager &operator=(ImagesManager &&man);
 
     private:
-        std::vector<fs::path> m_images;         // 图像路径
+        // 快照直接读写图像元数据
+        friend class CatalogSnapshot;
+
+        PathArena m_images;                     // 图像路径，基准目录下的图像只储存文件名，压缩包内的图像为 压缩包路径/条目名
+        // 图像元数据，与 m_images 下标一致；长度可能小于 m_images，缺少的部分视为尚未探测
+        mutable std::vector<ImageInfo> m_infos;
+        fs::path m_archive;                     // 压缩包路径，图像为普通文件时为空
+        std::vector<ArchiveEntry> m_entries;    // 压缩包条目索引，与 m_images 下标一致
+        ContentStore *m_store = nullptr;        // 内容寻址存储，为空时页面都是普通文件
+
+    protected:
+        std::uint32_t m_cacheOwner = 0U;        // 页面缓存中的所属者，Book 设为书籍ID
+
+        // 图像路径的修订号，路径或顺序改变后随之改变（见 PathArena::getRevision）
+        std::uint64_t m_getImagesRevision() const;
 
     public:
-        // 将当前所有图像文件复制到 destPath 目录下
+        // 将当前所有图像文件复制到 destPath 目录下，图像位于压缩包内时复制整个压缩包
         // destPath 必须为目录
         // moveOldPath 为 true 时，更新管理器储存的图像路径到新路径
-        void copy(const fs::path &destPath, bool moveOldPath = false);
-        // 将当前所有图像文件移动到 destPath 目录下
+        // engine 为空时使用默认的 TransferEngine；任意文件失败时全部回滚并返回 false
+        bool copy(const fs::path &destPath, bool moveOldPath = false, const TransferEngine *engine = nullptr);
+        // 将当前所有图像文件移动到 destPath 目录下，图像位于压缩包内时移动整个压缩包
         // destPath 必须为目录
         // 同时更新管理器储存的图像路径
-        void move(const fs::path &destPath);
+        // engine 为空时使用默认的 TransferEngine；任意文件失败时全部回滚并返回 false
+        // 内容存储内的图像按页码命名后复制出来，并释放对原对象的引用
+        bool move(const fs::path &destPath, const TransferEngine *engine = nullptr);
         // 清空管理器
+        // 内容存储内的图像只释放引用，removeFiles 为 true 时删除引用数归零的对象
         void clear(bool removeFiles = false);
         // 将第 index 个图像移除管理器（编号从 0 开始）
-        // 当 removeFile 为 true 时，将文件从磁盘上删除
+        // 当 removeFile 为 true 时，将文件从磁盘上删除；压缩包内的图像只移出管理器，不修改压缩包
+        // 内容存储内的图像只释放引用，被其他书籍引用的对象不会被删除
         void remove(std::size_t index, bool removeFile = false);
         // 将第 index0 个图像和第 index1 个图像在管理器中的顺序进行交换
         void swap(std::size_t index0, std::size_t index1);
-        // 把新的图像添加到管理器里
+        // 把新的图像添加到管理器里，管理压缩包时不能添加
         void add(const fs::path &imagePath);
-        // 获取第 index 个图像的路径
+        // 把图像插入为第 index 个图像（index 超出范围时追加），与 add 一样储存规范路径但不检查文件是否存在，管理压缩包时不能插入
+        void insert(std::size_t index, const fs::path &imagePath);
+        // 第 index 个图像的文件被改写后调用，丢弃其缓存内容与元数据
+        void refresh(std::size_t index);
+        // 获取第 index 个图像的路径，由基准目录与储存的名字拼出
         // 未处理 index 不合法的情况
-        const fs::path &getImagePath(std::size_t index) const;
+        fs::path getImagePath(std::size_t index) const;
         // 获取第 index 个图像的二进制路径
-        // 返回值类型为 std::unique_ptr<std::string>
+        // 返回值类型为 std::unique_ptr<std::string>，内容经由全局页面缓存读取后复制一份
         // 如果图像路径失效（index不合法或者路径上文件不存在），则返回nullptr
         std::unique_ptr<std::string> getImageContent(std::size_t index) const;
+        // 以只读内存映射的方式获取第 index 个图像的二进制内容，不复制文件内容
+        // 通过返回值的 getData() 获取 std::span<const std::byte>，返回值析构时解除映射
+        // 如果图像路径失效，则返回值的 isOpen() 为 false
+        MappedFile getImageView(std::size_t index, AccessHint hint = AccessHint::Sequential) const;
+        // 通过全局页面缓存获取第 index 个图像的二进制内容，未缓存时读取文件并放入缓存
+        // 如果图像路径失效，则返回 nullptr
+        PageContent getCachedContent(std::size_t index) const;
+        // 获取第 index 个图像在页面缓存中的键
+        // 内容存储内的图像不区分所属书籍，相同内容只缓存一份
+        PageKey getPageKey(std::size_t index) const;
+        // 获取读取第 index 个图像的函数，只持有路径与压缩包条目的副本，可以在管理器销毁后于其他线程调用
+        // index 不合法时返回的函数总是返回 nullptr
+        PageCache::Loader getPageLoader(std::size_t index) const;
+        // 读取 path 指向文件的全部二进制内容，失败返回 nullptr
+        static std::unique_ptr<std::string> readFile(const fs::path &path);
         // 清空管理器，扫描 srcPath 目录下的图像文件并添加到管理器内
+        // 新扫描到的图像按文件名自然顺序排列；管理压缩包时不能追加
         void scanImageFiles(const fs::path &srcPath, bool add = false);
+        /*
+         * 清空管理器，解析压缩包 archivePath 的中央目录并管理其中的图像，不解压任何图像
+         * 图像按条目名自然顺序排列，条目索引随 write 一起保存，之后访问任意一页都只读取该页的数据
+         * 成功返回 true，失败返回 false 并保持为空
+         */
+        bool openArchive(const fs::path &archivePath);
+        // 图像是否位于压缩包内
+        bool isArchive() const;
+        // 获取压缩包路径，图像为普通文件时为空
+        const fs::path &getArchivePath() const;
+        /*
+         * 设置内容寻址存储，之后位于存储内的图像都计入其引用数，为空时不维护引用
+         * 替换旧存储时先释放在旧存储内的引用（不删除对象）
+         */
+        void setContentStore(ContentStore *store);
 
         // 向 out 内写入类
-        bool write(std::ofstream &out) const;
-        // 从 in 内读入类
-        bool read(std::ifstream &in);
+        bool write(BinaryWriter &out) const;
+        // 从 in 内读入类，新读入的图像追加到已有图像之后
+        // version 为数据文件版本，低于 3 的数据没有压缩包信息
+        bool read(BinaryReader &in, std::uint16_t version);
+        // 获取第 index 个图像的元数据（宽、高、格式）
+        // 尚未探测时只读取文件头部进行探测并记录结果，结果随 write 一起保存
+        ImageInfo getImageInfo(std::size_t index) const;
+        // 探测所有尚未探测的图像，force 为 true 时重新探测全部图像
+        void probeImages(bool force = false);
+        // 计算第 index 个图像的感知哈希（dHash），格式不支持或图像为纯色时返回 false，结果不缓存
+        bool getPerceptualHash(std::size_t index, std::uint64_t &hash) const;
         // 获取管理器管理的图像数量
         std::size_t getSumOfImages() const;
 
     private:
         bool m_checkIndex(std::size_t i) const;
+        // 第 index 个图像是否为内容存储内的对象
+        bool m_isObject(std::size_t index) const;
+        // 生成将所有图像（或压缩包）传输到 destPath 目录下的任务
+        std::vector<TransferItem> m_makeTransferItems(const fs::path &destPath) const;
+        // 传输完成后将图像路径更新为 items 的目标路径
+        void m_relocate(std::vector<TransferItem> &items);
+        // 读取第 index 个图像的全部内容，失败返回 nullptr
+        std::unique_ptr<std::string> m_readImage(std::size_t index) const;
+        // 探测第 index 个图像的元数据
+        ImageInfo m_probeImage(std::size_t index) const;
     };
 }
 
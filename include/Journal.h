@@ -0,0 +1,135 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Tag.h"
+#include "TagIndex.h"
+#include "Serialize.h"
+
+namespace book {
+    // 日志记录的操作类型
+    enum class JournalOp : std::uint8_t {
+        CreateBookTag = 1,  // m_tagId, m_groupId, m_name
+        CreateGroupTag,     // m_tagId, m_name
+        EraseBookTag,       // m_tagId
+        EraseGroupTag,      // m_tagId
+        RenameBookTag,      // m_tagId, m_name
+        RenameGroupTag,     // m_tagId, m_name
+        AddBook,            // m_bookId, m_images, m_tags
+        EraseBook,          // m_bookId
+        AddBookTag,         // m_bookId, m_tagId
+        RemoveBookTag,      // m_bookId, m_tagId
+        RemoveBookTags,     // m_bookId, m_groupId
+        AddArchiveBook,     // m_bookId, m_images（只有压缩包路径）, m_tags
+        SetBookTitle,       // m_bookId, m_name
+        AddBookPage,        // m_bookId, m_images（只有新页面的路径）
+        RemoveBookPage,     // m_bookId, m_images（只有被删除页面的路径）
+    };
+
+    // 一条日志记录，只有操作类型用到的字段有意义
+    struct JournalRecord {
+        std::uint64_t m_seq = 0U;                   // 序号，从 1 开始递增
+        JournalOp m_op = JournalOp::CreateBookTag;  // 操作类型
+        BookIdType m_bookId = nullBookId;
+        TagIdType m_tagId = nullTagId;
+        TagIdType m_groupId = nullTagId;
+        std::string m_name{};
+        std::vector<fs::path> m_images{};
+        TagIdList m_tags{};
+    };
+
+    /*
+     * class Journal
+     * 只追加的预写日志，每次修改只追加一条记录，I/O 与库的大小无关
+     * 文件结构：magic(4) + version(2) + flags(2)，之后为若干条记录，flags 为记录内标签ID的字节数
+     * 每条记录：长度(4) + CRC32C(4) + 内容，写入中途崩溃留下的残缺记录在打开时被截掉
+     */
+    class Journal {
+    public:
+        static constexpr std::array<char, 4> fileMagic = { 'M', 'M', 'J', 'N' };   // 日志文件标识
+        static constexpr std::uint16_t fileVersion = 3U;                            // 日志格式版本，2 起记录书籍标题，3 起记录页面增删
+
+        // 默认构造函数，不打开任何文件
+        Journal() = default;
+        // 日志文件不可复制
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+        // 析构时关闭文件
+        ~Journal();
+
+    private:
+        fs::path m_path;                // 日志文件路径
+        int m_fd = -1;                  // 文件描述符，其他平台每次追加时重新打开文件
+        bool m_isOpen = false;          // 是否已打开
+        bool m_sync = false;            // 每条记录后是否同步到磁盘
+        std::uint64_t m_seq = 0U;       // 最后一条记录的序号
+        std::size_t m_size = 0U;        // 文件长度
+
+    public:
+        /*
+         * 打开 path 用于追加，不存在时创建
+         * 文件末尾残缺或校验失败的记录被截掉；seq 为基础数据已包含的最后序号，之后的记录从更大的序号开始
+         * 标签ID比当前构建窄的旧日志先按原序号整体改写为当前宽度
+         * 成功返回 true，失败返回 false
+         */
+        bool open(const fs::path &path, std::uint64_t seq = 0U);
+        // 关闭日志
+        void close();
+        // 是否已打开
+        bool isOpen() const;
+        /*
+         * 是否在每条记录写入后调用 fdatasync
+         * 默认关闭：记录通过一次 write 写入内核，进程崩溃不会丢失；开启后断电也不会丢失
+         */
+        void setSync(bool sync);
+        // 获取最后一条记录的序号
+        std::uint64_t getSequence() const;
+        // 获取日志文件长度
+        std::size_t getSize() const;
+        // 获取日志文件路径
+        const fs::path &getPath() const;
+
+        /*
+         * 追加一条记录，record.m_seq 被忽略并自动分配
+         * 成功返回 true，失败返回 false
+         */
+        bool append(const JournalRecord &record);
+        /*
+         * 将当前日志改名为 oldPath 并重新开始一个空日志，序号继续递增
+         * 用于压缩：oldPath 内的记录写入新的基础数据后即可删除
+         */
+        bool rotate(const fs::path &oldPath);
+
+        /*
+         * 依次读取 path 内序号大于 after 的完整记录并交给 apply
+         * 遇到残缺记录时停止，文件不存在视为没有记录
+         * apply 返回 false 或文件头部不正确时返回 false
+         * lastSeq 为读到的最后一条记录的序号（不小于 after）
+         */
+        static bool replay(const fs::path &path, std::uint64_t after,
+            const std::function<bool(const JournalRecord &)> &apply, std::uint64_t &lastSeq);
+
+    private:
+        // 将 data 追加到文件
+        bool m_write(std::span<const std::byte> data);
+        // 将序号为 seq 的记录连同长度与校验值编码到 out 末尾
+        static void m_encodeRecord(BinaryWriter &out, const JournalRecord &record, std::uint64_t seq);
+        // 编码与解码记录内容，解码时标签ID以 idSize 字节储存
+        static void m_encode(BinaryWriter &out, const JournalRecord &record);
+        static bool m_decode(BinaryReader &in, JournalRecord &record, std::size_t idSize);
+        /*
+         * 扫描 data 内的记录，对每条完整记录调用 apply（可为空），记录内标签ID以 idSize 字节储存
+         * 返回最后一条完整记录结束处的偏移，apply 返回 false 时 ok 置为 false
+         */
+        static std::size_t m_scan(std::span<const std::byte> data, std::uint64_t after,
+            const std::function<bool(const JournalRecord &)> &apply, std::uint64_t &lastSeq, bool &ok, std::size_t idSize);
+        // 将标签ID为 idSize 字节的日志 data 改写为当前宽度并替换 path
+        static bool m_widen(const fs::path &path, std::span<const std::byte> data, std::size_t idSize);
+    };
+}
+
+#endif
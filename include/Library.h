@@ -0,0 +1,180 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <future>
+#include <queue>
+#include <vector>
+#include <memory>
+#include "Book.h"
+#include "Journal.h"
+#include "ContentStore.h"
+
+namespace book {
+    /*
+     * class Library
+     * 漫画库，管理 mangas 目录下的所有书籍
+     * 书籍按 BookIdType 储存在连续的数组里，所有书籍共享同一个标签管理器、标签倒排索引与标题索引
+     * 整个漫画库（标签信息与书籍列表）保存在 .data/list.dat 一个文件内
+     * 文件带有版本号与 CRC32C 校验，格式见 Serialize.h
+     * read() 之后的修改以日志形式追加到 .data/list.journal，compact() 将日志合并回 list.dat
+     * 开启内容寻址后导入的图像存放在 .data/objects 内，内容相同的页面在所有书籍间只保存一份
+     */
+    class Library {
+    public:
+        // 使用漫画库根目录 root（即 mangas 目录）构造，不读取任何文件
+        Library(const fs::path &root);
+        // 书籍保存了标签管理器与索引的指针，因此禁止复制与移动
+        Library(const Library &) = delete;
+        Library &operator=(const Library &) = delete;
+        // 快照直接读写漫画库的内部数据
+        friend class CatalogSnapshot;
+
+        static constexpr std::array<char, 4> fileMagic = { 'M', 'M', 'L', 'B' };   // 数据文件标识
+        static constexpr std::uint16_t fileVersion = 4U;                            // 数据文件格式版本，2 起记录日志序号，3 起记录压缩包索引，4 起记录标题
+        // 等待后台压缩结束
+        ~Library();
+
+    private:
+        using BookIdHeap = std::priority_queue<BookIdType, std::vector<BookIdType>, std::greater<BookIdType>>; // 储存 BookId 的小根堆
+
+        fs::path m_root;                    // 漫画库根目录
+        TagManager m_tagManager;            // 标签管理器
+        TagIndex m_tagIndex;                // 标签倒排索引
+        TitleIndex m_titleIndex;            // 标题索引
+        ContentStore m_store;               // 内容寻址的图像存储，引用数由书籍登记时累加
+        bool m_contentAddressed = false;    // 导入书籍时是否存入内容存储
+        std::vector<Book> m_books;          // 书籍表，保证合法书籍ID与此动态数组下标一致
+        std::size_t m_curSumOfBooks;        // 当前共有多少书籍
+        BookIdType m_curMaxBook;            // 当前最大书籍ID
+        BookIdHeap m_erasedBooks;           // 被删除的书籍ID
+        Journal m_journal;                  // 修改日志
+        std::uint64_t m_journalSeq;         // 数据文件已包含的最后一条日志的序号
+        std::future<bool> m_compaction;     // 后台压缩任务
+
+    public:
+        // 清空漫画库，不删除任何文件
+        void clear();
+
+        /*
+         * 从 .data/list.dat 读入，再重放 .data/list.journal 内更新的记录，之后的修改都追加到日志
+         * 数据文件不存在时视为空漫画库
+         */
+        bool read();
+        // 写入 .data/list.dat，日志内已写入的记录在下次读入时被跳过
+        bool write() const;
+        // 从指定路径读入，整个文件只读取一次，头部或校验值不正确、书籍ID重复时清空并返回 false
+        // 不重放日志
+        bool read(const fs::path &path);
+        // 写入指定路径，整个文件只写入一次
+        bool write(const fs::path &path) const;
+        /*
+         * 将日志合并为新的 .data/list.dat 并开始新的日志
+         * 当前状态在调用线程上编码，background 为 true 时在后台线程写入文件
+         * 中途崩溃时旧日志保留为 list.journal.old，下次 read() 时一并重放
+         * 同步执行时返回是否成功，后台执行时返回是否成功开始
+         */
+        bool compact(bool background = true);
+        // 等待后台压缩结束，返回其是否成功，没有进行中的压缩时返回 true
+        bool waitForCompaction();
+        // 获取修改日志
+        Journal &getJournal();
+
+        // 获取漫画库根目录
+        const fs::path &getRoot() const;
+        // 获取数据文件路径
+        fs::path getDataPath() const;
+        // 获取快照文件路径，快照由 CatalogSnapshot 读写
+        fs::path getSnapshotPath() const;
+        // 获取日志文件路径
+        fs::path getJournalPath() const;
+        // 获取页面感知哈希索引的路径，索引由 DuplicateIndex 读写
+        fs::path getPerceptualHashPath() const;
+        // 获取内容寻址存储，其引用数只反映当前已读入的书籍
+        ContentStore &getContentStore();
+        const ContentStore &getContentStore() const;
+        // 设置之后导入的书籍是否存入内容存储，默认不存入
+        void setContentAddressed(bool enable);
+        // 导入书籍时是否存入内容存储
+        bool isContentAddressed() const;
+
+        /*
+         * 将 bookPath 目录下所有图像文件登记为一本新书，不移动文件
+         * bookPath 为 .cbz/.zip 压缩包时登记压缩包内的图像，只解析中央目录，不解压
+         * 标题默认为目录名或去掉扩展名的压缩包名
+         * 返回新书的ID，书籍已满时返回 nullBookId
+         */
+        BookIdType addBook(const fs::path &bookPath, const TagIdList &tags = {});
+        /*
+         * 将 images 内已存在的图像文件登记为一本新书，不移动文件
+         * 返回新书的ID，书籍已满时返回 nullBookId
+         */
+        BookIdType addBook(std::vector<fs::path> &&images, const TagIdList &tags = {});
+        /*
+         * 将 srcPath 目录下所有图像文件导入到漫画库的 name 目录下，作为一本新书
+         * srcPath 为压缩包时整个压缩包被导入到 name 目录下
+         * 开启内容寻址时图像改为存入 .data/objects，已有相同内容的图像不再复制，此时 name 只用作标题
+         * 标题默认为 name 的最后一级，name 为空时使用 srcPath 的名字
+         * 如果 removeOldFile 为 true，则移动文件，否则复制文件
+         * 文件经由 TransferEngine 并行传输，任意文件失败时全部回滚
+         * 返回新书的ID，书籍已满或传输失败时返回 nullBookId
+         */
+        BookIdType importBook(const fs::path &srcPath, const fs::path &name,
+            const TagIdList &tags = {}, bool removeOldFile = false);
+        /*
+         * 删除书籍
+         * 如果 removeFiles 为 true，则同时删除书籍的图像文件
+         * 成功返回 true，失败返回 false
+         */
+        bool eraseBook(BookIdType id, bool removeFiles = false);
+        // 检查书籍ID是否有效
+        bool checkBookId(BookIdType id) const;
+        // 获取书籍，ID 无效时返回 nullptr
+        Book *getBook(BookIdType id);
+        const Book *getBook(BookIdType id) const;
+        // 获取当前书籍数量
+        std::size_t getSumOfBooks() const;
+        // 获取所有书籍ID
+        std::unique_ptr<BookIdList> getBooks() const;
+
+        // 获取标签管理器
+        TagManager &getTagManager();
+        const TagManager &getTagManager() const;
+        // 获取标签倒排索引
+        const TagIndex &getTagIndex() const;
+        // 按多标签条件搜索书籍
+        BookIdList search(const TagQuery &query) const;
+        // 获取标题索引
+        const TitleIndex &getTitleIndex() const;
+        // 按标题搜索书籍，结果按匹配程度排序，limit 不为 0 时只返回前 limit 个
+        BookIdList searchTitle(std::string_view query, std::size_t limit = 0U) const;
+        /*
+         * 删除书标签，并将其从所有书籍上移除
+         * 成功返回 true，失败返回 false
+         */
+        bool eraseBookTag(TagIdType tagId);
+        /*
+         * 压缩书标签ID（见 TagManager::compactBookTags），并将所有书籍的标签与倒排索引改为新ID
+         * 日志打开时随即同步压缩日志，使数据文件与之后的日志都只含新ID；remap 不为空时写入重映射表
+         * 没有空位时不做任何修改，压缩日志失败时返回 false
+         */
+        bool compactTags(TagIdList *remap = nullptr);
+
+    private:
+        // 获取未被使用的新书籍ID，书籍已满时返回 nullBookId
+        BookIdType m_getNewId();
+        // 将构造好的书籍放入书籍表，并登记到索引与日志
+        BookIdType m_insertBook(Book &&book);
+        // 将新书的页面、标签与标题追加到日志
+        BookIdType m_logAddBook(BookIdType id);
+        // 检查 id 是否在书籍表范围内
+        bool m_checkIndex(BookIdType id) const;
+        // 将整个漫画库编码到 out
+        bool m_encode(BinaryWriter &out) const;
+        // 获取压缩失败时保留的旧日志路径
+        fs::path m_getOldJournalPath() const;
+        // 重放一条日志记录，记录与当前状态不符时返回 false
+        bool m_applyRecord(const JournalRecord &record);
+    };
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <string>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 对映射内容的访问方式提示
+    enum class AccessHint {
+        Normal,         // 不作提示
+        Sequential,     // 顺序读取，并提示内核预读整个文件
+        Random,         // 随机读取
+    };
+
+    /*
+     * class MappedFile
+     * 只读内存映射文件，析构时自动解除映射
+     * 在不支持 mmap 的平台上退化为一次性读入内存
+     */
+    class MappedFile {
+    public:
+        // 默认构造函数，不映射任何文件
+        MappedFile() = default;
+        // 映射 path 指向的文件
+        MappedFile(const fs::path &path, AccessHint hint = AccessHint::Sequential);
+        // 持有已在内存中的内容，接口与映射的文件相同
+        explicit MappedFile(std::string &&buffer);
+        // 映射不可复制
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        // 移动构造函数
+        MappedFile(MappedFile &&file) noexcept;
+        // 移动赋值
+        MappedFile &operator=(MappedFile &&file) noexcept;
+        // 析构时解除映射
+        ~MappedFile();
+
+    private:
+        const std::byte *m_data = nullptr;  // 映射内容首地址
+        std::size_t m_size = 0U;            // 映射内容长度
+        std::size_t m_pageOffset = 0U;      // m_data 距映射起点的距离，映射起点需按页对齐
+        bool m_isOpen = false;              // 是否成功打开
+        std::string m_buffer;               // 无法映射时读入的内容
+
+    public:
+        // 映射 path 指向的文件，原有映射会被解除
+        // 成功返回 true，失败返回 false
+        bool open(const fs::path &path, AccessHint hint = AccessHint::Sequential);
+        // 只映射 path 指向文件中从 offset 开始的 length 字节，length 为最大值时映射到文件末尾
+        // 范围超出文件时失败，成功返回 true，失败返回 false
+        bool open(const fs::path &path, std::uint64_t offset, std::size_t length,
+            AccessHint hint = AccessHint::Sequential);
+        // 解除映射
+        void close();
+        // 是否映射成功
+        bool isOpen() const;
+        // 获取映射内容
+        std::span<const std::byte> getData() const;
+        // 获取映射内容长度
+        std::size_t getSize() const;
+    };
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef NAME_TRIE_H
+#define NAME_TRIE_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace book {
+    /*
+     * class NameTrie
+     * 名字的压缩前缀树（radix trie），用于输入时的前缀补全与容错匹配
+     * 名字按 normalizeTitle 规范化后以码位为单位储存，只有一个子结点且没有名字结束于此的结点与子结点合并
+     * 每个名字带有一个值（如标签ID）与一个作用域（如所属标签组），同名的多个值挂在同一个结点上
+     * 结点记录子树内出现过的作用域的 64 位摘要，限定作用域时跳过不可能包含结果的子树
+     * 结点还记录子树内最短名字的剩余长度，查询按（编辑距离，名字长度，值）从小到大的顺序逐个产出结果，
+     * 只展开可能进入前 limit 个的结点
+     */
+    class NameTrie {
+    public:
+        static constexpr std::uint32_t anyScope = std::numeric_limits<std::uint32_t>::max();  // 不限定作用域
+        static constexpr unsigned maxDistance = 3U;     // 容错匹配允许的最大编辑距离
+
+        // 一条匹配结果
+        struct Match {
+            std::uint32_t m_value;      // 名字对应的值
+            std::uint32_t m_distance;   // 查询与名字某个前缀之间的最小编辑距离
+        };
+        using MatchList = std::vector<Match>;
+
+        // 构造函数
+        NameTrie();
+
+    private:
+        static constexpr std::uint32_t nullNode = 0U;   // 根结点不会作为子结点，借用其下标表示不存在
+
+        struct Entry {
+            std::uint32_t m_value;      // 值
+            std::uint32_t m_scope;      // 作用域
+        };
+
+        struct Node {
+            std::u32string m_label;                 // 从父结点到此结点的边上的码位，根结点为空
+            std::vector<std::uint32_t> m_children;  // 子结点下标，按标签首码位升序
+            std::vector<Entry> m_entries;           // 名字恰好结束于此的值
+            std::uint64_t m_scopeMask = 0U;         // 子树内作用域的摘要，第 scope % 64 位
+            std::uint32_t m_minLength = 0U;         // 子树内最短的名字在此结点之后还有多少码位
+        };
+
+        std::vector<Node> m_nodes;              // 结点表，下标 0 为根结点
+        std::vector<std::uint32_t> m_freeNodes; // 被回收的结点下标
+        std::size_t m_size;                     // 名字个数
+
+    public:
+        // 清空
+        void clear();
+        // 插入名字 name，值为 value，作用域为 scope
+        void insert(std::string_view name, std::uint32_t value, std::uint32_t scope);
+        // 删除名字 name 下值为 value 的一项，不存在时返回 false
+        bool erase(std::string_view name, std::uint32_t value);
+        // 获取名字个数
+        std::size_t size() const;
+        // 判断是否为空
+        bool empty() const;
+        // 占用的字节数（不含对象本身）
+        std::size_t getMemoryUsage() const;
+
+        /*
+         * 前缀补全：返回规范化后以 prefix 开头的名字
+         * 结果按名字长度、值升序，limit 不为 0 时只返回前 limit 个
+         * scope 不为 anyScope 时只返回该作用域内的名字
+         */
+        MatchList complete(std::string_view prefix, std::size_t limit = 0U, std::uint32_t scope = anyScope) const;
+        /*
+         * 容错补全：返回存在某个前缀与 query 的编辑距离不超过 distance 的名字
+         * distance 超过 maxDistance 时按 maxDistance 处理，为 0 时等同于 complete
+         * 结果按编辑距离、名字长度、值升序，limit 与 scope 同 complete
+         */
+        MatchList match(std::string_view query, unsigned distance, std::size_t limit = 0U,
+            std::uint32_t scope = anyScope) const;
+
+    private:
+        // 分配一个标签为 label 的新结点
+        std::uint32_t m_newNode(std::u32string_view label);
+        // 回收结点
+        void m_freeNode(std::uint32_t node);
+        // 查找 node 下标签以 first 开头的子结点，不存在时返回 nullNode
+        std::uint32_t m_findChild(std::uint32_t node, char32_t first) const;
+        // 将 child 按标签首码位插入 node 的子结点列表
+        void m_insertChild(std::uint32_t node, std::uint32_t child);
+        // 从 node 的子结点列表中移除 child
+        void m_removeChild(std::uint32_t node, std::uint32_t child);
+        // 在标签的第 at 个码位处拆分结点，node 保留前半段，后半段成为其唯一的子结点
+        void m_split(std::uint32_t node, std::size_t at);
+        // 将 node 唯一的子结点合并到 node 内
+        void m_merge(std::uint32_t node);
+        // 依据值与子结点重新计算 node 的作用域摘要与最短剩余长度
+        void m_updateSummary(std::uint32_t node);
+    };
+}
+
+#endif
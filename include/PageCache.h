@@ -0,0 +1,118 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace book {
+    using PageContent = std::shared_ptr<const std::string>;     // 页面二进制内容，读取失败时为 nullptr
+
+    // 页面缓存的键：所属书籍ID 与 页面路径
+    struct PageKey {
+        std::uint32_t m_owner = 0U;     // 所属书籍ID，不属于任何书籍时为 0
+        std::string m_path;             // 页面文件路径
+
+        bool operator==(const PageKey &other) const = default;
+    };
+
+    // 页面缓存统计信息
+    struct PageCacheStats {
+        std::uint64_t m_hits = 0U;          // 命中次数
+        std::uint64_t m_misses = 0U;        // 未命中次数
+        std::uint64_t m_evictions = 0U;     // 因超出预算被淘汰的页面数
+        std::size_t m_bytes = 0U;           // 当前缓存的字节数
+        std::size_t m_entries = 0U;         // 当前缓存的页面数
+    };
+
+    /*
+     * class PageCache
+     * 进程级页面缓存，在字节预算内缓存页面内容，按 LRU 淘汰
+     * 按键的哈希分片加锁，不同分片的访问互不阻塞
+     * 每次使用页面时记录全局递增的使用时刻，淘汰时比较各分片最久未使用的页面，按全局的使用顺序淘汰
+     */
+    class PageCache {
+    public:
+        using Loader = std::function<PageContent()>;
+
+        // budget 为字节预算，sumOfShards 为分片数量
+        PageCache(std::size_t budget = std::size_t(512U) << 20, std::size_t sumOfShards = 16U);
+        // 缓存不可复制
+        PageCache(const PageCache &) = delete;
+        PageCache &operator=(const PageCache &) = delete;
+
+        // 获取全局共享的页面缓存，ImagesManager 与 PagePrefetcher 均使用它
+        static PageCache &global();
+
+    private:
+        struct PageKeyHash {
+            std::size_t operator()(const PageKey &key) const noexcept;
+        };
+
+        // 缓存项
+        struct Entry {
+            PageKey m_key;
+            PageContent m_content;
+            std::uint64_t m_stamp = 0U;     // 最近一次使用的时刻
+        };
+        using EntryList = std::list<Entry>;
+
+        // 一个分片，链表头部为最近使用的页面
+        struct Shard {
+            std::mutex m_mutex;
+            EntryList m_lru;
+            std::unordered_map<PageKey, EntryList::iterator, PageKeyHash> m_map;
+        };
+
+        std::vector<std::unique_ptr<Shard>> m_shards;   // 分片
+        std::atomic<std::size_t> m_budget;              // 字节预算
+        std::atomic<std::size_t> m_bytes = 0U;          // 当前字节数
+        std::atomic<std::size_t> m_entries = 0U;        // 当前页面数
+        std::atomic<std::uint64_t> m_hits = 0U;
+        std::atomic<std::uint64_t> m_misses = 0U;
+        std::atomic<std::uint64_t> m_evictions = 0U;
+        std::atomic<std::uint64_t> m_clock = 1U;        // 下一个使用时刻，持有分片锁时递增，分片内链表顺序与时刻一致
+
+    public:
+        // 查找页面，未命中返回 nullptr
+        PageContent get(const PageKey &key);
+        // 查找页面，未命中时调用 loader 读取并放入缓存
+        PageContent getOrLoad(const PageKey &key, const Loader &loader);
+        // 放入页面，超出预算时淘汰最久未使用的页面
+        // 单个页面大于整个预算时不缓存
+        void put(const PageKey &key, PageContent content);
+        // 删除页面
+        void erase(const PageKey &key);
+        // 删除属于 owner 的所有页面
+        void erase(std::uint32_t owner);
+        // 清空缓存，统计计数不清零
+        void clear();
+
+        // 设置字节预算，超出时立即淘汰
+        void setBudget(std::size_t budget);
+        // 获取字节预算
+        std::size_t getBudget() const;
+        // 获取统计信息
+        PageCacheStats getStats() const;
+
+    private:
+        // 获取 key 所在分片的编号
+        std::size_t m_getShardIndex(const PageKey &key) const;
+        // 获取 key 所在的分片
+        Shard &m_getShard(const PageKey &key);
+        // 按全局使用顺序淘汰页面，直到不超出预算；使用时刻为 keep 的页面（刚放入的页面）不被淘汰
+        void m_evict(std::uint64_t keep = 0U);
+        // 获取分片内可被淘汰的最久未使用的页面，没有时返回 m_lru.end()，调用者持有分片锁
+        EntryList::iterator m_getVictim(Shard &shard, std::uint64_t keep);
+        // 从分片中移除一项，调用者持有分片锁
+        void m_removeEntry(Shard &shard, EntryList::iterator it);
+    };
+}
+
+#endif
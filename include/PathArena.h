@@ -0,0 +1,85 @@
+#ifndef PATH_ARENA_H
+#define PATH_ARENA_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    /*
+     * class PathArena
+     * 一组有序路径的紧凑储存：所有路径共享一个基准目录，位于其下的路径只储存相对名字
+     * 名字连续储存在同一个字符串内，每个路径只占一个偏移与长度，取路径时才拼出完整的 fs::path
+     * 删除留下的空洞在超过一半时整理
+     */
+    class PathArena {
+    public:
+        using StringType = fs::path::string_type;
+        using ViewType = std::basic_string_view<fs::path::value_type>;
+
+        // 默认构造函数
+        PathArena() = default;
+
+    private:
+        // 一个路径在 m_names 内的位置
+        struct Entry {
+            std::uint32_t m_offset;         // 名字的起始偏移
+            std::uint32_t m_length : 31;    // 名字的长度
+            std::uint32_t m_rooted : 1;     // 名字是否相对于 m_root
+        };
+
+        StringType m_root;              // 基准目录，不构造 fs::path 以免为每本书解析并储存路径的各个部分
+        StringType m_names;             // 所有名字连续储存
+        std::vector<Entry> m_entries;   // 各路径的位置，顺序即路径的顺序
+        std::size_t m_garbage = 0U;     // m_names 内已不被引用的字符数
+        std::uint64_t m_revision = 0U;  // 修订号，每次修改时取进程内递增的新值，不同实例之间也不重复
+
+    public:
+        // 获取基准目录
+        fs::path getRoot() const;
+        // 更换基准目录，相对名字随之移到新目录下，其余路径不变
+        void setRoot(const fs::path &root);
+        // 追加路径 path，没有基准目录时以 path 所在目录为基准目录
+        void add(const fs::path &path);
+        // 追加相对于基准目录的名字 name
+        void addRelative(const fs::path &name);
+        // 将 path 插入为第 index 个路径，index 超出范围时追加
+        void insert(std::size_t index, const fs::path &path);
+        // 删除第 index 个路径
+        void remove(std::size_t index);
+        // 交换第 index0 个与第 index1 个路径
+        void swap(std::size_t index0, std::size_t index1);
+        // 清空，包括基准目录
+        void clear();
+        // 预留 count 个路径、名字共 bytes 个字符的空间
+        void reserve(std::size_t count, std::size_t bytes = 0U);
+        // 获取路径个数
+        std::size_t size() const;
+        // 判断是否为空
+        bool empty() const;
+        // 获取第 index 个路径
+        fs::path getPath(std::size_t index) const;
+        // 获取第 index 个路径储存的名字，相对名字不含基准目录
+        ViewType getName(std::size_t index) const;
+        // 占用的堆内存字节数（不含对象本身）
+        std::size_t getMemoryUsage() const;
+        // 获取修订号，修订号不变说明路径与顺序都未修改，可用于校验依赖路径的缓存
+        std::uint64_t getRevision() const;
+
+    private:
+        // 将名字追加到 m_names 末尾，返回其位置
+        Entry m_append(ViewType name, bool rooted);
+        // 编码 path：位于基准目录下时为相对名字，否则为完整路径
+        Entry m_encode(const fs::path &path);
+        // 去掉 m_names 内不被引用的部分
+        void m_compact();
+        // 修改后更新修订号
+        void m_touch();
+    };
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef PERCEPTUAL_HASH_H
+#define PERCEPTUAL_HASH_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    /*
+     * 计算图像 data 的 64 位差值哈希（dHash）
+     * 图像缩小为 9×8 的灰度图后，每行相邻两格比较亮度得到 8 位
+     * 重新扫描、重新压缩或缩放过的同一页面哈希的汉明距离很小，字节完全不同也能识别
+     * 使用内置解码器，不依赖外部库：
+     *   PNG（非隔行）逐行解码，不保留整张图像
+     *   JPEG（基线与渐进式，Huffman 编码）只解码亮度的 DC 系数，即 1/8 缩略图，不做反 DCT
+     * GIF、WebP 等其他格式、不足 72×64 像素的 JPEG 以及纯色页面无法计算，返回 false
+     */
+    bool dhashImage(std::span<const std::byte> data, std::uint64_t &hash);
+    // 计算 path 指向图像文件的差值哈希，失败返回 false
+    bool dhashImageFile(const fs::path &path, std::uint64_t &hash);
+    // 两个哈希的汉明距离
+    inline int hammingDistance(std::uint64_t a, std::uint64_t b) { return std::popcount(a ^ b); }
+}
+
+#endif
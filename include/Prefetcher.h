@@ -0,0 +1,75 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <atomic>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "Img.h"
+#include "ThreadPool.h"
+
+namespace book {
+    using PageFuture = std::shared_future<PageContent>;         // 页面内容的异步句柄
+
+    /*
+     * class PagePrefetcher
+     * 顺序阅读预读器，依附于一个 ImagesManager（或 Book）
+     * 根据页面访问规律，在后台线程中提前读取后续 depth 页，读取结果放入全局页面缓存
+     * 读者跳转到较远的页面时，取消尚未完成的预读任务
+     */
+    class PagePrefetcher {
+    public:
+        // images 为被预读的图像管理器，pool 为执行预读任务的线程池
+        // pool 为空时，预读器自行创建一个两线程的线程池
+        PagePrefetcher(const ImagesManager &images, std::size_t depth = 4U, ThreadPool *pool = nullptr);
+        // 预读器不可复制
+        PagePrefetcher(const PagePrefetcher &) = delete;
+        PagePrefetcher &operator=(const PagePrefetcher &) = delete;
+        // 析构时取消所有未完成的预读
+        ~PagePrefetcher();
+
+    private:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        // 一次预读请求
+        struct Request {
+            PageFuture m_future;                                // 页面内容句柄
+            std::shared_ptr<std::atomic<bool>> m_cancelled;     // 取消标记，任务开始读取前检查
+        };
+
+        const ImagesManager *m_images;              // 被预读的图像管理器
+        std::unique_ptr<ThreadPool> m_ownPool;      // 自行创建的线程池
+        ThreadPool *m_pool;                         // 执行预读任务的线程池
+        std::size_t m_depth;                        // 预读深度
+        std::size_t m_lastIndex = npos;             // 上一次访问的页面
+        std::map<std::size_t, Request> m_requests;  // 页面编号 -> 尚未取走的预读请求
+        mutable std::mutex m_mutex;
+
+    public:
+        /*
+         * 获取第 index 页的内容句柄
+         * 已经预读的页面直接返回预读句柄，否则在当前线程同步读取
+         * 同时根据访问规律调整预读窗口
+         */
+        PageFuture getPage(std::size_t index);
+        // 取消所有未完成的预读
+        void cancel();
+        // 设置预读深度，为 0 时不预读
+        void setDepth(std::size_t depth);
+        // 获取预读深度
+        std::size_t getDepth() const;
+        // 获取尚未取走的预读请求数量
+        std::size_t getSumOfPending() const;
+
+    private:
+        // 提交第 index 页的预读任务（已存在时忽略）
+        void m_prefetch(std::size_t index);
+        // 取消 [first, last] 范围之外的所有预读
+        void m_cancelOutside(std::size_t first, std::size_t last);
+    };
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 被计时的热点
+    enum class ProbeId : std::uint8_t {
+        ImageRead,      // ImagesManager 读取一页的内容
+        ImageScan,      // ImagesManager::scanImageFiles 扫描一个目录
+        LibraryScan,    // LibraryScanner::scan 扫描整个漫画库
+        TagRead,        // TagManager 解析所有标签
+        LibraryRead,    // Library 读入数据文件
+        LibraryWrite,   // Library 写出数据文件
+        JournalAppend,  // Journal 追加一条记录
+        FileCopy,       // TransferEngine 复制一个文件
+        Count
+    };
+
+    // 累加计数器
+    enum class CounterId : std::uint8_t {
+        ImageBytesRead,     // 读取的页面字节数
+        FileBytesCopied,    // 复制的文件字节数
+        Count
+    };
+
+    constexpr std::size_t sumOfProbes = static_cast<std::size_t>(ProbeId::Count);       // 探针个数
+    constexpr std::size_t sumOfCounters = static_cast<std::size_t>(CounterId::Count);   // 计数器个数
+    constexpr std::size_t latencyBuckets = 64U;                                         // 延迟直方图的桶数
+
+    // 获取探针名，用作追踪事件名
+    std::string_view getProbeName(ProbeId probe);
+    // 获取计数器名
+    std::string_view getCounterName(CounterId counter);
+
+    // 一个探针的统计信息
+    struct ProbeStats {
+        std::uint64_t m_count = 0U;     // 次数
+        std::uint64_t m_totalNs = 0U;   // 总耗时（纳秒）
+        std::uint64_t m_maxNs = 0U;     // 最大耗时（纳秒）
+        // 延迟直方图：第 0 桶为 0 纳秒，第 i 桶为 [2^(i-1), 2^i) 纳秒
+        std::array<std::uint64_t, latencyBuckets> m_buckets{};
+
+        // 平均耗时（纳秒），没有记录时为 0
+        double getMeanNs() const;
+        // 估计分位数 q（0~1）处的耗时，返回所在桶的上界（纳秒），不超过最大耗时
+        std::uint64_t getPercentileNs(double q) const;
+    };
+
+    // 某一时刻所有线程统计信息之和
+    struct ProfileSnapshot {
+        std::array<ProbeStats, sumOfProbes> m_probes{};
+        std::array<std::uint64_t, sumOfCounters> m_counters{};
+
+        const ProbeStats &get(ProbeId probe) const;
+        std::uint64_t get(CounterId counter) const;
+    };
+
+    // 一次被记录的计时区间
+    struct TraceEvent {
+        std::uint64_t m_startNs = 0U;       // 开始时刻（Profiler::now()）
+        std::uint64_t m_durationNs = 0U;    // 耗时（纳秒）
+        ProbeId m_probe = ProbeId::Count;   // 探针
+    };
+
+    /*
+     * class Profiler
+     * 进程级性能采样：作用域计时器、累加计数器与按 2 的幂分桶的延迟直方图
+     * 每个线程写入自己的一份统计，只有本线程修改，不加锁也没有原子读改写，快照时汇总所有线程
+     * 默认关闭，关闭时计时器与计数器只读取一次开关；开启追踪后每个线程额外保留最近的计时区间，
+     * 可以导出为 Chrome 追踪格式（chrome://tracing 与 Perfetto 均可打开）
+     */
+    class Profiler {
+    public:
+        static constexpr std::size_t traceCapacity = std::size_t(1U) << 16;    // 每个线程保留的计时区间个数
+
+        // 不可复制
+        Profiler(const Profiler &) = delete;
+        Profiler &operator=(const Profiler &) = delete;
+
+        // 获取全局唯一的采样器，所有内置探针都记录到这里
+        static Profiler &global();
+
+        // 是否开启采样
+        static bool isEnabled() { return m_enabled.load(std::memory_order_relaxed); }
+        // 开启或关闭采样，已记录的统计保留
+        static void setEnabled(bool enable);
+        // 获取从进程内第一次计时起的纳秒数
+        static std::uint64_t now();
+        // 开启时将 value 累加到计数器 counter
+        static void count(CounterId counter, std::uint64_t value = 1U) {
+            if (isEnabled()) global().m_count(counter, value);
+        }
+
+    private:
+        struct ThreadData;
+        struct ThreadSlot;
+
+        // 每个线程的统计登记在唯一的采样器内，因此只能通过 global() 获取
+        Profiler() = default;
+
+        static inline std::atomic<bool> m_enabled = false;  // 采样开关，静态成员在判断时不经过 global() 的初始化检查
+        std::atomic<bool> m_tracing = false;                // 是否记录计时区间
+        std::mutex m_mutex;                                 // 保护线程列表
+        std::vector<std::unique_ptr<ThreadData>> m_threads; // 所有线程的统计，线程退出后留给之后的新线程复用
+        std::vector<ThreadData *> m_freeThreads;            // 已退出线程留下的统计
+
+    public:
+        // 开启或关闭追踪，只在采样开启时生效
+        void setTracing(bool enable);
+        // 是否开启追踪
+        bool isTracing() const;
+        // 记录探针 probe 从 startNs 到 endNs 的一次计时
+        void record(ProbeId probe, std::uint64_t startNs, std::uint64_t endNs);
+        // 汇总所有线程的统计
+        ProfileSnapshot snapshot();
+        // 清空所有统计与计时区间，与其他线程的记录同时进行时个别统计可能未被清零
+        void reset();
+        // 按开始时间顺序获取所有线程保留的计时区间，second 为线程编号
+        std::vector<std::pair<TraceEvent, std::uint32_t>> getTraceEvents();
+        /*
+         * 导出为 Chrome 追踪格式（JSON）：每个计时区间为一个完整事件（ph = X），
+         * 计数器的当前值为计数事件（ph = C），时间单位为微秒
+         */
+        std::string exportChromeTrace();
+        // 将 exportChromeTrace() 写入 path，成功返回 true，失败返回 false
+        bool writeChromeTrace(const fs::path &path);
+
+    private:
+        // 获取当前线程的统计，第一次调用时登记
+        ThreadData &m_getThreadData();
+        // 线程退出时归还其统计
+        void m_releaseThreadData(ThreadData *data);
+        // 累加当前线程的计数器
+        void m_count(CounterId counter, std::uint64_t value);
+    };
+
+    /*
+     * class ScopedTimer
+     * 作用域计时器：构造时开始、析构时结束，记录到全局采样器
+     * 采样关闭时只在构造时读取一次开关
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(ProbeId probe) : m_probe(probe), m_active(Profiler::isEnabled()) {
+            if (m_active) m_startNs = Profiler::now();
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+        ~ScopedTimer() {
+            if (m_active) Profiler::global().record(m_probe, m_startNs, Profiler::now());
+        }
+
+    private:
+        ProbeId m_probe;                // 探针
+        bool m_active;                  // 构造时采样是否开启
+        std::uint64_t m_startNs = 0U;   // 开始时刻
+    };
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <vector>
+#include "Img.h"
+#include "ThreadPool.h"
+
+namespace book {
+    // 扫描到的一话（capture N 目录）
+    struct ScannedChapter {
+        fs::path m_path;                    // 目录路径
+        std::vector<fs::path> m_images;     // 按自然顺序排列的图像文件
+    };
+
+    // 扫描到的一部漫画（Manga 目录）
+    struct ScannedManga {
+        fs::path m_path;                        // 目录路径
+        std::vector<ScannedChapter> m_chapters; // 按自然顺序排列的各话；图像直接位于漫画目录时视为唯一的一话
+    };
+
+    /*
+     * class LibraryScanner
+     * 并行扫描 mangas/<Manga>/capture N/ 目录结构
+     * 每部漫画与每一话都作为独立任务提交到工作窃取线程池
+     */
+    class LibraryScanner {
+    public:
+        // pool 为执行扫描任务的线程池，为空时使用全局线程池
+        LibraryScanner(ThreadPool *pool = nullptr);
+
+    private:
+        ThreadPool *m_pool;     // 执行扫描任务的线程池
+
+    public:
+        // 扫描漫画库根目录 root，忽略以点号开头的目录（如 .data）
+        // 返回按自然顺序排列的漫画列表
+        std::vector<ScannedManga> scan(const fs::path &root) const;
+        // 扫描单个漫画目录
+        ScannedManga scanManga(const fs::path &mangaPath) const;
+    };
+}
+
+#endif
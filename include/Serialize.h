@@ -0,0 +1,131 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 计算 CRC32C（Castagnoli），crc 为之前数据的校验值，用于分段计算
+    // x86-64 上支持 SSE4.2 时使用硬件指令
+    std::uint32_t crc32c(std::span<const std::byte> data, std::uint32_t crc = 0U);
+
+    /*
+     * class BinaryWriter
+     * 将数据编码到一块连续的内存缓冲区
+     * 定长整数按小端序写入，长度与计数使用 varint（LEB128）编码
+     */
+    class BinaryWriter {
+    public:
+        BinaryWriter() = default;
+
+    private:
+        std::string m_buffer;       // 编码结果
+
+    public:
+        // 写入定长无符号整数（小端序）
+        template<typename T> requires std::is_unsigned_v<T>
+        void putFixed(T value) {
+            char bytes[sizeof(T)];
+            for (std::size_t i = 0; i < sizeof(T); ++i) bytes[i] = static_cast<char>((value >> (8U * i)) & 0xffU);
+            m_buffer.append(bytes, sizeof(T));
+        }
+        // 写入 varint
+        void putVarint(std::uint64_t value);
+        // 写入字符串：varint 长度 + 内容
+        void putString(std::string_view str);
+        // 写入原始字节
+        void putBytes(std::span<const std::byte> bytes);
+
+        // 获取已编码的内容
+        std::span<const std::byte> getData() const;
+        // 获取已编码的字节数
+        std::size_t getSize() const;
+        // 预留空间
+        void reserve(std::size_t size);
+    };
+
+    /*
+     * class BinaryReader
+     * 从一块连续的内存缓冲区中解码 BinaryWriter 写入的数据
+     * 任何一次读取越界或数据非法后进入失败状态，之后的读取全部失败
+     */
+    class BinaryReader {
+    public:
+        BinaryReader(std::span<const std::byte> data);
+
+    private:
+        const std::byte *m_pos;     // 当前读取位置
+        const std::byte *m_end;     // 缓冲区末尾
+        bool m_fail = false;        // 是否已失败
+
+    public:
+        // 读取定长无符号整数（小端序）
+        template<typename T> requires std::is_unsigned_v<T>
+        bool getFixed(T &value) {
+            if (!m_require(sizeof(T))) return false;
+            value = 0U;
+            for (std::size_t i = 0; i < sizeof(T); ++i) value |= T(std::to_integer<std::uint8_t>(m_pos[i])) << (8U * i);
+            m_pos += sizeof(T);
+            return true;
+        }
+        // 读取 varint
+        bool getVarint(std::uint64_t &value);
+        // 读取 varint 表示的计数，每项至少占 minItemSize 字节，剩余数据放不下时视为非法
+        // 用于防止损坏的文件导致超大的内存分配
+        bool getCount(std::size_t &count, std::size_t minItemSize = 1U);
+        // 读取字符串
+        bool getString(std::string &str);
+        // 读取字符串，返回指向缓冲区内部的视图
+        bool getStringView(std::string_view &str);
+        // 读取 size 个原始字节，返回指向缓冲区内部的视图
+        bool getBytes(std::size_t size, std::span<const std::byte> &bytes);
+
+        // 是否已失败
+        bool fail() const;
+        // 是否已读取完毕
+        bool atEnd() const;
+        // 剩余字节数
+        std::size_t getRemaining() const;
+        // 手动置为失败状态，用于上层检查到非法数据时
+        void setFail();
+
+    private:
+        // 检查剩余字节数是否足够，不够时置为失败状态
+        bool m_require(std::size_t size);
+    };
+
+    // 数据文件头部
+    struct FileHeader {
+        std::array<char, 4> m_magic{};      // 文件类型标识
+        std::uint16_t m_version = 0U;       // 格式版本
+        std::uint16_t m_flags = 0U;         // 格式标记，由各文件类型自行定义
+    };
+
+    /*
+     * 以 data 替换 path 的内容：先写入同目录下的临时文件并 fsync，再改名为 path 并 fsync 所在目录
+     * 中途崩溃或断电时 path 要么是旧内容要么是完整的新内容，失败时删除临时文件
+     */
+    bool replaceFile(const fs::path &path, std::span<const std::byte> data);
+    /*
+     * 将 header 与 body 一次性写入 path
+     * 文件结构：magic(4) + version(2) + flags(2) + body + CRC32C(4)，校验范围为头部与 body
+     * 经由 replaceFile 写入，写入过程中崩溃或断电不会破坏原文件
+     */
+    bool writeDataFile(const fs::path &path, const FileHeader &header, const BinaryWriter &body);
+    /*
+     * 一次性读入 path 并校验，magic 必须一致、version 不能大于 maxVersion、CRC32C 必须正确
+     * 成功时 header 为文件头部，buffer 为整个文件内容，body 指向 buffer 内的数据部分
+     */
+    bool readDataFile(const fs::path &path, std::array<char, 4> magic, std::uint16_t maxVersion,
+        FileHeader &header, std::string &buffer, std::span<const std::byte> &body);
+}
+
+#endif
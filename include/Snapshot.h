@@ -0,0 +1,224 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "Tag.h"
+#include "TagIndex.h"
+#include "ImageProbe.h"
+#include "MappedFile.h"
+
+namespace book {
+    class Library;
+    class CatalogSnapshot;
+
+    namespace snapshot {
+        // 以下结构按小端序、自然对齐直接储存在快照文件内，读取时原地访问，不做任何解析
+
+        // 一段连续的记录：起始偏移（相对文件开头）与记录个数
+        struct Section {
+            std::uint64_t m_offset;
+            std::uint64_t m_count;
+        };
+
+        // 快照头部，位于数据文件头部（FileHeader）之后
+        struct Header {
+            std::uint32_t m_headerCrc;          // 本结构的 CRC32C，计算时此字段视为 0
+            std::uint32_t m_reserved;
+            std::uint64_t m_fileSize;           // 整个文件的长度
+            std::uint64_t m_sumOfBookTags;      // 有效书标签个数
+            std::uint64_t m_sumOfGroupTags;     // 有效组标签个数
+            std::uint64_t m_sumOfBooks;         // 有效书籍个数
+            Section m_bookTags;                 // TagRecord，下标即书标签ID
+            Section m_groupTags;                // TagRecord，下标即组标签ID
+            Section m_bookTagOrder;             // 按名字排序的有效书标签ID
+            Section m_groupTagOrder;            // 按名字排序的有效组标签ID
+            Section m_books;                    // BookRecord，下标即书籍ID
+            Section m_pages;                    // PageRecord，每本书的页面连续存放
+            Section m_tagIds;                   // TagIdType，每本书的标签连续存放
+            Section m_strings;                  // 标签名、页面路径与标题的字节池
+            Section m_archives;                 // ArchiveRecord，下标即书籍ID
+            Section m_entries;                  // EntryRecord，压缩包书籍的条目索引连续存放
+        };
+
+        struct TagRecord {
+            std::uint32_t m_nameOffset;         // 名字在字节池内的偏移
+            std::uint32_t m_nameLength;         // 名字长度
+            TagIdType m_id;                     // 标签ID，空位为 nullTagId
+            TagIdType m_groupId;                // 书标签所属组，组标签为 nullTagId
+        };
+
+        struct BookRecord {
+            BookIdType m_id;                    // 书籍ID，空位为 nullBookId
+            std::uint32_t m_sumOfTags;          // 标签个数
+            std::uint64_t m_firstTag;           // 第一个标签在 m_tagIds 内的下标
+            std::uint64_t m_firstPage;          // 第一页在 m_pages 内的下标
+            std::uint64_t m_sumOfPages;         // 页数
+            std::uint64_t m_titleOffset;        // 标题在字节池内的偏移
+            std::uint32_t m_titleLength;        // 标题长度
+            std::uint32_t m_reserved;
+        };
+
+        struct PageRecord {
+            std::uint64_t m_pathOffset;         // 路径在字节池内的偏移
+            std::uint32_t m_pathLength;         // 路径长度
+            std::uint32_t m_width;              // 宽度
+            std::uint32_t m_height;             // 高度
+            std::uint32_t m_format;             // ImageFormat
+        };
+
+        struct ArchiveRecord {
+            std::uint64_t m_pathOffset;         // 压缩包路径在字节池内的偏移
+            std::uint32_t m_pathLength;         // 压缩包路径长度，图像为普通文件的书为 0
+            std::uint32_t m_reserved;
+            std::uint64_t m_firstEntry;         // 第一个条目在 m_entries 内的下标，条目个数即页数
+        };
+
+        struct EntryRecord {
+            std::uint64_t m_offset;             // 数据在压缩包内的偏移
+            std::uint64_t m_compressedSize;     // 压缩后的长度
+            std::uint64_t m_size;               // 解压后的长度
+            std::uint32_t m_crc;                // CRC32
+            std::uint16_t m_method;             // ArchiveMethod
+            std::uint16_t m_reserved;
+        };
+    }
+
+    /*
+     * class BookView
+     * 快照内一本书的只读视图，接口与 Book 的读取接口对应
+     * 视图只保存指针，所属的 CatalogSnapshot 关闭后失效
+     */
+    class BookView {
+    public:
+        // 默认构造为空视图
+        BookView() = default;
+        BookView(const CatalogSnapshot *snapshot, const snapshot::BookRecord *record);
+
+    private:
+        // 快照还原书籍时读取压缩包条目
+        friend class CatalogSnapshot;
+
+        const CatalogSnapshot *m_snapshot = nullptr;    // 所属快照
+        const snapshot::BookRecord *m_record = nullptr; // 书籍记录
+
+        // 获取本书的页面记录，记录越界时视为没有页面
+        std::span<const snapshot::PageRecord> m_getPages() const;
+        // 获取本书的压缩包记录，不存在时返回 nullptr
+        const snapshot::ArchiveRecord *m_getArchive() const;
+        // 获取本书的压缩包条目记录，与页面一一对应；图像为普通文件或记录越界时为空
+        std::span<const snapshot::EntryRecord> m_getEntries() const;
+
+    public:
+        // 是否为空视图
+        bool isNull() const;
+        // 获取书籍ID
+        BookIdType getBookId() const;
+        // 获取标题
+        std::string_view getTitle() const;
+        // 获取页数
+        std::size_t getSumOfImages() const;
+        // 获取第 index 页的路径（储存的原始字节，POSIX 上即 native 路径），index 不合法时返回空
+        // 压缩包内的页面为 压缩包路径/条目名
+        std::string_view getImagePath(std::size_t index) const;
+        // 获取压缩包路径，图像为普通文件时返回空
+        std::string_view getArchivePath() const;
+        // 获取第 index 页的元数据，index 不合法时返回 Invalid
+        ImageInfo getImageInfo(std::size_t index) const;
+        // 获取标签数量
+        std::size_t getSumOfTags() const;
+        // 获取所有标签，直接指向快照内的数据
+        std::span<const TagIdType> getTags() const;
+        // 判断是否拥有标签
+        bool hasTag(TagIdType tagId) const;
+    };
+
+    /*
+     * class CatalogSnapshot
+     * 漫画库的内存映射快照，启动时只映射文件并检查头部，不解析也不构造任何对象
+     * 标签与书籍通过视图原地查询，接口与 TagManager、Library 的读取接口对应
+     * 需要修改时调用 materialize 一次性构造出完整的 Library
+     * 文件结构：FileHeader + snapshot::Header + 各段记录（8 字节对齐）+ 字节池 + CRC32C
+     * 记录原地访问，无法扩宽，标签ID宽度与当前构建不同的快照视为无效，需要由 write 重新生成
+     */
+    class CatalogSnapshot {
+    public:
+        static constexpr std::array<char, 4> fileMagic = { 'M', 'M', 'S', 'N' };   // 快照文件标识
+        static constexpr std::uint16_t fileVersion = 3U;                            // 快照格式版本，2 起记录压缩包索引，3 起记录标题
+
+        // 默认构造函数，不打开任何文件
+        CatalogSnapshot() = default;
+        // 打开 path 指向的快照
+        CatalogSnapshot(const fs::path &path);
+        // 视图保存了指向本对象的指针，因此禁止复制与移动
+        CatalogSnapshot(const CatalogSnapshot &) = delete;
+        CatalogSnapshot &operator=(const CatalogSnapshot &) = delete;
+
+    private:
+        MappedFile m_file;                      // 映射的快照文件
+        snapshot::Header m_header{};            // 头部副本
+
+    public:
+        /*
+         * 将 library 写为快照，整个文件只写入一次
+         * 成功返回 true，失败返回 false
+         */
+        static bool write(const Library &library, const fs::path &path);
+
+        /*
+         * 映射 path 指向的快照，只检查头部与各段范围，耗时与漫画库大小无关
+         * 成功返回 true，失败返回 false 并保持关闭
+         */
+        bool open(const fs::path &path);
+        // 关闭快照，之前获取的视图全部失效
+        void close();
+        // 是否已打开
+        bool isOpen() const;
+        // 校验整个文件的 CRC32C，需要读取整个文件
+        bool verify() const;
+        /*
+         * 用快照内容构造 library，library 原有内容被清空
+         * 成功返回 true，失败返回 false
+         */
+        bool materialize(Library &library) const;
+
+        // 以下与 TagManager 对应
+        TagIdType getBookTagId(std::string_view name) const;
+        TagIdType getGroupTagId(std::string_view name) const;
+        TagIdType getGroupTagId(TagIdType bookTagId) const;
+        // 获取书标签名，ID 不合法时返回空
+        std::string_view getBookTagName(TagIdType id) const;
+        // 获取组标签名，ID 不合法时返回空
+        std::string_view getGroupTagName(TagIdType id) const;
+        bool checkTagId(TagIdType id) const;
+        bool checkGroupTagId(TagIdType id) const;
+        std::size_t getSumOfBookTags() const;
+        std::size_t getSumOfGroupTags() const;
+
+        // 以下与 Library 对应
+        std::size_t getSumOfBooks() const;
+        bool checkBookId(BookIdType id) const;
+        // 获取书籍视图，ID 无效时返回空视图
+        BookView getBook(BookIdType id) const;
+        // 获取所有书籍ID
+        BookIdList getBooks() const;
+
+    private:
+        friend class BookView;
+
+        // 获取段内的记录，段在 open 时已检查过范围与对齐
+        template<typename T>
+        std::span<const T> m_getSection(const snapshot::Section &section) const;
+        // 获取字节池内的字符串，越界时返回空
+        std::string_view m_getString(std::uint64_t offset, std::uint64_t length) const;
+        // 在按名字排序的 order 内二分查找 name
+        TagIdType m_findTag(std::string_view name, const snapshot::Section &tags,
+            const snapshot::Section &order) const;
+        // 获取 tags 段内的有效标签记录，ID 不合法时返回 nullptr
+        const snapshot::TagRecord *m_getTag(TagIdType id, const snapshot::Section &tags) const;
+    };
+}
+
+#endif
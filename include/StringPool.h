@@ -0,0 +1,50 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace book {
+    /*
+     * class StringPool
+     * 字符串驻留池，相同内容的字符串只储存一份，返回的 string_view 在池的整个生命周期内有效
+     * 字符串连续储存在固定大小的块内，块不会移动，因此之后的驻留不会使已返回的视图失效
+     * 驻留的字符串不会被释放：标签改名或删除后旧名字仍留在池内，占用只随出现过的不同名字增长，
+     * 上限为进程内出现过的所有名字的总长，适合标签名这类种类有限、反复出现的字符串；可由 getMemoryUsage() 观察
+     * 已驻留的字符串在共享锁下查找，只有首次驻留时取得独占锁
+     */
+    class StringPool {
+    public:
+        static constexpr std::size_t chunkSize = std::size_t(64U) << 10;  // 每块的字节数，更长的字符串单独成块
+
+        // 默认构造函数
+        StringPool() = default;
+        // 视图指向池内的块，禁止复制与移动
+        StringPool(const StringPool &) = delete;
+        StringPool &operator=(const StringPool &) = delete;
+
+        // 获取全局共享的驻留池，标签名均驻留在其中
+        static StringPool &global();
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::vector<std::unique_ptr<char[]>> m_chunks;  // 储存字符串的块
+        std::size_t m_used = chunkSize;                 // 最后一块已使用的字节数，没有块时视为已满
+        std::size_t m_bytes = 0U;                       // 所有块的总字节数
+        std::unordered_set<std::string_view> m_strings; // 已驻留的字符串，指向块内
+
+    public:
+        // 驻留 str，返回池内内容相同的字符串，空串返回空视图
+        std::string_view intern(std::string_view str);
+        // 获取已驻留的字符串个数
+        std::size_t size() const;
+        // 占用的字节数（块与索引，不含对象本身）
+        std::size_t getMemoryUsage() const;
+    };
+}
+
+#endif
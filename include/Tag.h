@@ -5,13 +5,33 @@
 #include <limits>
 #include <string>
 #include <vector>
-#include <queue>
-#include <fstream>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include "Serialize.h"
+#include "NameTrie.h"
+#include "IdAllocator.h"
+#include "StringPool.h"
+
+/*
+ * 标签ID的位数，默认 16 位（最多 65535 个书标签），标签更多时以 -DBOOK_TAG_ID_BITS=32 编译
+ * 文件头部记录写入时的ID字节数，32 位构建可以直接读入 16 位构建写出的文件并在下次写入时扩宽
+ */
+#ifndef BOOK_TAG_ID_BITS
+#define BOOK_TAG_ID_BITS 16
+#endif
 
 namespace book {
     /* 自定义类型 */
+#if BOOK_TAG_ID_BITS == 16
     using TagIdType = uint16_t;                 // 标签ID类型
+#elif BOOK_TAG_ID_BITS == 32
+    using TagIdType = uint32_t;                 // 标签ID类型
+#else
+#error "BOOK_TAG_ID_BITS must be 16 or 32"
+#endif
     using TagIdList = std::vector<TagIdType>;   // 标签ID列表类型
 
     /* 类的提前声明 */
@@ -19,6 +39,8 @@ namespace book {
     class BookTag;
     class GroupTag;
     class TagManager;
+    class CatalogSnapshot;
+    class Journal;
 
     /* 一些常量 */
     constexpr TagIdType nullTagId = std::numeric_limits<TagIdType>::min();      // 空标签ID
@@ -27,6 +49,11 @@ namespace book {
     extern const BookTag nullbtag;      // 空书标签
     extern const GroupTag nullgtag;     // 空组标签
 
+    // 判断文件记录的标签ID字节数 idSize 能否被读入，只接受 2 字节与不超过 TagIdType 的 4 字节
+    bool checkTagIdSize(std::size_t idSize);
+    // 从 in 中读取以 idSize 字节储存的标签ID并扩宽为 TagIdType
+    bool readTagId(BinaryReader &in, TagIdType &id, std::size_t idSize = sizeof(TagIdType));
+
     // concept 用于判断类型是否是 BookTag 和 GroupTag 之一
     template<typename TagType>
     concept isTagType = std::is_same_v<TagType, BookTag> || std::is_same_v<TagType, GroupTag>;
@@ -52,13 +79,13 @@ namespace book {
     private:
         // 成员变量
         TagIdType m_id;         // 标签ID
-        std::string m_name;     // 标签名
+        std::string_view m_name;    // 标签名，驻留在 StringPool::global() 内，相同的名字只储存一份，改名与删除后旧名字不释放
 
     public:
-        // 标签从文件流读入
-        void read(std::ifstream &in);
-        // 标签向文件流写入
-        void write(std::ofstream &out) const;
+        // 标签从 in 中读入，ID以 idSize 字节储存
+        bool read(BinaryReader &in, std::size_t idSize = sizeof(TagIdType));
+        // 标签向 out 写入
+        void write(BinaryWriter &out) const;
 
         // 获取标签ID
         TagIdType getId() const;
@@ -86,10 +113,10 @@ namespace book {
 
         // 获取标签组ID
         TagIdType getGroupId() const;
-        // 标签从文件流读入
-        void read(std::ifstream &in);
-        // 标签向文件流写入
-        void write(std::ofstream &out) const;
+        // 标签从 in 中读入，ID以 idSize 字节储存
+        bool read(BinaryReader &in, std::size_t idSize = sizeof(TagIdType));
+        // 标签向 out 写入
+        void write(BinaryWriter &out) const;
     };
 
     /* class GroupTag */
@@ -103,6 +130,13 @@ namespace book {
         // 虽然与Tag没有什么区别，构造函数还是要写的
     };
 
+    // 标签补全的一条建议
+    struct TagSuggestion {
+        TagIdType m_tagId;          // 标签ID
+        std::uint32_t m_distance;   // 输入与标签名某个前缀之间的编辑距离，前缀补全时为 0
+    };
+    using TagSuggestionList = std::vector<TagSuggestion>;   // 标签补全建议列表类型
+
     /*
      * class TagManager
      * 用于管理书标签与组标签
@@ -115,7 +149,11 @@ namespace book {
         TagManager(std::string_view path);
 
     private:
-        using TagIdHeap = std::priority_queue<TagIdType, std::vector<TagIdType>, std::greater<TagIdType>>; // 储存 TagId 的小根堆
+        // 快照直接读写标签信息
+        friend class book::CatalogSnapshot;
+
+        // 标签名 -> 标签ID，键直接引用标签驻留的名字，不另外复制
+        using TagNameIndex = std::unordered_map<std::string_view, TagIdType>;
 
         // 用于储存标签信息的内部类
         template<isTagType TagType>
@@ -129,24 +167,33 @@ namespace book {
             std::size_t m_curSumOfTags;         // 当前共有多少标签
             TagIdType m_curMaxTag;              // 当前最大标签ID
             TagList m_Tags;        // 标签列表，保证合法标签ID与此动态数组下标一致
-            TagIdHeap m_erasedTags;             // 被删除的标签ID
+            IdAllocator m_erasedTags;           // 被删除的标签ID，新标签优先使用其中最小的
+            TagNameIndex m_nameIndex;           // 标签名索引，只包含有效标签
+            NameTrie m_nameTrie;                // 标签名前缀树，用于补全，书标签的作用域为所属组
         };
 
     private:
         TagsInfo<BookTag> m_bookTags;           // 书标签信息
         TagsInfo<GroupTag> m_groupTags;         // 组标签信息
+        std::vector<TagIdList> m_groupMembers;  // 下标为书标签所属的组ID，组内的书标签ID（升序），随书标签的创建与删除维护
+        Journal *m_journal = nullptr;           // 修改日志，为空时不记录
 
     public:
         // 清空 TagManager 的信息
         void clear();
 
-        // 写入指定路径
-        void read(std::string_view path);
-        // 从指定路径读入
-        void write(std::string_view path) const;
+        // 从指定路径读入，文件头部或校验值不正确时清空并返回 false，较窄的标签ID被扩宽
+        bool read(std::string_view path);
+        // 写入指定路径，整个文件只写入一次
+        bool write(std::string_view path) const;
+
+        // 从 in 中解码，标签ID以 idSize 字节储存，数据非法时清空并返回 false
+        bool read(BinaryReader &in, std::size_t idSize = sizeof(TagIdType));
+        // 编码到 out 内，标签ID总以 sizeof(TagIdType) 字节写入
+        void write(BinaryWriter &out) const;
 
-        void read(std::ifstream &in);
-        void write(std::ofstream &out) const;
+        static constexpr std::array<char, 4> fileMagic = { 'M', 'M', 'T', 'G' };   // 标签文件标识
+        static constexpr std::uint16_t fileVersion = 1U;                            // 标签文件格式版本
 
         /*
          * 用标签名获取书ID
@@ -189,7 +236,7 @@ namespace book {
         /*
          * 创建一个新的书标签
          * 返回新创建标签的ID
-         * 如果创建失败（标签已满或者标签已存在），则返回空ID，即 nullTagId
+         * 如果创建失败（标签已满或者 groupTagId 不是有效的组标签），则返回空ID，即 nullTagId
          */
         TagIdType createBookTag(std::string_view name, TagIdType groupTagId);
         /*
@@ -208,6 +255,18 @@ namespace book {
          * 成功返回 true，失败返回 false
          */
         bool eraseGroupTag(TagIdType groupTagId);
+        /*
+         * 重命名书标签
+         * 成功返回 true，失败（标签不存在或新名字已被使用）返回 false
+         */
+        bool renameBookTag(TagIdType bookTagId, std::string_view name);
+        /*
+         * 重命名组标签
+         * 成功返回 true，失败（标签不存在或新名字已被使用）返回 false
+         */
+        bool renameGroupTag(TagIdType groupTagId, std::string_view name);
+        // 设置修改日志，之后创建、删除、重命名标签都会追加到日志，为空时不记录
+        void setJournal(Journal *journal);
         /*
          * 获取当前书标签个数
          * 返回个数
@@ -223,13 +282,34 @@ namespace book {
          */
         std::size_t getSumOfTagsFromGroup(TagIdType groupId) const;
         /*
-         * 获取某个标签组下的所有书标签
+         * 获取某个标签组下的所有书标签（升序）
          */
         std::unique_ptr<TagIdList> getBookTags(TagIdType groupId) const;
+        /*
+         * 获取某个标签组下的所有书标签（升序），不复制
+         * 返回的视图在创建或删除书标签后失效
+         */
+        std::span<const TagIdType> getGroupMembers(TagIdType groupId) const;
+        /*
+         * 压缩书标签ID：按原有顺序将所有书标签重新编号为 1..n，消除被删除的标签留下的空位
+         * 返回重映射表，下标为旧ID，值为新ID，已删除的旧ID映射为 nullTagId；没有空位时返回空表且不做任何修改
+         * 不写入日志，持有书标签ID的书籍与索引需要由调用方按重映射表更新（见 Library::compactTags）
+         */
+        TagIdList compactBookTags();
         // 获取所有书标签 ID
         std::unique_ptr<TagIdList> getBookTags() const;
         // 获取所有组标签 ID
         std::unique_ptr<TagIdList> getGroupTags() const;
+        /*
+         * 书标签补全，标签名与输入都按 normalizeTitle 规范化（忽略大小写、全半角与标点）
+         * 返回名字以 prefix 开头的书标签；maxDistance 不为 0 时允许 prefix 与名字的某个前缀有至多 maxDistance 处编辑
+         * 结果按编辑距离、名字长度、标签ID升序，limit 不为 0 时只返回前 limit 个
+         * groupTagId 不为 nullTagId 时只返回该组内的书标签
+         */
+        TagSuggestionList suggestBookTags(std::string_view prefix, std::size_t limit = 0U,
+            unsigned maxDistance = 0U, TagIdType groupTagId = nullTagId) const;
+        // 组标签补全，规则同 suggestBookTags
+        TagSuggestionList suggestGroupTags(std::string_view prefix, std::size_t limit = 0U, unsigned maxDistance = 0U) const;
 
     private:
         /* 通用清空 Info */
@@ -241,21 +321,38 @@ namespace book {
         /* 通过 name 获取 info 内标签ID */
         template<isTagType TagType>
         TagIdType m_getTagId(std::string_view name, const TagsInfo<TagType> &info) const;
+        /* 依据 info.m_Tags 重建标签名索引与前缀树 */
+        template<isTagType TagType>
+        void m_rebuildNameIndex(TagsInfo<TagType> &info);
+        /* 将有效标签 tag 登记到 info 的标签名索引与前缀树 */
+        template<isTagType TagType>
+        void m_indexName(const TagType &tag, TagsInfo<TagType> &info);
+        /* 在 info 的前缀树内补全，scope 为 NameTrie::anyScope 时不限定组 */
+        template<isTagType TagType>
+        TagSuggestionList m_suggest(std::string_view prefix, std::size_t limit, unsigned maxDistance,
+            std::uint32_t scope, const TagsInfo<TagType> &info) const;
+        /* 依据书标签重建组到书标签的索引 */
+        void m_rebuildGroupMembers();
+        /* 检查所有书标签的组ID都在组标签ID的范围内，读入的数据在重建组索引前必须通过检查 */
+        bool m_checkGroupIds() const;
         /* 通过 id 获取 info 内标签 */
         template<isTagType TagType>
         const TagType &m_getTag(TagIdType id, const TagsInfo<TagType> &info) const;
-        /* 从输入流 in 中读取 info */
+        /* 从 in 中读取 info，标签ID以 idSize 字节储存，数据不自洽时返回 false */
         template<isTagType TagType>
-        void m_readInfo(std::ifstream &in, TagsInfo<TagType> &info);
-        /* 将 info 写入输出流 out */
+        bool m_readInfo(BinaryReader &in, TagsInfo<TagType> &info, std::size_t idSize);
+        /* 将 info 写入 out */
         template<isTagType TagType>
-        void m_writeInfo(std::ofstream &out, const TagsInfo<TagType> &info) const;
+        void m_writeInfo(BinaryWriter &out, const TagsInfo<TagType> &info) const;
         /*
          * 从 info 中获取未被使用的新 ID
          * 获取新 ID 即创建了新的标签
          */
         template<isTagType TagType>
         TagIdType m_getNewId(TagsInfo<TagType> &info);
+        /* 将 info 内标签ID为 id 的标签重命名为 name */
+        template<isTagType TagType>
+        bool m_renameTag(TagIdType id, std::string_view name, TagsInfo<TagType> &info);
         /* 从 info 中删除标签ID为 id 的标签 */
         template<isTagType TagType>
         bool m_eraseTag(TagIdType id, TagsInfo<TagType> &info);
@@ -0,0 +1,62 @@
+#ifndef TAG_INDEX_H
+#define TAG_INDEX_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Tag.h"
+#include "Bitmap.h"
+
+namespace book {
+    using BookIdType = std::uint32_t;           // 书籍ID类型
+    using BookIdList = std::vector<BookIdType>; // 书籍ID列表类型
+    constexpr BookIdType nullBookId = 0U;       // 空书籍ID
+
+    // 多标签查询条件
+    struct TagQuery {
+        TagIdList m_all;        // 必须同时包含的标签（AND）
+        TagIdList m_any;        // 至少包含其中之一的标签（OR），为空时不作限制
+        TagIdList m_none;       // 不能包含的标签（NOT）
+    };
+
+    /*
+     * class TagIndex
+     * 标签倒排索引：书标签ID -> 含有该标签的所有书籍ID（压缩位图）
+     * 由 Book::addTag、Book::removeTag、Book::removeTags 增量维护
+     */
+    class TagIndex {
+    public:
+        // 默认构造函数
+        TagIndex() = default;
+
+    private:
+        std::vector<IdBitmap> m_tagBooks;       // 下标为书标签ID
+        IdBitmap m_allBooks;                    // 所有登记过的书籍
+        static const IdBitmap m_emptyBitmap;    // 空位图，查询不存在的标签时返回
+
+    public:
+        // 清空索引
+        void clear();
+        // 登记书籍 bookId 及其所有标签 tags
+        void addBook(BookIdType bookId, std::span<const TagIdType> tags);
+        // 移除书籍 bookId 及其所有标签 tags
+        void removeBook(BookIdType bookId, std::span<const TagIdType> tags);
+        // 为已登记的书籍 bookId 添加标签 tagId
+        void add(TagIdType tagId, BookIdType bookId);
+        // 删除书籍 bookId 的标签 tagId
+        void remove(TagIdType tagId, BookIdType bookId);
+        // 删除标签 tagId 的全部记录，用于标签被删除时
+        void eraseTag(TagIdType tagId);
+
+        // 获取含有标签 tagId 的所有书籍
+        const IdBitmap &getBooks(TagIdType tagId) const;
+        // 获取所有登记过的书籍
+        const IdBitmap &getAllBooks() const;
+        // 按多标签条件查询书籍
+        IdBitmap query(const TagQuery &query) const;
+        // 按多标签条件查询书籍，返回升序的书籍ID列表
+        BookIdList search(const TagQuery &query) const;
+    };
+}
+
+#endif
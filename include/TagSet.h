@@ -0,0 +1,95 @@
+#ifndef TAG_SET_H
+#define TAG_SET_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "Tag.h"
+
+namespace book {
+    /*
+     * class TagSet
+     * 书籍的标签集合，标签ID升序且不重复，每个标签连同其所属的组ID一起储存
+     * 各组的标签个数随增删维护，与标签储存在同一块内存内，按组计数与按组清除不需要逐个查询标签管理器
+     * 不超过 inlineCapacity 个标签时储存在对象内，不分配堆内存；更多时储存在容量为 8 的倍数的堆数组内
+     * 查找以 128 位为一组做 SIMD 比较（16 位ID 8 个，32 位ID 4 个）
+     * 标签个数超过 bitsetThreshold 时改为二分查找，最大ID不超过 65535 时另外维护位图，查找只需一次位运算
+     */
+    class TagSet {
+    public:
+        static constexpr std::size_t inlineCapacity = 8U;      // 对象内最多储存的标签个数
+        static constexpr std::size_t bitsetThreshold = 64U;    // 标签个数超过此值时维护位图
+
+        // 默认构造函数
+        TagSet() = default;
+        // 复制构造函数
+        TagSet(const TagSet &other);
+        // 移动构造函数
+        TagSet(TagSet &&other) noexcept;
+        // 复制赋值
+        TagSet &operator=(const TagSet &other);
+        // 移动赋值
+        TagSet &operator=(TagSet &&other) noexcept;
+
+    private:
+        /*
+         * 储存区依次为四个长度为 m_capacity 的数组：
+         * 标签ID（升序）、对应的组ID、出现过的组ID（升序）、对应组内的标签个数
+         */
+        using Storage = std::array<TagIdType, inlineCapacity * 4U>;
+
+        Storage m_inline{};                         // 对象内储存区
+        std::unique_ptr<TagIdType[]> m_heap;        // 堆上储存区，为空时使用对象内储存区
+        std::uint32_t m_size = 0U;                  // 标签个数
+        std::uint32_t m_sumOfGroups = 0U;           // 出现过的组个数
+        std::uint32_t m_capacity = inlineCapacity;  // 当前储存区能容纳的标签个数
+        std::vector<std::uint64_t> m_bits;          // 标签个数超过 bitsetThreshold 时的位图，否则或最大ID过大时为空
+
+    public:
+        // 添加属于 groupId 组的标签 tagId，已经存在时返回 false
+        bool insert(TagIdType tagId, TagIdType groupId);
+        // 删除标签 tagId，不存在时返回 false
+        bool erase(TagIdType tagId);
+        // 删除属于 groupId 组的所有标签，返回删除的个数
+        std::size_t eraseGroup(TagIdType groupId);
+        // 清空，释放堆内存
+        void clear();
+        // 按重映射表 table（下标为旧ID）改写所有标签ID，超出表的范围或映射为 nullTagId 的标签被删除
+        void remap(std::span<const TagIdType> table);
+        // 判断是否含有标签 tagId
+        bool contains(TagIdType tagId) const;
+        // 获取标签个数
+        std::size_t size() const;
+        // 判断是否为空
+        bool empty() const;
+        // 获取所有标签ID（升序），增删标签后失效
+        std::span<const TagIdType> getTags() const;
+        // 获取属于 groupId 组的所有标签ID（升序）
+        TagIdList getTags(TagIdType groupId) const;
+        // 获取属于 groupId 组的标签个数
+        std::size_t getSumOfTags(TagIdType groupId) const;
+        // 获取含有标签的所有组ID（升序），增删标签后失效
+        std::span<const TagIdType> getGroups() const;
+        // 占用的堆内存字节数（不含对象本身）
+        std::size_t getMemoryUsage() const;
+
+    private:
+        // 获取储存区内的第 index 个数组，依次为标签ID、标签的组ID、出现过的组ID、组内标签个数
+        TagIdType *m_array(std::size_t index);
+        const TagIdType *m_array(std::size_t index) const;
+        // 查找标签 tagId 的下标，不存在时返回 m_size
+        std::size_t m_find(TagIdType tagId) const;
+        // 查找组 groupId 在出现过的组中的下标，不存在时返回 m_sumOfGroups
+        std::size_t m_findGroup(TagIdType groupId) const;
+        // 更换储存区，使其能容纳 capacity 个标签（不小于 m_size），容量不超过 inlineCapacity 时回到对象内
+        void m_reserve(std::size_t capacity);
+        // 将 groupId 组的标签个数加上 delta，个数为 0 的组被移除
+        void m_countGroup(TagIdType groupId, int delta);
+        // 依据当前标签重建位图，标签个数不超过 bitsetThreshold 的一半或最大ID超出位图上限时释放位图
+        void m_rebuildBits();
+    };
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace book {
+    /*
+     * class ThreadPool
+     * 工作窃取线程池
+     * 每个工作线程拥有自己的任务队列：在工作线程内提交的任务放入自己的队列并优先执行（后进先出），
+     * 自己的队列为空时从其他线程的队列头部窃取任务；外部提交的任务轮流分配到各个队列
+     */
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        // 创建 sumOfThreads 个工作线程，为 0 时使用硬件并发数
+        ThreadPool(std::size_t sumOfThreads = 0U);
+        // 线程池不可复制
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        // 析构时执行完所有已提交的任务后再退出
+        ~ThreadPool();
+
+        // 获取全局共享的线程池
+        static ThreadPool &global();
+
+    private:
+        // 一个工作线程的任务队列
+        struct WorkQueue {
+            std::mutex m_mutex;
+            std::deque<Task> m_tasks;
+        };
+
+        std::vector<std::thread> m_workers;                 // 工作线程
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;   // 与工作线程一一对应的任务队列
+        std::atomic<std::size_t> m_nextQueue = 0U;          // 外部提交任务时轮流选择的队列
+        std::mutex m_mutex;
+        std::condition_variable m_taskReady;    // 有新任务或需要退出
+        std::condition_variable m_allDone;      // 所有任务执行完毕
+        std::size_t m_sumOfPending = 0U;        // 已提交但未执行完毕的任务数量，由 m_mutex 保护
+        bool m_stop = false;                    // 是否正在退出
+
+    public:
+        // 提交任务
+        void submit(Task task);
+        // 等待所有已提交的任务执行完毕
+        void wait();
+        // 获取工作线程数量
+        std::size_t getSumOfThreads() const;
+
+    private:
+        // 工作线程主循环
+        void m_workerLoop(std::size_t index);
+        // 为第 index 个工作线程取得一个任务，没有任务时返回 false
+        bool m_takeTask(std::size_t index, Task &task);
+    };
+
+    /*
+     * class TaskGroup
+     * 在线程池上执行的一组任务，可以只等待这一组任务完成
+     * 组内的任务可以继续向同一组提交任务
+     */
+    class TaskGroup {
+    public:
+        TaskGroup(ThreadPool &pool);
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+        // 析构时等待组内任务全部完成
+        ~TaskGroup();
+
+    private:
+        ThreadPool *m_pool;
+        std::mutex m_mutex;
+        std::condition_variable m_allDone;
+        std::size_t m_sumOfPending = 0U;
+
+    public:
+        // 向组内提交任务
+        void submit(ThreadPool::Task task);
+        // 等待组内任务全部完成
+        void wait();
+    };
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef TITLE_INDEX_H
+#define TITLE_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "TagIndex.h"
+
+namespace book {
+    /*
+     * 将标题规范化为用于索引与匹配的形式（UTF-8）
+     * 拉丁字母转为小写，全角字母、数字与符号转为半角
+     * 空白与标点视为分隔符，连续的分隔符合并为一个空格，首尾不留空格
+     * 不合法的 UTF-8 字节被丢弃
+     */
+    std::string normalizeTitle(std::string_view title);
+
+    /*
+     * class PostingList
+     * 有序书籍ID列表的压缩储存，用于标题索引的倒排表
+     * 元素分块储存，每块最多 2 * blockSize 个：块首元素与偏移记在跳表内，其余元素按与前一个元素的差值以 varint 编码
+     * 追加更大的ID为 O(1)，在中间插入或删除只重新编码所在的一块
+     * 求交集时借助跳表跳过不可能包含候选ID的块，不解码整个列表
+     */
+    class PostingList {
+    public:
+        static constexpr std::size_t blockSize = 128U;     // 追加时每块的元素个数
+
+        PostingList() = default;
+
+    private:
+        struct Skip {
+            BookIdType m_first;         // 块首元素
+            std::uint32_t m_offset;     // 块内其余元素在 m_data 内的起始偏移
+            std::uint32_t m_count;      // 块内元素个数
+        };
+
+        std::vector<std::uint8_t> m_data;   // 各块的差值编码，按块顺序连续存放
+        std::vector<Skip> m_skips;          // 跳表，按块首元素升序
+        std::uint32_t m_size = 0U;          // 元素个数
+        BookIdType m_last = nullBookId;     // 最大元素，用于判断能否直接追加
+
+    public:
+        // 添加元素，返回是否真的添加了新元素
+        bool add(BookIdType id);
+        // 删除元素，返回是否真的删除了元素
+        bool remove(BookIdType id);
+        // 获取元素个数
+        std::size_t size() const;
+        // 判断是否为空
+        bool empty() const;
+        // 按升序导出所有元素
+        BookIdList toList() const;
+        // 只保留 ids（升序）中同时在本列表内的元素
+        void intersect(BookIdList &ids) const;
+        // 占用的字节数（不含对象本身）
+        std::size_t getMemoryUsage() const;
+
+    private:
+        // 获取第 block 块的编码范围的末尾
+        std::size_t m_getBlockEnd(std::size_t block) const;
+        // 将第 block 块解码追加到 out
+        void m_decodeBlock(std::size_t block, BookIdList &out) const;
+        // 用 ids（升序）重新编码第 block 块，元素过多时拆分，为空时删除该块
+        void m_encodeBlock(std::size_t block, const BookIdList &ids);
+        // 查找可能包含 id 的块，即块首元素不大于 id 的最后一块，id 小于所有块首时返回 0
+        std::size_t m_findBlock(BookIdType id) const;
+    };
+
+    // 标题匹配的程度，数值越小越好
+    enum class TitleMatchRank : std::uint8_t {
+        Exact,      // 规范化后与查询完全相同
+        Prefix,     // 以查询开头
+        WordPrefix, // 查询出现在某个词的开头
+        Phrase,     // 查询连续出现在标题中
+        AllTerms,   // 查询的各个词都出现，但不连续
+    };
+
+    // 一条标题搜索结果
+    struct TitleMatch {
+        BookIdType m_bookId = nullBookId;
+        TitleMatchRank m_rank = TitleMatchRank::AllTerms;
+    };
+
+    /*
+     * class TitleIndex
+     * 标题全文索引：字符 n-gram -> 标题含有该 n-gram 的所有书籍ID
+     * 中日文标题没有分词，因此按字符切分：每个词的相邻两个字符（bigram）与每个单独的字符（unigram）分别建立倒排表
+     * 查询时求各 n-gram 倒排表的交集，再对候选书籍逐个验证并按匹配程度排序
+     * 由 Book::setTitle 增量维护，改名时只更新新旧标题不同的 n-gram，规范化后为空的标题不登记
+     */
+    class TitleIndex {
+    public:
+        // 默认构造函数
+        TitleIndex() = default;
+
+    private:
+        std::unordered_map<std::uint64_t, PostingList> m_postings;  // n-gram -> 倒排表
+        std::vector<std::string> m_titles;      // 下标为书籍ID，规范化后的标题
+        std::vector<std::uint16_t> m_lengths;   // 下标为书籍ID，规范化后标题的字节数（超过 65535 时截断），排序时先只读这个紧凑的数组
+        std::size_t m_sumOfBooks = 0U;          // 登记的书籍数
+
+    public:
+        // 清空索引
+        void clear();
+        // 登记书籍 bookId 的标题 title，已登记的书籍替换为新标题
+        void addBook(BookIdType bookId, std::string_view title);
+        // 移除书籍 bookId
+        void removeBook(BookIdType bookId);
+        // 获取书籍 bookId 规范化后的标题，未登记时返回空
+        std::string_view getTitle(BookIdType bookId) const;
+        // 获取登记的书籍数
+        std::size_t getSumOfBooks() const;
+        // 获取倒排表占用的字节数
+        std::size_t getMemoryUsage() const;
+
+        /*
+         * 搜索标题含有 query 的书籍，query 内以空白或标点分隔的各个词都必须出现
+         * 结果按匹配程度、标题长度、书籍ID排序，limit 不为 0 时只返回前 limit 个
+         */
+        std::vector<TitleMatch> search(std::string_view query, std::size_t limit = 0U) const;
+    };
+}
+
+#endif
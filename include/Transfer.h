@@ -0,0 +1,91 @@
+#ifndef TRANSFER_H
+#define TRANSFER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <vector>
+#include "ThreadPool.h"
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 传输方式
+    enum class TransferMode {
+        Copy,       // 复制，保留源文件
+        Move,       // 移动，成功后删除源文件
+    };
+
+    // 单个文件实际使用的传输方法
+    enum class TransferMethod : std::uint8_t {
+        None,       // 未传输（失败或被回滚）
+        Rename,     // 同一文件系统内改名
+        Reflink,    // FICLONE 写时复制，不复制数据
+        CopyRange,  // copy_file_range，数据在内核内复制
+        Stream,     // 普通读写
+    };
+
+    // 一个待传输的文件
+    struct TransferItem {
+        fs::path m_src;     // 源文件
+        fs::path m_dest;    // 目标文件，不能已存在
+    };
+
+    // 单个文件的传输结果，与 TransferItem 下标一致
+    struct TransferResult {
+        std::uint64_t m_bytes = 0U;                     // 传输的字节数
+        TransferMethod m_method = TransferMethod::None; // 使用的传输方法
+        std::error_code m_error;                        // 错误，成功时为空
+    };
+
+    // 整批传输的进度
+    struct TransferProgress {
+        std::size_t m_sumOfFiles = 0U;      // 文件总数
+        std::size_t m_doneFiles = 0U;       // 已完成（成功或失败）的文件数
+        std::uint64_t m_doneBytes = 0U;     // 已传输的字节数
+    };
+
+    // 每个文件完成后调用，index 为完成的文件下标；同一批次内的调用不会并发
+    using TransferCallback = std::function<void(const TransferProgress &progress, std::size_t index,
+        const TransferResult &result)>;
+
+    /*
+     * class TransferEngine
+     * 批量复制或移动文件，在线程池上同时进行至多 maxInFlight 个文件的传输
+     * 优先使用 FICLONE 写时复制，其次 copy_file_range，都不支持时退化为普通读写
+     * 复制的数据先写入目标旁的临时文件，全部成功后再依次改名为目标文件
+     * 任意一个文件失败时整批回滚：删除已创建的目标与临时文件，已改名移动的文件移回原处
+     */
+    class TransferEngine {
+    public:
+        // pool 为空时使用全局线程池
+        TransferEngine(ThreadPool *pool = nullptr, std::size_t maxInFlight = 8U);
+
+    private:
+        ThreadPool *m_pool;             // 执行传输的线程池
+        std::size_t m_maxInFlight;      // 同时进行的传输数量上限
+        TransferCallback m_callback;    // 进度回调
+
+    public:
+        // 设置进度回调
+        void setCallback(TransferCallback callback);
+        /*
+         * 传输 items 内的所有文件，目标目录不存在时自动创建
+         * 全部成功返回 true；否则回滚并返回 false
+         * results 不为空时填入每个文件的结果，回滚后失败文件的 m_error 保留原因
+         * 移动时全部目标就位后才删除跨文件系统复制的源文件，删除失败只记录在 m_error 内，不回滚
+         * 会阻塞等待线程池，不能在同一线程池的工作线程内调用
+         */
+        bool run(const std::vector<TransferItem> &items, TransferMode mode,
+            std::vector<TransferResult> *results = nullptr) const;
+        /*
+         * 将 src 的内容复制到新文件 dest（不能已存在），返回使用的方法
+         * 失败时返回 TransferMethod::None 并设置 ec
+         */
+        static TransferMethod copyFile(const fs::path &src, const fs::path &dest,
+            std::uint64_t &bytes, std::error_code &ec);
+    };
+}
+
+#endif
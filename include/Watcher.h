@@ -0,0 +1,125 @@
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "Library.h"
+
+namespace book {
+    // 监视器累计应用的增量
+    struct WatchStats {
+        std::size_t m_pagesAdded = 0U;      // 新增的页面
+        std::size_t m_pagesRemoved = 0U;    // 删除的页面
+        std::size_t m_pagesRefreshed = 0U;  // 文件被改写、丢弃了缓存的页面
+        std::size_t m_booksAdded = 0U;      // 自动登记的新书
+        std::size_t m_overflows = 0U;       // 内核事件队列溢出、退回到逐目录比对的次数
+    };
+
+    /*
+     * class LibraryWatcher
+     * 监视 mangas 目录树（忽略以点号开头的目录），把文件的创建、删除与改名合并为书籍页面的最小增删
+     * Linux 上使用 inotify，没有变化时阻塞在 poll 上不占用 CPU；其他平台 start() 返回 false，可定时调用 resync()
+     * 同一路径的事件在 settleTime 内不再变化、且没有仍在写入的文件时才生效，生效时以磁盘上的最终状态为准，
+     * 因此创建后又删除的文件不产生任何增量，正在下载的文件在关闭前不会被加入
+     * 书籍的目录为其第一页所在的目录，压缩包书籍与没有页面的书籍不参与页面同步
+     * 书籍目录在监视范围内改名时书籍随之迁移，页面路径更新为新目录下的路径
+     * 监视器不加锁，poll() 与 resync() 必须与漫画库的其他操作在同一线程调用
+     */
+    class LibraryWatcher {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // 监视 library 的根目录，settleTime 为事件生效前的静默时间
+        LibraryWatcher(Library &library, std::chrono::milliseconds settleTime = std::chrono::milliseconds(500));
+        LibraryWatcher(const LibraryWatcher &) = delete;
+        LibraryWatcher &operator=(const LibraryWatcher &) = delete;
+        // 析构时停止监视
+        ~LibraryWatcher();
+
+    private:
+        // 等待生效的路径
+        struct Pending {
+            Clock::time_point m_deadline;   // 最后一次事件之后 settleTime
+            bool m_isDirectory = false;     // 是否为目录（整个目录与书籍比对）
+            bool m_writing = false;         // 文件是否仍被打开写入
+        };
+
+        Library &m_library;                                 // 被同步的漫画库
+        std::chrono::milliseconds m_settleTime;             // 事件生效前的静默时间
+        bool m_autoAddBooks = false;                        // 是否把出现图像或压缩包的新目录登记为新书
+        int m_fd = -1;                                      // inotify 文件描述符
+        std::unordered_map<int, fs::path> m_watches;        // 监视描述符 -> 目录
+        std::unordered_map<std::string, BookIdType> m_bookDirs; // 书籍目录（压缩包书籍为压缩包路径） -> 书籍ID
+        std::size_t m_sumOfBooks = 0U;                      // 建立书籍目录表时的书籍数量，不一致时重建
+        std::unordered_map<std::string, Pending> m_pending; // 等待生效的路径
+        std::unordered_map<std::uint32_t, fs::path> m_movedDirs; // 本批事件中被移走的目录，按改名事件的 cookie 配对
+        WatchStats m_stats;                                 // 累计增量
+
+    public:
+        /*
+         * 开始监视，为根目录下的所有目录建立监视
+         * 已经开始时返回 true，平台不支持或根目录无法监视时返回 false
+         */
+        bool start();
+        // 停止监视，丢弃尚未生效的事件
+        void stop();
+        // 是否正在监视
+        bool isRunning() const;
+        /*
+         * 获取可读时表示有新事件的文件描述符，未开始时为 -1
+         * 可交给界面的事件循环（如 QSocketNotifier），可读或有事件将要生效时调用 poll()
+         */
+        int getFd() const;
+        // 设置是否把出现图像或压缩包的新目录自动登记为新书，默认不登记
+        void setAutoAddBooks(bool enable);
+
+        /*
+         * 等待至多 timeout 读取事件（为负时一直等待），之后应用已经生效的增量，返回本次增删与刷新的页面数
+         * 有事件将要生效时等待时间不超过最早的生效时刻
+         */
+        std::size_t poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+        // 获取最早的生效时刻距现在的时间，没有等待生效的事件时返回 std::nullopt
+        std::optional<std::chrono::milliseconds> getNextTimeout() const;
+        // 等待生效的路径个数
+        std::size_t getPendingCount() const;
+        /*
+         * 逐个比对所有书籍目录与磁盘上的图像，只增删有差异的页面，返回增删的页面数
+         * 用于没有 inotify 的平台或事件丢失之后
+         */
+        std::size_t resync();
+        /*
+         * 重建书籍目录表
+         * 书籍数量变化时会自动重建；在监视器之外移动书籍或修改其页面后应手动调用
+         */
+        void refreshBooks();
+        // 获取累计增量
+        const WatchStats &getStats() const;
+
+    private:
+        // 为 dir 及其下所有子目录建立监视，忽略以点号开头的目录；touch 为 true 时把这些目录都记为待比对
+        void m_watchTree(const fs::path &dir, bool touch = false);
+        // 读取并合并内核事件，返回是否读到了事件
+        bool m_readEvents();
+        // 记录路径 path 上的一次事件，推迟其生效时刻
+        Pending &m_touch(const fs::path &path, bool isDirectory, Clock::time_point now);
+        // 移除 dir 及其下所有子目录的监视，用于目录被移出监视范围
+        void m_unwatchTree(const fs::path &dir);
+        // 目录 from 改名为 to 后，把其下的书籍目录改登记到新路径
+        void m_moveBookDirs(const fs::path &from, const fs::path &to);
+        // 应用所有到期且不在写入中的路径
+        std::size_t m_applySettled(Clock::time_point now);
+        // 依据磁盘上的最终状态同步文件 path，返回增删与刷新的页面数
+        std::size_t m_applyFile(const fs::path &path);
+        // 比对目录 dir 与其书籍，返回增删的页面数
+        std::size_t m_resyncDirectory(const fs::path &dir);
+        // 获取目录或压缩包 path 对应的书籍，不存在时返回 nullptr
+        Book *m_findBook(const fs::path &path);
+        // 新目录或新压缩包出现时登记新书，返回新书ID
+        BookIdType m_addBook(const fs::path &path);
+    };
+}
+
+#endif
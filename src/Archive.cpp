@@ -0,0 +1,233 @@
+#include "Archive.h"
+#include <algorithm>
+#include <numeric>
+#include <zlib.h>
+#include "Img.h"
+#include "Serialize.h"
+
+using namespace book;
+
+/* 压缩包辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint32_t localHeaderSignature = 0x04034b50U;     // 本地文件头
+    constexpr std::uint32_t centralHeaderSignature = 0x02014b50U;   // 中央目录项
+    constexpr std::uint32_t endSignature = 0x06054b50U;             // 中央目录结束记录
+    constexpr std::uint32_t end64Signature = 0x06064b50U;           // ZIP64 中央目录结束记录
+    constexpr std::uint32_t end64LocatorSignature = 0x07064b50U;    // ZIP64 结束记录定位器
+    constexpr std::size_t localHeaderSize = 30U;
+    constexpr std::size_t centralHeaderSize = 46U;
+    constexpr std::size_t endSize = 22U;
+    constexpr std::size_t end64Size = 56U;
+    constexpr std::size_t end64LocatorSize = 20U;
+    constexpr std::size_t maxCommentSize = 0xffffU;
+    constexpr std::uint16_t zip64ExtraId = 0x0001U;
+    constexpr std::uint16_t encryptedFlag = 0x0001U;
+
+    // 中央目录的位置
+    struct CentralDirectory {
+        std::uint64_t m_offset = 0U;
+        std::uint64_t m_size = 0U;
+        std::uint64_t m_count = 0U;
+    };
+
+    // 从文件末尾向前查找中央目录结束记录，必要时读取 ZIP64 结束记录
+    bool findCentralDirectory(std::span<const std::byte> data, CentralDirectory &dir) {
+        if (data.size() < endSize) return false;
+        auto last = data.size() - endSize;
+        auto first = last > maxCommentSize ? last - maxCommentSize : 0U;
+        for (auto pos = last + 1U; pos-- > first; ) {
+            BinaryReader in(data.subspan(pos, endSize));
+            std::uint32_t signature = 0U;
+            std::uint16_t disk = 0U, cdDisk = 0U, countOnDisk = 0U, count = 0U, commentSize = 0U;
+            std::uint32_t size = 0U, offset = 0U;
+            in.getFixed(signature);
+            if (signature != endSignature) continue;
+            in.getFixed(disk); in.getFixed(cdDisk); in.getFixed(countOnDisk); in.getFixed(count);
+            in.getFixed(size); in.getFixed(offset); in.getFixed(commentSize);
+            // 注释长度必须正好延伸到文件末尾，避免把注释内的数据误认为结束记录
+            if (pos + endSize + commentSize != data.size()) continue;
+            if (disk != 0U || cdDisk != 0U || countOnDisk != count) return false;
+            dir = { offset, size, count };
+
+            if (offset != 0xffffffffU && size != 0xffffffffU && count != 0xffffU) return true;
+            if (pos < end64LocatorSize) return false;
+            BinaryReader locator(data.subspan(pos - end64LocatorSize, end64LocatorSize));
+            std::uint32_t locatorDisk = 0U, sumOfDisks = 0U;
+            std::uint64_t end64Offset = 0U;
+            locator.getFixed(signature); locator.getFixed(locatorDisk);
+            locator.getFixed(end64Offset); locator.getFixed(sumOfDisks);
+            if (signature != end64LocatorSignature || data.size() < end64Size ||
+                end64Offset > data.size() - end64Size) return false;
+            BinaryReader end64(data.subspan(end64Offset, end64Size));
+            std::uint64_t recordSize = 0U, countOnDisk64 = 0U;
+            std::uint16_t made = 0U, needed = 0U;
+            std::uint32_t disk64 = 0U, cdDisk64 = 0U;
+            end64.getFixed(signature); end64.getFixed(recordSize); end64.getFixed(made); end64.getFixed(needed);
+            end64.getFixed(disk64); end64.getFixed(cdDisk64); end64.getFixed(countOnDisk64);
+            end64.getFixed(dir.m_count); end64.getFixed(dir.m_size); end64.getFixed(dir.m_offset);
+            return signature == end64Signature && disk64 == 0U && cdDisk64 == 0U && countOnDisk64 == dir.m_count;
+        }
+        return false;
+    }
+
+    // 从 ZIP64 扩展字段中读出被置为 0xffffffff 的长度与偏移
+    bool readZip64Extra(std::span<const std::byte> extra, ArchiveEntry &entry, std::uint64_t &localOffset,
+        bool hasSize, bool hasCompressedSize, bool hasOffset) {
+        BinaryReader in(extra);
+        while (in.getRemaining() >= 4U) {
+            std::uint16_t id = 0U, size = 0U;
+            in.getFixed(id); in.getFixed(size);
+            std::span<const std::byte> field;
+            if (!in.getBytes(size, field)) return false;
+            if (id != zip64ExtraId) continue;
+            BinaryReader fieldIn(field);
+            if (hasSize && !fieldIn.getFixed(entry.m_size)) return false;
+            if (hasCompressedSize && !fieldIn.getFixed(entry.m_compressedSize)) return false;
+            if (hasOffset && !fieldIn.getFixed(localOffset)) return false;
+            return true;
+        }
+        return !hasSize && !hasCompressedSize && !hasOffset;
+    }
+
+    // 读取 data 内 localOffset 处的本地文件头，得到条目数据的偏移
+    bool locateData(std::span<const std::byte> data, std::uint64_t localOffset, ArchiveEntry &entry) {
+        if (localOffset > data.size() || data.size() - localOffset < localHeaderSize) return false;
+        BinaryReader in(data.subspan(localOffset, localHeaderSize));
+        std::uint32_t signature = 0U;
+        std::uint16_t nameSize = 0U, extraSize = 0U;
+        std::span<const std::byte> skipped;
+        in.getFixed(signature);
+        if (signature != localHeaderSignature) return false;
+        in.getBytes(22U, skipped);
+        in.getFixed(nameSize); in.getFixed(extraSize);
+        entry.m_offset = localOffset + localHeaderSize + nameSize + extraSize;
+        return entry.m_offset <= data.size() && entry.m_compressedSize <= data.size() - entry.m_offset;
+    }
+
+    // 以原始 Deflate 流解压 src，最多输出 limit 字节
+    // 输出达到 limit 或流正常结束时返回 true
+    bool inflateRaw(std::span<const std::byte> src, std::size_t limit, std::string &out) {
+        z_stream stream{};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+        out.resize(limit);
+        std::size_t inPos = 0U, outPos = 0U;
+        int ret = Z_OK;
+        while (ret == Z_OK && outPos < limit) {
+            // zlib 的长度为 32 位，大块数据分段送入
+            auto inChunk = std::min<std::size_t>(src.size() - inPos, 1U << 30);
+            auto outChunk = std::min<std::size_t>(limit - outPos, 1U << 30);
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<std::byte *>(src.data() + inPos));
+            stream.avail_in = static_cast<uInt>(inChunk);
+            stream.next_out = reinterpret_cast<Bytef *>(out.data() + outPos);
+            stream.avail_out = static_cast<uInt>(outChunk);
+            ret = inflate(&stream, Z_NO_FLUSH);
+            inPos += inChunk - stream.avail_in;
+            outPos += outChunk - stream.avail_out;
+            if (ret == Z_BUF_ERROR && inPos == src.size()) break;
+            if (ret == Z_BUF_ERROR) ret = Z_OK;
+        }
+        inflateEnd(&stream);
+        out.resize(outPos);
+        return outPos == limit || ret == Z_STREAM_END;
+    }
+}
+/* ====== END ====== */
+
+/* 压缩包读取函数 */
+/* ===== BEGIN ===== */
+bool book::readZipIndex(std::span<const std::byte> data, std::vector<ArchiveEntry> &entries) {
+    entries.clear();
+    CentralDirectory dir;
+    if (!findCentralDirectory(data, dir)) return false;
+    if (dir.m_offset > data.size() || dir.m_size > data.size() - dir.m_offset ||
+        dir.m_count > dir.m_size / centralHeaderSize) return false;
+
+    BinaryReader in(data.subspan(dir.m_offset, dir.m_size));
+    for (std::uint64_t i = 0; i < dir.m_count; ++i) {
+        std::uint32_t signature = 0U, crc = 0U, compressedSize = 0U, size = 0U, externalAttributes = 0U,
+            localOffset32 = 0U;
+        std::uint16_t made = 0U, needed = 0U, flags = 0U, method = 0U, time = 0U, date = 0U, nameSize = 0U,
+            extraSize = 0U, commentSize = 0U, disk = 0U, internalAttributes = 0U;
+        in.getFixed(signature);
+        if (signature != centralHeaderSignature) return false;
+        in.getFixed(made); in.getFixed(needed); in.getFixed(flags); in.getFixed(method);
+        in.getFixed(time); in.getFixed(date); in.getFixed(crc);
+        in.getFixed(compressedSize); in.getFixed(size);
+        in.getFixed(nameSize); in.getFixed(extraSize); in.getFixed(commentSize);
+        in.getFixed(disk); in.getFixed(internalAttributes); in.getFixed(externalAttributes);
+        in.getFixed(localOffset32);
+        std::span<const std::byte> nameBytes, extra, comment;
+        if (!in.getBytes(nameSize, nameBytes) || !in.getBytes(extraSize, extra) ||
+            !in.getBytes(commentSize, comment)) return false;
+        std::string_view name(reinterpret_cast<const char *>(nameBytes.data()), nameBytes.size());
+
+        // 只收录未加密的、支持的压缩方法的图像文件
+        if ((flags & encryptedFlag) || name.empty() || name.back() == '/' || !isImageFile(fs::path(name))) continue;
+        if (method != static_cast<std::uint16_t>(ArchiveMethod::Stored) &&
+            method != static_cast<std::uint16_t>(ArchiveMethod::Deflate)) continue;
+
+        ArchiveEntry entry;
+        entry.m_name = name;
+        entry.m_crc = crc;
+        entry.m_method = static_cast<ArchiveMethod>(method);
+        entry.m_compressedSize = compressedSize;
+        entry.m_size = size;
+        std::uint64_t localOffset = localOffset32;
+        if (!readZip64Extra(extra, entry, localOffset, size == 0xffffffffU, compressedSize == 0xffffffffU,
+            localOffset32 == 0xffffffffU)) return false;
+        if (entry.m_method == ArchiveMethod::Stored && entry.m_size != entry.m_compressedSize) return false;
+        if (!locateData(data, localOffset, entry)) return false;
+        entries.emplace_back(std::move(entry));
+    }
+
+    // 按名字自然顺序排列，名字内的目录一并参与比较
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto &entry : entries) keys.emplace_back(makeNaturalKey(entry.m_name));
+    std::vector<std::size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), std::size_t(0U));
+    std::stable_sort(order.begin(), order.end(), [&keys](std::size_t a, std::size_t b) {
+        return keys[a] < keys[b];
+    });
+    std::vector<ArchiveEntry> ret;
+    ret.reserve(entries.size());
+    for (auto i : order) ret.emplace_back(std::move(entries[i]));
+    entries = std::move(ret);
+    return true;
+}
+
+bool book::readZipIndex(const fs::path &path, std::vector<ArchiveEntry> &entries) {
+    entries.clear();
+    MappedFile file(path, AccessHint::Random);
+    return file.isOpen() && readZipIndex(file.getData(), entries);
+}
+
+std::unique_ptr<std::string> book::readArchiveEntry(const fs::path &path, const ArchiveEntry &entry,
+    std::size_t limit) {
+    auto size = static_cast<std::size_t>(std::min<std::uint64_t>(entry.m_size, limit));
+    auto isWhole = size == entry.m_size;
+    std::unique_ptr<std::string> ret(new std::string());
+    if (entry.m_method == ArchiveMethod::Stored) {
+        MappedFile file;
+        if (!file.open(path, entry.m_offset, size, AccessHint::Sequential)) return nullptr;
+        ret->assign(reinterpret_cast<const char *>(file.getData().data()), file.getSize());
+    } else {
+        MappedFile file;
+        if (!file.open(path, entry.m_offset, static_cast<std::size_t>(entry.m_compressedSize), AccessHint::Sequential) ||
+            !inflateRaw(file.getData(), size, *ret) || ret->size() != size) return nullptr;
+    }
+    if (isWhole && crc32_z(0UL, reinterpret_cast<const Bytef *>(ret->data()), ret->size()) != entry.m_crc) return nullptr;
+    return ret;
+}
+
+MappedFile book::mapArchiveEntry(const fs::path &path, const ArchiveEntry &entry, AccessHint hint) {
+    MappedFile ret;
+    if (entry.m_method == ArchiveMethod::Stored) {
+        ret.open(path, entry.m_offset, static_cast<std::size_t>(entry.m_size), hint);
+        return ret;
+    }
+    auto content = readArchiveEntry(path, entry);
+    return content ? MappedFile(std::move(*content)) : MappedFile();
+}
+/* ====== END ====== */
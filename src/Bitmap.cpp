@@ -0,0 +1,318 @@
+#include "Bitmap.h"
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+using namespace book;
+
+/* 位运算辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    // 以下循环均为定长、无分支的逐字运算，编译器可以将其自动向量化
+    std::uint32_t countBits(const std::uint64_t *words, std::size_t n) {
+        std::uint32_t ret = 0U;
+        for (std::size_t i = 0; i < n; ++i) ret += std::popcount(words[i]);
+        return ret;
+    }
+
+    void andWords(std::uint64_t *dest, const std::uint64_t *src, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) dest[i] &= src[i];
+    }
+
+    void orWords(std::uint64_t *dest, const std::uint64_t *src, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) dest[i] |= src[i];
+    }
+
+    void andNotWords(std::uint64_t *dest, const std::uint64_t *src, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) dest[i] &= ~src[i];
+    }
+
+    bool testBit(const std::vector<std::uint64_t> &bits, std::uint16_t low) {
+        return (bits[low >> 6] >> (low & 63U)) & 1U;
+    }
+}
+/* ====== END ====== */
+
+/* struct Container in IdBitmap */
+/* ===== BEGIN ===== */
+bool IdBitmap::Container::isBitmap() const {
+    return !m_bits.empty();
+}
+
+bool IdBitmap::Container::contains(std::uint16_t low) const {
+    if (isBitmap()) return testBit(m_bits, low);
+    return std::binary_search(m_array.begin(), m_array.end(), low);
+}
+
+bool IdBitmap::Container::add(std::uint16_t low) {
+    if (isBitmap()) {
+        auto &word = m_bits[low >> 6];
+        auto mask = std::uint64_t(1U) << (low & 63U);
+        if (word & mask) return false;
+        word |= mask;
+    } else {
+        auto it = std::lower_bound(m_array.begin(), m_array.end(), low);
+        if (it != m_array.end() && *it == low) return false;
+        m_array.insert(it, low);
+    }
+    ++m_cardinality;
+    normalize();
+    return true;
+}
+
+bool IdBitmap::Container::remove(std::uint16_t low) {
+    if (isBitmap()) {
+        auto &word = m_bits[low >> 6];
+        auto mask = std::uint64_t(1U) << (low & 63U);
+        if (!(word & mask)) return false;
+        word &= ~mask;
+    } else {
+        auto it = std::lower_bound(m_array.begin(), m_array.end(), low);
+        if (it == m_array.end() || *it != low) return false;
+        m_array.erase(it);
+    }
+    --m_cardinality;
+    normalize();
+    return true;
+}
+
+void IdBitmap::Container::normalize() {
+    if (isBitmap() && m_cardinality <= arrayMaxSize) toArray();
+    else if (!isBitmap() && m_cardinality > arrayMaxSize) toBitmap();
+}
+
+void IdBitmap::Container::toBitmap() {
+    m_bits.assign(bitmapWords, 0U);
+    for (auto low : m_array) m_bits[low >> 6] |= std::uint64_t(1U) << (low & 63U);
+    m_array.clear();
+    m_array.shrink_to_fit();
+}
+
+void IdBitmap::Container::toArray() {
+    m_array.clear();
+    m_array.reserve(m_cardinality);
+    for (std::size_t i = 0; i < bitmapWords; ++i) {
+        for (auto word = m_bits[i]; word; word &= word - 1U) {
+            m_array.push_back(static_cast<std::uint16_t>(i * 64U + std::countr_zero(word)));
+        }
+    }
+    m_bits.clear();
+    m_bits.shrink_to_fit();
+}
+/* ====== END ====== */
+
+/* class IdBitmap */
+/* ===== BEGIN ===== */
+// 构造函数
+IdBitmap::IdBitmap(const ValueList &values) {
+    for (auto value : values) add(value);
+}
+
+// 公有函数
+bool IdBitmap::add(ValueType value) {
+    auto key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](const Container &c, std::uint16_t k) { return c.m_key < k; });
+    if (it == m_containers.end() || it->m_key != key) {
+        it = m_containers.insert(it, Container());
+        it->m_key = key;
+    }
+    return it->add(static_cast<std::uint16_t>(value));
+}
+
+bool IdBitmap::remove(ValueType value) {
+    auto key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](const Container &c, std::uint16_t k) { return c.m_key < k; });
+    if (it == m_containers.end() || it->m_key != key) return false;
+    if (!it->remove(static_cast<std::uint16_t>(value))) return false;
+    if (it->m_cardinality == 0U) m_containers.erase(it);
+    return true;
+}
+
+bool IdBitmap::contains(ValueType value) const {
+    auto container = m_findContainer(static_cast<std::uint16_t>(value >> 16));
+    return container && container->contains(static_cast<std::uint16_t>(value));
+}
+
+void IdBitmap::clear() {
+    m_containers.clear();
+}
+
+std::size_t IdBitmap::size() const {
+    std::size_t ret = 0U;
+    for (const auto &c : m_containers) ret += c.m_cardinality;
+    return ret;
+}
+
+bool IdBitmap::empty() const {
+    return m_containers.empty();
+}
+
+IdBitmap::ValueList IdBitmap::toList() const {
+    ValueList ret;
+    ret.reserve(size());
+    for (const auto &c : m_containers) {
+        ValueType high = ValueType(c.m_key) << 16;
+        if (c.isBitmap()) {
+            for (std::size_t i = 0; i < bitmapWords; ++i) {
+                for (auto word = c.m_bits[i]; word; word &= word - 1U) {
+                    ret.push_back(high | ValueType(i * 64U + std::countr_zero(word)));
+                }
+            }
+        } else {
+            for (auto low : c.m_array) ret.push_back(high | low);
+        }
+    }
+    return ret;
+}
+
+IdBitmap &IdBitmap::operator&=(const IdBitmap &other) {
+    return *this = *this & other;
+}
+
+IdBitmap &IdBitmap::operator|=(const IdBitmap &other) {
+    return *this = *this | other;
+}
+
+IdBitmap &IdBitmap::operator-=(const IdBitmap &other) {
+    return *this = *this - other;
+}
+
+IdBitmap book::operator&(const IdBitmap &lhs, const IdBitmap &rhs) {
+    IdBitmap ret;
+    auto i = lhs.m_containers.begin(), j = rhs.m_containers.begin();
+    while (i != lhs.m_containers.end() && j != rhs.m_containers.end()) {
+        if (i->m_key < j->m_key) ++i;
+        else if (j->m_key < i->m_key) ++j;
+        else {
+            auto c = IdBitmap::m_and(*i, *j);
+            if (c.m_cardinality) ret.m_containers.emplace_back(std::move(c));
+            ++i; ++j;
+        }
+    }
+    return ret;
+}
+
+IdBitmap book::operator|(const IdBitmap &lhs, const IdBitmap &rhs) {
+    IdBitmap ret;
+    ret.m_containers.reserve(lhs.m_containers.size() + rhs.m_containers.size());
+    auto i = lhs.m_containers.begin(), j = rhs.m_containers.begin();
+    while (i != lhs.m_containers.end() || j != rhs.m_containers.end()) {
+        if (j == rhs.m_containers.end() || (i != lhs.m_containers.end() && i->m_key < j->m_key)) {
+            ret.m_containers.push_back(*i++);
+        } else if (i == lhs.m_containers.end() || j->m_key < i->m_key) {
+            ret.m_containers.push_back(*j++);
+        } else {
+            ret.m_containers.emplace_back(IdBitmap::m_or(*i, *j));
+            ++i; ++j;
+        }
+    }
+    return ret;
+}
+
+IdBitmap book::operator-(const IdBitmap &lhs, const IdBitmap &rhs) {
+    IdBitmap ret;
+    auto j = rhs.m_containers.begin();
+    for (const auto &c : lhs.m_containers) {
+        while (j != rhs.m_containers.end() && j->m_key < c.m_key) ++j;
+        if (j == rhs.m_containers.end() || j->m_key != c.m_key) {
+            ret.m_containers.push_back(c);
+            continue;
+        }
+        auto diff = IdBitmap::m_andNot(c, *j);
+        if (diff.m_cardinality) ret.m_containers.emplace_back(std::move(diff));
+    }
+    return ret;
+}
+
+bool book::operator==(const IdBitmap &lhs, const IdBitmap &rhs) {
+    if (lhs.m_containers.size() != rhs.m_containers.size()) return false;
+    for (std::size_t i = 0; i < lhs.m_containers.size(); ++i) {
+        const auto &a = lhs.m_containers[i], &b = rhs.m_containers[i];
+        if (a.m_key != b.m_key || a.m_cardinality != b.m_cardinality) return false;
+        if (a.m_array != b.m_array || a.m_bits != b.m_bits) return false;
+    }
+    return true;
+}
+
+// 私有函数
+const IdBitmap::Container *IdBitmap::m_findContainer(std::uint16_t key) const {
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](const Container &c, std::uint16_t k) { return c.m_key < k; });
+    if (it == m_containers.end() || it->m_key != key) return nullptr;
+    return &*it;
+}
+
+IdBitmap::Container IdBitmap::m_and(const Container &lhs, const Container &rhs) {
+    Container ret;
+    ret.m_key = lhs.m_key;
+    if (lhs.isBitmap() && rhs.isBitmap()) {
+        ret.m_bits = lhs.m_bits;
+        andWords(ret.m_bits.data(), rhs.m_bits.data(), bitmapWords);
+        ret.m_cardinality = countBits(ret.m_bits.data(), bitmapWords);
+    } else if (lhs.isBitmap() || rhs.isBitmap()) {
+        const auto &arr = lhs.isBitmap() ? rhs : lhs;
+        const auto &bmp = lhs.isBitmap() ? lhs : rhs;
+        for (auto low : arr.m_array) {
+            if (testBit(bmp.m_bits, low)) ret.m_array.push_back(low);
+        }
+        ret.m_cardinality = static_cast<std::uint32_t>(ret.m_array.size());
+    } else {
+        ret.m_array.reserve(std::min(lhs.m_array.size(), rhs.m_array.size()));
+        std::set_intersection(lhs.m_array.begin(), lhs.m_array.end(),
+            rhs.m_array.begin(), rhs.m_array.end(), std::back_inserter(ret.m_array));
+        ret.m_cardinality = static_cast<std::uint32_t>(ret.m_array.size());
+    }
+    ret.normalize();
+    return ret;
+}
+
+IdBitmap::Container IdBitmap::m_or(const Container &lhs, const Container &rhs) {
+    Container ret;
+    ret.m_key = lhs.m_key;
+    if (lhs.isBitmap() || rhs.isBitmap()) {
+        const auto &bmp = lhs.isBitmap() ? lhs : rhs;
+        const auto &other = lhs.isBitmap() ? rhs : lhs;
+        ret.m_bits = bmp.m_bits;
+        if (other.isBitmap()) {
+            orWords(ret.m_bits.data(), other.m_bits.data(), bitmapWords);
+        } else {
+            for (auto low : other.m_array) ret.m_bits[low >> 6] |= std::uint64_t(1U) << (low & 63U);
+        }
+        ret.m_cardinality = countBits(ret.m_bits.data(), bitmapWords);
+    } else {
+        ret.m_array.reserve(lhs.m_array.size() + rhs.m_array.size());
+        std::set_union(lhs.m_array.begin(), lhs.m_array.end(),
+            rhs.m_array.begin(), rhs.m_array.end(), std::back_inserter(ret.m_array));
+        ret.m_cardinality = static_cast<std::uint32_t>(ret.m_array.size());
+    }
+    ret.normalize();
+    return ret;
+}
+
+IdBitmap::Container IdBitmap::m_andNot(const Container &lhs, const Container &rhs) {
+    Container ret;
+    ret.m_key = lhs.m_key;
+    if (lhs.isBitmap()) {
+        ret.m_bits = lhs.m_bits;
+        if (rhs.isBitmap()) {
+            andNotWords(ret.m_bits.data(), rhs.m_bits.data(), bitmapWords);
+        } else {
+            for (auto low : rhs.m_array) ret.m_bits[low >> 6] &= ~(std::uint64_t(1U) << (low & 63U));
+        }
+        ret.m_cardinality = countBits(ret.m_bits.data(), bitmapWords);
+    } else if (rhs.isBitmap()) {
+        for (auto low : lhs.m_array) {
+            if (!testBit(rhs.m_bits, low)) ret.m_array.push_back(low);
+        }
+        ret.m_cardinality = static_cast<std::uint32_t>(ret.m_array.size());
+    } else {
+        std::set_difference(lhs.m_array.begin(), lhs.m_array.end(),
+            rhs.m_array.begin(), rhs.m_array.end(), std::back_inserter(ret.m_array));
+        ret.m_cardinality = static_cast<std::uint32_t>(ret.m_array.size());
+    }
+    ret.normalize();
+    return ret;
+}
+/* ====== END ====== */
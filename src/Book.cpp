@@ -1,4 +1,6 @@
 #include "Book.h"
+#include "Journal.h"
+#include <algorithm>
 
 using namespace book;
 
@@ -6,10 +8,14 @@ using namespace book;
 /* ===== BEGIN ===== */
 // 构造函数
 
-// 将 bookPath 目录下所有图像文件加入管理器，tagManager 为标签管理器指针
+// 将 bookPath 目录下所有图像文件加入管理器，bookPath 为压缩包时管理压缩包内的图像
+// tagManager 为标签管理器指针
 Book::Book(const fs::path &bookPath, TagManager *tagManager, BookIdType id, const TagIdList &tags)
-    : ImagesManager(), m_tagManager(tagManager), m_bookId(id), m_tags(tags) {
-    scanImageFiles(bookPath);
+    : ImagesManager(), m_tagManager(tagManager), m_bookId(id) {
+    m_cacheOwner = id;
+    m_setTags(tags);
+    if (isArchiveFile(bookPath)) openArchive(bookPath);
+    else scanImageFiles(bookPath);
 }
 
 // 将 srcPath 目录下所有图像文件添加到 destPath 目录下并加入管理器
@@ -17,8 +23,10 @@ Book::Book(const fs::path &bookPath, TagManager *tagManager, BookIdType id, cons
 // 如果 removeOldFile 为 false，那么不删除 srcPath 目录下的图像文件，即对源文件进行复制
 // 如果 removeOldFile 为 true，那么删除 srcPath 目录下的图像文件，即对源文件进行移动 
 Book::Book(const fs::path &srcPath, const fs::path &destPath, TagManager *tagManager,
-    BookIdType id, const TagIdList &tags, bool removeOldFile = false)
-    : ImagesManager(srcPath), m_tagManager(tagManager), m_bookId(id), m_tags(tags) {
+    BookIdType id, const TagIdList &tags, bool removeOldFile)
+    : ImagesManager(srcPath), m_tagManager(tagManager), m_bookId(id) {
+    m_cacheOwner = id;
+    m_setTags(tags);
     if (removeOldFile) move(destPath);
     else copy(destPath, true);
 }
@@ -28,65 +36,149 @@ Book::Book(const fs::path &srcPath, const fs::path &destPath, TagManager *tagMan
 // 如果 removeOldFile 为 false，那么不删除 images 所指向的图像文件，即对源文件进行复制
 // 如果 removeOldFile 为 true，那么删除 images 所指向的图像文件，即对源文件进行移动
 Book::Book(const std::vector<fs::path> &images, const fs::path &destPath, TagManager *tagManager,
-    BookIdType id, const TagIdList &tags, bool removeOldFile = false)
-    : ImagesManager(images), m_tagManager(tagManager), m_bookId(id), m_tags(tags) {
+    BookIdType id, const TagIdList &tags, bool removeOldFile)
+    : ImagesManager(images), m_tagManager(tagManager), m_bookId(id) {
+    m_cacheOwner = id;
+    m_setTags(tags);
     if (removeOldFile) move(destPath);
     else copy(destPath, true);
 }
 
+// 使用 images 内已经存在的图像文件初始化，不复制或移动文件
+Book::Book(std::vector<fs::path> &&images, TagManager *tagManager, BookIdType id,
+    const TagIdList &tags)
+    : ImagesManager(std::move(images)), m_tagManager(tagManager), m_bookId(id) {
+    m_cacheOwner = id;
+    m_setTags(tags);
+}
+
 // 移动构造函数
 Book::Book(Book &&book) : ImagesManager(std::move(book)), m_tagManager(book.m_tagManager),
-    m_bookId(book.m_bookId), m_tags(std::move(book.m_tags)) {
+    m_bookId(book.m_bookId), m_tags(std::move(book.m_tags)), m_title(std::move(book.m_title)),
+    m_tagIndex(book.m_tagIndex), m_titleIndex(book.m_titleIndex), m_journal(book.m_journal),
+    m_pageKeys(std::move(book.m_pageKeys)), m_pageKeysRevision(book.m_pageKeysRevision), m_pageKeysSorted(book.m_pageKeysSorted) {
+    book.m_tagManager = nullptr;
+    book.m_tagIndex = nullptr;
+    book.m_titleIndex = nullptr;
+    book.m_journal = nullptr;
+    book.m_bookId = nullBookId;
+}
+
+// 移动赋值
+Book &Book::operator=(Book &&book) {
+    ImagesManager::operator=(std::move(book));
+    m_tagManager = book.m_tagManager;
+    m_bookId = book.m_bookId;
+    m_tags = std::move(book.m_tags);
+    m_title = std::move(book.m_title);
+    m_tagIndex = book.m_tagIndex;
+    m_titleIndex = book.m_titleIndex;
+    m_journal = book.m_journal;
+    m_pageKeys = std::move(book.m_pageKeys);
+    m_pageKeysRevision = book.m_pageKeysRevision;
+    m_pageKeysSorted = book.m_pageKeysSorted;
     book.m_tagManager = nullptr;
     book.m_bookId = nullBookId;
+    book.m_tagIndex = nullptr;
+    book.m_titleIndex = nullptr;
+    book.m_journal = nullptr;
+    return *this;
 }
 
 BookIdType Book::getBookId() const {
     return m_bookId;
 }
 
-std::unique_ptr<TagIdList> Book::getTags() const {
-    return std::make_unique<TagIdList>(new TagIdList(m_tags));
+std::span<const TagIdType> Book::getTags() const {
+    return m_tags.getTags();
 }
 
 std::unique_ptr<TagIdList> Book::getTags(TagIdType groupId) const {
-    std::unique_ptr<TagIdList> ret(new TagIdList());
-    for (auto id : m_tags) {
-        auto &tag = m_tagManager->getBookTag(id);
-        if (tag.isNull() || tag.getGroupId() != groupId) continue;
-        ret->emplace_back(id);
-    }
-    return ret;
+    return std::make_unique<TagIdList>(m_tags.getTags(groupId));
+}
+
+bool Book::hasTag(TagIdType tagId) const {
+    return m_tags.contains(tagId);
 }
 
 void Book::addTag(TagIdType tagId) {
     if (!m_tagManager->checkTagId(tagId)) return ;
-    m_tags.push_back(tagId);
+    if (!m_tags.insert(tagId, m_tagManager->getGroupTagId(tagId))) return ;
+    if (m_tagIndex) m_tagIndex->add(tagId, m_bookId);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::AddBookTag, .m_bookId = m_bookId, .m_tagId = tagId });
 }
 
 void Book::removeTag(TagIdType tagId) {
     if (!m_tagManager->checkTagId(tagId)) return ;
-
-    auto it = m_tags.begin();
-    for (; it != m_tags.end() && *it != tagId; ++it);
-    if (it == m_tags.end()) return ;
-    for (++it; it != m_tags.end(); ++it) {
-        *(it - 1) = *it;
-    }
-    m_tags.pop_back();
+    if (!m_tags.erase(tagId)) return ;
+    if (m_tagIndex) m_tagIndex->remove(tagId, m_bookId);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::RemoveBookTag, .m_bookId = m_bookId, .m_tagId = tagId });
 }
 
 void Book::removeTags(TagIdType groupId) {
     if (!m_tagManager->checkGroupTagId(groupId)) return ; 
 
-    auto it0 = m_tags.begin(), it1 = m_tags.begin();
-    std::size_t cnt = 0;
-    for (; it0 != m_tags.end() && it1 != m_tags.end(); ++it0) {
-        for (; it1 != m_tags.end() && m_tagManager->getGroupTagId(*it1) == groupId; ++it1);
-        *it0 = *it1;
-        ++cnt;
+    if (m_tagIndex) {
+        for (auto id : m_tags.getTags(groupId)) m_tagIndex->remove(id, m_bookId);
     }
-    while (cnt--) m_tags.pop_back();
+    m_tags.eraseGroup(groupId);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::RemoveBookTags, .m_bookId = m_bookId, .m_groupId = groupId });
+}
+
+void Book::remapTags(std::span<const TagIdType> table) {
+    m_tags.remap(table);
+}
+
+const std::string &Book::getTitle() const {
+    return m_title;
+}
+
+void Book::setTitle(std::string_view title) {
+    if (m_title == title) return ;
+    m_title = title;
+    if (m_titleIndex) m_titleIndex->addBook(m_bookId, m_title);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::SetBookTitle, .m_bookId = m_bookId, .m_name = m_title });
+}
+
+void Book::setTitleIndex(TitleIndex *titleIndex) {
+    m_titleIndex = titleIndex;
+    if (m_titleIndex) m_titleIndex->addBook(m_bookId, m_title);
+}
+
+void Book::setJournal(Journal *journal) {
+    m_journal = journal;
+}
+
+bool Book::addPage(const fs::path &imagePath) {
+    if (isArchive() || !isImageFile(imagePath)) return false;
+    // 插入到第一个文件名自然顺序更靠后的页面之前，已有页面的排序键只在路径被其他操作修改后重新生成
+    m_refreshPageKeys();
+    auto key = makeNaturalKey(imagePath.filename().string());
+    auto it = m_pageKeysSorted ? std::upper_bound(m_pageKeys.begin(), m_pageKeys.end(), key) :
+        std::find_if(m_pageKeys.begin(), m_pageKeys.end(), [&key](const std::string &pageKey) { return pageKey > key; });
+    auto index = static_cast<std::size_t>(it - m_pageKeys.begin());
+    m_pageKeys.insert(it, std::move(key));
+    insert(index, imagePath);
+    // 指向其他文件名的符号链接被解析为目标文件，此时缓存的排序键与储存的文件名不符，下次重新生成
+    m_pageKeysRevision = getImagePath(index).filename() == imagePath.filename() ? m_getImagesRevision() : 0U;
+    if (m_journal) m_journal->append({ .m_op = JournalOp::AddBookPage, .m_bookId = m_bookId, .m_images = { getImagePath(index) } });
+    return true;
+}
+
+bool Book::removePage(std::size_t index, bool removeFile) {
+    if (index >= getSumOfImages()) return false;
+    auto path = getImagePath(index);
+    m_refreshPageKeys();
+    remove(index, removeFile);
+    m_pageKeys.erase(m_pageKeys.begin() + static_cast<std::ptrdiff_t>(index));
+    m_pageKeysRevision = m_getImagesRevision();
+    if (m_journal) m_journal->append({ .m_op = JournalOp::RemoveBookPage, .m_bookId = m_bookId, .m_images = { std::move(path) } });
+    return true;
+}
+
+void Book::setTagIndex(TagIndex *tagIndex) {
+    m_tagIndex = tagIndex;
+    if (m_tagIndex) m_tagIndex->addBook(m_bookId, m_tags.getTags());
 }
 
 std::size_t Book::getSumOfTags() const {
@@ -94,29 +186,50 @@ std::size_t Book::getSumOfTags() const {
 }
 
 std::size_t Book::getSumOfTags(TagIdType groupId) const {
-    std::size_t cnt = 0;
-    for (auto id : m_tags) {
-        if (m_tagManager->getGroupTagId(id) == groupId) ++cnt;
-    }
-    return cnt;
+    return m_tags.getSumOfTags(groupId);
+}
+
+std::span<const TagIdType> Book::getTagGroups() const {
+    return m_tags.getGroups();
 }
 
-bool Book::read(std::ifstream &in, TagManager *tagManager) {
+bool Book::read(BinaryReader &in, TagManager *tagManager, std::uint16_t version, std::size_t idSize) {
     m_tagManager = tagManager;
-    if (!ImagesManager::read(in)) return false;
-    in.read(reinterpret_cast<char *>(&m_bookId), sizeof(m_bookId));
+    if (!ImagesManager::read(in, version) || !in.getFixed(m_bookId)) return false;
+    m_cacheOwner = m_bookId;
     std::size_t size;
-    in.read(reinterpret_cast<char *>(&size), sizeof(size));
-    m_tags.resize(size);
-    in.read(reinterpret_cast<char *>(&m_tags[0]), m_tags.size() * sizeof(decltype(m_tags)::value_type));
-    return true;
+    if (!in.getCount(size, idSize)) return false;
+    m_tags.clear();
+    for (std::size_t i = 0; i < size; ++i) {
+        TagIdType tag = nullTagId;
+        readTagId(in, tag, idSize);
+        m_tags.insert(tag, m_tagManager->getGroupTagId(tag));
+    }
+    if (version >= 4U) in.getString(m_title);
+    return !in.fail();
 }
 
-bool Book::write(std::ofstream &out) const {
+bool Book::write(BinaryWriter &out) const {
     if (!ImagesManager::write(out)) return false;
-    out.write(reinterpret_cast<const char *>(&m_bookId), sizeof(m_bookId));
-    std::size_t size = m_tags.size();
-    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
-    out.write(reinterpret_cast<const char *>(&m_tags[0]), m_tags.size() * sizeof(decltype(m_tags)::value_type));
+    out.putFixed(m_bookId);
+    out.putVarint(m_tags.size());
+    for (auto tag : m_tags.getTags()) out.putFixed(tag);
+    out.putString(m_title);
+    return true;
+}
+
+// 私有函数
+void Book::m_setTags(const TagIdList &tags) {
+    m_tags.clear();
+    for (auto tag : tags) m_tags.insert(tag, m_tagManager ? m_tagManager->getGroupTagId(tag) : nullTagId);
+}
+
+void Book::m_refreshPageKeys() {
+    if (m_pageKeysRevision == m_getImagesRevision() && m_pageKeys.size() == getSumOfImages()) return ;
+    m_pageKeys.clear();
+    m_pageKeys.reserve(getSumOfImages() + 1U);
+    for (std::size_t i = 0; i < getSumOfImages(); ++i) m_pageKeys.emplace_back(makeNaturalKey(getImagePath(i).filename().string()));
+    m_pageKeysSorted = std::is_sorted(m_pageKeys.begin(), m_pageKeys.end());
+    m_pageKeysRevision = m_getImagesRevision();
 }
 /* ====== END ====== */
\ No newline at end of file
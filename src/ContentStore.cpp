@@ -0,0 +1,148 @@
+#include "ContentStore.h"
+#include <cstring>
+#include <system_error>
+#include "Hash.h"
+#include "MappedFile.h"
+
+using namespace book;
+
+/* 内容存储辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    // 导入时每个图像的状态
+    enum class ImportState : std::uint8_t {
+        Failed,     // 读取失败或与同哈希的对象内容不同
+        New,        // 存储内还没有该内容
+        Stored,     // 存储内已有相同内容的对象
+    };
+
+    // 比较两个文件的内容
+    bool sameContent(const MappedFile &a, const MappedFile &b) {
+        auto x = a.getData(), y = b.getData();
+        return x.size() == y.size() && (x.empty() || std::memcmp(x.data(), y.data(), x.size()) == 0);
+    }
+
+    bool sameContent(const fs::path &a, const fs::path &b) {
+        MappedFile x(a, AccessHint::Sequential), y(b, AccessHint::Sequential);
+        return x.isOpen() && y.isOpen() && sameContent(x, y);
+    }
+}
+/* ====== END ====== */
+
+/* class ContentStore */
+/* ===== BEGIN ===== */
+// 构造函数
+ContentStore::ContentStore(const fs::path &root, ThreadPool *pool)
+    : m_root(root), m_pool(pool ? pool : &ThreadPool::global()) {
+    if (!m_root.empty()) {
+        m_prefix = m_root.native();
+        m_prefix += fs::path::preferred_separator;
+    }
+}
+
+// 公有函数
+const fs::path &ContentStore::getRoot() const {
+    return m_root;
+}
+
+bool ContentStore::isObject(const fs::path &path) const {
+    return !m_prefix.empty() && path.native().starts_with(m_prefix);
+}
+
+fs::path ContentStore::getObjectPath(std::uint64_t hash, const fs::path &extension) const {
+    // 后缀统一为小写，同一内容不会因为后缀大小写不同存两份
+    auto name = toHex(hash);
+    for (auto ch : extension.string()) name.push_back(ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch);
+    return m_root / name.substr(0U, 2U) / name;
+}
+
+bool ContentStore::import(std::vector<fs::path> &images, bool removeSource, const TransferEngine *engine) {
+    auto n = images.size();
+    std::vector<fs::path> objects(n);
+    std::vector<ImportState> states(n, ImportState::Failed);
+
+    // 并行计算哈希，已存在同名对象时逐字节比较，排除哈希碰撞
+    {
+        TaskGroup group(*m_pool);
+        for (std::size_t i = 0; i < n; ++i) {
+            group.submit([this, &images, &objects, &states, i] {
+                MappedFile src(images[i], AccessHint::Sequential);
+                if (!src.isOpen()) return;
+                objects[i] = getObjectPath(xxhash64(src.getData()), images[i].extension());
+                MappedFile object;
+                if (!object.open(objects[i], AccessHint::Sequential)) states[i] = ImportState::New;
+                else if (sameContent(src, object)) states[i] = ImportState::Stored;
+            });
+        }
+        group.wait();
+    }
+
+    // 本批次内重复的内容只传输第一份
+    std::vector<TransferItem> items;
+    std::vector<bool> isDuplicate(n, false);
+    std::unordered_map<fs::path::string_type, std::size_t> firstSource;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (states[i] == ImportState::Failed) return false;
+        if (states[i] == ImportState::Stored) continue;
+        auto [it, inserted] = firstSource.emplace(objects[i].native(), i);
+        if (!inserted) {
+            if (!sameContent(images[i], images[it->second])) return false;
+            isDuplicate[i] = true;
+            continue;
+        }
+        items.emplace_back(TransferItem{ images[i], objects[i] });
+    }
+    auto mode = removeSource ? TransferMode::Move : TransferMode::Copy;
+    if (!(engine ? *engine : TransferEngine(m_pool)).run(items, mode)) return false;
+
+    // 内容已存在的源文件没有参与传输，移动时在全部成功后删除
+    std::error_code ec;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (removeSource && (states[i] == ImportState::Stored || isDuplicate[i]) && !isObject(images[i])) {
+            fs::remove(images[i], ec);
+        }
+        images[i] = std::move(objects[i]);
+    }
+    return true;
+}
+
+void ContentStore::retain(const fs::path &object) {
+    if (isObject(object)) ++m_refs[object.native()];
+}
+
+bool ContentStore::release(const fs::path &object, bool removeUnused) {
+    auto it = m_refs.find(object.native());
+    if (it == m_refs.end()) return false;
+    if (--it->second > 0U) return false;
+    m_refs.erase(it);
+    std::error_code ec;
+    if (removeUnused) fs::remove(object, ec);
+    return true;
+}
+
+std::size_t ContentStore::getRefCount(const fs::path &object) const {
+    auto it = m_refs.find(object.native());
+    return it == m_refs.end() ? 0U : it->second;
+}
+
+std::size_t ContentStore::getSumOfObjects() const {
+    return m_refs.size();
+}
+
+void ContentStore::clearRefs() {
+    m_refs.clear();
+}
+
+std::size_t ContentStore::collect() {
+    std::size_t ret = 0U;
+    std::error_code ec;
+    std::vector<fs::path> unused;
+    for (fs::recursive_directory_iterator it(m_root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && !m_refs.contains(it->path().native())) unused.emplace_back(it->path());
+    }
+    for (const auto &path : unused) {
+        if (fs::remove(path, ec)) ++ret;
+    }
+    return ret;
+}
+/* ====== END ====== */
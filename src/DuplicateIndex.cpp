@@ -0,0 +1,385 @@
+#include "DuplicateIndex.h"
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+#include "Hash.h"
+
+using namespace book;
+
+/* 重复检测辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint32_t segmentValues = 1U << 16;      // 每段的取值个数
+    constexpr std::size_t pagesPerTask = 64U;               // 计算哈希时每个任务处理的页面数
+    constexpr std::uint32_t valuesPerTask = 1024U;          // 查找页面对时每个任务处理的段值数
+    constexpr std::size_t pagesPerScan = 2048U;             // 线性查找页面对时每个任务处理的页面数
+
+    std::uint32_t getSegment(std::uint64_t hash, int segment) {
+        return static_cast<std::uint32_t>((hash >> (16 * segment)) & 0xffffU);
+    }
+
+    /*
+     * 汉明距离内核：找出 hashes[0, n) 内与 query 距离不超过 maxDistance 的位置，写入 out 并返回个数
+     * 先计算一批距离（可向量化），再无分支地写入满足条件的位置
+     * x86-64 上按 CPU 支持的指令集分别编译，运行时选择 AVX-512（含 VPOPCNTQ）、POPCNT 或通用实现
+     */
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__linux)
+    __attribute__((target_clones("arch=icelake-server", "popcnt", "default")))
+#endif
+    std::size_t scanKernel(const std::uint64_t *hashes, std::size_t n, std::uint64_t query, int maxDistance,
+        std::uint32_t *out) {
+        constexpr std::size_t blockSize = 256U;
+        std::uint8_t distances[blockSize];
+        std::size_t ret = 0U;
+        for (std::size_t first = 0; first < n; first += blockSize) {
+            auto size = std::min(blockSize, n - first);
+            for (std::size_t i = 0; i < size; ++i) distances[i] = static_cast<std::uint8_t>(std::popcount(hashes[first + i] ^ query));
+            for (std::size_t i = 0; i < size; ++i) {
+                out[ret] = static_cast<std::uint32_t>(first + i);
+                ret += distances[i] <= maxDistance;
+            }
+        }
+        return ret;
+    }
+
+    // 页面路径的键，路径相同的页面视为内容未变
+    std::uint64_t makePageKey(const fs::path &path) {
+        const auto &native = path.native();
+        return xxhash64(std::as_bytes(std::span(native.data(), native.size())));
+    }
+}
+
+void book::hammingScan(std::span<const std::uint64_t> hashes, std::uint64_t query, int maxDistance,
+    std::vector<std::uint32_t> &out) {
+    if (maxDistance < 0) return;
+    std::array<std::uint32_t, 1024> buffer;
+    for (std::size_t first = 0; first < hashes.size(); first += buffer.size()) {
+        auto size = std::min(hashes.size() - first, buffer.size());
+        auto n = scanKernel(hashes.data() + first, size, query, maxDistance, buffer.data());
+        for (std::size_t i = 0; i < n; ++i) out.emplace_back(static_cast<std::uint32_t>(first + buffer[i]));
+    }
+}
+/* ====== END ====== */
+
+/* class DuplicateIndex */
+/* ===== BEGIN ===== */
+// 公有函数
+void DuplicateIndex::clear() {
+    m_hashes.clear();
+    m_pages.clear();
+    m_keys.clear();
+    m_failedKeys.clear();
+    for (auto &offsets : m_offsets) offsets.clear();
+    for (auto &buckets : m_buckets) buckets.clear();
+    for (auto &hashes : m_bucketHashes) hashes.clear();
+}
+
+std::size_t DuplicateIndex::getSumOfPages() const {
+    return m_hashes.size();
+}
+
+std::uint64_t DuplicateIndex::getHash(std::size_t index) const {
+    return m_hashes.at(index);
+}
+
+const PageRef &DuplicateIndex::getPage(std::size_t index) const {
+    return m_pages.at(index);
+}
+
+void DuplicateIndex::add(const PageRef &page, std::uint64_t hash, std::uint64_t key) {
+    m_hashes.emplace_back(hash);
+    m_pages.emplace_back(page);
+    m_keys.emplace_back(key);
+}
+
+void DuplicateIndex::reindex() {
+    // 计数排序：先统计每个桶的大小，再按下标顺序放入，桶内下标有序
+    auto n = m_hashes.size();
+    for (int k = 0; k < sumOfSegments; ++k) {
+        auto &offsets = m_offsets[k];
+        auto &buckets = m_buckets[k];
+        auto &hashes = m_bucketHashes[k];
+        offsets.assign(segmentValues + 1U, 0U);
+        for (auto hash : m_hashes) ++offsets[getSegment(hash, k) + 1U];
+        for (std::uint32_t v = 0; v < segmentValues; ++v) offsets[v + 1U] += offsets[v];
+        std::vector<std::uint32_t> next(offsets.begin(), offsets.end() - 1);
+        buckets.resize(n);
+        hashes.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto pos = next[getSegment(m_hashes[i], k)]++;
+            buckets[pos] = static_cast<std::uint32_t>(i);
+            hashes[pos] = m_hashes[i];
+        }
+    }
+}
+
+std::size_t DuplicateIndex::update(const Library &library, ThreadPool *pool) {
+    // 路径未变的页面沿用原有的结果
+    std::unordered_map<std::uint64_t, std::uint64_t> known;
+    known.reserve(m_keys.size());
+    for (std::size_t i = 0; i < m_keys.size(); ++i) known.emplace(m_keys[i], m_hashes[i]);
+
+    enum class State : std::uint8_t { Failed, Done, Pending };
+    std::vector<PageRef> pages;
+    std::vector<std::uint64_t> keys, hashes;
+    std::vector<State> states;
+    std::vector<std::size_t> pending;
+    auto books = library.getBooks();
+    for (auto id : *books) {
+        auto book = library.getBook(id);
+        for (std::size_t i = 0; i < book->getSumOfImages(); ++i) {
+            auto key = makePageKey(book->getImagePath(i));
+            auto it = known.find(key);
+            pages.emplace_back(PageRef{ id, static_cast<std::uint32_t>(i) });
+            keys.emplace_back(key);
+            hashes.emplace_back(it == known.end() ? 0U : it->second);
+            if (it != known.end()) {
+                states.emplace_back(State::Done);
+            } else if (std::binary_search(m_failedKeys.begin(), m_failedKeys.end(), key)) {
+                states.emplace_back(State::Failed);
+            } else {
+                states.emplace_back(State::Pending);
+                pending.emplace_back(pages.size() - 1U);
+            }
+        }
+    }
+
+    // 解码与计算哈希互不依赖，按批提交到线程池
+    {
+        TaskGroup group(pool ? *pool : ThreadPool::global());
+        for (std::size_t first = 0; first < pending.size(); first += pagesPerTask) {
+            group.submit([&, first] {
+                auto last = std::min(pending.size(), first + pagesPerTask);
+                for (auto i = first; i < last; ++i) {
+                    auto index = pending[i];
+                    auto book = library.getBook(pages[index].m_book);
+                    states[index] = book->getPerceptualHash(pages[index].m_page, hashes[index]) ?
+                        State::Done : State::Failed;
+                }
+            });
+        }
+        group.wait();
+    }
+
+    clear();
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+        if (states[i] == State::Done) add(pages[i], hashes[i], keys[i]);
+        else m_failedKeys.emplace_back(keys[i]);
+    }
+    std::sort(m_failedKeys.begin(), m_failedKeys.end());
+    m_failedKeys.erase(std::unique(m_failedKeys.begin(), m_failedKeys.end()), m_failedKeys.end());
+    reindex();
+    return pending.size();
+}
+
+std::vector<std::uint32_t> DuplicateIndex::search(std::uint64_t hash, int maxDistance) const {
+    std::vector<std::uint32_t> ret;
+    if (maxDistance < 0) return ret;
+    if (maxDistance > maxIndexedDistance || m_offsets[0].empty()) {
+        hammingScan(m_hashes, hash, maxDistance, ret);
+        return ret;
+    }
+    auto radius = maxDistance / sumOfSegments;
+    std::vector<std::uint32_t> found;
+    for (int k = 0; k < sumOfSegments; ++k) {
+        m_forEachNeighbor(getSegment(hash, k), radius, [&](std::uint32_t value) {
+            auto first = m_offsets[k][value], size = m_offsets[k][value + 1U] - first;
+            found.resize(size);
+            auto n = scanKernel(m_bucketHashes[k].data() + first, size, hash, maxDistance, found.data());
+            for (std::size_t i = 0; i < n; ++i) ret.emplace_back(m_buckets[k][first + found[i]]);
+        });
+    }
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+std::vector<PagePair> DuplicateIndex::findPairs(int maxDistance, ThreadPool *pool) const {
+    std::vector<PagePair> ret;
+    if (maxDistance < 0 || m_hashes.empty()) return ret;
+    // 可用索引时按段与段值范围划分任务，否则按页面范围划分线性扫描
+    bool indexed = maxDistance <= maxIndexedDistance && !m_offsets[0].empty();
+    auto sumOfParts = indexed ? std::size_t(sumOfSegments) * (segmentValues / valuesPerTask) :
+        (m_hashes.size() + pagesPerScan - 1U) / pagesPerScan;
+    std::vector<std::vector<PagePair>> parts(sumOfParts);
+    {
+        TaskGroup group(pool ? *pool : ThreadPool::global());
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            group.submit([this, &parts, i, indexed, maxDistance] {
+                if (!indexed) {
+                    m_scanPairs(i * pagesPerScan, std::min(m_hashes.size(), (i + 1U) * pagesPerScan), maxDistance, parts[i]);
+                    return;
+                }
+                auto segment = static_cast<int>(i % sumOfSegments);
+                auto first = static_cast<std::uint32_t>(i / sumOfSegments * valuesPerTask);
+                m_findPairs(segment, first, first + valuesPerTask, maxDistance, parts[i]);
+            });
+        }
+        group.wait();
+    }
+    std::size_t sum = 0U;
+    for (const auto &part : parts) sum += part.size();
+    ret.reserve(sum);
+    for (const auto &part : parts) ret.insert(ret.end(), part.begin(), part.end());
+    std::sort(ret.begin(), ret.end(), [](const PagePair &a, const PagePair &b) {
+        return a.m_first != b.m_first ? a.m_first < b.m_first : a.m_second < b.m_second;
+    });
+    return ret;
+}
+
+std::vector<BookSimilarity> DuplicateIndex::findSimilarBooks(int maxDistance, double minScore,
+    ThreadPool *pool) const {
+    std::unordered_map<BookIdType, std::uint32_t> sumOfPages;
+    for (const auto &page : m_pages) ++sumOfPages[page.m_book];
+
+    // 按书籍对汇总相似页面，first 为书籍ID较小一侧的页面下标
+    std::unordered_map<std::uint64_t, std::vector<std::pair<std::uint32_t, std::uint32_t>>> matches;
+    for (const auto &pair : findPairs(maxDistance, pool)) {
+        auto first = pair.m_first, second = pair.m_second;
+        if (m_pages[first].m_book == m_pages[second].m_book) continue;
+        if (m_pages[first].m_book > m_pages[second].m_book) std::swap(first, second);
+        auto key = (std::uint64_t(m_pages[first].m_book) << 32) | m_pages[second].m_book;
+        matches[key].emplace_back(first, second);
+    }
+
+    std::vector<BookSimilarity> ret;
+    std::vector<std::uint32_t> firsts, seconds;
+    for (auto &[key, pairs] : matches) {
+        firsts.clear();
+        seconds.clear();
+        for (auto [first, second] : pairs) {
+            firsts.emplace_back(first);
+            seconds.emplace_back(second);
+        }
+        // 一页可能与另一本书的多页相似，只计一次
+        std::sort(firsts.begin(), firsts.end());
+        std::sort(seconds.begin(), seconds.end());
+        auto shared = static_cast<std::uint32_t>(std::min(
+            std::unique(firsts.begin(), firsts.end()) - firsts.begin(),
+            std::unique(seconds.begin(), seconds.end()) - seconds.begin()));
+        BookSimilarity similarity;
+        similarity.m_first = static_cast<BookIdType>(key >> 32);
+        similarity.m_second = static_cast<BookIdType>(key & 0xffffffffU);
+        similarity.m_sharedPages = shared;
+        similarity.m_score = double(shared) /
+            double(std::min(sumOfPages[similarity.m_first], sumOfPages[similarity.m_second]));
+        if (similarity.m_score >= minScore) ret.emplace_back(similarity);
+    }
+    std::sort(ret.begin(), ret.end(), [](const BookSimilarity &a, const BookSimilarity &b) {
+        if (a.m_score != b.m_score) return a.m_score > b.m_score;
+        return a.m_first != b.m_first ? a.m_first < b.m_first : a.m_second < b.m_second;
+    });
+    return ret;
+}
+
+bool DuplicateIndex::write(const fs::path &path) const {
+    BinaryWriter out;
+    out.reserve(m_hashes.size() * 24U + m_failedKeys.size() * 8U + 16U);
+    out.putVarint(m_hashes.size());
+    for (std::size_t i = 0; i < m_hashes.size(); ++i) {
+        out.putFixed(m_hashes[i]);
+        out.putFixed(m_pages[i].m_book);
+        out.putFixed(m_pages[i].m_page);
+        out.putFixed(m_keys[i]);
+    }
+    out.putVarint(m_failedKeys.size());
+    for (auto key : m_failedKeys) out.putFixed(key);
+    FileHeader header{ fileMagic, fileVersion, std::uint16_t(sizeof(BookIdType)) };
+    return writeDataFile(path, header, out);
+}
+
+bool DuplicateIndex::read(const fs::path &path) {
+    clear();
+    FileHeader header;
+    std::string buffer;
+    std::span<const std::byte> body;
+    if (!readDataFile(path, fileMagic, fileVersion, header, buffer, body)) return false;
+    if (header.m_flags != sizeof(BookIdType)) return false;
+    BinaryReader in(body);
+
+    std::size_t size;
+    if (!in.getCount(size, 24U)) return false;
+    m_hashes.reserve(size);
+    m_pages.reserve(size);
+    m_keys.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        std::uint64_t hash, key;
+        PageRef page;
+        if (!in.getFixed(hash) || !in.getFixed(page.m_book) || !in.getFixed(page.m_page) || !in.getFixed(key)) {
+            clear();
+            return false;
+        }
+        add(page, hash, key);
+    }
+    if (!in.getCount(size, 8U)) { clear(); return false; }
+    m_failedKeys.resize(size);
+    for (auto &key : m_failedKeys) {
+        if (!in.getFixed(key)) { clear(); return false; }
+    }
+    if (!in.atEnd() || !std::is_sorted(m_failedKeys.begin(), m_failedKeys.end())) { clear(); return false; }
+    reindex();
+    return true;
+}
+
+// 私有函数
+void DuplicateIndex::m_findPairs(int segment, std::uint32_t firstValue, std::uint32_t lastValue, int maxDistance,
+    std::vector<PagePair> &out) const {
+    // 逐个桶与其半径内的相邻桶两两比较，相邻桶在整个桶的比较过程中都留在缓存里
+    auto radius = maxDistance / sumOfSegments;
+    const auto &offsets = m_offsets[segment];
+    const auto &buckets = m_buckets[segment];
+    const auto &hashes = m_bucketHashes[segment];
+    std::vector<std::uint32_t> found;
+    for (auto value = firstValue; value < lastValue; ++value) {
+        auto first = offsets[value], last = offsets[value + 1U];
+        if (first == last) continue;
+        m_forEachNeighbor(value, radius, [&](std::uint32_t neighbor) {
+            auto neighborFirst = offsets[neighbor], size = offsets[neighbor + 1U] - neighborFirst;
+            if (size == 0U) return;
+            found.resize(size);
+            for (auto a = first; a < last; ++a) {
+                auto i = buckets[a];
+                auto hash = hashes[a];
+                auto n = scanKernel(hashes.data() + neighborFirst, size, hash, maxDistance, found.data());
+                for (std::size_t f = 0; f < n; ++f) {
+                    // 每对在两个页面各自的桶内都会遇到，只在下标较小的一侧记录
+                    auto j = buckets[neighborFirst + found[f]];
+                    if (j <= i) continue;
+                    // 编号更小的段已经能找到这一对时跳过，每对只记录一次
+                    auto diff = hash ^ hashes[neighborFirst + found[f]];
+                    bool seen = false;
+                    for (int prev = 0; prev < segment && !seen; ++prev) seen = std::popcount(getSegment(diff, prev)) <= radius;
+                    if (!seen) out.emplace_back(PagePair{ i, j, std::uint32_t(std::popcount(diff)) });
+                }
+            }
+        });
+    }
+}
+
+void DuplicateIndex::m_scanPairs(std::size_t first, std::size_t last, int maxDistance, std::vector<PagePair> &out) const {
+    std::vector<std::uint32_t> found;
+    for (auto i = first; i < last; ++i) {
+        found.clear();
+        hammingScan(std::span(m_hashes).subspan(i + 1U), m_hashes[i], maxDistance, found);
+        for (auto j : found) {
+            auto second = static_cast<std::uint32_t>(i + 1U + j);
+            out.emplace_back(PagePair{ static_cast<std::uint32_t>(i), second,
+                static_cast<std::uint32_t>(std::popcount(m_hashes[i] ^ m_hashes[second])) });
+        }
+    }
+}
+
+template<typename Visitor>
+void DuplicateIndex::m_forEachNeighbor(std::uint32_t value, int radius, Visitor &&visit) {
+    visit(value);
+    // 每层只翻转比上一层更高的位，每个段值只枚举一次
+    auto flip = [&visit](auto &self, std::uint32_t current, int lowest, int left) -> void {
+        for (int bit = lowest; bit < 16; ++bit) {
+            auto next = current ^ (1U << bit);
+            visit(next);
+            if (left > 1) self(self, next, bit + 1, left - 1);
+        }
+    };
+    if (radius > 0) flip(flip, value, 0, radius);
+}
+/* ====== END ====== */
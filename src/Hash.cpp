@@ -0,0 +1,143 @@
+#include "Hash.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "MappedFile.h"
+
+using namespace book;
+
+/* XXH64 辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+    constexpr std::size_t stripeSize = 32U;
+
+    // 按小端序读取
+    std::uint64_t read64(const std::byte *p) {
+        std::uint64_t ret;
+        std::memcpy(&ret, p, sizeof(ret));
+        if constexpr (std::endian::native == std::endian::big) ret = __builtin_bswap64(ret);
+        return ret;
+    }
+
+    std::uint32_t read32(const std::byte *p) {
+        std::uint32_t ret;
+        std::memcpy(&ret, p, sizeof(ret));
+        if constexpr (std::endian::native == std::endian::big) ret = __builtin_bswap32(ret);
+        return ret;
+    }
+
+    std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+        acc += input * prime2;
+        acc = std::rotl(acc, 31);
+        return acc * prime1;
+    }
+
+    std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t value) {
+        acc ^= round(0U, value);
+        return acc * prime1 + prime4;
+    }
+
+    // 处理 p 开始的若干完整条带，返回处理的字节数
+    std::size_t consumeStripes(std::array<std::uint64_t, 4> &acc, const std::byte *p, std::size_t size) {
+        std::size_t pos = 0U;
+        for (; size - pos >= stripeSize; pos += stripeSize) {
+            acc[0] = round(acc[0], read64(p + pos));
+            acc[1] = round(acc[1], read64(p + pos + 8U));
+            acc[2] = round(acc[2], read64(p + pos + 16U));
+            acc[3] = round(acc[3], read64(p + pos + 24U));
+        }
+        return pos;
+    }
+}
+/* ====== END ====== */
+
+/* class XXHash64 */
+/* ===== BEGIN ===== */
+// 构造函数
+XXHash64::XXHash64(std::uint64_t seed)
+    : m_acc{ seed + prime1 + prime2, seed + prime2, seed, seed - prime1 }, m_seed(seed) {}
+
+// 公有函数
+void XXHash64::update(std::span<const std::byte> data) {
+    if (data.empty()) return;
+    m_totalSize += data.size();
+    auto p = data.data();
+    auto size = data.size();
+    // 先补齐上次剩下的不完整条带
+    if (m_bufferSize > 0U) {
+        auto n = std::min(size, stripeSize - m_bufferSize);
+        std::memcpy(m_buffer.data() + m_bufferSize, p, n);
+        m_bufferSize += n;
+        p += n;
+        size -= n;
+        if (m_bufferSize < stripeSize) return;
+        consumeStripes(m_acc, m_buffer.data(), stripeSize);
+        m_bufferSize = 0U;
+    }
+    auto done = consumeStripes(m_acc, p, size);
+    m_bufferSize = size - done;
+    std::memcpy(m_buffer.data(), p + done, m_bufferSize);
+}
+
+std::uint64_t XXHash64::digest() const {
+    std::uint64_t ret;
+    if (m_totalSize >= stripeSize) {
+        ret = std::rotl(m_acc[0], 1) + std::rotl(m_acc[1], 7) + std::rotl(m_acc[2], 12) + std::rotl(m_acc[3], 18);
+        for (auto acc : m_acc) ret = mergeRound(ret, acc);
+    } else {
+        ret = m_seed + prime5;
+    }
+    ret += m_totalSize;
+
+    auto p = m_buffer.data();
+    auto size = m_bufferSize;
+    for (; size >= 8U; p += 8U, size -= 8U) {
+        ret ^= round(0U, read64(p));
+        ret = std::rotl(ret, 27) * prime1 + prime4;
+    }
+    if (size >= 4U) {
+        ret ^= std::uint64_t(read32(p)) * prime1;
+        ret = std::rotl(ret, 23) * prime2 + prime3;
+        p += 4U;
+        size -= 4U;
+    }
+    for (; size > 0U; ++p, --size) {
+        ret ^= std::to_integer<std::uint64_t>(*p) * prime5;
+        ret = std::rotl(ret, 11) * prime1;
+    }
+    ret ^= ret >> 33;
+    ret *= prime2;
+    ret ^= ret >> 29;
+    ret *= prime3;
+    ret ^= ret >> 32;
+    return ret;
+}
+/* ====== END ====== */
+
+/* 哈希函数 */
+/* ===== BEGIN ===== */
+std::uint64_t book::xxhash64(std::span<const std::byte> data, std::uint64_t seed) {
+    XXHash64 hash(seed);
+    hash.update(data);
+    return hash.digest();
+}
+
+bool book::xxhash64File(const fs::path &path, std::uint64_t &hash) {
+    MappedFile file(path, AccessHint::Sequential);
+    if (!file.isOpen()) return false;
+    hash = xxhash64(file.getData());
+    return true;
+}
+
+std::string book::toHex(std::uint64_t hash) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string ret(16U, '0');
+    for (std::size_t i = 0; i < 16U; ++i) ret[15U - i] = digits[(hash >> (4U * i)) & 0xfU];
+    return ret;
+}
+/* ====== END ====== */
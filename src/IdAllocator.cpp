@@ -0,0 +1,98 @@
+#include "IdAllocator.h"
+#include <algorithm>
+#include <bit>
+
+using namespace book;
+
+/* class IdAllocator */
+/* ===== BEGIN ===== */
+bool IdAllocator::release(ValueType id) {
+    if (id == nullId || isFree(id)) return false;
+    m_grow(id);
+    // 自底向上置位，某一层的字原本就非零时上层已经置位
+    std::size_t index = id;
+    for (auto &level : m_levels) {
+        auto &word = level[index / 64U];
+        bool wasEmpty = word == 0U;
+        word |= std::uint64_t(1U) << (index % 64U);
+        if (!wasEmpty) break;
+        index /= 64U;
+    }
+    ++m_size;
+    return true;
+}
+
+IdAllocator::ValueType IdAllocator::acquire() {
+    if (m_size == 0U) return nullId;
+    std::size_t index = 0U;
+    for (auto level = m_levels.rbegin(); level != m_levels.rend(); ++level) {
+        index = index * 64U + static_cast<std::size_t>(std::countr_zero((*level)[index]));
+    }
+    // 自底向上清位，某一层的字清位后仍非零时上层保持不变
+    std::size_t bit = index;
+    for (auto &level : m_levels) {
+        auto &word = level[bit / 64U];
+        word &= ~(std::uint64_t(1U) << (bit % 64U));
+        if (word != 0U) break;
+        bit /= 64U;
+    }
+    --m_size;
+    return static_cast<ValueType>(index);
+}
+
+bool IdAllocator::isFree(ValueType id) const {
+    if (m_levels.empty() || id / 64U >= m_levels.front().size()) return false;
+    return m_levels.front()[id / 64U] >> (id % 64U) & 1U;
+}
+
+void IdAllocator::clear() {
+    m_levels.clear();
+    m_size = 0U;
+}
+
+std::size_t IdAllocator::size() const {
+    return m_size;
+}
+
+bool IdAllocator::empty() const {
+    return m_size == 0U;
+}
+
+IdAllocator::ValueList IdAllocator::toList() const {
+    ValueList ret;
+    ret.reserve(m_size);
+    if (m_levels.empty()) return ret;
+    const auto &bottom = m_levels.front();
+    for (std::size_t i = 0; i < bottom.size(); ++i) {
+        for (auto word = bottom[i]; word != 0U; word &= word - 1U) {
+            ret.emplace_back(static_cast<ValueType>(i * 64U + static_cast<std::size_t>(std::countr_zero(word))));
+        }
+    }
+    return ret;
+}
+
+std::size_t IdAllocator::getMemoryUsage() const {
+    std::size_t ret = m_levels.capacity() * sizeof(std::vector<std::uint64_t>);
+    for (const auto &level : m_levels) ret += level.capacity() * sizeof(std::uint64_t);
+    return ret;
+}
+
+// 私有函数
+void IdAllocator::m_grow(ValueType id) {
+    std::size_t words = std::size_t(id) / 64U + 1U;
+    if (!m_levels.empty() && words <= m_levels.front().size()) return;
+    // 按倍数扩充底层，之后由底层重新计算所有上层
+    if (m_levels.empty()) m_levels.emplace_back();
+    auto &bottom = m_levels.front();
+    bottom.resize(std::max(words, bottom.size() * 2U));
+    m_levels.resize(1U);
+    while (m_levels.back().size() > 1U) {
+        const auto &lower = m_levels.back();
+        std::vector<std::uint64_t> upper((lower.size() + 63U) / 64U);
+        for (std::size_t i = 0; i < lower.size(); ++i) {
+            if (lower[i] != 0U) upper[i / 64U] |= std::uint64_t(1U) << (i % 64U);
+        }
+        m_levels.emplace_back(std::move(upper));
+    }
+}
+/* ====== END ====== */
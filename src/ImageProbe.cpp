@@ -0,0 +1,129 @@
+#include "ImageProbe.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+
+using namespace book;
+
+/* 字节读取辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    std::uint32_t readBE16(const std::uint8_t *p) { return (std::uint32_t(p[0]) << 8) | p[1]; }
+    std::uint32_t readBE32(const std::uint8_t *p) { return (readBE16(p) << 16) | readBE16(p + 2); }
+    std::uint32_t readLE16(const std::uint8_t *p) { return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8); }
+    std::uint32_t readLE24(const std::uint8_t *p) { return readLE16(p) | (std::uint32_t(p[2]) << 16); }
+
+    bool startsWith(const std::uint8_t *p, std::size_t size, std::string_view magic) {
+        return size >= magic.size() && std::memcmp(p, magic.data(), magic.size()) == 0;
+    }
+
+    ImageInfo makeInfo(std::uint32_t width, std::uint32_t height, ImageFormat format) {
+        if (width == 0U || height == 0U) return ImageInfo{ 0U, 0U, ImageFormat::Invalid };
+        return ImageInfo{ width, height, format };
+    }
+
+    // 判断 JPEG 标记是否为 SOF（排除 DHT、JPG、DAC）
+    bool isSofMarker(std::uint8_t marker) {
+        return marker >= 0xc0U && marker <= 0xcfU && marker != 0xc4U && marker != 0xc8U && marker != 0xccU;
+    }
+
+    // 判断 JPEG 标记是否没有长度字段
+    bool isStandaloneMarker(std::uint8_t marker) {
+        return marker == 0x01U || (marker >= 0xd0U && marker <= 0xd8U);
+    }
+
+    ImageInfo probePng(const std::uint8_t *p, std::size_t size) {
+        // 8 字节签名 + IHDR 块（长度、类型、宽、高）
+        if (size < 24U || !startsWith(p + 12, size - 12U, "IHDR")) return makeInfo(0U, 0U, ImageFormat::Invalid);
+        return makeInfo(readBE32(p + 16), readBE32(p + 20), ImageFormat::Png);
+    }
+
+    ImageInfo probeGif(const std::uint8_t *p, std::size_t size) {
+        if (size < 10U) return makeInfo(0U, 0U, ImageFormat::Invalid);
+        return makeInfo(readLE16(p + 6), readLE16(p + 8), ImageFormat::Gif);
+    }
+
+    ImageInfo probeWebp(const std::uint8_t *p, std::size_t size) {
+        if (size < 30U) return makeInfo(0U, 0U, ImageFormat::Invalid);
+        if (startsWith(p + 12, size - 12U, "VP8 ")) {
+            // 有损格式：3 字节帧标记 + 起始码 9d 01 2a + 14 位宽高
+            if (p[23] != 0x9dU || p[24] != 0x01U || p[25] != 0x2aU) return makeInfo(0U, 0U, ImageFormat::Invalid);
+            return makeInfo(readLE16(p + 26) & 0x3fffU, readLE16(p + 28) & 0x3fffU, ImageFormat::Webp);
+        } else if (startsWith(p + 12, size - 12U, "VP8L")) {
+            // 无损格式：签名 0x2f + 14 位 (宽 - 1) + 14 位 (高 - 1)
+            if (p[20] != 0x2fU) return makeInfo(0U, 0U, ImageFormat::Invalid);
+            std::uint32_t bits = readLE16(p + 21) | (readLE16(p + 23) << 16);
+            return makeInfo((bits & 0x3fffU) + 1U, ((bits >> 14) & 0x3fffU) + 1U, ImageFormat::Webp);
+        } else if (startsWith(p + 12, size - 12U, "VP8X")) {
+            // 扩展格式：24 位 (画布宽 - 1) + 24 位 (画布高 - 1)
+            return makeInfo(readLE24(p + 24) + 1U, readLE24(p + 27) + 1U, ImageFormat::Webp);
+        }
+        return makeInfo(0U, 0U, ImageFormat::Invalid);
+    }
+
+    // 按段查找 JPEG 的 SOF 标记，readAt(offset, n, out) 读取偏移 offset 处的 n 个字节
+    // 只读取各段的段头，不读取段内数据
+    template<typename Reader>
+    ImageInfo probeJpeg(Reader &&readAt) {
+        constexpr int maxSegments = 1024;
+        std::uint8_t seg[9];
+        std::uint64_t pos = 2U;
+        for (int i = 0; i < maxSegments; ++i) {
+            if (!readAt(pos, 4U, seg) || seg[0] != 0xffU) break;
+            auto marker = seg[1];
+            if (marker == 0xffU) { ++pos; continue; }          // 填充字节
+            if (isStandaloneMarker(marker)) { pos += 2U; continue; }
+            if (marker == 0xd9U || marker == 0xdaU) break;      // 图像结束或扫描开始
+            if (isSofMarker(marker)) {
+                if (!readAt(pos, 9U, seg)) break;
+                return makeInfo(readBE16(seg + 7), readBE16(seg + 5), ImageFormat::Jpeg);
+            }
+            pos += 2U + readBE16(seg + 2);
+        }
+        return makeInfo(0U, 0U, ImageFormat::Invalid);
+    }
+}
+/* ====== END ====== */
+
+/* 图像元数据探测 */
+/* ===== BEGIN ===== */
+ImageInfo book::probeImage(std::span<const std::byte> header) {
+    auto p = reinterpret_cast<const std::uint8_t *>(header.data());
+    auto size = header.size();
+    if (startsWith(p, size, "\x89PNG\r\n\x1a\n")) return probePng(p, size);
+    if (startsWith(p, size, "GIF87a") || startsWith(p, size, "GIF89a")) return probeGif(p, size);
+    if (startsWith(p, size, "RIFF") && size >= 12U && startsWith(p + 8, size - 8U, "WEBP")) return probeWebp(p, size);
+    if (size >= 2U && p[0] == 0xffU && p[1] == 0xd8U) {
+        return probeJpeg([p, size](std::uint64_t offset, std::size_t n, std::uint8_t *out) {
+            if (offset + n > size) return false;
+            std::memcpy(out, p + offset, n);
+            return true;
+        });
+    }
+    return makeInfo(0U, 0U, ImageFormat::Invalid);
+}
+
+ImageInfo book::probeImageFile(const fs::path &path) {
+    std::ifstream fin(path, std::ios::in | std::ios::binary);
+    if (fin.fail()) return makeInfo(0U, 0U, ImageFormat::Invalid);
+
+    std::array<std::uint8_t, 4096U> buffer;
+    fin.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+    auto size = static_cast<std::size_t>(fin.gcount());
+    if (size < 2U || buffer[0] != 0xffU || buffer[1] != 0xd8U) {
+        return probeImage(std::as_bytes(std::span(buffer.data(), size)));
+    }
+
+    // JPEG 的 SOF 可能位于较大的 EXIF/ICC 段之后，超出缓冲区的段头直接定位读取
+    return probeJpeg([&](std::uint64_t offset, std::size_t n, std::uint8_t *out) {
+        if (offset + n <= size) {
+            std::memcpy(out, buffer.data() + offset, n);
+            return true;
+        }
+        fin.clear();
+        fin.seekg(static_cast<std::streamoff>(offset));
+        fin.read(reinterpret_cast<char *>(out), static_cast<std::streamsize>(n));
+        return static_cast<std::size_t>(fin.gcount()) == n;
+    });
+}
+/* ====== END ====== */
@@ -1,87 +1,318 @@
 #include "Img.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <numeric>
+#include <utility>
+#include "ContentStore.h"
+#include "PerceptualHash.h"
+#include "Profiler.h"
 
 using namespace book;
 
+/* 图像文件辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    // 将不超过 8 个字符的后缀转为小写并压缩进一个整数，便于一次比较
+    // 含有非 ASCII 字符时返回 0
+    template<typename CharType>
+    constexpr std::uint64_t packExtension(std::basic_string_view<CharType> ext) {
+        std::uint64_t ret = 0U;
+        for (std::size_t i = 0; i < ext.size(); ++i) {
+            auto ch = static_cast<std::uint64_t>(ext[i]);
+            if (ch > 0x7fU) return 0U;
+            if (ch >= 'A' && ch <= 'Z') ch = ch - 'A' + 'a';
+            ret |= ch << (8U * i);
+        }
+        return ret;
+    }
+
+    // 将一组后缀压缩为整数
+    template<std::size_t N>
+    constexpr std::array<std::uint64_t, N> packExtensions(const std::array<std::string_view, N> &types) {
+        std::array<std::uint64_t, N> ret{};
+        for (std::size_t i = 0; i < N; ++i) ret[i] = packExtension(types[i]);
+        return ret;
+    }
+
+    constexpr auto packedImageTypes = packExtensions(IMG_TYPES);
+    constexpr auto packedArchiveTypes = packExtensions(ARCHIVE_TYPES);
+
+    // 压缩包内的图像先探测开头的这么多字节，探测失败再读取整个图像
+    constexpr std::size_t archiveProbeSize = std::size_t(64U) << 10;
+
+    // 将路径转为保存在数据文件内的字节，不支持的平台返回 false
+    bool pathToBytes(const fs::path &path, std::string &ret) {
+        auto &tmp = path.native();
+        if constexpr (std::is_same_v<fs::path::string_type, std::wstring>) {
+            // 被迫用宏再包裹一层 _^_
+#ifdef _WIN32
+            std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+            ret = converter.to_bytes(tmp);
+#endif
+        } else if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+            // FIXIT TOMORROW
+            // FIXED
+#ifdef __linux
+            ret = tmp;
+#endif
+        } else return false;
+        return true;
+    }
+
+    // 将数据文件内的字节转回路径，不支持的平台返回 false
+    bool bytesToPath(std::string &bytes, fs::path &path) {
+        if constexpr (std::is_same_v<fs::path::string_type, std::wstring>) {
+#ifdef _WIN32
+            std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+            path = converter.from_bytes(bytes);
+#endif
+        } else if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+#ifdef __linux
+            path = std::move(bytes);
+#endif
+        } else return false;
+        return true;
+    }
+
+    // 判断 path 的后缀是否在 packedTypes 内
+    template<std::size_t N>
+    bool hasExtension(const fs::path &path, const std::array<std::uint64_t, N> &packedTypes) {
+        using StringView = std::basic_string_view<fs::path::value_type>;
+        StringView native(path.native());
+        auto dot = native.find_last_of(fs::path::value_type('.'));
+        auto sep = native.find_last_of(fs::path::preferred_separator);
+        // 没有后缀、点号位于目录名中或文件名以点号开头时都不匹配
+        if (dot == native.npos || (sep != native.npos && dot <= sep + 1U) || dot == 0U) return false;
+        if (native.size() - dot > sizeof(std::uint64_t)) return false;
+        auto packed = packExtension(native.substr(dot));
+        return std::find(packedTypes.begin(), packedTypes.end(), packed) != packedTypes.end();
+    }
+
+    // 读取一页的内容：entry 为空时 path 为图像文件，否则为 entry 所在的压缩包
+    std::unique_ptr<std::string> readPage(const fs::path &path, const ArchiveEntry *entry) {
+        ScopedTimer timer(ProbeId::ImageRead);
+        auto ret = entry ? readArchiveEntry(path, *entry) : ImagesManager::readFile(path);
+        if (ret) Profiler::count(CounterId::ImageBytesRead, ret->size());
+        return ret;
+    }
+}
+
+bool book::isImageFile(const fs::path &path) {
+    return hasExtension(path, packedImageTypes);
+}
+
+bool book::isArchiveFile(const fs::path &path) {
+    return hasExtension(path, packedArchiveTypes);
+}
+
+std::string book::makeNaturalKey(std::string_view name) {
+    // 连续数字编码为：'\x01' + 去掉前导零后的位数 + 数字本身，因此数字按数值排序且排在文字之前
+    // 其余 ASCII 字母转为小写
+    std::string ret;
+    ret.reserve(name.size() + 8U);
+    for (std::size_t i = 0; i < name.size(); ) {
+        auto ch = name[i];
+        if (ch >= '0' && ch <= '9') {
+            auto begin = i;
+            while (i < name.size() && name[i] >= '0' && name[i] <= '9') ++i;
+            auto first = begin;
+            while (first + 1U < i && name[first] == '0') ++first;
+            auto len = std::min<std::size_t>(i - first, 0xffU);
+            ret.push_back('\x01');
+            ret.push_back(static_cast<char>(len));
+            ret.append(name.substr(first, i - first));
+        } else {
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+            ret.push_back(ch);
+            ++i;
+        }
+    }
+    return ret;
+}
+
+void book::sortNatural(std::vector<fs::path> &paths) {
+    std::vector<std::string> keys;
+    keys.reserve(paths.size());
+    for (const auto &path : paths) keys.emplace_back(makeNaturalKey(path.filename().string()));
+    std::vector<std::size_t> order(paths.size());
+    std::iota(order.begin(), order.end(), std::size_t(0U));
+    std::stable_sort(order.begin(), order.end(), [&keys](std::size_t a, std::size_t b) {
+        return keys[a] < keys[b];
+    });
+    std::vector<fs::path> ret;
+    ret.reserve(paths.size());
+    for (auto i : order) ret.emplace_back(std::move(paths[i]));
+    paths = std::move(ret);
+}
+/* ====== END ====== */
+
 /* class ImagesManager */
 /* ===== BEGIN ===== */
 // 构造函数
 
 ImagesManager::ImagesManager(const fs::path &path) {
-    scanImageFiles(path);
+    if (isArchiveFile(path)) openArchive(path);
+    else scanImageFiles(path);
 }
 
-ImagesManager::ImagesManager(const std::vector<fs::path> &images)
-: m_images(images) { }
+ImagesManager::ImagesManager(const std::vector<fs::path> &images) {
+    m_images.reserve(images.size());
+    for (const auto &path : images) m_images.add(path);
+}
 
 ImagesManager::ImagesManager(std::vector<fs::path> &&images)
-: m_images(std::move(images)) { }
+: ImagesManager(images) { }
+
+ImagesManager::ImagesManager(ImagesManager &&man)
+: m_images(std::move(man.m_images)), m_infos(std::move(man.m_infos)), m_archive(std::move(man.m_archive)),
+    m_entries(std::move(man.m_entries)), m_store(std::exchange(man.m_store, nullptr)),
+    m_cacheOwner(man.m_cacheOwner) { }
+
+ImagesManager &ImagesManager::operator=(ImagesManager &&man) {
+    m_images = std::move(man.m_images);
+    m_infos = std::move(man.m_infos);
+    m_archive = std::move(man.m_archive);
+    m_entries = std::move(man.m_entries);
+    m_store = std::exchange(man.m_store, nullptr);
+    m_cacheOwner = man.m_cacheOwner;
+    return *this;
+}
 
 // 公有函数
 
-void ImagesManager::copy(const fs::path &destPath, bool moveOldPath) {
-    fs::create_directories(destPath);
-    for (auto &path : m_images) {
-        fs::path destFilePath = destPath / path.filename();
-        fs::copy_file(path, destFilePath);
-        if (moveOldPath) path = std::move(destFilePath);
-    }
-    // m_copy(destPath, moveOldPath);
-}
-
-void ImagesManager::move(const fs::path &destPath) {
-    fs::create_directories(destPath);
-    for (auto &path : m_images) {
-        fs::path destFilePath = destPath / path.filename();
-        std::error_code ec;
-        // 防止跨文件系统移动失败
-        fs::rename(path, destPath, ec);
-        if (ec) {
-            fs::copy_file(path, destPath);
-            fs::remove(path);
+bool ImagesManager::copy(const fs::path &destPath, bool moveOldPath, const TransferEngine *engine) {
+    auto items = m_makeTransferItems(destPath);
+    if (!(engine ? *engine : TransferEngine()).run(items, TransferMode::Copy)) return false;
+    if (!moveOldPath) return true;
+    // 复制出的新文件不在存储内，不再引用原来的对象
+    for (std::size_t i = 0; m_store && i < m_images.size(); ++i) {
+        if (m_isObject(i) && m_store->release(m_images.getPath(i))) PageCache::global().erase(getPageKey(i));
+    }
+    m_relocate(items);
+    return true;
+}
+
+bool ImagesManager::move(const fs::path &destPath, const TransferEngine *engine) {
+    auto items = m_makeTransferItems(destPath);
+    // 内容存储内的对象可能被其他书籍引用，只能复制出来，之后释放引用并删除其余源文件
+    bool hasObjects = false;
+    for (std::size_t i = 0; !hasObjects && i < m_images.size(); ++i) hasObjects = m_isObject(i);
+    auto mode = hasObjects ? TransferMode::Copy : TransferMode::Move;
+    if (!(engine ? *engine : TransferEngine()).run(items, mode)) return false;
+    // 旧路径已不存在，对应的缓存内容不会再被访问
+    std::error_code ec;
+    for (std::size_t i = 0; i < m_images.size(); ++i) {
+        if (!m_isObject(i)) {
+            PageCache::global().erase(getPageKey(i));
+            if (hasObjects) fs::remove(m_images.getPath(i), ec);
+        } else if (m_store->release(m_images.getPath(i))) {
+            PageCache::global().erase(getPageKey(i));
         }
-        path = std::move(destPath);
     }
+    m_relocate(items);
+    return true;
 }
 
 void ImagesManager::clear(bool removeFiles) {
-    if (removeFiles) {
-        for (const auto &path : m_images) {
-            fs::remove(path);
+    for (std::size_t i = 0; i < m_images.size(); ++i) {
+        if (m_isObject(i)) {
+            if (m_store->release(m_images.getPath(i), removeFiles)) PageCache::global().erase(getPageKey(i));
+        } else if (removeFiles) {
+            PageCache::global().erase(getPageKey(i));
+            if (!isArchive()) fs::remove(m_images.getPath(i));
         }
     }
+    if (removeFiles && isArchive()) fs::remove(m_archive);
     m_images.clear();
+    m_infos.clear();
+    m_archive.clear();
+    m_entries.clear();
 }
 
 void ImagesManager::remove(std::size_t index, bool removeFile) {
     if (!m_checkIndex(index)) return ;
-    if (removeFile) fs::remove(m_images.at(index));
-    for (auto i = m_images.begin() + index + 1; i != m_images.end(); ++i) {
-        *(i - 1) = *i;
+    if (m_isObject(index)) {
+        if (m_store->release(m_images.getPath(index), removeFile)) PageCache::global().erase(getPageKey(index));
+    } else if (removeFile) {
+        PageCache::global().erase(getPageKey(index));
+        if (!isArchive()) fs::remove(m_images.getPath(index));
     }
-    m_images.pop_back();
+    m_images.remove(index);
+    if (isArchive()) m_entries.erase(m_entries.begin() + index);
+    if (index < m_infos.size()) m_infos.erase(m_infos.begin() + index);
 }
 
 void ImagesManager::swap(std::size_t index0, std::size_t index1) {
     if (!m_checkIndex(index0) || !m_checkIndex(index1)) return ;
-    m_images.at(index0).swap(m_images.at(index1));
+    m_images.swap(index0, index1);
+    if (isArchive()) std::swap(m_entries[index0], m_entries[index1]);
+    if (index0 < m_infos.size() || index1 < m_infos.size()) {
+        m_infos.resize(m_images.size());
+        std::swap(m_infos[index0], m_infos[index1]);
+    }
 }
 
 void ImagesManager::add(const fs::path &imagePath) {
-    if (!fs::exists(imagePath) || !fs::is_regular_file(imagePath)) return ;
+    if (isArchive() || !fs::exists(imagePath) || !fs::is_regular_file(imagePath)) return ;
     fs::path path(fs::canonical(imagePath));
-    m_images.emplace_back(std::move(path));
+    if (m_store) m_store->retain(path);
+    m_images.add(path);
+}
+
+void ImagesManager::insert(std::size_t index, const fs::path &imagePath) {
+    if (isArchive()) return ;
+    index = std::min(index, m_images.size());
+    // 与 add 一样储存规范路径；文件可能已不存在（如重放日志），此时只规范化已存在的前缀
+    std::error_code ec;
+    fs::path path(fs::weakly_canonical(imagePath, ec));
+    if (ec) path = imagePath;
+    if (m_store) m_store->retain(path);
+    m_images.insert(index, path);
+    if (index < m_infos.size()) m_infos.insert(m_infos.begin() + index, ImageInfo());
 }
 
-const fs::path &ImagesManager::getImagePath(std::size_t index) const {
-    return m_images.at(index);
+void ImagesManager::refresh(std::size_t index) {
+    if (!m_checkIndex(index)) return ;
+    PageCache::global().erase(getPageKey(index));
+    if (index < m_infos.size()) m_infos[index] = ImageInfo();
+}
+
+fs::path ImagesManager::getImagePath(std::size_t index) const {
+    return m_images.getPath(index);
 }
 
 std::unique_ptr<std::string> ImagesManager::getImageContent(std::size_t index) const {
+    // 经由全局页面缓存读取，返回的是缓存内容的副本，调用方可以修改
+    auto content = getCachedContent(index);
+    if (!content) return nullptr;
+    return std::make_unique<std::string>(*content);
+}
+
+PageContent ImagesManager::getCachedContent(std::size_t index) const {
     if (!m_checkIndex(index)) return nullptr;
+    return PageCache::global().getOrLoad(getPageKey(index), [this, index] {
+        return PageContent(m_readImage(index));
+    });
+}
+
+PageKey ImagesManager::getPageKey(std::size_t index) const {
+    if (!m_checkIndex(index)) return PageKey{ m_cacheOwner, std::string() };
+    return PageKey{ m_isObject(index) ? 0U : m_cacheOwner, m_images.getPath(index).string() };
+}
+
+PageCache::Loader ImagesManager::getPageLoader(std::size_t index) const {
+    if (!m_checkIndex(index)) return [] { return PageContent(); };
+    if (isArchive()) {
+        return [archive = m_archive, entry = m_entries[index]] { return PageContent(readPage(archive, &entry)); };
+    }
+    return [path = m_images.getPath(index)] { return PageContent(readPage(path, nullptr)); };
+}
 
-    const auto &path = m_images.at(index);
-    auto size = fs::file_size(path);
+std::unique_ptr<std::string> ImagesManager::readFile(const fs::path &path) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) return nullptr;
     std::ifstream fin(path, std::ios::in | std::ios::binary);
     if (fin.fail()) return nullptr;
 
@@ -90,78 +321,228 @@ std::unique_ptr<std::string> ImagesManager::getImageContent(std::size_t index) c
     return ret;
 }
 
+MappedFile ImagesManager::getImageView(std::size_t index, AccessHint hint) const {
+    if (!m_checkIndex(index)) return MappedFile();
+    if (isArchive()) return mapArchiveEntry(m_archive, m_entries[index], hint);
+    return MappedFile(m_images.getPath(index), hint);
+}
+
 void ImagesManager::scanImageFiles(const fs::path &srcPath, bool add) {
+    ScopedTimer timer(ProbeId::ImageScan);
     if (!fs::exists(srcPath) || !fs::is_directory(srcPath)) return ;
 
-    if (!add) m_images.clear();
+    if (!add) clear();
+    else if (isArchive()) return ;
+    std::vector<fs::path> images;
     for (auto &i : fs::directory_iterator(srcPath)) {
-        if (!i.is_regular_file()) continue;
-        auto &path = i.path();
-        for (auto type : IMG_TYPES) {
-            if (type != path.extension()) continue;
-            m_images.emplace_back(path);
-        }
+        if (!i.is_regular_file() || !isImageFile(i.path())) continue;
+        images.emplace_back(i.path());
     }
+    sortNatural(images);
+    m_images.reserve(m_images.size() + images.size());
+    for (const auto &path : images) m_images.add(path);
 }
 
-bool ImagesManager::write(std::ofstream &out) const {
-    std::size_t size = m_images.size(), length;
-    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
-    for (auto &path : m_images) {
-        auto &tmp = path.native();
-        std::string ret;
-        if constexpr (std::is_same_v<fs::path::string_type, std::wstring>) {
-            // 被迫用宏再包裹一层 _^_
-#ifdef _WIN32
-            std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-            ret = converter.to_bytes(tmp);
-#endif
-        } else if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
-            // FIXIT TOMORROW
-            // FIXED
-#ifdef __linux
-            ret = tmp;
-#endif
-        } else return false;
-        length = ret.length();
-        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
-        out.write(ret.c_str(), ret.size());
+bool ImagesManager::write(BinaryWriter &out) const {
+    std::string ret;
+    if (!pathToBytes(m_archive, ret)) return false;
+    out.putString(ret);
+    auto size = m_images.size();
+    out.putVarint(size);
+    if (isArchive()) {
+        // 压缩包内的图像只保存条目索引，路径由压缩包路径与条目名拼出
+        for (const auto &entry : m_entries) {
+            out.putString(entry.m_name);
+            out.putVarint(entry.m_offset);
+            out.putVarint(entry.m_compressedSize);
+            out.putVarint(entry.m_size);
+            out.putFixed(entry.m_crc);
+            out.putFixed(static_cast<std::uint16_t>(entry.m_method));
+        }
+    } else {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (!pathToBytes(m_images.getPath(i), ret)) return false;
+            out.putString(ret);
+        }
+    }
+    // 图像元数据，未探测的图像写入空元数据
+    for (std::size_t i = 0; i < size; ++i) {
+        auto info = i < m_infos.size() ? m_infos[i] : ImageInfo();
+        out.putVarint(info.m_width);
+        out.putVarint(info.m_height);
+        out.putFixed(static_cast<std::uint8_t>(info.m_format));
     }
     return true;
 }
 
-bool ImagesManager::read(std::ifstream& in) {
-    std::size_t size, length;
+bool ImagesManager::read(BinaryReader &in, std::uint16_t version) {
+    std::size_t size;
     std::string tmp;
-    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    fs::path archive;
+    if (version >= 3U) {
+        if (!in.getString(tmp) || !bytesToPath(tmp, archive)) return false;
+    }
+    // 压缩包与普通图像不能混在同一个管理器内
+    if ((!archive.empty() || isArchive()) && !m_images.empty()) return false;
+    if (!in.getCount(size)) return false;
+    auto base = m_images.size();
+    m_images.reserve(m_images.size() + size);
+    if (!archive.empty()) {
+        m_archive = std::move(archive);
+        m_images.setRoot(m_archive);
+        m_entries.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            ArchiveEntry entry;
+            std::uint16_t method;
+            if (!in.getString(entry.m_name) || !in.getVarint(entry.m_offset) ||
+                !in.getVarint(entry.m_compressedSize) || !in.getVarint(entry.m_size) ||
+                !in.getFixed(entry.m_crc) || !in.getFixed(method)) return false;
+            if (method != static_cast<std::uint16_t>(ArchiveMethod::Stored) &&
+                method != static_cast<std::uint16_t>(ArchiveMethod::Deflate)) return false;
+            entry.m_method = static_cast<ArchiveMethod>(method);
+            m_images.addRelative(fs::path(entry.m_name));
+            m_entries.emplace_back(std::move(entry));
+        }
+    } else {
+        for (std::size_t i = 0; i < size; ++i) {
+            fs::path path;
+            if (!in.getString(tmp) || !bytesToPath(tmp, path)) return false;
+            m_images.add(path);
+        }
+    }
+    m_infos.resize(base);
+    m_infos.reserve(base + size);
     for (std::size_t i = 0; i < size; ++i) {
+        ImageInfo info;
+        std::uint64_t width, height;
+        std::uint8_t format;
+        if (!in.getVarint(width) || !in.getVarint(height) || !in.getFixed(format)) return false;
+        info.m_width = static_cast<std::uint32_t>(width);
+        info.m_height = static_cast<std::uint32_t>(height);
+        if (format > static_cast<std::uint8_t>(ImageFormat::Webp)) format = 0U;
+        info.m_format = static_cast<ImageFormat>(format);
+        m_infos.emplace_back(info);
+    }
+    return true;
+}
 
-        in.read(reinterpret_cast<char*>(&length), sizeof(length));
-        tmp.resize(length);
-        in.read(reinterpret_cast<char*>(&tmp[0]), length);
+ImageInfo ImagesManager::getImageInfo(std::size_t index) const {
+    if (!m_checkIndex(index)) return ImageInfo{ 0U, 0U, ImageFormat::Invalid };
+    if (m_infos.size() <= index) m_infos.resize(m_images.size());
+    auto &info = m_infos[index];
+    if (!info.isProbed()) info = m_probeImage(index);
+    return info;
+}
 
-        if constexpr (std::is_same_v<fs::path::string_type, std::wstring>) {
-#ifdef _WIN32
-            std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-            m_images.emplace_back(converter.from_bytes(tmp));
-#endif
-        } else if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
-#ifdef __linux
-            m_images.emplace_back(std::move(tmp));
-#endif
-        } else return false;
+void ImagesManager::probeImages(bool force) {
+    m_infos.resize(m_images.size());
+    for (std::size_t i = 0; i < m_images.size(); ++i) {
+        if (force || !m_infos[i].isProbed()) m_infos[i] = m_probeImage(i);
     }
-    return true;
+}
+
+bool ImagesManager::getPerceptualHash(std::size_t index, std::uint64_t &hash) const {
+    if (!m_checkIndex(index)) return false;
+    auto view = getImageView(index, AccessHint::Sequential);
+    return view.isOpen() && dhashImage(view.getData(), hash);
 }
 
 std::size_t ImagesManager::getSumOfImages() const {
     return m_images.size();
 }
 
+bool ImagesManager::openArchive(const fs::path &archivePath) {
+    clear();
+    std::vector<ArchiveEntry> entries;
+    if (!fs::is_regular_file(archivePath) || !readZipIndex(archivePath, entries)) return false;
+    m_archive = fs::canonical(archivePath);
+    m_images.setRoot(m_archive);
+    m_images.reserve(entries.size());
+    for (const auto &entry : entries) m_images.addRelative(fs::path(entry.m_name));
+    m_entries = std::move(entries);
+    return true;
+}
+
+bool ImagesManager::isArchive() const {
+    return !m_archive.empty();
+}
+
+const fs::path &ImagesManager::getArchivePath() const {
+    return m_archive;
+}
+
+void ImagesManager::setContentStore(ContentStore *store) {
+    if (m_store == store) return ;
+    if (m_store) {
+        for (std::size_t i = 0; i < m_images.size(); ++i) m_store->release(m_images.getPath(i), false);
+    }
+    m_store = store;
+    if (m_store) {
+        for (std::size_t i = 0; i < m_images.size(); ++i) m_store->retain(m_images.getPath(i));
+    }
+}
+
+std::vector<TransferItem> ImagesManager::m_makeTransferItems(const fs::path &destPath) const {
+    if (isArchive()) return { TransferItem{ m_archive, destPath / m_archive.filename() } };
+    std::vector<TransferItem> ret;
+    ret.reserve(m_images.size());
+    for (std::size_t i = 0; i < m_images.size(); ++i) {
+        // 对象以哈希命名且同一对象可能出现多次，传出存储时按页码重新命名
+        auto path = m_images.getPath(i);
+        auto name = m_isObject(i) ? fs::path(std::to_string(i + 1U)) += path.extension() : path.filename();
+        ret.emplace_back(TransferItem{ path, destPath / name });
+    }
+    return ret;
+}
+
+void ImagesManager::m_relocate(std::vector<TransferItem> &items) {
+    if (isArchive()) {
+        // 页面名字相对于压缩包路径，随之移动
+        m_archive = std::move(items.front().m_dest);
+        m_images.setRoot(m_archive);
+        return ;
+    }
+    m_images.clear();
+    m_images.reserve(items.size());
+    for (const auto &item : items) m_images.add(item.m_dest);
+}
+
+std::unique_ptr<std::string> ImagesManager::m_readImage(std::size_t index) const {
+    if (isArchive()) return readPage(m_archive, &m_entries[index]);
+    return readPage(m_images.getPath(index), nullptr);
+}
+
+ImageInfo ImagesManager::m_probeImage(std::size_t index) const {
+    if (!isArchive()) return probeImageFile(m_images.getPath(index));
+    const auto &entry = m_entries[index];
+    if (entry.m_method == ArchiveMethod::Stored) {
+        // 未压缩的条目直接映射，探测只会访问到用到的页
+        auto view = mapArchiveEntry(m_archive, entry, AccessHint::Random);
+        return view.isOpen() ? probeImage(view.getData()) : ImageInfo{ 0U, 0U, ImageFormat::Invalid };
+    }
+    auto header = readArchiveEntry(m_archive, entry, archiveProbeSize);
+    auto info = header ? probeImage(std::as_bytes(std::span(header->data(), header->size()))) :
+        ImageInfo{ 0U, 0U, ImageFormat::Invalid };
+    // JPEG 的 SOF 可能位于很大的 EXIF/ICC 段之后，此时解压整个图像再探测
+    if (!info.isValid() && header && entry.m_size > header->size()) {
+        header = readArchiveEntry(m_archive, entry);
+        if (header) info = probeImage(std::as_bytes(std::span(header->data(), header->size())));
+    }
+    return info;
+}
+
+std::uint64_t ImagesManager::m_getImagesRevision() const {
+    return m_images.getRevision();
+}
+
 bool ImagesManager::m_checkIndex(std::size_t i) const {
     return i < m_images.size();
 }
 
+bool ImagesManager::m_isObject(std::size_t index) const {
+    return m_store && !isArchive() && m_store->isObject(m_images.getPath(index));
+}
+
 // 私有函数
 
 /* ====== END ====== */
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "Journal.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include "Profiler.h"
+
+#ifdef __linux
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace book;
+
+/* 日志辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::size_t headerSize = 8U;          // magic + version + flags
+    constexpr std::size_t recordHeaderSize = 8U;    // 长度 + CRC32C
+
+    // 编码文件头部
+    std::string encodeHeader() {
+        BinaryWriter out;
+        out.putBytes(std::as_bytes(std::span(Journal::fileMagic)));
+        out.putFixed(Journal::fileVersion);
+        out.putFixed(std::uint16_t(sizeof(TagIdType)));
+        auto data = out.getData();
+        return std::string(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+    // 检查文件头部，idSize 为记录内标签ID的字节数
+    bool checkHeader(std::span<const std::byte> data, std::size_t &idSize) {
+        if (data.size() < headerSize) return false;
+        std::array<char, 4> magic;
+        std::uint16_t version = 0U, flags = 0U;
+        std::memcpy(magic.data(), data.data(), magic.size());
+        BinaryReader in(data.subspan(magic.size(), 4U));
+        in.getFixed(version);
+        in.getFixed(flags);
+        idSize = flags;
+        return magic == Journal::fileMagic && version != 0U && version <= Journal::fileVersion &&
+            checkTagIdSize(idSize);
+    }
+
+    // 一次读入整个文件，不存在时返回 false
+    bool readWholeFile(const fs::path &path, std::string &buffer) {
+        std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (fin.fail()) return false;
+        buffer.resize(static_cast<std::size_t>(fin.tellg()));
+        fin.seekg(0);
+        fin.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        return !fin.fail();
+    }
+
+    // 路径与日志内字节之间的转换，与 ImagesManager::write 保持一致
+    std::string pathToBytes(const fs::path &path) {
+        if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+            return path.native();
+        } else {
+            auto str = path.u8string();
+            return std::string(str.begin(), str.end());
+        }
+    }
+
+    fs::path bytesToPath(std::string_view bytes) {
+        if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+            return fs::path(bytes);
+        } else {
+            return fs::path(std::u8string(bytes.begin(), bytes.end()));
+        }
+    }
+}
+/* ====== END ====== */
+
+/* class Journal */
+/* ===== BEGIN ===== */
+// 析构函数
+Journal::~Journal() {
+    close();
+}
+
+// 公有函数
+bool Journal::open(const fs::path &path, std::uint64_t seq) {
+    close();
+    std::error_code ec;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+
+    // 扫描已有记录，截掉末尾残缺的部分
+    std::string buffer;
+    std::size_t validSize = 0U;
+    if (readWholeFile(path, buffer) && !buffer.empty()) {
+        auto data = std::as_bytes(std::span(buffer.data(), buffer.size()));
+        std::size_t idSize = 0U;
+        if (!checkHeader(data, idSize)) return false;
+        // 较窄的旧日志先整体改写为当前宽度，之后的记录才能直接追加
+        if (idSize != sizeof(TagIdType)) {
+            if (!m_widen(path, data, idSize) || !readWholeFile(path, buffer)) return false;
+            data = std::as_bytes(std::span(buffer.data(), buffer.size()));
+        }
+        bool ok = true;
+        validSize = m_scan(data, 0U, nullptr, m_seq, ok, sizeof(TagIdType));
+        if (validSize != buffer.size()) {
+            fs::resize_file(path, validSize, ec);
+            if (ec) return false;
+        }
+    }
+    if (validSize == 0U) {
+        auto header = encodeHeader();
+        std::ofstream fout(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        fout.write(header.data(), static_cast<std::streamsize>(header.size()));
+        fout.close();
+        if (fout.fail()) return false;
+        validSize = header.size();
+    }
+
+#ifdef __linux
+    m_fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (m_fd < 0) return false;
+#endif
+    m_path = path;
+    m_size = validSize;
+    m_seq = std::max(m_seq, seq);
+    m_isOpen = true;
+    return true;
+}
+
+void Journal::close() {
+#ifdef __linux
+    if (m_fd >= 0) ::close(m_fd);
+#endif
+    m_fd = -1;
+    m_isOpen = false;
+    m_seq = 0U;
+    m_size = 0U;
+}
+
+bool Journal::isOpen() const {
+    return m_isOpen;
+}
+
+void Journal::setSync(bool sync) {
+    m_sync = sync;
+}
+
+std::uint64_t Journal::getSequence() const {
+    return m_seq;
+}
+
+std::size_t Journal::getSize() const {
+    return m_size;
+}
+
+const fs::path &Journal::getPath() const {
+    return m_path;
+}
+
+bool Journal::append(const JournalRecord &record) {
+    if (!m_isOpen) return false;
+    ScopedTimer timer(ProbeId::JournalAppend);
+    // 长度、校验值与内容拼成一块，一次写入
+    BinaryWriter out;
+    m_encodeRecord(out, record, m_seq + 1U);
+    if (!m_write(out.getData())) return false;
+    ++m_seq;
+    m_size += out.getSize();
+    return true;
+}
+
+bool Journal::rotate(const fs::path &oldPath) {
+    if (!m_isOpen) return false;
+    auto path = m_path;
+    auto seq = m_seq;
+    close();
+    std::error_code ec;
+    fs::rename(path, oldPath, ec);
+    if (ec) return false;
+    return open(path, seq);
+}
+
+bool Journal::replay(const fs::path &path, std::uint64_t after,
+    const std::function<bool(const JournalRecord &)> &apply, std::uint64_t &lastSeq) {
+    lastSeq = after;
+    std::string buffer;
+    if (!readWholeFile(path, buffer) || buffer.empty()) return true;
+    auto data = std::as_bytes(std::span(buffer.data(), buffer.size()));
+    std::size_t idSize = 0U;
+    if (!checkHeader(data, idSize)) return false;
+    bool ok = true;
+    m_scan(data, after, apply, lastSeq, ok, idSize);
+    return ok;
+}
+
+// 私有函数
+bool Journal::m_write(std::span<const std::byte> data) {
+#ifdef __linux
+    auto p = reinterpret_cast<const char *>(data.data());
+    auto n = data.size();
+    while (n) {
+        auto ret = ::write(m_fd, p, n);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += ret;
+        n -= static_cast<std::size_t>(ret);
+    }
+    return !m_sync || ::fdatasync(m_fd) == 0;
+#else
+    std::ofstream fout(m_path, std::ios::out | std::ios::binary | std::ios::app);
+    fout.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    fout.close();
+    return !fout.fail();
+#endif
+}
+
+void Journal::m_encodeRecord(BinaryWriter &out, const JournalRecord &record, std::uint64_t seq) {
+    BinaryWriter body;
+    body.putVarint(seq);
+    m_encode(body, record);
+    out.reserve(out.getSize() + recordHeaderSize + body.getSize());
+    out.putFixed(static_cast<std::uint32_t>(body.getSize()));
+    out.putFixed(crc32c(body.getData()));
+    out.putBytes(body.getData());
+}
+
+void Journal::m_encode(BinaryWriter &out, const JournalRecord &record) {
+    out.putFixed(static_cast<std::uint8_t>(record.m_op));
+    switch (record.m_op) {
+    case JournalOp::CreateBookTag:
+        out.putFixed(record.m_tagId);
+        out.putFixed(record.m_groupId);
+        out.putString(record.m_name);
+        break;
+    case JournalOp::CreateGroupTag:
+    case JournalOp::RenameBookTag:
+    case JournalOp::RenameGroupTag:
+        out.putFixed(record.m_tagId);
+        out.putString(record.m_name);
+        break;
+    case JournalOp::EraseBookTag:
+    case JournalOp::EraseGroupTag:
+        out.putFixed(record.m_tagId);
+        break;
+    case JournalOp::AddBook:
+    case JournalOp::AddArchiveBook:
+        out.putFixed(record.m_bookId);
+        out.putVarint(record.m_images.size());
+        for (const auto &image : record.m_images) out.putString(pathToBytes(image));
+        out.putVarint(record.m_tags.size());
+        for (auto tag : record.m_tags) out.putFixed(tag);
+        break;
+    case JournalOp::EraseBook:
+        out.putFixed(record.m_bookId);
+        break;
+    case JournalOp::AddBookTag:
+    case JournalOp::RemoveBookTag:
+        out.putFixed(record.m_bookId);
+        out.putFixed(record.m_tagId);
+        break;
+    case JournalOp::RemoveBookTags:
+        out.putFixed(record.m_bookId);
+        out.putFixed(record.m_groupId);
+        break;
+    case JournalOp::SetBookTitle:
+        out.putFixed(record.m_bookId);
+        out.putString(record.m_name);
+        break;
+    case JournalOp::AddBookPage:
+    case JournalOp::RemoveBookPage:
+        out.putFixed(record.m_bookId);
+        out.putString(pathToBytes(record.m_images.front()));
+        break;
+    }
+}
+
+bool Journal::m_decode(BinaryReader &in, JournalRecord &record, std::size_t idSize) {
+    std::uint8_t op;
+    std::size_t size;
+    std::string_view bytes;
+    if (!in.getVarint(record.m_seq) || !in.getFixed(op)) return false;
+    record.m_op = static_cast<JournalOp>(op);
+    switch (record.m_op) {
+    case JournalOp::CreateBookTag:
+        return readTagId(in, record.m_tagId, idSize) && readTagId(in, record.m_groupId, idSize) &&
+            in.getString(record.m_name);
+    case JournalOp::CreateGroupTag:
+    case JournalOp::RenameBookTag:
+    case JournalOp::RenameGroupTag:
+        return readTagId(in, record.m_tagId, idSize) && in.getString(record.m_name);
+    case JournalOp::EraseBookTag:
+    case JournalOp::EraseGroupTag:
+        return readTagId(in, record.m_tagId, idSize);
+    case JournalOp::AddBook:
+    case JournalOp::AddArchiveBook:
+        if (!in.getFixed(record.m_bookId) || !in.getCount(size)) return false;
+        record.m_images.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            if (!in.getStringView(bytes)) return false;
+            record.m_images.emplace_back(bytesToPath(bytes));
+        }
+        if (!in.getCount(size, idSize)) return false;
+        record.m_tags.resize(size);
+        for (auto &tag : record.m_tags) readTagId(in, tag, idSize);
+        return !in.fail();
+    case JournalOp::EraseBook:
+        return in.getFixed(record.m_bookId);
+    case JournalOp::AddBookTag:
+    case JournalOp::RemoveBookTag:
+        return in.getFixed(record.m_bookId) && readTagId(in, record.m_tagId, idSize);
+    case JournalOp::RemoveBookTags:
+        return in.getFixed(record.m_bookId) && readTagId(in, record.m_groupId, idSize);
+    case JournalOp::SetBookTitle:
+        return in.getFixed(record.m_bookId) && in.getString(record.m_name);
+    case JournalOp::AddBookPage:
+    case JournalOp::RemoveBookPage:
+        if (!in.getFixed(record.m_bookId) || !in.getStringView(bytes)) return false;
+        record.m_images.emplace_back(bytesToPath(bytes));
+        return true;
+    }
+    return false;
+}
+
+std::size_t Journal::m_scan(std::span<const std::byte> data, std::uint64_t after,
+    const std::function<bool(const JournalRecord &)> &apply, std::uint64_t &lastSeq, bool &ok, std::size_t idSize) {
+    auto pos = headerSize;
+    while (data.size() - pos >= recordHeaderSize) {
+        BinaryReader header(data.subspan(pos, recordHeaderSize));
+        std::uint32_t size = 0U, crc = 0U;
+        header.getFixed(size);
+        header.getFixed(crc);
+        if (size > data.size() - pos - recordHeaderSize) break;
+        auto body = data.subspan(pos + recordHeaderSize, size);
+        if (crc32c(body) != crc) break;
+
+        JournalRecord record;
+        BinaryReader in(body);
+        if (!m_decode(in, record, idSize) || !in.atEnd()) break;
+        pos += recordHeaderSize + size;
+        if (record.m_seq <= after) continue;
+        lastSeq = record.m_seq;
+        if (apply && !apply(record)) {
+            ok = false;
+            break;
+        }
+    }
+    return pos;
+}
+
+bool Journal::m_widen(const fs::path &path, std::span<const std::byte> data, std::size_t idSize) {
+    auto header = encodeHeader();
+    BinaryWriter out;
+    out.putBytes(std::as_bytes(std::span(header.data(), header.size())));
+    std::uint64_t lastSeq = 0U;
+    bool ok = true;
+    // 完整的记录按原序号重新编码，末尾残缺的部分随之丢弃
+    m_scan(data, 0U, [&out](const JournalRecord &record) {
+        m_encodeRecord(out, record, record.m_seq);
+        return true;
+    }, lastSeq, ok, idSize);
+
+    // 先写入临时文件再改名，中途失败时旧日志保持不变
+    return replaceFile(path, out.getData());
+}
+/* ====== END ====== */
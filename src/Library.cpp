@@ -0,0 +1,449 @@
+#include "Library.h"
+#include <algorithm>
+#include <limits>
+#include <system_error>
+#include "Profiler.h"
+
+using namespace book;
+
+/* 漫画库辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    // 书籍的默认标题：目录名，或去掉扩展名的压缩包名
+    std::string defaultTitle(const fs::path &path) {
+        auto name = path.has_filename() ? path : path.parent_path();
+        auto str = (isArchiveFile(name) ? name.stem() : name.filename()).u8string();
+        return std::string(str.begin(), str.end());
+    }
+}
+/* ====== END ====== */
+
+/* class Library */
+/* ===== BEGIN ===== */
+// 构造函数
+Library::Library(const fs::path &root)
+    : m_root(root), m_store([&root] {
+        // 对象路径会写入数据文件，使用规范的绝对路径，避免根目录写法不同时引用数对不上
+        std::error_code ec;
+        auto objects = fs::weakly_canonical(root / ".data" / "objects", ec);
+        return ec ? root / ".data" / "objects" : objects;
+    }()), m_books(1), m_curSumOfBooks(0U), m_curMaxBook(nullBookId), m_journalSeq(0U) {
+    m_tagManager.setJournal(&m_journal);
+}
+
+// 析构函数
+Library::~Library() {
+    waitForCompaction();
+}
+
+// 公有函数
+void Library::clear() {
+    m_tagManager.clear();
+    m_tagIndex.clear();
+    m_titleIndex.clear();
+    m_books.clear();
+    m_books.resize(1);
+    m_curSumOfBooks = 0U;
+    m_curMaxBook = nullBookId;
+    m_erasedBooks = BookIdHeap();
+    m_journalSeq = 0U;
+    m_store.clearRefs();
+}
+
+bool Library::read() {
+    waitForCompaction();
+    m_journal.close();
+    if (!read(getDataPath()) && fs::exists(getDataPath())) return false;
+
+    // 依次重放上次压缩未完成时留下的旧日志与当前日志，跳过数据文件已包含的记录
+    auto oldPath = m_getOldJournalPath();
+    auto hasOld = fs::exists(oldPath);
+    auto apply = [this](const JournalRecord &record) { return m_applyRecord(record); };
+    auto seq = m_journalSeq;
+    if (!Journal::replay(oldPath, seq, apply, seq) || !Journal::replay(getJournalPath(), seq, apply, seq)) {
+        clear();
+        return false;
+    }
+    m_journalSeq = seq;
+    if (!m_journal.open(getJournalPath(), seq)) return false;
+    return hasOld ? compact(false) : true;
+}
+
+bool Library::write() const {
+    return write(getDataPath());
+}
+
+bool Library::read(const fs::path &path) {
+    ScopedTimer timer(ProbeId::LibraryRead);
+    clear();
+    // 一次性读入整个文件并校验，之后全部在内存中解析
+    FileHeader header;
+    std::string buffer;
+    std::span<const std::byte> body;
+    if (!readDataFile(path, fileMagic, fileVersion, header, buffer, body)) return false;
+    // 头部记录写入时的标签ID字节数，较窄的旧文件在读入时扩宽，下次写入即为当前宽度
+    if (!checkTagIdSize(header.m_flags)) return false;
+    BinaryReader in(body);
+
+    std::size_t size;
+    std::uint64_t sum;
+    if (header.m_version >= 2U && !in.getVarint(m_journalSeq)) return false;
+    if (!m_tagManager.read(in, header.m_flags) || !in.getVarint(sum) || !in.getFixed(m_curMaxBook) ||
+        !in.getCount(size, sizeof(BookIdType))) { clear(); return false; }
+    m_curSumOfBooks = static_cast<std::size_t>(sum);
+    BookIdType tmp;
+    for (decltype(size) i = 0; i < size; ++i) {
+        if (!in.getFixed(tmp)) { clear(); return false; }
+        m_erasedBooks.push(tmp);
+    }
+
+    // 书籍数量不可能超过剩余字节数，避免损坏的文件导致超大分配
+    if (m_curSumOfBooks > in.getRemaining()) { clear(); return false; }
+    m_books.resize(std::size_t(m_curMaxBook) + 1U);
+    for (decltype(m_curSumOfBooks) i = 0; i < m_curSumOfBooks; ++i) {
+        Book book;
+        // 重复的书籍ID会覆盖先读入的书籍并使书籍数量与书籍表不符
+        if (!book.read(in, &m_tagManager, header.m_version, header.m_flags) || !m_checkIndex(book.getBookId()) ||
+            checkBookId(book.getBookId())) {
+            clear();
+            return false;
+        }
+        m_insertBook(std::move(book));
+    }
+    if (!in.atEnd()) { clear(); return false; }
+    return true;
+}
+
+bool Library::write(const fs::path &path) const {
+    ScopedTimer timer(ProbeId::LibraryWrite);
+    // 先在内存中组装整个文件，再一次性写出
+    BinaryWriter out;
+    if (!m_encode(out)) return false;
+    FileHeader header{ fileMagic, fileVersion, std::uint16_t(sizeof(TagIdType)) };
+    return writeDataFile(path, header, out);
+}
+
+bool Library::compact(bool background) {
+    waitForCompaction();
+    if (!m_journal.isOpen()) return write();
+
+    BinaryWriter out;
+    if (!m_encode(out)) return false;
+    // 旧日志还在说明上次压缩没有完成，其中的记录尚未写入数据文件，此时不能覆盖，只在写入成功后删除
+    auto oldPath = m_getOldJournalPath();
+    if (!fs::exists(oldPath) && !m_journal.rotate(oldPath)) return false;
+    auto task = [path = getDataPath(), oldPath, out = std::move(out)] {
+        FileHeader header{ fileMagic, fileVersion, std::uint16_t(sizeof(TagIdType)) };
+        if (!writeDataFile(path, header, out)) return false;
+        std::error_code ec;
+        fs::remove(oldPath, ec);
+        return true;
+    };
+    if (!background) return task();
+    m_compaction = std::async(std::launch::async, std::move(task));
+    return true;
+}
+
+bool Library::waitForCompaction() {
+    return m_compaction.valid() ? m_compaction.get() : true;
+}
+
+Journal &Library::getJournal() {
+    return m_journal;
+}
+
+
+const fs::path &Library::getRoot() const {
+    return m_root;
+}
+
+fs::path Library::getDataPath() const {
+    return m_root / ".data" / "list.dat";
+}
+
+fs::path Library::getSnapshotPath() const {
+    return m_root / ".data" / "list.snap";
+}
+
+fs::path Library::getJournalPath() const {
+    return m_root / ".data" / "list.journal";
+}
+
+fs::path Library::getPerceptualHashPath() const {
+    return m_root / ".data" / "phash.dat";
+}
+
+ContentStore &Library::getContentStore() {
+    return m_store;
+}
+
+const ContentStore &Library::getContentStore() const {
+    return m_store;
+}
+
+void Library::setContentAddressed(bool enable) {
+    m_contentAddressed = enable;
+}
+
+bool Library::isContentAddressed() const {
+    return m_contentAddressed;
+}
+
+BookIdType Library::addBook(const fs::path &bookPath, const TagIdList &tags) {
+    auto id = m_getNewId();
+    if (id == nullBookId) return id;
+    Book book(bookPath, &m_tagManager, id, tags);
+    book.setTitle(defaultTitle(bookPath));
+    return m_logAddBook(m_insertBook(std::move(book)));
+}
+
+BookIdType Library::addBook(std::vector<fs::path> &&images, const TagIdList &tags) {
+    auto id = m_getNewId();
+    if (id == nullBookId) return id;
+    return m_logAddBook(m_insertBook(Book(std::move(images), &m_tagManager, id, tags)));
+}
+
+BookIdType Library::importBook(const fs::path &srcPath, const fs::path &name,
+    const TagIdList &tags, bool removeOldFile) {
+    auto id = m_getNewId();
+    if (id == nullBookId) return id;
+    auto fail = [this, id] {
+        m_erasedBooks.push(id);
+        --m_curSumOfBooks;
+        return nullBookId;
+    };
+    if (m_contentAddressed && !isArchiveFile(srcPath)) {
+        // 图像存入内容存储后书籍直接引用对象，引用数在登记时累加
+        ImagesManager source(srcPath);
+        std::vector<fs::path> images;
+        images.reserve(source.getSumOfImages());
+        for (std::size_t i = 0; i < source.getSumOfImages(); ++i) images.emplace_back(source.getImagePath(i));
+        if (!m_store.import(images, removeOldFile)) return fail();
+        Book book(std::move(images), &m_tagManager, id, tags);
+        book.setTitle(defaultTitle(name.empty() ? srcPath : name));
+        return m_logAddBook(m_insertBook(std::move(book)));
+    }
+    // 先登记源文件再整批传输，传输失败时文件已回滚，归还书籍ID
+    Book book(srcPath, &m_tagManager, id, tags);
+    auto destPath = m_root / name;
+    if (!(removeOldFile ? book.move(destPath) : book.copy(destPath, true))) return fail();
+    book.setTitle(defaultTitle(name.empty() ? srcPath : name));
+    return m_logAddBook(m_insertBook(std::move(book)));
+}
+
+bool Library::eraseBook(BookIdType id, bool removeFiles) {
+    if (!checkBookId(id)) return false;
+    auto &book = m_books[id];
+    m_tagIndex.removeBook(id, book.getTags());
+    m_titleIndex.removeBook(id);
+    book.clear(removeFiles);
+    PageCache::global().erase(id);
+    book = Book();
+    m_erasedBooks.push(id);
+    --m_curSumOfBooks;
+    m_journal.append({ .m_op = JournalOp::EraseBook, .m_bookId = id });
+    return true;
+}
+
+bool Library::checkBookId(BookIdType id) const {
+    return m_checkIndex(id) && m_books[id].getBookId() != nullBookId;
+}
+
+Book *Library::getBook(BookIdType id) {
+    return checkBookId(id) ? &m_books[id] : nullptr;
+}
+
+const Book *Library::getBook(BookIdType id) const {
+    return checkBookId(id) ? &m_books[id] : nullptr;
+}
+
+std::size_t Library::getSumOfBooks() const {
+    return m_curSumOfBooks;
+}
+
+std::unique_ptr<BookIdList> Library::getBooks() const {
+    std::unique_ptr<BookIdList> ret(new BookIdList());
+    ret->reserve(m_curSumOfBooks);
+    for (const auto &book : m_books) {
+        if (book.getBookId() == nullBookId) continue;
+        ret->emplace_back(book.getBookId());
+    }
+    return ret;
+}
+
+TagManager &Library::getTagManager() {
+    return m_tagManager;
+}
+
+const TagManager &Library::getTagManager() const {
+    return m_tagManager;
+}
+
+const TagIndex &Library::getTagIndex() const {
+    return m_tagIndex;
+}
+
+BookIdList Library::search(const TagQuery &query) const {
+    return m_tagIndex.search(query);
+}
+
+const TitleIndex &Library::getTitleIndex() const {
+    return m_titleIndex;
+}
+
+BookIdList Library::searchTitle(std::string_view query, std::size_t limit) const {
+    BookIdList ret;
+    for (const auto &match : m_titleIndex.search(query, limit)) ret.emplace_back(match.m_bookId);
+    return ret;
+}
+
+bool Library::eraseBookTag(TagIdType tagId) {
+    if (!m_tagManager.checkTagId(tagId)) return false;
+    // 书籍上的移除不单独记录，重放 EraseBookTag 时会经由本函数再次移除
+    for (auto id : m_tagIndex.getBooks(tagId).toList()) {
+        auto &book = m_books[id];
+        book.setJournal(nullptr);
+        book.removeTag(tagId);
+        book.setJournal(&m_journal);
+    }
+    m_tagIndex.eraseTag(tagId);
+    return m_tagManager.eraseBookTag(tagId);
+}
+
+bool Library::compactTags(TagIdList *remap) {
+    auto table = m_tagManager.compactBookTags();
+    if (remap) *remap = table;
+    if (table.empty()) return true;
+    m_tagIndex.clear();
+    for (auto &book : m_books) {
+        if (book.getBookId() == nullBookId) continue;
+        book.remapTags(table);
+        m_tagIndex.addBook(book.getBookId(), book.getTags());
+    }
+    // 旧日志中的记录使用旧ID，必须在追加新记录之前合并进数据文件
+    return !m_journal.isOpen() || compact(false);
+}
+
+// 私有函数
+BookIdType Library::m_getNewId() {
+    if (!m_erasedBooks.empty()) {
+        auto id = m_erasedBooks.top(); m_erasedBooks.pop();
+        ++m_curSumOfBooks;
+        return id;
+    } else if (m_curMaxBook < std::numeric_limits<BookIdType>::max()) {
+        ++m_curSumOfBooks;
+        ++m_curMaxBook;
+        if (m_books.size() <= m_curMaxBook) m_books.resize(std::size_t(m_curMaxBook) + 1U);
+        return m_curMaxBook;
+    } else {
+        return nullBookId;
+    }
+}
+
+BookIdType Library::m_insertBook(Book &&book) {
+    auto id = book.getBookId();
+    m_books[id] = std::move(book);
+    m_books[id].setTagIndex(&m_tagIndex);
+    m_books[id].setTitleIndex(&m_titleIndex);
+    m_books[id].setContentStore(&m_store);
+    m_books[id].setJournal(&m_journal);
+    return id;
+}
+
+BookIdType Library::m_logAddBook(BookIdType id) {
+    if (!m_journal.isOpen()) return id;
+    const auto &book = m_books[id];
+    auto tags = book.getTags();
+    if (book.isArchive()) {
+        // 条目索引重放时重新从压缩包解析，不写入日志
+        m_journal.append({ .m_op = JournalOp::AddArchiveBook, .m_bookId = id,
+            .m_images = { book.getArchivePath() }, .m_tags = TagIdList(tags.begin(), tags.end()) });
+    } else {
+        JournalRecord record{ .m_op = JournalOp::AddBook, .m_bookId = id, .m_tags = TagIdList(tags.begin(), tags.end()) };
+        record.m_images.reserve(book.getSumOfImages());
+        for (std::size_t i = 0; i < book.getSumOfImages(); ++i) record.m_images.emplace_back(book.getImagePath(i));
+        m_journal.append(record);
+    }
+    if (!book.getTitle().empty()) {
+        m_journal.append({ .m_op = JournalOp::SetBookTitle, .m_bookId = id, .m_name = book.getTitle() });
+    }
+    return id;
+}
+
+bool Library::m_checkIndex(BookIdType id) const {
+    return id != nullBookId && id <= m_curMaxBook && id < m_books.size();
+}
+bool Library::m_encode(BinaryWriter &out) const {
+    out.putVarint(std::max(m_journalSeq, m_journal.getSequence()));
+    m_tagManager.write(out);
+    out.putVarint(m_curSumOfBooks);
+    out.putFixed(m_curMaxBook);
+    auto tmpHeap = m_erasedBooks;
+    out.putVarint(tmpHeap.size());
+    while (!tmpHeap.empty()) {
+        out.putFixed(tmpHeap.top()); tmpHeap.pop();
+    }
+    for (const auto &book : m_books) {
+        if (book.getBookId() == nullBookId) continue;
+        if (!book.write(out)) return false;
+    }
+    return true;
+}
+
+fs::path Library::m_getOldJournalPath() const {
+    return m_root / ".data" / "list.journal.old";
+}
+
+bool Library::m_applyRecord(const JournalRecord &record) {
+    auto book = getBook(record.m_bookId);
+    switch (record.m_op) {
+    case JournalOp::CreateBookTag:
+        return m_tagManager.createBookTag(record.m_name, record.m_groupId) == record.m_tagId;
+    case JournalOp::CreateGroupTag:
+        return m_tagManager.createGroupTag(record.m_name) == record.m_tagId;
+    case JournalOp::EraseBookTag:
+        return eraseBookTag(record.m_tagId);
+    case JournalOp::EraseGroupTag:
+        return m_tagManager.eraseGroupTag(record.m_tagId);
+    case JournalOp::RenameBookTag:
+        return m_tagManager.renameBookTag(record.m_tagId, record.m_name);
+    case JournalOp::RenameGroupTag:
+        return m_tagManager.renameGroupTag(record.m_tagId, record.m_name);
+    case JournalOp::AddBook: {
+        // 书籍ID的分配是确定的，重放时必须得到相同的ID
+        if (m_getNewId() != record.m_bookId) return false;
+        auto images = record.m_images;
+        m_insertBook(Book(std::move(images), &m_tagManager, record.m_bookId, record.m_tags));
+        return true;
+    }
+    case JournalOp::AddArchiveBook: {
+        if (m_getNewId() != record.m_bookId || record.m_images.size() != 1U) return false;
+        m_insertBook(Book(record.m_images.front(), &m_tagManager, record.m_bookId, record.m_tags));
+        return true;
+    }
+    case JournalOp::EraseBook:
+        return eraseBook(record.m_bookId);
+    case JournalOp::AddBookTag:
+        if (book) book->addTag(record.m_tagId);
+        return book != nullptr;
+    case JournalOp::RemoveBookTag:
+        if (book) book->removeTag(record.m_tagId);
+        return book != nullptr;
+    case JournalOp::RemoveBookTags:
+        if (book) book->removeTags(record.m_groupId);
+        return book != nullptr;
+    case JournalOp::SetBookTitle:
+        if (book) book->setTitle(record.m_name);
+        return book != nullptr;
+    case JournalOp::AddBookPage:
+        return book && record.m_images.size() == 1U && book->addPage(record.m_images.front());
+    case JournalOp::RemoveBookPage:
+        if (!book || record.m_images.size() != 1U) return false;
+        for (std::size_t i = 0; i < book->getSumOfImages(); ++i) {
+            if (book->getImagePath(i) == record.m_images.front()) return book->removePage(i);
+        }
+        return false;
+    }
+    return false;
+}
+/* ====== END ====== */
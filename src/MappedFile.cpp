@@ -0,0 +1,138 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <utility>
+
+#ifdef __linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace book;
+
+/* class MappedFile */
+/* ===== BEGIN ===== */
+// 构造函数
+MappedFile::MappedFile(const fs::path &path, AccessHint hint) {
+    open(path, hint);
+}
+
+MappedFile::MappedFile(std::string &&buffer)
+    : m_size(buffer.size()), m_isOpen(true), m_buffer(std::move(buffer)) {
+    if (!m_buffer.empty()) m_data = reinterpret_cast<const std::byte *>(m_buffer.data());
+}
+
+MappedFile::MappedFile(MappedFile &&file) noexcept
+    : m_data(std::exchange(file.m_data, nullptr)), m_size(std::exchange(file.m_size, 0U)),
+    m_pageOffset(std::exchange(file.m_pageOffset, 0U)), m_isOpen(std::exchange(file.m_isOpen, false)), m_buffer(std::move(file.m_buffer)) {
+    // 内容储存在 m_buffer 内时，移动后需要重新指向新的缓冲区
+    if (!m_buffer.empty()) m_data = reinterpret_cast<const std::byte *>(m_buffer.data());
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&file) noexcept {
+    if (this == &file) return *this;
+    close();
+    m_data = std::exchange(file.m_data, nullptr);
+    m_size = std::exchange(file.m_size, 0U);
+    m_pageOffset = std::exchange(file.m_pageOffset, 0U);
+    m_isOpen = std::exchange(file.m_isOpen, false);
+    m_buffer = std::move(file.m_buffer);
+    if (!m_buffer.empty()) m_data = reinterpret_cast<const std::byte *>(m_buffer.data());
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// 公有函数
+bool MappedFile::open(const fs::path &path, AccessHint hint) {
+    return open(path, 0U, std::numeric_limits<std::size_t>::max(), hint);
+}
+
+bool MappedFile::open(const fs::path &path, std::uint64_t offset, std::size_t length, AccessHint hint) {
+    close();
+#ifdef __linux
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || offset > static_cast<std::uint64_t>(st.st_size)) {
+        ::close(fd);
+        return false;
+    }
+    auto rest = static_cast<std::uint64_t>(st.st_size) - offset;
+    if (length == std::numeric_limits<std::size_t>::max()) length = static_cast<std::size_t>(rest);
+    else if (length > rest) {
+        ::close(fd);
+        return false;
+    }
+    if (length == 0U) {
+        // 空内容无法映射，视为打开成功的空内容
+        ::close(fd);
+        m_isOpen = true;
+        return true;
+    }
+    // mmap 的偏移必须按页对齐，多映射的部分由 m_pageOffset 跳过
+    static const auto pageSize = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    auto pageOffset = static_cast<std::size_t>(offset % pageSize);
+    void *addr = ::mmap(nullptr, length + pageOffset, PROT_READ, MAP_PRIVATE, fd,
+        static_cast<off_t>(offset - pageOffset));
+    ::close(fd);        // 映射建立后即可关闭文件描述符
+    if (addr == MAP_FAILED) return false;
+    if (hint == AccessHint::Sequential) {
+        ::madvise(addr, length + pageOffset, MADV_SEQUENTIAL);
+        ::madvise(addr, length + pageOffset, MADV_WILLNEED);
+    } else if (hint == AccessHint::Random) {
+        ::madvise(addr, length + pageOffset, MADV_RANDOM);
+    }
+    m_data = static_cast<const std::byte *>(addr) + pageOffset;
+    m_size = length;
+    m_pageOffset = pageOffset;
+    m_isOpen = true;
+    return true;
+#else
+    (void)hint;
+    std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (fin.fail()) return false;
+    auto size = static_cast<std::uint64_t>(fin.tellg());
+    if (offset > size) return false;
+    if (length == std::numeric_limits<std::size_t>::max()) length = static_cast<std::size_t>(size - offset);
+    else if (length > size - offset) return false;
+    m_buffer.resize(length);
+    fin.seekg(static_cast<std::streamoff>(offset));
+    fin.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    if (fin.fail()) {
+        m_buffer.clear();
+        return false;
+    }
+    m_data = reinterpret_cast<const std::byte *>(m_buffer.data());
+    m_size = m_buffer.size();
+    m_isOpen = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef __linux
+    if (m_data && m_buffer.empty()) ::munmap(const_cast<std::byte *>(m_data - m_pageOffset), m_size + m_pageOffset);
+#endif
+    m_data = nullptr;
+    m_size = 0U;
+    m_pageOffset = 0U;
+    m_isOpen = false;
+    m_buffer.clear();
+}
+
+bool MappedFile::isOpen() const {
+    return m_isOpen;
+}
+
+std::span<const std::byte> MappedFile::getData() const {
+    return { m_data, m_size };
+}
+
+std::size_t MappedFile::getSize() const {
+    return m_size;
+}
+/* ====== END ====== */
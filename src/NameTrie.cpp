@@ -0,0 +1,314 @@
+#include "NameTrie.h"
+#include "TitleIndex.h"
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+using namespace book;
+
+/* 前缀树辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint32_t noRow = std::numeric_limits<std::uint32_t>::max();
+
+    // 将名字规范化后解码为码位，normalizeTitle 的输出总是合法的 UTF-8
+    std::u32string toKey(std::string_view name) {
+        auto normalized = normalizeTitle(name);
+        std::u32string ret;
+        ret.reserve(normalized.size());
+        for (std::size_t pos = 0; pos < normalized.size(); ) {
+            auto lead = static_cast<unsigned char>(normalized[pos]);
+            std::size_t length = lead < 0x80U ? 1U : lead < 0xe0U ? 2U : lead < 0xf0U ? 3U : 4U;
+            char32_t cp = length == 1U ? lead : lead & (0x7fU >> length);
+            for (std::size_t i = 1; i < length; ++i) cp = (cp << 6U) | (static_cast<unsigned char>(normalized[pos + i]) & 0x3fU);
+            ret.push_back(cp);
+            pos += length;
+        }
+        return ret;
+    }
+
+    std::uint64_t scopeBit(std::uint32_t scope) {
+        return std::uint64_t(1U) << (scope & 63U);
+    }
+
+    // 待展开的结点或待产出的结果，按（距离下界，长度下界，结点先于结果，值）从小到大出队
+    struct Candidate {
+        std::uint32_t m_distance;   // 结点：子树内结果距离的下界；结果：距离
+        std::uint32_t m_length;     // 结点：子树内名字长度的下界；结果：名字长度
+        bool m_isEntry;             // 是否为结果
+        std::uint32_t m_index;      // 结点下标或结果的值
+        std::uint32_t m_depth;      // 结点：从根到此结点末尾的码位数
+        std::uint32_t m_best;       // 结点：父结点路径上的最小距离
+        std::uint32_t m_row;        // 结点：父结点的 DP 行在 rows 内的起始位置，noRow 表示不再需要计算
+
+        bool operator>(const Candidate &other) const {
+            return std::tie(m_distance, m_length, m_isEntry, m_index) >
+                std::tie(other.m_distance, other.m_length, other.m_isEntry, other.m_index);
+        }
+    };
+}
+/* ====== END ====== */
+
+/* class NameTrie */
+/* ===== BEGIN ===== */
+// 构造函数
+NameTrie::NameTrie() : m_nodes(1), m_freeNodes(), m_size(0U) {}
+
+// 公有函数
+void NameTrie::clear() {
+    m_nodes.assign(1, Node());
+    m_freeNodes.clear();
+    m_size = 0U;
+}
+
+void NameTrie::insert(std::string_view name, std::uint32_t value, std::uint32_t scope) {
+    auto key = toKey(name);
+    auto bit = scopeBit(scope);
+    std::uint32_t node = 0U;
+    // 沿路径更新摘要，pos 为已经过的码位数
+    auto update = [this, bit, &key](std::uint32_t node, std::size_t pos) {
+        auto &cur = m_nodes[node];
+        auto rest = static_cast<std::uint32_t>(key.size() - pos);
+        cur.m_minLength = cur.m_scopeMask == 0U ? rest : std::min(cur.m_minLength, rest);
+        cur.m_scopeMask |= bit;
+    };
+    update(node, 0U);
+    for (std::size_t pos = 0; pos < key.size(); ) {
+        auto child = m_findChild(node, key[pos]);
+        if (child == nullNode) {
+            // 剩余部分整个作为新的叶结点
+            child = m_newNode(std::u32string_view(key).substr(pos));
+            m_insertChild(node, child);
+            update(child, key.size());
+            node = child;
+            break;
+        }
+        const auto &label = m_nodes[child].m_label;
+        std::size_t common = 1U;
+        while (common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) ++common;
+        if (common < label.size()) m_split(child, common);
+        pos += common;
+        update(child, pos);
+        node = child;
+    }
+    m_nodes[node].m_entries.emplace_back(Entry{ value, scope });
+    ++m_size;
+}
+
+bool NameTrie::erase(std::string_view name, std::uint32_t value) {
+    auto key = toKey(name);
+    std::vector<std::uint32_t> path{ 0U };
+    for (std::size_t pos = 0; pos < key.size(); ) {
+        auto child = m_findChild(path.back(), key[pos]);
+        if (child == nullNode) return false;
+        const auto &label = m_nodes[child].m_label;
+        if (key.compare(pos, label.size(), label) != 0) return false;
+        pos += label.size();
+        path.push_back(child);
+    }
+    auto &entries = m_nodes[path.back()].m_entries;
+    auto it = std::find_if(entries.begin(), entries.end(), [value](const Entry &entry) { return entry.m_value == value; });
+    if (it == entries.end()) return false;
+    entries.erase(it);
+    --m_size;
+
+    // 自下而上整理路径：删除空叶结点，合并只剩一个子结点的结点
+    for (auto i = path.size() - 1U; i > 0U; --i) {
+        auto node = path[i];
+        if (m_nodes[node].m_entries.empty() && m_nodes[node].m_children.empty()) {
+            m_removeChild(path[i - 1U], node);
+            m_freeNode(node);
+            continue;
+        }
+        if (m_nodes[node].m_entries.empty() && m_nodes[node].m_children.size() == 1U) m_merge(node);
+        m_updateSummary(node);
+    }
+    m_updateSummary(0U);
+    return true;
+}
+
+std::size_t NameTrie::size() const {
+    return m_size;
+}
+
+bool NameTrie::empty() const {
+    return m_size == 0U;
+}
+
+std::size_t NameTrie::getMemoryUsage() const {
+    std::size_t ret = m_nodes.capacity() * sizeof(Node) + m_freeNodes.capacity() * sizeof(std::uint32_t);
+    for (const auto &node : m_nodes) {
+        // 短标签储存在 std::u32string 对象内部，不另外分配
+        if (node.m_label.capacity() > std::u32string().capacity()) ret += (node.m_label.capacity() + 1U) * sizeof(char32_t);
+        ret += node.m_children.capacity() * sizeof(std::uint32_t) + node.m_entries.capacity() * sizeof(Entry);
+    }
+    return ret;
+}
+
+NameTrie::MatchList NameTrie::complete(std::string_view prefix, std::size_t limit, std::uint32_t scope) const {
+    return match(prefix, 0U, limit, scope);
+}
+
+NameTrie::MatchList NameTrie::match(std::string_view query, unsigned distance, std::size_t limit,
+    std::uint32_t scope) const {
+    MatchList ret;
+    if (m_size == 0U) return ret;
+    auto key = toKey(query);
+    distance = std::min(distance, maxDistance);
+    // DP 的值超过 distance 后只需知道其超出，截断为 distance + 1，保证不溢出
+    const auto cap = static_cast<std::uint8_t>(distance + 1U);
+    const auto width = key.size() + 1U;
+    auto bit = scopeBit(scope);
+
+    /*
+     * rows 内按 width 分段储存已展开结点末尾的 DP 行
+     * 第 j 列为查询的前 j 个码位与当前路径的编辑距离；best 为路径上各前缀与整个查询的最小距离
+     * 路径的任何延伸都不会使一行的最小值变小，因此最小值不小于 best 时停止计算，子树内结果的距离都为 best
+     */
+    std::vector<std::uint8_t> rows(width);
+    for (std::size_t j = 0; j < width; ++j) rows[j] = static_cast<std::uint8_t>(std::min<std::size_t>(j, cap));
+    std::vector<Candidate> storage;
+    storage.reserve(256U);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> queue(std::greater<>(), std::move(storage));
+    queue.push(Candidate{ 0U, m_nodes[0].m_minLength, false, 0U, 0U, rows[width - 1U], 0U });
+    std::vector<std::uint8_t> row(width);
+    while (!queue.empty()) {
+        auto cur = queue.top(); queue.pop();
+        if (cur.m_isEntry) {
+            ret.emplace_back(Match{ cur.m_index, cur.m_distance });
+            if (limit != 0U && ret.size() >= limit) break;
+            continue;
+        }
+        const auto &node = m_nodes[cur.m_index];
+        auto best = cur.m_best;
+        auto rowPos = cur.m_row;
+        auto minimum = best;
+        if (rowPos != noRow) {
+            // 沿边上的码位逐个计算 DP 行
+            std::copy_n(rows.begin() + rowPos, width, row.begin());
+            minimum = *std::min_element(row.begin(), row.end());
+            bool pruned = false;
+            for (auto cp : node.m_label) {
+                auto diagonal = row[0];
+                row[0] = static_cast<std::uint8_t>(std::min<unsigned>(row[0] + 1U, cap));
+                minimum = row[0];
+                for (std::size_t j = 1; j < width; ++j) {
+                    auto value = std::min<unsigned>({ row[j] + 1U, row[j - 1U] + 1U, diagonal + (key[j - 1U] != cp ? 1U : 0U) });
+                    diagonal = row[j];
+                    row[j] = static_cast<std::uint8_t>(std::min<unsigned>(value, cap));
+                    minimum = std::min<std::uint32_t>(minimum, row[j]);
+                }
+                best = std::min<std::uint32_t>(best, row[width - 1U]);
+                if (minimum >= best) break;
+                if (minimum > distance && best > distance) { pruned = true; break; }
+            }
+            if (pruned) continue;
+            if (minimum >= best) {
+                rowPos = noRow;
+            } else if (!node.m_label.empty()) {
+                rowPos = static_cast<std::uint32_t>(rows.size());
+                rows.insert(rows.end(), row.begin(), row.end());
+            }
+        }
+        if (best <= distance) {
+            for (const auto &entry : node.m_entries) {
+                if (scope != anyScope && entry.m_scope != scope) continue;
+                queue.push(Candidate{ best, cur.m_depth, true, entry.m_value, cur.m_depth, best, noRow });
+            }
+        }
+        auto bound = rowPos == noRow ? best : std::min(best, minimum);
+        if (bound > distance) continue;
+        for (auto child : node.m_children) {
+            const auto &next = m_nodes[child];
+            if (scope != anyScope && !(next.m_scopeMask & bit)) continue;
+            auto depth = cur.m_depth + static_cast<std::uint32_t>(next.m_label.size());
+            queue.push(Candidate{ bound, depth + next.m_minLength, false, child, depth, best, rowPos });
+        }
+    }
+    return ret;
+}
+
+// 私有函数
+std::uint32_t NameTrie::m_newNode(std::u32string_view label) {
+    std::uint32_t node;
+    if (!m_freeNodes.empty()) {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        node = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[node].m_label = label;
+    return node;
+}
+
+void NameTrie::m_freeNode(std::uint32_t node) {
+    m_nodes[node] = Node();
+    m_freeNodes.push_back(node);
+}
+
+std::uint32_t NameTrie::m_findChild(std::uint32_t node, char32_t first) const {
+    const auto &children = m_nodes[node].m_children;
+    auto it = std::lower_bound(children.begin(), children.end(), first,
+        [this](std::uint32_t child, char32_t cp) { return m_nodes[child].m_label.front() < cp; });
+    if (it == children.end() || m_nodes[*it].m_label.front() != first) return nullNode;
+    return *it;
+}
+
+void NameTrie::m_insertChild(std::uint32_t node, std::uint32_t child) {
+    auto &children = m_nodes[node].m_children;
+    auto first = m_nodes[child].m_label.front();
+    auto it = std::lower_bound(children.begin(), children.end(), first,
+        [this](std::uint32_t other, char32_t cp) { return m_nodes[other].m_label.front() < cp; });
+    children.insert(it, child);
+}
+
+void NameTrie::m_removeChild(std::uint32_t node, std::uint32_t child) {
+    auto &children = m_nodes[node].m_children;
+    auto it = std::find(children.begin(), children.end(), child);
+    if (it != children.end()) children.erase(it);
+}
+
+void NameTrie::m_split(std::uint32_t node, std::size_t at) {
+    // 分配结点可能使结点表重新分配，先复制后半段
+    auto tail = m_newNode(std::u32string(m_nodes[node].m_label.substr(at)));
+    auto &head = m_nodes[node];
+    auto &rest = m_nodes[tail];
+    rest.m_children = std::move(head.m_children);
+    rest.m_entries = std::move(head.m_entries);
+    rest.m_scopeMask = head.m_scopeMask;
+    rest.m_minLength = head.m_minLength;
+    head.m_minLength += static_cast<std::uint32_t>(rest.m_label.size());
+    head.m_label.resize(at);
+    head.m_children.assign(1, tail);
+    head.m_entries.clear();
+}
+
+void NameTrie::m_merge(std::uint32_t node) {
+    auto child = m_nodes[node].m_children.front();
+    auto &head = m_nodes[node];
+    auto &rest = m_nodes[child];
+    head.m_label += rest.m_label;
+    head.m_children = std::move(rest.m_children);
+    head.m_entries = std::move(rest.m_entries);
+    head.m_scopeMask = rest.m_scopeMask;
+    head.m_minLength = rest.m_minLength;
+    m_freeNode(child);
+}
+
+void NameTrie::m_updateSummary(std::uint32_t node) {
+    auto &cur = m_nodes[node];
+    std::uint64_t mask = 0U;
+    auto minLength = std::numeric_limits<std::uint32_t>::max();
+    for (const auto &entry : cur.m_entries) mask |= scopeBit(entry.m_scope);
+    if (!cur.m_entries.empty()) minLength = 0U;
+    for (auto child : cur.m_children) {
+        const auto &next = m_nodes[child];
+        mask |= next.m_scopeMask;
+        minLength = std::min(minLength, static_cast<std::uint32_t>(next.m_label.size()) + next.m_minLength);
+    }
+    cur.m_scopeMask = mask;
+    cur.m_minLength = cur.m_children.empty() && cur.m_entries.empty() ? 0U : minLength;
+}
+/* ====== END ====== */
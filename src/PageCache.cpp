@@ -0,0 +1,153 @@
+#include "PageCache.h"
+#include <iterator>
+#include <limits>
+
+using namespace book;
+
+/* class PageCache */
+/* ===== BEGIN ===== */
+// 构造函数
+PageCache::PageCache(std::size_t budget, std::size_t sumOfShards) : m_budget(budget) {
+    if (sumOfShards == 0U) sumOfShards = 1U;
+    m_shards.reserve(sumOfShards);
+    for (std::size_t i = 0; i < sumOfShards; ++i) m_shards.emplace_back(new Shard());
+}
+
+PageCache &PageCache::global() {
+    static PageCache cache;
+    return cache;
+}
+
+std::size_t PageCache::PageKeyHash::operator()(const PageKey &key) const noexcept {
+    auto h = std::hash<std::string>()(key.m_path);
+    return h ^ (std::size_t(key.m_owner) * 0x9e3779b97f4a7c15ULL);
+}
+
+// 公有函数
+PageContent PageCache::get(const PageKey &key) {
+    auto &shard = m_getShard(key);
+    std::lock_guard lock(shard.m_mutex);
+    auto it = shard.m_map.find(key);
+    if (it == shard.m_map.end()) {
+        m_misses.fetch_add(1U, std::memory_order_relaxed);
+        return nullptr;
+    }
+    m_hits.fetch_add(1U, std::memory_order_relaxed);
+    it->second->m_stamp = m_clock.fetch_add(1U, std::memory_order_relaxed);
+    shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, it->second);
+    return it->second->m_content;
+}
+
+PageContent PageCache::getOrLoad(const PageKey &key, const Loader &loader) {
+    if (auto ret = get(key)) return ret;
+    // 在锁外读取，避免阻塞同一分片的其他访问
+    auto ret = loader();
+    if (ret) put(key, ret);
+    return ret;
+}
+
+void PageCache::put(const PageKey &key, PageContent content) {
+    if (!content || content->size() > m_budget.load(std::memory_order_relaxed)) return ;
+    auto &shard = m_getShard(key);
+    std::uint64_t stamp;
+    {
+        std::lock_guard lock(shard.m_mutex);
+        auto it = shard.m_map.find(key);
+        if (it != shard.m_map.end()) m_removeEntry(shard, it->second);
+        stamp = m_clock.fetch_add(1U, std::memory_order_relaxed);
+        shard.m_lru.push_front(Entry{ key, content, stamp });
+        shard.m_map.emplace(key, shard.m_lru.begin());
+        m_bytes.fetch_add(content->size(), std::memory_order_relaxed);
+        m_entries.fetch_add(1U, std::memory_order_relaxed);
+    }
+    m_evict(stamp);
+}
+
+void PageCache::erase(const PageKey &key) {
+    auto &shard = m_getShard(key);
+    std::lock_guard lock(shard.m_mutex);
+    auto it = shard.m_map.find(key);
+    if (it != shard.m_map.end()) m_removeEntry(shard, it->second);
+}
+
+void PageCache::erase(std::uint32_t owner) {
+    for (auto &shard : m_shards) {
+        std::lock_guard lock(shard->m_mutex);
+        for (auto it = shard->m_lru.begin(); it != shard->m_lru.end(); ) {
+            auto cur = it++;
+            if (cur->m_key.m_owner == owner) m_removeEntry(*shard, cur);
+        }
+    }
+}
+
+void PageCache::clear() {
+    for (auto &shard : m_shards) {
+        std::lock_guard lock(shard->m_mutex);
+        while (!shard->m_lru.empty()) m_removeEntry(*shard, shard->m_lru.begin());
+    }
+}
+
+void PageCache::setBudget(std::size_t budget) {
+    m_budget.store(budget, std::memory_order_relaxed);
+    m_evict();
+}
+
+std::size_t PageCache::getBudget() const {
+    return m_budget.load(std::memory_order_relaxed);
+}
+
+PageCacheStats PageCache::getStats() const {
+    PageCacheStats ret;
+    ret.m_hits = m_hits.load(std::memory_order_relaxed);
+    ret.m_misses = m_misses.load(std::memory_order_relaxed);
+    ret.m_evictions = m_evictions.load(std::memory_order_relaxed);
+    ret.m_bytes = m_bytes.load(std::memory_order_relaxed);
+    ret.m_entries = m_entries.load(std::memory_order_relaxed);
+    return ret;
+}
+
+// 私有函数
+std::size_t PageCache::m_getShardIndex(const PageKey &key) const {
+    return PageKeyHash()(key) % m_shards.size();
+}
+
+PageCache::Shard &PageCache::m_getShard(const PageKey &key) {
+    return *m_shards[m_getShardIndex(key)];
+}
+
+void PageCache::m_evict(std::uint64_t keep) {
+    // 每次只持有一个分片的锁：先找出各分片尾部中使用时刻最早的页面，再锁住其分片确认未被使用后淘汰
+    while (m_bytes.load(std::memory_order_relaxed) > m_budget.load(std::memory_order_relaxed)) {
+        Shard *oldest = nullptr;
+        auto oldestStamp = std::numeric_limits<std::uint64_t>::max();
+        for (auto &shard : m_shards) {
+            std::lock_guard lock(shard->m_mutex);
+            auto it = m_getVictim(*shard, keep);
+            if (it == shard->m_lru.end() || it->m_stamp >= oldestStamp) continue;
+            oldest = shard.get();
+            oldestStamp = it->m_stamp;
+        }
+        if (!oldest) return ;
+        std::lock_guard lock(oldest->m_mutex);
+        auto it = m_getVictim(*oldest, keep);
+        // 期间被其他线程使用或删除时重新查找
+        if (it == oldest->m_lru.end() || it->m_stamp != oldestStamp) continue;
+        m_removeEntry(*oldest, it);
+        m_evictions.fetch_add(1U, std::memory_order_relaxed);
+    }
+}
+
+PageCache::EntryList::iterator PageCache::m_getVictim(Shard &shard, std::uint64_t keep) {
+    if (shard.m_lru.empty()) return shard.m_lru.end();
+    auto it = std::prev(shard.m_lru.end());
+    if (it->m_stamp != keep) return it;
+    return it == shard.m_lru.begin() ? shard.m_lru.end() : std::prev(it);
+}
+
+void PageCache::m_removeEntry(Shard &shard, EntryList::iterator it) {
+    m_bytes.fetch_sub(it->m_content->size(), std::memory_order_relaxed);
+    m_entries.fetch_sub(1U, std::memory_order_relaxed);
+    shard.m_map.erase(it->m_key);
+    shard.m_lru.erase(it);
+}
+/* ====== END ====== */
@@ -0,0 +1,131 @@
+#include "PathArena.h"
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+using namespace book;
+
+namespace {
+    // 所有实例共用的修订号来源，移动后的实例不会与其他实例的修订号重复
+    std::atomic<std::uint64_t> nextRevision{ 1U };
+}
+
+/* class PathArena */
+/* ===== BEGIN ===== */
+fs::path PathArena::getRoot() const {
+    return fs::path(m_root);
+}
+
+void PathArena::setRoot(const fs::path &root) {
+    m_root = root.native();
+    m_touch();
+}
+
+void PathArena::add(const fs::path &path) {
+    m_entries.emplace_back(m_encode(path));
+    m_touch();
+}
+
+void PathArena::addRelative(const fs::path &name) {
+    m_entries.emplace_back(m_append(name.native(), true));
+    m_touch();
+}
+
+void PathArena::insert(std::size_t index, const fs::path &path) {
+    index = std::min(index, m_entries.size());
+    m_entries.insert(m_entries.begin() + static_cast<std::ptrdiff_t>(index), m_encode(path));
+    m_touch();
+}
+
+void PathArena::remove(std::size_t index) {
+    m_garbage += m_entries[index].m_length;
+    m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(index));
+    if (m_garbage > m_names.size() / 2U) m_compact();
+    m_touch();
+}
+
+void PathArena::swap(std::size_t index0, std::size_t index1) {
+    std::swap(m_entries[index0], m_entries[index1]);
+    m_touch();
+}
+
+void PathArena::clear() {
+    m_root.clear();
+    m_names.clear();
+    m_entries.clear();
+    m_garbage = 0U;
+    m_touch();
+}
+
+void PathArena::reserve(std::size_t count, std::size_t bytes) {
+    m_entries.reserve(count);
+    m_names.reserve(bytes);
+}
+
+std::size_t PathArena::size() const {
+    return m_entries.size();
+}
+
+bool PathArena::empty() const {
+    return m_entries.empty();
+}
+
+fs::path PathArena::getPath(std::size_t index) const {
+    auto name = getName(index);
+    if (!m_entries[index].m_rooted) return fs::path(name);
+    // 直接拼接字符串，只构造一次 fs::path
+    StringType path;
+    path.reserve(m_root.size() + 1U + name.size());
+    path.append(m_root);
+    if (!path.empty() && path.back() != fs::path::preferred_separator) path.push_back(fs::path::preferred_separator);
+    path.append(name);
+    return fs::path(std::move(path));
+}
+
+PathArena::ViewType PathArena::getName(std::size_t index) const {
+    auto &entry = m_entries[index];
+    return ViewType(m_names).substr(entry.m_offset, entry.m_length);
+}
+
+std::size_t PathArena::getMemoryUsage() const {
+    return (m_root.capacity() + m_names.capacity()) * sizeof(fs::path::value_type) + m_entries.capacity() * sizeof(Entry);
+}
+
+std::uint64_t PathArena::getRevision() const {
+    return m_revision;
+}
+
+// 私有函数
+PathArena::Entry PathArena::m_append(ViewType name, bool rooted) {
+    Entry entry{ static_cast<std::uint32_t>(m_names.size()), static_cast<std::uint32_t>(name.size()), rooted };
+    m_names.append(name);
+    return entry;
+}
+
+PathArena::Entry PathArena::m_encode(const fs::path &path) {
+    if (m_root.empty()) m_root = path.parent_path().native();
+    ViewType native(path.native()), root(m_root);
+    constexpr auto separator = fs::path::preferred_separator;
+    // 基准目录为根目录等以分隔符结尾的情况下，分隔符已包含在前缀内
+    auto prefix = root.size() + (!root.empty() && root.back() != separator ? 1U : 0U);
+    if (!root.empty() && native.size() > prefix && native.starts_with(root) &&
+        (prefix == root.size() || native[root.size()] == separator)) return m_append(native.substr(prefix), true);
+    return m_append(native, false);
+}
+
+void PathArena::m_compact() {
+    StringType names;
+    names.reserve(m_names.size() - m_garbage);
+    for (auto &entry : m_entries) {
+        auto offset = static_cast<std::uint32_t>(names.size());
+        names.append(m_names, entry.m_offset, entry.m_length);
+        entry.m_offset = offset;
+    }
+    m_names = std::move(names);
+    m_garbage = 0U;
+}
+
+void PathArena::m_touch() {
+    m_revision = nextRevision.fetch_add(1U, std::memory_order_relaxed);
+}
+/* ====== END ====== */
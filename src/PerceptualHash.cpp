@@ -0,0 +1,633 @@
+#include "PerceptualHash.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+#include "MappedFile.h"
+
+using namespace book;
+
+/* 缩略图辅助类 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint32_t gridWidth = 9U;     // 缩略图宽度，每行 8 个差值
+    constexpr std::uint32_t gridHeight = 8U;    // 缩略图高度
+    constexpr double flatThreshold = 2.0;       // 格子平均亮度（0 ~ 255）的极差低于此值时视为纯色页面
+    constexpr std::uint32_t maxDimension = 1U << 16;    // 解码时允许的最大宽高，避免损坏的文件导致超大分配
+
+    std::uint32_t readBE16(const std::uint8_t *p) { return (std::uint32_t(p[0]) << 8) | p[1]; }
+    std::uint32_t readBE32(const std::uint8_t *p) { return (readBE16(p) << 16) | readBE16(p + 2); }
+
+    // 将 RGB 转为亮度
+    int luma(int r, int g, int b) { return (77 * r + 150 * g + 29 * b) >> 8; }
+
+    /*
+     * class Thumbnail
+     * 将逐行送入的亮度按面积平均累加到 9×8 的格子内，不保留整张图像
+     */
+    class Thumbnail {
+    public:
+        // 图像宽 width、高 height，宽高至少为 9、8
+        Thumbnail(std::uint32_t width, std::uint32_t height) : m_height(height), m_columns(width) {
+            for (std::uint32_t x = 0; x < width; ++x) {
+                m_columns[x] = static_cast<std::uint8_t>(std::uint64_t(x) * gridWidth / width);
+                ++m_columnCounts[m_columns[x]];
+            }
+        }
+
+    private:
+        std::uint32_t m_height;
+        std::vector<std::uint8_t> m_columns;                        // 每列像素所在的格子列
+        std::array<std::uint32_t, gridWidth> m_columnCounts{};     // 每个格子列包含的像素列数
+        std::array<std::uint32_t, gridHeight> m_rowCounts{};       // 每个格子行已累加的像素行数
+        std::array<std::int64_t, gridWidth * gridHeight> m_sums{}; // 每个格子的亮度和
+
+    public:
+        // 累加第 y 行的亮度，values 内有 width 个值
+        template<typename T>
+        void addRow(std::uint32_t y, const T *values) {
+            auto row = static_cast<std::size_t>(std::uint64_t(y) * gridHeight / m_height);
+            auto sums = m_sums.data() + row * gridWidth;
+            for (std::size_t x = 0; x < m_columns.size(); ++x) sums[m_columns[x]] += values[x];
+            ++m_rowCounts[row];
+        }
+
+        // 计算差值哈希，有格子为空或图像为纯色时返回 false
+        bool getHash(std::uint64_t &hash) const {
+            std::array<double, gridWidth * gridHeight> means;
+            for (std::uint32_t y = 0; y < gridHeight; ++y) {
+                for (std::uint32_t x = 0; x < gridWidth; ++x) {
+                    auto count = std::uint64_t(m_rowCounts[y]) * m_columnCounts[x];
+                    if (count == 0U) return false;
+                    means[y * gridWidth + x] = double(m_sums[y * gridWidth + x]) / double(count);
+                }
+            }
+            auto [low, high] = std::minmax_element(means.begin(), means.end());
+            if (*high - *low < flatThreshold) return false;
+            hash = 0U;
+            for (std::uint32_t y = 0; y < gridHeight; ++y) {
+                for (std::uint32_t x = 0; x + 1U < gridWidth; ++x) {
+                    hash = (hash << 1) | (means[y * gridWidth + x] > means[y * gridWidth + x + 1U] ? 1U : 0U);
+                }
+            }
+            return true;
+        }
+    };
+}
+/* ====== END ====== */
+
+/* PNG 解码 */
+/* ===== BEGIN ===== */
+namespace {
+    /*
+     * class PngDecoder
+     * 逐块送入 IDAT 数据，每解压出一行就反滤波、转为亮度并累加到缩略图，只保留当前行与上一行
+     */
+    class PngDecoder {
+    public:
+        PngDecoder() = default;
+        PngDecoder(const PngDecoder &) = delete;
+        PngDecoder &operator=(const PngDecoder &) = delete;
+        ~PngDecoder() { if (m_inflating) inflateEnd(&m_stream); }
+
+    private:
+        std::uint32_t m_width = 0U;
+        std::uint32_t m_height = 0U;
+        std::uint32_t m_depth = 0U;                 // 每个样本的位数
+        std::uint32_t m_colorType = 0U;
+        std::uint32_t m_channels = 0U;
+        std::size_t m_filterStride = 0U;            // 反滤波时左侧像素的字节距离
+        std::array<std::uint8_t, 256> m_palette{};  // 调色板各颜色的亮度
+        std::vector<std::uint8_t> m_row;            // 当前行，首字节为滤波类型
+        std::vector<std::uint8_t> m_prev;           // 上一行（已反滤波）
+        std::vector<int> m_gray;                    // 当前行的亮度
+        std::size_t m_filled = 0U;                  // 当前行已解压的字节数
+        std::uint32_t m_y = 0U;                     // 当前行号
+        std::unique_ptr<Thumbnail> m_thumbnail;
+        z_stream m_stream{};
+        bool m_inflating = false;
+
+    public:
+        // 解析 IHDR，只支持非隔行图像
+        bool setHeader(const std::uint8_t *p, std::size_t size) {
+            if (size < 13U || m_inflating) return false;
+            m_width = readBE32(p);
+            m_height = readBE32(p + 4);
+            m_depth = p[8];
+            m_colorType = p[9];
+            if (p[10] != 0U || p[11] != 0U || p[12] != 0U) return false;
+            if (m_width < gridWidth || m_height < gridHeight || m_width > maxDimension || m_height > maxDimension) {
+                return false;
+            }
+            switch (m_colorType) {
+            case 0U: m_channels = 1U; if (m_depth != 1U && m_depth != 2U && m_depth != 4U && m_depth != 8U && m_depth != 16U) return false; break;
+            case 3U: m_channels = 1U; if (m_depth != 1U && m_depth != 2U && m_depth != 4U && m_depth != 8U) return false; break;
+            case 2U: m_channels = 3U; if (m_depth != 8U && m_depth != 16U) return false; break;
+            case 4U: m_channels = 2U; if (m_depth != 8U && m_depth != 16U) return false; break;
+            case 6U: m_channels = 4U; if (m_depth != 8U && m_depth != 16U) return false; break;
+            default: return false;
+            }
+            auto bitsPerPixel = std::size_t(m_channels) * m_depth;
+            m_filterStride = std::max<std::size_t>(1U, bitsPerPixel / 8U);
+            m_row.assign(1U + (std::size_t(m_width) * bitsPerPixel + 7U) / 8U, 0U);
+            m_prev.assign(m_row.size(), 0U);
+            m_gray.resize(m_width);
+            m_thumbnail = std::make_unique<Thumbnail>(m_width, m_height);
+            if (inflateInit(&m_stream) != Z_OK) return false;
+            m_inflating = true;
+            return true;
+        }
+
+        // 解析 PLTE
+        void setPalette(const std::uint8_t *p, std::size_t size) {
+            for (std::size_t i = 0; i + 3U <= size && i / 3U < m_palette.size(); i += 3U) {
+                m_palette[i / 3U] = static_cast<std::uint8_t>(luma(p[i], p[i + 1U], p[i + 2U]));
+            }
+        }
+
+        // 送入一块 IDAT 数据
+        bool feed(const std::uint8_t *p, std::size_t size) {
+            if (!m_inflating) return false;
+            m_stream.next_in = const_cast<Bytef *>(p);
+            m_stream.avail_in = static_cast<uInt>(size);
+            while (m_y < m_height) {
+                m_stream.next_out = m_row.data() + m_filled;
+                m_stream.avail_out = static_cast<uInt>(m_row.size() - m_filled);
+                auto ret = inflate(&m_stream, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) return false;
+                m_filled = m_row.size() - m_stream.avail_out;
+                if (m_filled == m_row.size()) {
+                    if (!m_processRow()) return false;
+                    m_filled = 0U;
+                    continue;
+                }
+                // 输出缓冲区未满说明已没有可解压的数据
+                if (ret != Z_OK || m_stream.avail_in == 0U) break;
+            }
+            return true;
+        }
+
+        // 所有行解码完毕后计算哈希
+        bool getHash(std::uint64_t &hash) const {
+            return m_thumbnail && m_y == m_height && m_thumbnail->getHash(hash);
+        }
+
+    private:
+        static std::uint8_t m_paeth(int a, int b, int c) {
+            int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+            return static_cast<std::uint8_t>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+        }
+
+        bool m_processRow() {
+            auto cur = m_row.data() + 1, prev = m_prev.data() + 1;
+            auto size = m_row.size() - 1U, stride = m_filterStride;
+            switch (m_row[0]) {
+            case 0U: break;
+            case 1U: for (std::size_t i = stride; i < size; ++i) cur[i] += cur[i - stride]; break;
+            case 2U: for (std::size_t i = 0; i < size; ++i) cur[i] += prev[i]; break;
+            case 3U:
+                for (std::size_t i = 0; i < size; ++i) {
+                    cur[i] += static_cast<std::uint8_t>(((i >= stride ? cur[i - stride] : 0) + prev[i]) >> 1);
+                }
+                break;
+            case 4U:
+                for (std::size_t i = 0; i < size; ++i) {
+                    cur[i] += i >= stride ? m_paeth(cur[i - stride], prev[i], prev[i - stride]) : m_paeth(0, prev[i], 0);
+                }
+                break;
+            default:
+                return false;
+            }
+
+            if (m_depth < 8U) {
+                // 多个像素打包在一个字节内，高位在前
+                auto mask = (1U << m_depth) - 1U;
+                for (std::uint32_t x = 0; x < m_width; ++x) {
+                    auto bit = std::size_t(x) * m_depth;
+                    auto value = (cur[bit / 8U] >> (8U - m_depth - bit % 8U)) & mask;
+                    m_gray[x] = m_colorType == 3U ? m_palette[value] : static_cast<int>(value * 255U / mask);
+                }
+            } else {
+                // 16 位样本只取高字节；灰度与透明度通道忽略透明度
+                auto sample = m_depth / 8U, pixel = sample * m_channels;
+                for (std::uint32_t x = 0; x < m_width; ++x) {
+                    auto px = cur + std::size_t(x) * pixel;
+                    if (m_colorType == 3U) m_gray[x] = m_palette[px[0]];
+                    else if (m_channels <= 2U) m_gray[x] = px[0];
+                    else m_gray[x] = luma(px[0], px[sample], px[2U * sample]);
+                }
+            }
+            m_thumbnail->addRow(m_y++, m_gray.data());
+            m_row.swap(m_prev);
+            return true;
+        }
+    };
+
+    bool dhashPng(const std::uint8_t *p, std::size_t size, std::uint64_t &hash) {
+        PngDecoder decoder;
+        // 签名之后依次为各块：长度、类型、数据、CRC
+        for (std::size_t pos = 8U; pos + 12U <= size; ) {
+            auto length = std::size_t(readBE32(p + pos));
+            if (length > size - pos - 12U) return false;
+            auto type = p + pos + 4, data = p + pos + 8;
+            if (std::memcmp(type, "IHDR", 4U) == 0) {
+                if (!decoder.setHeader(data, length)) return false;
+            } else if (std::memcmp(type, "PLTE", 4U) == 0) {
+                decoder.setPalette(data, length);
+            } else if (std::memcmp(type, "IDAT", 4U) == 0) {
+                if (!decoder.feed(data, length)) return false;
+            } else if (std::memcmp(type, "IEND", 4U) == 0) {
+                break;
+            }
+            pos += length + 12U;
+        }
+        return decoder.getHash(hash);
+    }
+}
+/* ====== END ====== */
+
+/* JPEG DC 解码 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr int huffmanFastBits = 9;
+
+    // Huffman 表，短码查表，长码按长度逐个比较
+    struct HuffmanTable {
+        std::array<std::uint16_t, 1U << huffmanFastBits> m_fast{};  // (码长 << 8) | 符号，0 表示码长超过查表位数
+        std::array<std::int32_t, 17> m_maxCode{};                   // 各码长的最大码，没有该长度时为 -1
+        std::array<std::int32_t, 17> m_valueOffset{};               // 各码长首个符号在 m_values 内的下标减去首个码
+        std::array<std::uint8_t, 256> m_values{};
+        bool m_defined = false;
+
+        // counts 为 16 个码长的符号数，values 为按码排列的符号
+        bool build(const std::uint8_t *counts, const std::uint8_t *values, std::size_t sumOfValues) {
+            m_fast.fill(0U);
+            std::copy(values, values + sumOfValues, m_values.begin());
+            std::int32_t code = 0, index = 0;
+            for (int len = 1; len <= 16; ++len) {
+                m_valueOffset[len] = index - code;
+                for (int i = 0; i < counts[len - 1]; ++i, ++code, ++index) {
+                    if (len <= huffmanFastBits) {
+                        auto first = std::size_t(code) << (huffmanFastBits - len);
+                        auto entry = static_cast<std::uint16_t>((len << 8) | m_values[index]);
+                        std::fill_n(m_fast.begin() + first, std::size_t(1U) << (huffmanFastBits - len), entry);
+                    }
+                }
+                m_maxCode[len] = counts[len - 1] ? code - 1 : -1;
+                if (code > (1 << len)) return false;
+                code <<= 1;
+            }
+            m_defined = true;
+            return true;
+        }
+    };
+
+    /*
+     * class BitReader
+     * 读取熵编码数据，去除填充的 0x00，遇到标记后只补 0
+     */
+    class BitReader {
+    public:
+        BitReader(const std::uint8_t *begin, const std::uint8_t *end) : m_p(begin), m_end(end) {}
+
+    private:
+        const std::uint8_t *m_p;
+        const std::uint8_t *m_end;
+        std::uint64_t m_bits = 0U;      // 左对齐的待读位
+        int m_count = 0;                // 待读位数
+        int m_padding = 0;              // 待读位末尾补上的 0 的位数
+        bool m_marker = false;          // 是否已读到标记
+
+        void m_fill() {
+            while (m_count <= 56) {
+                std::uint64_t byte = 0U;
+                bool padded = m_marker || m_p >= m_end;
+                if (!padded) {
+                    byte = *m_p;
+                    if (byte != 0xffU) ++m_p;
+                    else if (m_p + 1 < m_end && m_p[1] == 0x00U) m_p += 2;
+                    else { m_marker = padded = true; byte = 0U; }
+                }
+                if (padded) m_padding += 8;
+                m_bits |= byte << (56 - m_count);
+                m_count += 8;
+            }
+        }
+
+    public:
+        // 是否读到了数据末尾补上的 0，即数据被截断或已损坏
+        bool isOverrun() const {
+            return m_padding > m_count;
+        }
+
+        // 读取 n（不超过 16）位
+        std::uint32_t getBits(int n) {
+            if (n == 0) return 0U;
+            if (m_count < n) m_fill();
+            auto ret = static_cast<std::uint32_t>(m_bits >> (64 - n));
+            m_bits <<= n;
+            m_count -= n;
+            return ret;
+        }
+
+        // 解码一个 Huffman 符号，失败返回 -1
+        int decode(const HuffmanTable &table) {
+            if (m_count < 16) m_fill();
+            auto entry = table.m_fast[m_bits >> (64 - huffmanFastBits)];
+            if (entry) {
+                m_bits <<= entry >> 8;
+                m_count -= entry >> 8;
+                return entry & 0xff;
+            }
+            for (int len = huffmanFastBits + 1; len <= 16; ++len) {
+                auto code = static_cast<std::int32_t>(m_bits >> (64 - len));
+                if (code <= table.m_maxCode[len]) {
+                    m_bits <<= len;
+                    m_count -= len;
+                    return table.m_values[static_cast<std::uint8_t>(code + table.m_valueOffset[len])];
+                }
+            }
+            return -1;
+        }
+
+        // 丢弃剩余位并跳过 RSTn 标记
+        bool restart() {
+            if (isOverrun()) return false;
+            m_bits = 0U;
+            m_count = 0;
+            m_padding = 0;
+            while (!m_marker && m_p < m_end) {
+                if (*m_p == 0xffU && m_p + 1 < m_end && m_p[1] != 0x00U) m_marker = true;
+                else m_p += *m_p == 0xffU ? 2 : 1;
+            }
+            if (!m_marker || m_p + 1 >= m_end || m_p[1] < 0xd0U || m_p[1] > 0xd7U) return false;
+            m_p += 2;
+            m_marker = false;
+            return true;
+        }
+    };
+
+    // 将 s 位的差值还原为有符号数
+    int extend(std::uint32_t value, int s) {
+        return value < (1U << (s - 1)) ? static_cast<int>(value) - (1 << s) + 1 : static_cast<int>(value);
+    }
+
+    struct JpegComponent {
+        std::uint8_t m_id = 0U;
+        std::uint32_t m_h = 1U;         // 水平采样因子
+        std::uint32_t m_v = 1U;         // 垂直采样因子
+        std::uint8_t m_quant = 0U;      // 量化表编号
+        std::uint8_t m_dcTable = 0U;    // 本次扫描使用的 DC 表
+        std::uint8_t m_acTable = 0U;    // 本次扫描使用的 AC 表
+        int m_pred = 0;                 // DC 预测值
+    };
+
+    /*
+     * class JpegDecoder
+     * 只解码亮度分量的 DC 系数，得到宽高各为原图 1/8 的缩略图
+     * 基线图像需要解码 AC 系数的 Huffman 符号才能跳过，但不做反量化与反 DCT
+     * 渐进式图像只读取第一个包含亮度分量的 DC 扫描
+     */
+    class JpegDecoder {
+    public:
+        JpegDecoder(const std::uint8_t *p, std::size_t size) : m_p(p), m_size(size) {}
+
+    private:
+        const std::uint8_t *m_p;
+        std::size_t m_size;
+        std::array<HuffmanTable, 4> m_dcTables;
+        std::array<HuffmanTable, 4> m_acTables;
+        std::array<std::uint32_t, 4> m_quantDc{ 1U, 1U, 1U, 1U };  // 各量化表的 DC 量化值
+        std::vector<JpegComponent> m_components;
+        std::uint32_t m_width = 0U;
+        std::uint32_t m_height = 0U;
+        std::uint32_t m_maxH = 1U;
+        std::uint32_t m_maxV = 1U;
+        std::uint32_t m_restartInterval = 0U;
+        bool m_progressive = false;
+
+    public:
+        bool getHash(std::uint64_t &hash) {
+            for (std::size_t pos = 2U; pos + 4U <= m_size; ) {
+                if (m_p[pos] != 0xffU) return false;
+                auto marker = m_p[pos + 1U];
+                if (marker == 0xffU) { ++pos; continue; }
+                if (marker == 0x01U || (marker >= 0xd0U && marker <= 0xd7U)) { pos += 2U; continue; }
+                if (marker == 0xd9U) return false;
+                auto length = std::size_t(readBE16(m_p + pos + 2U));
+                if (length < 2U || pos + 2U + length > m_size) return false;
+                auto seg = m_p + pos + 4U;
+                auto segSize = length - 2U;
+                pos += 2U + length;
+                switch (marker) {
+                case 0xc4U: if (!m_readHuffman(seg, segSize)) return false; break;
+                case 0xdbU: if (!m_readQuant(seg, segSize)) return false; break;
+                case 0xddU: if (segSize < 2U) return false; m_restartInterval = readBE16(seg); break;
+                case 0xc0U: case 0xc1U: case 0xc2U:
+                    m_progressive = marker == 0xc2U;
+                    if (!m_readFrame(seg, segSize)) return false;
+                    break;
+                case 0xdaU: {
+                    std::vector<std::size_t> scan;
+                    std::uint32_t al = 0U;
+                    if (!m_readScan(seg, segSize, scan, al)) return false;
+                    if (!scan.empty()) return m_decodeScan(scan, al, pos, hash);
+                    pos = m_skipEntropyData(pos);
+                    break;
+                }
+                default:
+                    // 算术编码、无损等其他 SOF 不支持
+                    if (marker >= 0xc3U && marker <= 0xcfU && marker != 0xc4U && marker != 0xc8U && marker != 0xccU) {
+                        return false;
+                    }
+                    break;
+                }
+            }
+            return false;
+        }
+
+    private:
+        bool m_readHuffman(const std::uint8_t *p, std::size_t size) {
+            while (size >= 17U) {
+                std::uint32_t tableClass = p[0] >> 4, id = p[0] & 0x0fU;
+                if (tableClass > 1U || id > 3U) return false;
+                std::size_t sum = 0U;
+                for (int i = 1; i <= 16; ++i) sum += p[i];
+                if (sum > 256U || 17U + sum > size) return false;
+                auto &table = tableClass ? m_acTables[id] : m_dcTables[id];
+                if (!table.build(p + 1, p + 17, sum)) return false;
+                p += 17U + sum;
+                size -= 17U + sum;
+            }
+            return true;
+        }
+
+        bool m_readQuant(const std::uint8_t *p, std::size_t size) {
+            while (size >= 1U) {
+                std::uint32_t precision = p[0] >> 4, id = p[0] & 0x0fU;
+                auto tableSize = precision ? 129U : 65U;
+                if (id > 3U || size < tableSize) return false;
+                m_quantDc[id] = precision ? readBE16(p + 1) : p[1];
+                p += tableSize;
+                size -= tableSize;
+            }
+            return true;
+        }
+
+        bool m_readFrame(const std::uint8_t *p, std::size_t size) {
+            if (size < 6U || p[0] != 8U || !m_components.empty()) return false;
+            m_height = readBE16(p + 1);
+            m_width = readBE16(p + 3);
+            std::size_t n = p[5];
+            if (n == 0U || size < 6U + 3U * n || m_width == 0U || m_height == 0U) return false;
+            if (m_width > maxDimension || m_height > maxDimension) return false;
+            for (std::size_t i = 0; i < n; ++i) {
+                JpegComponent component;
+                component.m_id = p[6U + 3U * i];
+                component.m_h = p[7U + 3U * i] >> 4;
+                component.m_v = p[7U + 3U * i] & 0x0fU;
+                component.m_quant = p[8U + 3U * i] & 0x03U;
+                if (component.m_h == 0U || component.m_h > 4U || component.m_v == 0U || component.m_v > 4U) return false;
+                m_maxH = std::max(m_maxH, component.m_h);
+                m_maxV = std::max(m_maxV, component.m_v);
+                m_components.emplace_back(component);
+            }
+            return true;
+        }
+
+        // 解析 SOS，扫描可以用于解码亮度 DC 时 scan 为扫描内的分量下标，否则为空
+        bool m_readScan(const std::uint8_t *p, std::size_t size, std::vector<std::size_t> &scan, std::uint32_t &al) {
+            if (m_components.empty() || size < 1U) return false;
+            std::size_t n = p[0];
+            if (n == 0U || size < 4U + 2U * n) return false;
+            bool hasLuma = false;
+            for (std::size_t i = 0; i < n; ++i) {
+                auto it = std::find_if(m_components.begin(), m_components.end(), [id = p[1U + 2U * i]](const auto &c) {
+                    return c.m_id == id;
+                });
+                if (it == m_components.end()) return false;
+                it->m_dcTable = p[2U + 2U * i] >> 4;
+                it->m_acTable = p[2U + 2U * i] & 0x0fU;
+                if (it->m_dcTable > 3U || it->m_acTable > 3U) return false;
+                hasLuma = hasLuma || it == m_components.begin();
+                scan.emplace_back(static_cast<std::size_t>(it - m_components.begin()));
+            }
+            std::uint32_t ss = p[1U + 2U * n], ah = p[3U + 2U * n] >> 4;
+            al = p[3U + 2U * n] & 0x0fU;
+            // 渐进式图像只使用 DC 首次扫描，AC 扫描与细化扫描跳过
+            if (!hasLuma || (m_progressive && (ss != 0U || ah != 0U))) scan.clear();
+            return true;
+        }
+
+        // 跳过熵编码数据，返回下一个标记的位置
+        std::size_t m_skipEntropyData(std::size_t pos) const {
+            while (pos + 1U < m_size) {
+                if (m_p[pos] == 0xffU && m_p[pos + 1U] != 0x00U && (m_p[pos + 1U] < 0xd0U || m_p[pos + 1U] > 0xd7U)) break;
+                ++pos;
+            }
+            return pos;
+        }
+
+        // 解码一个块的 DC 系数，基线图像同时跳过 AC 系数
+        bool m_decodeBlock(BitReader &reader, JpegComponent &component, int &dc) const {
+            const auto &dcTable = m_dcTables[component.m_dcTable];
+            auto s = reader.decode(dcTable);
+            if (s < 0 || s > 16) return false;
+            component.m_pred += s ? extend(reader.getBits(s), s) : 0;
+            dc = component.m_pred;
+            if (m_progressive) return true;
+            const auto &acTable = m_acTables[component.m_acTable];
+            for (int k = 1; k < 64; ) {
+                auto rs = reader.decode(acTable);
+                if (rs < 0) return false;
+                auto r = rs >> 4;
+                s = rs & 0x0f;
+                if (s == 0) {
+                    if (r != 15) break;
+                    k += 16;
+                    continue;
+                }
+                reader.getBits(s);
+                k += r + 1;
+            }
+            return true;
+        }
+
+        bool m_decodeScan(const std::vector<std::size_t> &scan, std::uint32_t al, std::size_t pos, std::uint64_t &hash) {
+            for (auto i : scan) {
+                const auto &component = m_components[i];
+                if (!m_dcTables[component.m_dcTable].m_defined) return false;
+                if (!m_progressive && !m_acTables[component.m_acTable].m_defined) return false;
+            }
+            // 亮度分量的块数，以及按 MCU 补齐后的块数
+            const auto &luma = m_components.front();
+            auto lumaWidth = (m_width * luma.m_h + m_maxH - 1U) / m_maxH;
+            auto lumaHeight = (m_height * luma.m_v + m_maxV - 1U) / m_maxV;
+            auto blocksX = (lumaWidth + 7U) / 8U, blocksY = (lumaHeight + 7U) / 8U;
+            if (blocksX < gridWidth || blocksY < gridHeight) return false;
+            bool interleaved = scan.size() > 1U;
+            auto mcusX = interleaved ? (m_width + 8U * m_maxH - 1U) / (8U * m_maxH) : blocksX;
+            auto mcusY = interleaved ? (m_height + 8U * m_maxV - 1U) / (8U * m_maxV) : blocksY;
+            auto planeWidth = interleaved ? mcusX * luma.m_h : blocksX;
+            auto planeHeight = interleaved ? luma.m_v : 1U;
+            // 只保留一行 MCU 的 DC 系数，解码完一行即送入缩略图，内存与图像高度无关
+            std::vector<int> plane(std::size_t(planeWidth) * planeHeight);
+            // DC 系数为块内平均亮度减 128 后的 8 倍，反量化后换算回 0 ~ 255
+            auto quant = static_cast<int>(m_quantDc[luma.m_quant]);
+            Thumbnail thumbnail(blocksX, blocksY);
+            std::vector<int> row(blocksX);
+
+            BitReader reader(m_p + pos, m_p + m_size);
+            for (auto &component : m_components) component.m_pred = 0;
+            std::uint32_t mcu = 0U;
+            for (std::uint32_t my = 0; my < mcusY; ++my) {
+                for (std::uint32_t mx = 0; mx < mcusX; ++mx, ++mcu) {
+                    if (m_restartInterval && mcu > 0U && mcu % m_restartInterval == 0U) {
+                        if (!reader.restart()) return false;
+                        for (auto &component : m_components) component.m_pred = 0;
+                    }
+                    for (auto i : scan) {
+                        auto &component = m_components[i];
+                        auto h = interleaved ? component.m_h : 1U, v = interleaved ? component.m_v : 1U;
+                        for (std::uint32_t by = 0; by < v; ++by) {
+                            for (std::uint32_t bx = 0; bx < h; ++bx) {
+                                int dc = 0;
+                                if (!m_decodeBlock(reader, component, dc)) return false;
+                                if (i == 0U) plane[std::size_t(by) * planeWidth + mx * h + bx] = dc;
+                            }
+                        }
+                    }
+                }
+                // 补齐 MCU 的块行超出图像时丢弃
+                for (std::uint32_t by = 0; by < planeHeight && my * planeHeight + by < blocksY; ++by) {
+                    for (std::uint32_t x = 0; x < blocksX; ++x) {
+                        row[x] = std::clamp(((plane[std::size_t(by) * planeWidth + x] << al) * quant) / 8 + 128, 0, 255);
+                    }
+                    thumbnail.addRow(my * planeHeight + by, row.data());
+                }
+                if (reader.isOverrun()) return false;
+            }
+            return thumbnail.getHash(hash);
+        }
+    };
+}
+/* ====== END ====== */
+
+/* 感知哈希 */
+/* ===== BEGIN ===== */
+bool book::dhashImage(std::span<const std::byte> data, std::uint64_t &hash) {
+    auto p = reinterpret_cast<const std::uint8_t *>(data.data());
+    auto size = data.size();
+    if (size >= 8U && std::memcmp(p, "\x89PNG\r\n\x1a\n", 8U) == 0) return dhashPng(p, size, hash);
+    if (size >= 4U && p[0] == 0xffU && p[1] == 0xd8U) return JpegDecoder(p, size).getHash(hash);
+    return false;
+}
+
+bool book::dhashImageFile(const fs::path &path, std::uint64_t &hash) {
+    MappedFile file(path, AccessHint::Sequential);
+    return file.isOpen() && dhashImage(file.getData(), hash);
+}
+/* ====== END ====== */
@@ -0,0 +1,93 @@
+#include "Prefetcher.h"
+
+using namespace book;
+
+/* class PagePrefetcher */
+/* ===== BEGIN ===== */
+// 构造函数
+PagePrefetcher::PagePrefetcher(const ImagesManager &images, std::size_t depth, ThreadPool *pool)
+    : m_images(&images), m_ownPool(pool ? nullptr : new ThreadPool(2U)),
+    m_pool(pool ? pool : m_ownPool.get()), m_depth(depth) {}
+
+PagePrefetcher::~PagePrefetcher() {
+    cancel();
+}
+
+// 公有函数
+PageFuture PagePrefetcher::getPage(std::size_t index) {
+    std::unique_lock lock(m_mutex);
+    PageFuture ret;
+    auto it = m_requests.find(index);
+    if (it != m_requests.end()) {
+        ret = std::move(it->second.m_future);
+        m_requests.erase(it);
+    }
+
+    // 跳转到预读窗口之外时，窗口外的预读全部取消
+    // 只有首次访问或向后翻一页时才继续预读
+    auto last = m_lastIndex;
+    m_lastIndex = index;
+    m_cancelOutside(index, index + m_depth);
+    if (last == npos || index == last + 1U) {
+        for (std::size_t i = 1; i <= m_depth && m_images->getSumOfImages() > index + i; ++i) {
+            m_prefetch(index + i);
+        }
+    }
+    lock.unlock();
+
+    if (ret.valid()) return ret;
+    // 未被预读的页面直接在当前线程读取
+    std::promise<PageContent> promise;
+    promise.set_value(m_images->getCachedContent(index));
+    return promise.get_future().share();
+}
+
+void PagePrefetcher::cancel() {
+    std::lock_guard lock(m_mutex);
+    for (auto &[index, request] : m_requests) request.m_cancelled->store(true);
+    m_requests.clear();
+}
+
+void PagePrefetcher::setDepth(std::size_t depth) {
+    std::lock_guard lock(m_mutex);
+    m_depth = depth;
+}
+
+std::size_t PagePrefetcher::getDepth() const {
+    std::lock_guard lock(m_mutex);
+    return m_depth;
+}
+
+std::size_t PagePrefetcher::getSumOfPending() const {
+    std::lock_guard lock(m_mutex);
+    return m_requests.size();
+}
+
+// 私有函数
+void PagePrefetcher::m_prefetch(std::size_t index) {
+    if (m_requests.contains(index)) return ;
+
+    auto promise = std::make_shared<std::promise<PageContent>>();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_requests.emplace(index, Request{ promise->get_future().share(), cancelled });
+    // 任务只持有键与读取函数（路径、压缩包条目的副本），不依赖预读器与图像管理器的生命周期
+    m_pool->submit([promise, cancelled, key = m_images->getPageKey(index), loader = m_images->getPageLoader(index)] {
+        if (cancelled->load()) {
+            promise->set_value(nullptr);
+            return ;
+        }
+        promise->set_value(PageCache::global().getOrLoad(key, loader));
+    });
+}
+
+void PagePrefetcher::m_cancelOutside(std::size_t first, std::size_t last) {
+    for (auto it = m_requests.begin(); it != m_requests.end(); ) {
+        if (it->first >= first && it->first <= last) {
+            ++it;
+            continue;
+        }
+        it->second.m_cancelled->store(true);
+        it = m_requests.erase(it);
+    }
+}
+/* ====== END ====== */
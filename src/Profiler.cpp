@@ -0,0 +1,273 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace book;
+
+/* 性能采样辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    using Counter = std::atomic<std::uint64_t>;
+
+    constexpr std::array<std::string_view, sumOfProbes> probeNames = {
+        "ImagesManager::readImage", "ImagesManager::scanImageFiles", "LibraryScanner::scan", "TagManager::read",
+        "Library::read", "Library::write", "Journal::append", "TransferEngine::copyFile",
+    };
+    constexpr std::array<std::string_view, sumOfCounters> counterNames = { "imageBytesRead", "fileBytesCopied" };
+
+    // 只有所属线程写入，读入再写回即可，其他线程读到的总是某个完整的值
+    void addRelaxed(Counter &counter, std::uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::size_t getBucket(std::uint64_t ns) {
+        return std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(ns)), latencyBuckets - 1U);
+    }
+
+    // 将纳秒写为微秒，保留 3 位小数
+    void appendMicros(std::string &out, std::uint64_t ns) {
+        char buffer[32];
+        auto size = std::snprintf(buffer, sizeof(buffer), "%llu.%03llu",
+            static_cast<unsigned long long>(ns / 1000U), static_cast<unsigned long long>(ns % 1000U));
+        out.append(buffer, static_cast<std::size_t>(size));
+    }
+}
+/* ====== END ====== */
+
+std::string_view book::getProbeName(ProbeId probe) {
+    auto index = static_cast<std::size_t>(probe);
+    return index < sumOfProbes ? probeNames[index] : std::string_view();
+}
+
+std::string_view book::getCounterName(CounterId counter) {
+    auto index = static_cast<std::size_t>(counter);
+    return index < sumOfCounters ? counterNames[index] : std::string_view();
+}
+
+/* struct ProbeStats */
+/* ===== BEGIN ===== */
+double ProbeStats::getMeanNs() const {
+    return m_count ? static_cast<double>(m_totalNs) / static_cast<double>(m_count) : 0.0;
+}
+
+std::uint64_t ProbeStats::getPercentileNs(double q) const {
+    if (m_count == 0U) return 0U;
+    auto target = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count)));
+    target = std::max<std::uint64_t>(target, 1U);
+    std::uint64_t sum = 0U;
+    for (std::size_t i = 0; i < latencyBuckets; ++i) {
+        sum += m_buckets[i];
+        if (sum < target) continue;
+        auto upper = i == 0U ? 0U : (std::uint64_t(1U) << i) - 1U;
+        return std::min(upper, m_maxNs);
+    }
+    return m_maxNs;
+}
+/* ====== END ====== */
+
+/* struct ProfileSnapshot */
+/* ===== BEGIN ===== */
+const ProbeStats &ProfileSnapshot::get(ProbeId probe) const {
+    return m_probes[static_cast<std::size_t>(probe)];
+}
+
+std::uint64_t ProfileSnapshot::get(CounterId counter) const {
+    return m_counters[static_cast<std::size_t>(counter)];
+}
+/* ====== END ====== */
+
+/* class Profiler */
+/* ===== BEGIN ===== */
+// 一个线程的统计
+struct Profiler::ThreadData {
+    struct Probe {
+        Counter m_count;
+        Counter m_totalNs;
+        Counter m_maxNs;
+        std::array<Counter, latencyBuckets> m_buckets;
+    };
+
+    std::uint32_t m_id = 0U;                        // 线程编号，从 1 开始
+    std::array<Probe, sumOfProbes> m_probes;        // 各探针的统计
+    std::array<Counter, sumOfCounters> m_counters;  // 各计数器的值
+    std::mutex m_traceMutex;                        // 保护计时区间，只在追踪开启或导出时使用
+    std::vector<TraceEvent> m_events;               // 最近的计时区间，满后循环覆盖
+    std::size_t m_nextEvent = 0U;                   // 满后下一个被覆盖的位置
+};
+
+// 当前线程的统计，线程退出时归还
+struct Profiler::ThreadSlot {
+    ThreadData *m_data = nullptr;
+
+    ~ThreadSlot() {
+        if (m_data) global().m_releaseThreadData(m_data);
+    }
+};
+
+Profiler &Profiler::global() {
+    // 不析构：全局线程池的工作线程在静态对象析构期间才退出，届时仍要归还统计
+    static auto *profiler = new Profiler();
+    return *profiler;
+}
+
+void Profiler::setEnabled(bool enable) {
+    m_enabled.store(enable, std::memory_order_relaxed);
+}
+
+std::uint64_t Profiler::now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+// 公有函数
+void Profiler::setTracing(bool enable) {
+    m_tracing.store(enable, std::memory_order_relaxed);
+}
+
+bool Profiler::isTracing() const {
+    return m_tracing.load(std::memory_order_relaxed);
+}
+
+void Profiler::record(ProbeId probe, std::uint64_t startNs, std::uint64_t endNs) {
+    auto &data = m_getThreadData();
+    auto ns = endNs > startNs ? endNs - startNs : 0U;
+    auto &stats = data.m_probes[static_cast<std::size_t>(probe)];
+    addRelaxed(stats.m_count, 1U);
+    addRelaxed(stats.m_totalNs, ns);
+    if (ns > stats.m_maxNs.load(std::memory_order_relaxed)) stats.m_maxNs.store(ns, std::memory_order_relaxed);
+    addRelaxed(stats.m_buckets[getBucket(ns)], 1U);
+
+    if (!m_tracing.load(std::memory_order_relaxed)) return;
+    TraceEvent event{ startNs, ns, probe };
+    std::lock_guard lock(data.m_traceMutex);
+    if (data.m_events.size() < traceCapacity) {
+        data.m_events.emplace_back(event);
+    } else {
+        data.m_events[data.m_nextEvent] = event;
+        data.m_nextEvent = (data.m_nextEvent + 1U) % traceCapacity;
+    }
+}
+
+ProfileSnapshot Profiler::snapshot() {
+    ProfileSnapshot ret;
+    std::lock_guard lock(m_mutex);
+    for (auto &data : m_threads) {
+        for (std::size_t i = 0; i < sumOfProbes; ++i) {
+            auto &src = data->m_probes[i];
+            auto &dest = ret.m_probes[i];
+            dest.m_count += src.m_count.load(std::memory_order_relaxed);
+            dest.m_totalNs += src.m_totalNs.load(std::memory_order_relaxed);
+            dest.m_maxNs = std::max(dest.m_maxNs, src.m_maxNs.load(std::memory_order_relaxed));
+            for (std::size_t j = 0; j < latencyBuckets; ++j) dest.m_buckets[j] += src.m_buckets[j].load(std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < sumOfCounters; ++i) ret.m_counters[i] += data->m_counters[i].load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+void Profiler::reset() {
+    std::lock_guard lock(m_mutex);
+    for (auto &data : m_threads) {
+        for (auto &probe : data->m_probes) {
+            probe.m_count.store(0U, std::memory_order_relaxed);
+            probe.m_totalNs.store(0U, std::memory_order_relaxed);
+            probe.m_maxNs.store(0U, std::memory_order_relaxed);
+            for (auto &bucket : probe.m_buckets) bucket.store(0U, std::memory_order_relaxed);
+        }
+        for (auto &counter : data->m_counters) counter.store(0U, std::memory_order_relaxed);
+        std::lock_guard traceLock(data->m_traceMutex);
+        data->m_events.clear();
+        data->m_nextEvent = 0U;
+    }
+}
+
+std::vector<std::pair<TraceEvent, std::uint32_t>> Profiler::getTraceEvents() {
+    std::vector<std::pair<TraceEvent, std::uint32_t>> ret;
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto &data : m_threads) {
+            std::lock_guard traceLock(data->m_traceMutex);
+            for (auto &event : data->m_events) ret.emplace_back(event, data->m_id);
+        }
+    }
+    std::stable_sort(ret.begin(), ret.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first.m_startNs < rhs.first.m_startNs;
+    });
+    return ret;
+}
+
+std::string Profiler::exportChromeTrace() {
+    auto events = getTraceEvents();
+    auto stats = snapshot();
+    auto end = now();
+    std::uint32_t sumOfThreads = 0U;
+    {
+        std::lock_guard lock(m_mutex);
+        sumOfThreads = static_cast<std::uint32_t>(m_threads.size());
+    }
+
+    std::string ret;
+    ret.reserve(events.size() * 96U + 256U);
+    ret.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    ret.append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"MangaManager\"}}");
+    for (std::uint32_t id = 1; id <= sumOfThreads; ++id) {
+        auto tid = std::to_string(id);
+        ret.append(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":").append(tid)
+            .append(",\"args\":{\"name\":\"thread ").append(tid).append("\"}}");
+    }
+    for (auto &[event, tid] : events) {
+        ret.append(",\n{\"name\":\"").append(getProbeName(event.m_probe))
+            .append("\",\"cat\":\"book\",\"ph\":\"X\",\"pid\":1,\"tid\":").append(std::to_string(tid)).append(",\"ts\":");
+        appendMicros(ret, event.m_startNs);
+        ret.append(",\"dur\":");
+        appendMicros(ret, event.m_durationNs);
+        ret.push_back('}');
+    }
+    for (std::size_t i = 0; i < sumOfCounters; ++i) {
+        ret.append(",\n{\"name\":\"").append(counterNames[i]).append("\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":");
+        appendMicros(ret, end);
+        ret.append(",\"args\":{\"value\":").append(std::to_string(stats.m_counters[i])).append("}}");
+    }
+    ret.append("\n]}\n");
+    return ret;
+}
+
+bool Profiler::writeChromeTrace(const fs::path &path) {
+    auto trace = exportChromeTrace();
+    std::ofstream fout(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout) return false;
+    fout.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+    return static_cast<bool>(fout);
+}
+
+// 私有函数
+Profiler::ThreadData &Profiler::m_getThreadData() {
+    thread_local ThreadSlot slot;
+    if (slot.m_data) return *slot.m_data;
+    std::lock_guard lock(m_mutex);
+    if (!m_freeThreads.empty()) {
+        slot.m_data = m_freeThreads.back();
+        m_freeThreads.pop_back();
+    } else {
+        auto &data = m_threads.emplace_back(new ThreadData());
+        data->m_id = static_cast<std::uint32_t>(m_threads.size());
+        slot.m_data = data.get();
+    }
+    return *slot.m_data;
+}
+
+void Profiler::m_releaseThreadData(ThreadData *data) {
+    // 统计与计时区间保留，由之后的新线程继续累加
+    std::lock_guard lock(m_mutex);
+    m_freeThreads.emplace_back(data);
+}
+
+void Profiler::m_count(CounterId counter, std::uint64_t value) {
+    addRelaxed(m_getThreadData().m_counters[static_cast<std::size_t>(counter)], value);
+}
+/* ====== END ====== */
@@ -0,0 +1,93 @@
+#include "Scanner.h"
+#include <system_error>
+#include "Profiler.h"
+
+using namespace book;
+
+/* 扫描辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    // 判断目录项是否为需要忽略的隐藏目录
+    bool isHidden(const fs::path &path) {
+        auto name = path.filename().native();
+        return !name.empty() && name.front() == fs::path::value_type('.');
+    }
+
+    // 列出 dir 下的所有子目录，按自然顺序排列
+    std::vector<fs::path> listDirectories(const fs::path &dir) {
+        std::vector<fs::path> ret;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_directory(ec) && !isHidden(it->path())) ret.emplace_back(it->path());
+        }
+        sortNatural(ret);
+        return ret;
+    }
+
+    // 扫描 dir 下的所有图像文件，按自然顺序排列
+    std::vector<fs::path> listImages(const fs::path &dir) {
+        std::vector<fs::path> ret;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (isImageFile(it->path()) && it->is_regular_file(ec)) ret.emplace_back(it->path());
+        }
+        sortNatural(ret);
+        return ret;
+    }
+
+    // 在 group 中扫描漫画目录 manga，结果写入 manga.m_chapters
+    void submitManga(TaskGroup &group, ScannedManga &manga) {
+        auto chapters = listDirectories(manga.m_path);
+        // 预先分配好所有话的位置，各任务只写入自己的位置
+        manga.m_chapters.resize(chapters.size() + 1U);
+        manga.m_chapters.front().m_path = manga.m_path;
+        for (std::size_t i = 0; i < chapters.size(); ++i) {
+            auto &chapter = manga.m_chapters[i + 1U];
+            chapter.m_path = std::move(chapters[i]);
+            group.submit([&chapter] { chapter.m_images = listImages(chapter.m_path); });
+        }
+        manga.m_chapters.front().m_images = listImages(manga.m_path);
+    }
+
+    // 删除没有图像的话
+    void removeEmptyChapters(ScannedManga &manga) {
+        std::erase_if(manga.m_chapters, [](const ScannedChapter &c) { return c.m_images.empty(); });
+    }
+}
+/* ====== END ====== */
+
+/* class LibraryScanner */
+/* ===== BEGIN ===== */
+// 构造函数
+LibraryScanner::LibraryScanner(ThreadPool *pool) : m_pool(pool ? pool : &ThreadPool::global()) {}
+
+// 公有函数
+std::vector<ScannedManga> LibraryScanner::scan(const fs::path &root) const {
+    ScopedTimer timer(ProbeId::LibraryScan);
+    auto mangaPaths = listDirectories(root);
+    std::vector<ScannedManga> ret(mangaPaths.size());
+    {
+        TaskGroup group(*m_pool);
+        for (std::size_t i = 0; i < mangaPaths.size(); ++i) {
+            auto &manga = ret[i];
+            manga.m_path = std::move(mangaPaths[i]);
+            group.submit([&group, &manga] { submitManga(group, manga); });
+        }
+        group.wait();
+    }
+    for (auto &manga : ret) removeEmptyChapters(manga);
+    return ret;
+}
+
+ScannedManga LibraryScanner::scanManga(const fs::path &mangaPath) const {
+    ScannedManga ret;
+    ret.m_path = mangaPath;
+    {
+        TaskGroup group(*m_pool);
+        submitManga(group, ret);
+        group.wait();
+    }
+    removeEmptyChapters(ret);
+    return ret;
+}
+/* ====== END ====== */
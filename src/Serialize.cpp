@@ -0,0 +1,306 @@
+#include "Serialize.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#ifdef __linux
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define BOOK_CRC32C_X86 1
+#endif
+
+using namespace book;
+
+/* CRC32C */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::uint32_t crc32cPoly = 0x82f63b78U;  // 反射后的 Castagnoli 多项式
+
+    // slicing-by-8 查找表
+    constexpr auto crc32cTable = [] {
+        std::array<std::array<std::uint32_t, 256>, 8> ret{};
+        for (std::uint32_t i = 0; i < 256U; ++i) {
+            std::uint32_t crc = i;
+            for (int j = 0; j < 8; ++j) crc = (crc >> 1) ^ (crc & 1U ? crc32cPoly : 0U);
+            ret[0][i] = crc;
+        }
+        for (std::uint32_t i = 0; i < 256U; ++i) {
+            for (std::size_t t = 1; t < 8U; ++t) ret[t][i] = (ret[t - 1][i] >> 8) ^ ret[0][ret[t - 1][i] & 0xffU];
+        }
+        return ret;
+    }();
+
+    std::uint32_t crc32cSoftware(const std::uint8_t *p, std::size_t n, std::uint32_t crc) {
+        while (n >= 8U) {
+            std::uint32_t lo = crc ^ (std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24);
+            crc = crc32cTable[7][lo & 0xffU] ^ crc32cTable[6][(lo >> 8) & 0xffU]
+                ^ crc32cTable[5][(lo >> 16) & 0xffU] ^ crc32cTable[4][lo >> 24]
+                ^ crc32cTable[3][p[4]] ^ crc32cTable[2][p[5]] ^ crc32cTable[1][p[6]] ^ crc32cTable[0][p[7]];
+            p += 8; n -= 8U;
+        }
+        while (n--) crc = (crc >> 8) ^ crc32cTable[0][(crc ^ *p++) & 0xffU];
+        return crc;
+    }
+
+#ifdef BOOK_CRC32C_X86
+    __attribute__((target("sse4.2")))
+    std::uint32_t crc32cHardware(const std::uint8_t *p, std::size_t n, std::uint32_t crc) {
+        std::uint64_t crc64 = crc;
+        while (n >= 8U) {
+            std::uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+            p += 8; n -= 8U;
+        }
+        crc = static_cast<std::uint32_t>(crc64);
+        while (n--) crc = _mm_crc32_u8(crc, *p++);
+        return crc;
+    }
+
+    const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+std::uint32_t book::crc32c(std::span<const std::byte> data, std::uint32_t crc) {
+    auto p = reinterpret_cast<const std::uint8_t *>(data.data());
+    crc = ~crc;
+#ifdef BOOK_CRC32C_X86
+    if (hasSse42) return ~crc32cHardware(p, data.size(), crc);
+#endif
+    return ~crc32cSoftware(p, data.size(), crc);
+}
+/* ====== END ====== */
+
+/* class BinaryWriter */
+/* ===== BEGIN ===== */
+void BinaryWriter::putVarint(std::uint64_t value) {
+    char bytes[10];
+    std::size_t n = 0U;
+    while (value >= 0x80U) {
+        bytes[n++] = static_cast<char>((value & 0x7fU) | 0x80U);
+        value >>= 7;
+    }
+    bytes[n++] = static_cast<char>(value);
+    m_buffer.append(bytes, n);
+}
+
+void BinaryWriter::putString(std::string_view str) {
+    putVarint(str.size());
+    m_buffer.append(str);
+}
+
+void BinaryWriter::putBytes(std::span<const std::byte> bytes) {
+    m_buffer.append(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+std::span<const std::byte> BinaryWriter::getData() const {
+    return std::as_bytes(std::span(m_buffer.data(), m_buffer.size()));
+}
+
+std::size_t BinaryWriter::getSize() const {
+    return m_buffer.size();
+}
+
+void BinaryWriter::reserve(std::size_t size) {
+    m_buffer.reserve(size);
+}
+/* ====== END ====== */
+
+/* class BinaryReader */
+/* ===== BEGIN ===== */
+BinaryReader::BinaryReader(std::span<const std::byte> data)
+    : m_pos(data.data()), m_end(data.data() + data.size()) {}
+
+bool BinaryReader::getVarint(std::uint64_t &value) {
+    value = 0U;
+    for (unsigned shift = 0U; shift < 64U; shift += 7U) {
+        if (!m_require(1U)) return false;
+        auto byte = std::to_integer<std::uint8_t>(*m_pos++);
+        value |= std::uint64_t(byte & 0x7fU) << shift;
+        if (!(byte & 0x80U)) return true;
+    }
+    setFail();
+    return false;
+}
+
+bool BinaryReader::getCount(std::size_t &count, std::size_t minItemSize) {
+    std::uint64_t value;
+    if (!getVarint(value)) return false;
+    if (minItemSize && value > getRemaining() / minItemSize) {
+        setFail();
+        return false;
+    }
+    count = static_cast<std::size_t>(value);
+    return true;
+}
+
+bool BinaryReader::getString(std::string &str) {
+    std::string_view view;
+    if (!getStringView(view)) return false;
+    str.assign(view);
+    return true;
+}
+
+bool BinaryReader::getStringView(std::string_view &str) {
+    std::size_t size;
+    if (!getCount(size)) return false;
+    str = std::string_view(reinterpret_cast<const char *>(m_pos), size);
+    m_pos += size;
+    return true;
+}
+
+bool BinaryReader::getBytes(std::size_t size, std::span<const std::byte> &bytes) {
+    if (!m_require(size)) return false;
+    bytes = std::span(m_pos, size);
+    m_pos += size;
+    return true;
+}
+
+bool BinaryReader::fail() const {
+    return m_fail;
+}
+
+bool BinaryReader::atEnd() const {
+    return m_pos == m_end;
+}
+
+std::size_t BinaryReader::getRemaining() const {
+    return static_cast<std::size_t>(m_end - m_pos);
+}
+
+void BinaryReader::setFail() {
+    m_fail = true;
+    m_pos = m_end;
+}
+
+bool BinaryReader::m_require(std::size_t size) {
+    if (m_fail || getRemaining() < size) {
+        setFail();
+        return false;
+    }
+    return true;
+}
+/* ====== END ====== */
+
+/* 数据文件读写 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::size_t headerSize = 8U;      // magic + version + flags
+    constexpr std::size_t footerSize = 4U;      // CRC32C
+
+    void encodeHeader(const FileHeader &header, char *out) {
+        std::memcpy(out, header.m_magic.data(), 4U);
+        out[4] = static_cast<char>(header.m_version & 0xffU);
+        out[5] = static_cast<char>(header.m_version >> 8);
+        out[6] = static_cast<char>(header.m_flags & 0xffU);
+        out[7] = static_cast<char>(header.m_flags >> 8);
+    }
+
+#ifdef __linux
+    // 写入全部数据并刷到磁盘
+    bool writeAndSync(int fd, std::span<const std::byte> data) {
+        auto p = reinterpret_cast<const char *>(data.data());
+        auto n = data.size();
+        while (n) {
+            auto ret = ::write(fd, p, n);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += ret;
+            n -= static_cast<std::size_t>(ret);
+        }
+        return ::fsync(fd) == 0;
+    }
+
+    // 刷新目录项，使改名在断电后仍然有效
+    bool syncDirectory(const fs::path &dir) {
+        int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return false;
+        auto ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+#endif
+}
+
+bool book::replaceFile(const fs::path &path, std::span<const std::byte> data) {
+    std::error_code ec;
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+#ifdef __linux
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    // 临时文件的内容必须先于改名落盘，否则崩溃后可能留下指向空文件的新名字
+    auto ok = writeAndSync(fd, data);
+    if (::close(fd) != 0) ok = false;
+    if (!ok) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    fs::rename(tmpPath, path, ec);
+    return !ec && syncDirectory(path.parent_path());
+#else
+    {
+        std::ofstream fout(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (fout.fail()) return false;
+        fout.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        fout.close();
+        if (fout.fail()) {
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+#endif
+}
+
+bool book::writeDataFile(const fs::path &path, const FileHeader &header, const BinaryWriter &body) {
+    // 头部、数据与校验值拼接为一块缓冲区，一次写出
+    auto data = body.getData();
+    std::string buffer(headerSize + data.size() + footerSize, '\x00');
+    encodeHeader(header, buffer.data());
+    std::memcpy(buffer.data() + headerSize, data.data(), data.size());
+    auto crc = crc32c(std::as_bytes(std::span(buffer.data(), headerSize + data.size())));
+    for (std::size_t i = 0; i < footerSize; ++i) {
+        buffer[headerSize + data.size() + i] = static_cast<char>((crc >> (8U * i)) & 0xffU);
+    }
+
+    std::error_code ec;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+    return replaceFile(path, std::as_bytes(std::span(buffer.data(), buffer.size())));
+}
+
+bool book::readDataFile(const fs::path &path, std::array<char, 4> magic, std::uint16_t maxVersion,
+    FileHeader &header, std::string &buffer, std::span<const std::byte> &body) {
+    std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (fin.fail()) return false;
+    auto size = static_cast<std::size_t>(fin.tellg());
+    if (size < headerSize + footerSize) return false;
+    buffer.resize(size);
+    fin.seekg(0);
+    fin.read(buffer.data(), static_cast<std::streamsize>(size)); fin.close();
+    if (fin.fail()) return false;
+
+    auto bytes = std::as_bytes(std::span(buffer.data(), buffer.size()));
+    BinaryReader reader(bytes);
+    std::uint32_t crc;
+    reader.getBytes(size - footerSize, body);
+    reader.getFixed(crc);
+    if (reader.fail() || crc32c(body) != crc) return false;
+
+    std::memcpy(header.m_magic.data(), buffer.data(), 4U);
+    BinaryReader headerReader(bytes.subspan(4U, 4U));
+    headerReader.getFixed(header.m_version);
+    headerReader.getFixed(header.m_flags);
+    if (header.m_magic != magic || header.m_version == 0U || header.m_version > maxVersion) return false;
+    body = bytes.subspan(headerSize, size - headerSize - footerSize);
+    return true;
+}
+/* ====== END ====== */
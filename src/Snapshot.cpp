@@ -0,0 +1,504 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "Library.h"
+
+using namespace book;
+using namespace book::snapshot;
+
+// 快照内的记录按本机内存布局原地访问，只支持小端序
+static_assert(std::endian::native == std::endian::little);
+static_assert(sizeof(Header) == 200U && sizeof(TagRecord) == 8U + 2U * sizeof(TagIdType));
+static_assert(sizeof(BookRecord) == 48U && sizeof(PageRecord) == 24U);
+static_assert(sizeof(ArchiveRecord) == 24U && sizeof(EntryRecord) == 32U);
+
+/* 快照辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::size_t fileHeaderSize = 8U;          // FileHeader 的长度，快照头部紧随其后
+    constexpr std::size_t fileFooterSize = 4U;          // CRC32C
+    constexpr std::size_t sectionAlign = 8U;            // 各段的对齐
+
+    // 计算头部的 CRC32C，m_headerCrc 视为 0
+    std::uint32_t headerCrc(Header header) {
+        header.m_headerCrc = 0U;
+        return crc32c(std::as_bytes(std::span(&header, 1U)));
+    }
+
+    // 路径与快照内字节之间的转换，与 ImagesManager::write 保持一致
+    std::string pathToBytes(const fs::path &path) {
+        if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+            return path.native();
+        } else {
+            auto str = path.u8string();
+            return std::string(str.begin(), str.end());
+        }
+    }
+
+    fs::path bytesToPath(std::string_view bytes) {
+        if constexpr (std::is_same_v<fs::path::string_type, std::string>) {
+            return fs::path(bytes);
+        } else {
+            return fs::path(std::u8string(bytes.begin(), bytes.end()));
+        }
+    }
+
+    // 检查 section 是否按 T 对齐且完整落在 [begin, end) 内
+    template<typename T>
+    bool checkSection(const Section &section, std::size_t begin, std::size_t end) {
+        return section.m_offset % alignof(T) == 0U && section.m_offset >= begin && section.m_offset <= end &&
+            section.m_count <= (end - section.m_offset) / sizeof(T);
+    }
+
+    // 在 pos 处按 sectionAlign 对齐后放置 count 个 T，返回所在的段，pos 移到段末尾
+    template<typename T>
+    Section placeSection(std::size_t &pos, std::size_t count) {
+        pos = (pos + sectionAlign - 1U) / sectionAlign * sectionAlign;
+        Section ret{ pos, count };
+        pos += count * sizeof(T);
+        return ret;
+    }
+
+    // 将 records 写到 section 指定的位置，不足的部分用 0 填充
+    template<typename T>
+    void putSection(BinaryWriter &out, const Section &section, std::span<const T> records) {
+        static constexpr std::byte padding[sectionAlign] = {};
+        out.putBytes(std::span(padding, section.m_offset - fileHeaderSize - out.getSize()));
+        out.putBytes(std::as_bytes(records));
+    }
+}
+/* ====== END ====== */
+
+/* class BookView */
+/* ===== BEGIN ===== */
+// 构造函数
+BookView::BookView(const CatalogSnapshot *snapshot, const BookRecord *record)
+    : m_snapshot(snapshot), m_record(record) {}
+
+// 公有函数
+bool BookView::isNull() const {
+    return m_record == nullptr;
+}
+
+BookIdType BookView::getBookId() const {
+    return m_record ? m_record->m_id : nullBookId;
+}
+
+std::string_view BookView::getTitle() const {
+    return m_record ? m_snapshot->m_getString(m_record->m_titleOffset, m_record->m_titleLength) : std::string_view();
+}
+
+std::size_t BookView::getSumOfImages() const {
+    return m_getPages().size();
+}
+
+std::string_view BookView::getImagePath(std::size_t index) const {
+    auto pages = m_getPages();
+    if (index >= pages.size()) return {};
+    return m_snapshot->m_getString(pages[index].m_pathOffset, pages[index].m_pathLength);
+}
+
+std::string_view BookView::getArchivePath() const {
+    auto archive = m_getArchive();
+    return archive ? m_snapshot->m_getString(archive->m_pathOffset, archive->m_pathLength) : std::string_view();
+}
+
+ImageInfo BookView::getImageInfo(std::size_t index) const {
+    auto pages = m_getPages();
+    if (index >= pages.size()) return ImageInfo{ 0U, 0U, ImageFormat::Invalid };
+    auto &page = pages[index];
+    auto format = page.m_format <= static_cast<std::uint32_t>(ImageFormat::Webp) ?
+        static_cast<ImageFormat>(page.m_format) : ImageFormat::Unknown;
+    return ImageInfo{ page.m_width, page.m_height, format };
+}
+
+std::size_t BookView::getSumOfTags() const {
+    return getTags().size();
+}
+
+std::span<const TagIdType> BookView::getTags() const {
+    if (!m_record) return {};
+    auto tags = m_snapshot->m_getSection<TagIdType>(m_snapshot->m_header.m_tagIds);
+    if (m_record->m_firstTag > tags.size() || m_record->m_sumOfTags > tags.size() - m_record->m_firstTag) return {};
+    return tags.subspan(m_record->m_firstTag, m_record->m_sumOfTags);
+}
+
+bool BookView::hasTag(TagIdType tagId) const {
+    return std::ranges::find(getTags(), tagId) != getTags().end();
+}
+
+// 私有函数
+std::span<const PageRecord> BookView::m_getPages() const {
+    if (!m_record) return {};
+    auto pages = m_snapshot->m_getSection<PageRecord>(m_snapshot->m_header.m_pages);
+    if (m_record->m_firstPage > pages.size() || m_record->m_sumOfPages > pages.size() - m_record->m_firstPage) return {};
+    return pages.subspan(m_record->m_firstPage, m_record->m_sumOfPages);
+}
+
+const ArchiveRecord *BookView::m_getArchive() const {
+    if (!m_record) return nullptr;
+    auto archives = m_snapshot->m_getSection<ArchiveRecord>(m_snapshot->m_header.m_archives);
+    return m_record->m_id < archives.size() ? &archives[m_record->m_id] : nullptr;
+}
+
+std::span<const EntryRecord> BookView::m_getEntries() const {
+    auto archive = m_getArchive();
+    if (!archive || archive->m_pathLength == 0U) return {};
+    auto entries = m_snapshot->m_getSection<EntryRecord>(m_snapshot->m_header.m_entries);
+    auto size = m_getPages().size();
+    if (archive->m_firstEntry > entries.size() || size > entries.size() - archive->m_firstEntry) return {};
+    return entries.subspan(archive->m_firstEntry, size);
+}
+/* ====== END ====== */
+
+/* class CatalogSnapshot */
+/* ===== BEGIN ===== */
+// 构造函数
+CatalogSnapshot::CatalogSnapshot(const fs::path &path) {
+    open(path);
+}
+
+// 公有函数
+bool CatalogSnapshot::write(const Library &library, const fs::path &path) {
+    Header header{};
+    std::vector<TagRecord> bookTags, groupTags;
+    std::vector<TagIdType> bookTagOrder, groupTagOrder, tagIds;
+    std::vector<BookRecord> books;
+    std::vector<PageRecord> pages;
+    std::vector<ArchiveRecord> archives;
+    std::vector<EntryRecord> entries;
+    std::string strings;
+
+    // 标签表，下标即标签ID，空位保留以便还原被删除的ID
+    auto putTags = [&strings](const auto &info, std::vector<TagRecord> &records, std::vector<TagIdType> &order) {
+        records.reserve(info.m_Tags.size());
+        for (const auto &tag : info.m_Tags) {
+            TagRecord record{};
+            if (!tag.isNull()) {
+                record.m_id = tag.getId();
+                record.m_nameOffset = static_cast<std::uint32_t>(strings.size());
+                record.m_nameLength = static_cast<std::uint32_t>(tag.getName().size());
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(tag)>, BookTag>) record.m_groupId = tag.getGroupId();
+                strings.append(tag.getName());
+                order.emplace_back(tag.getId());
+            }
+            records.emplace_back(record);
+        }
+        std::ranges::sort(order, {}, [&info](TagIdType id) { return info.m_Tags[id].getName(); });
+    };
+    const auto &tagManager = library.m_tagManager;
+    putTags(tagManager.m_bookTags, bookTags, bookTagOrder);
+    putTags(tagManager.m_groupTags, groupTags, groupTagOrder);
+    header.m_sumOfBookTags = tagManager.m_bookTags.m_curSumOfTags;
+    header.m_sumOfGroupTags = tagManager.m_groupTags.m_curSumOfTags;
+
+    // 书籍表，下标即书籍ID
+    books.resize(std::size_t(library.m_curMaxBook) + 1U);
+    archives.resize(books.size());
+    for (const auto &book : library.m_books) {
+        auto id = book.getBookId();
+        if (id == nullBookId) continue;
+        auto &record = books[id];
+        record.m_id = id;
+        auto bookTagIds = book.getTags();
+        record.m_firstTag = tagIds.size();
+        record.m_sumOfTags = static_cast<std::uint32_t>(bookTagIds.size());
+        tagIds.insert(tagIds.end(), bookTagIds.begin(), bookTagIds.end());
+        record.m_firstPage = pages.size();
+        record.m_sumOfPages = book.getSumOfImages();
+        record.m_titleOffset = strings.size();
+        record.m_titleLength = static_cast<std::uint32_t>(book.getTitle().size());
+        strings.append(book.getTitle());
+        const ImagesManager &images = book;
+        for (std::size_t i = 0; i < book.getSumOfImages(); ++i) {
+            auto info = i < images.m_infos.size() ? images.m_infos[i] : ImageInfo();
+            auto bytes = pathToBytes(book.getImagePath(i));
+            pages.emplace_back(PageRecord{ strings.size(), static_cast<std::uint32_t>(bytes.size()),
+                info.m_width, info.m_height, static_cast<std::uint32_t>(info.m_format) });
+            strings.append(bytes);
+        }
+        if (images.isArchive()) {
+            auto bytes = pathToBytes(images.getArchivePath());
+            archives[id] = ArchiveRecord{ strings.size(), static_cast<std::uint32_t>(bytes.size()), 0U, entries.size() };
+            strings.append(bytes);
+            for (const auto &entry : images.m_entries) {
+                entries.emplace_back(EntryRecord{ entry.m_offset, entry.m_compressedSize, entry.m_size, entry.m_crc,
+                    static_cast<std::uint16_t>(entry.m_method), 0U });
+            }
+        }
+    }
+    header.m_sumOfBooks = library.m_curSumOfBooks;
+
+    // 先确定各段的位置，再按顺序一次组装
+    auto pos = fileHeaderSize + sizeof(Header);
+    header.m_bookTags = placeSection<TagRecord>(pos, bookTags.size());
+    header.m_groupTags = placeSection<TagRecord>(pos, groupTags.size());
+    header.m_bookTagOrder = placeSection<TagIdType>(pos, bookTagOrder.size());
+    header.m_groupTagOrder = placeSection<TagIdType>(pos, groupTagOrder.size());
+    header.m_books = placeSection<BookRecord>(pos, books.size());
+    header.m_pages = placeSection<PageRecord>(pos, pages.size());
+    header.m_tagIds = placeSection<TagIdType>(pos, tagIds.size());
+    header.m_archives = placeSection<ArchiveRecord>(pos, archives.size());
+    header.m_entries = placeSection<EntryRecord>(pos, entries.size());
+    header.m_strings = placeSection<char>(pos, strings.size());
+    header.m_fileSize = pos + fileFooterSize;
+    header.m_headerCrc = headerCrc(header);
+
+    BinaryWriter out;
+    out.reserve(pos - fileHeaderSize);
+    out.putBytes(std::as_bytes(std::span(&header, 1U)));
+    putSection<TagRecord>(out, header.m_bookTags, bookTags);
+    putSection<TagRecord>(out, header.m_groupTags, groupTags);
+    putSection<TagIdType>(out, header.m_bookTagOrder, bookTagOrder);
+    putSection<TagIdType>(out, header.m_groupTagOrder, groupTagOrder);
+    putSection<BookRecord>(out, header.m_books, books);
+    putSection<PageRecord>(out, header.m_pages, pages);
+    putSection<TagIdType>(out, header.m_tagIds, tagIds);
+    putSection<ArchiveRecord>(out, header.m_archives, archives);
+    putSection<EntryRecord>(out, header.m_entries, entries);
+    putSection<char>(out, header.m_strings, strings);
+    return writeDataFile(path, FileHeader{ fileMagic, fileVersion, std::uint16_t(sizeof(TagIdType)) }, out);
+}
+
+bool CatalogSnapshot::open(const fs::path &path) {
+    close();
+    if (!m_file.open(path, AccessHint::Random)) return false;
+    auto data = m_file.getData();
+    auto fail = [this] { close(); return false; };
+    if (data.size() < fileHeaderSize + sizeof(Header) + fileFooterSize) return fail();
+
+    FileHeader fileHeader;
+    std::memcpy(fileHeader.m_magic.data(), data.data(), fileHeader.m_magic.size());
+    BinaryReader in(data.subspan(fileHeader.m_magic.size(), 4U));
+    in.getFixed(fileHeader.m_version);
+    in.getFixed(fileHeader.m_flags);
+    // 各版本的头部布局不同，只接受当前版本；旧版本或标签ID宽度不同的快照需要重新生成
+    if (fileHeader.m_magic != fileMagic || fileHeader.m_version != fileVersion ||
+        fileHeader.m_flags != sizeof(TagIdType)) return fail();
+
+    std::memcpy(&m_header, data.data() + fileHeaderSize, sizeof(Header));
+    if (m_header.m_headerCrc != headerCrc(m_header) || m_header.m_fileSize != data.size()) return fail();
+    auto begin = fileHeaderSize + sizeof(Header), end = data.size() - fileFooterSize;
+    if (!checkSection<TagRecord>(m_header.m_bookTags, begin, end) ||
+        !checkSection<TagRecord>(m_header.m_groupTags, begin, end) ||
+        !checkSection<TagIdType>(m_header.m_bookTagOrder, begin, end) ||
+        !checkSection<TagIdType>(m_header.m_groupTagOrder, begin, end) ||
+        !checkSection<BookRecord>(m_header.m_books, begin, end) ||
+        !checkSection<PageRecord>(m_header.m_pages, begin, end) ||
+        !checkSection<TagIdType>(m_header.m_tagIds, begin, end) ||
+        !checkSection<ArchiveRecord>(m_header.m_archives, begin, end) ||
+        !checkSection<EntryRecord>(m_header.m_entries, begin, end) ||
+        !checkSection<char>(m_header.m_strings, begin, end)) return fail();
+    // 标签表与书籍表至少包含空位 0
+    if (m_header.m_bookTags.m_count == 0U || m_header.m_bookTags.m_count > std::size_t(maxTagId) + 1U ||
+        m_header.m_groupTags.m_count == 0U || m_header.m_groupTags.m_count > std::size_t(maxTagId) + 1U ||
+        m_header.m_books.m_count == 0U || m_header.m_archives.m_count != m_header.m_books.m_count ||
+        m_header.m_books.m_count > std::size_t(std::numeric_limits<BookIdType>::max()) + 1U) return fail();
+    return true;
+}
+
+void CatalogSnapshot::close() {
+    m_file.close();
+    m_header = Header{};
+}
+
+bool CatalogSnapshot::isOpen() const {
+    return m_file.isOpen();
+}
+
+bool CatalogSnapshot::verify() const {
+    if (!isOpen()) return false;
+    auto data = m_file.getData();
+    std::uint32_t crc;
+    BinaryReader in(data.last(fileFooterSize));
+    return in.getFixed(crc) && crc32c(data.first(data.size() - fileFooterSize)) == crc;
+}
+
+bool CatalogSnapshot::materialize(Library &library) const {
+    library.clear();
+    if (!isOpen()) return false;
+
+    // 标签表，空位记为被删除的ID
+    auto &tagManager = library.m_tagManager;
+    auto loadTags = [this](auto &info, const Section &section, auto makeTag) {
+        auto records = m_getSection<TagRecord>(section);
+        info.m_Tags.clear();
+        info.m_Tags.reserve(records.size());
+        info.m_nameIndex.reserve(records.size());
+        info.m_curSumOfTags = 0U;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            if (i != nullTagId && records[i].m_id == i) {
+                auto name = m_getString(records[i].m_nameOffset, records[i].m_nameLength);
+                // 名字索引的键引用驻留后的名字，不能引用映射的文件
+                info.m_nameIndex.emplace(info.m_Tags.emplace_back(makeTag(records[i], name)).getName(), records[i].m_id);
+                info.m_nameTrie.insert(name, records[i].m_id, records[i].m_groupId);
+                ++info.m_curSumOfTags;
+            } else {
+                info.m_Tags.emplace_back();
+                if (i != nullTagId) info.m_erasedTags.release(static_cast<TagIdType>(i));
+            }
+        }
+        info.m_curMaxTag = static_cast<TagIdType>(records.size() - 1U);
+    };
+    loadTags(tagManager.m_bookTags, m_header.m_bookTags, [](const TagRecord &record, std::string_view name) {
+        return BookTag(record.m_id, record.m_groupId, name);
+    });
+    loadTags(tagManager.m_groupTags, m_header.m_groupTags, [](const TagRecord &record, std::string_view name) {
+        return GroupTag(record.m_id, name);
+    });
+    if (!tagManager.m_checkGroupIds()) {
+        library.clear();
+        return false;
+    }
+    tagManager.m_rebuildGroupMembers();
+
+    // 书籍表，空位记为被删除的ID
+    auto records = m_getSection<BookRecord>(m_header.m_books);
+    library.m_books.resize(records.size());
+    library.m_curMaxBook = static_cast<BookIdType>(records.size() - 1U);
+    for (std::size_t i = 1; i < records.size(); ++i) {
+        BookView view(this, &records[i]);
+        if (view.getBookId() != i) {
+            library.m_erasedBooks.push(static_cast<BookIdType>(i));
+            continue;
+        }
+        std::vector<fs::path> paths;
+        std::vector<ImageInfo> infos;
+        paths.reserve(view.getSumOfImages());
+        infos.reserve(view.getSumOfImages());
+        for (std::size_t j = 0; j < view.getSumOfImages(); ++j) {
+            paths.emplace_back(bytesToPath(view.getImagePath(j)));
+            infos.emplace_back(view.getImageInfo(j));
+        }
+        // 压缩包书籍的条目名即页面路径去掉压缩包路径前缀的部分
+        auto archivePath = view.getArchivePath();
+        auto entryRecords = view.m_getEntries();
+        if (!archivePath.empty() && entryRecords.size() != paths.size()) {
+            library.clear();
+            return false;
+        }
+        std::vector<ArchiveEntry> entries;
+        entries.reserve(entryRecords.size());
+        for (std::size_t j = 0; j < entryRecords.size(); ++j) {
+            auto path = view.getImagePath(j);
+            if (path.size() <= archivePath.size() || !path.starts_with(archivePath)) {
+                library.clear();
+                return false;
+            }
+            auto &record = entryRecords[j];
+            entries.emplace_back(ArchiveEntry{ std::string(path.substr(archivePath.size() + 1U)), record.m_offset,
+                record.m_compressedSize, record.m_size, record.m_crc, static_cast<ArchiveMethod>(record.m_method) });
+        }
+        auto tags = view.getTags();
+        if (!archivePath.empty()) paths.clear();
+        Book book(std::move(paths), &tagManager, view.getBookId(), TagIdList(tags.begin(), tags.end()));
+        book.setTitle(view.getTitle());
+        auto &images = static_cast<ImagesManager &>(book);
+        images.m_infos = std::move(infos);
+        if (!archivePath.empty()) {
+            // 压缩包内的页面只储存条目名，相对于压缩包路径
+            images.m_archive = bytesToPath(archivePath);
+            images.m_images.setRoot(images.m_archive);
+            images.m_images.reserve(entries.size());
+            for (const auto &entry : entries) images.m_images.addRelative(fs::path(entry.m_name));
+            images.m_entries = std::move(entries);
+        }
+        library.m_insertBook(std::move(book));
+        ++library.m_curSumOfBooks;
+    }
+    return true;
+}
+
+TagIdType CatalogSnapshot::getBookTagId(std::string_view name) const {
+    return m_findTag(name, m_header.m_bookTags, m_header.m_bookTagOrder);
+}
+
+TagIdType CatalogSnapshot::getGroupTagId(std::string_view name) const {
+    return m_findTag(name, m_header.m_groupTags, m_header.m_groupTagOrder);
+}
+
+TagIdType CatalogSnapshot::getGroupTagId(TagIdType bookTagId) const {
+    auto record = m_getTag(bookTagId, m_header.m_bookTags);
+    return record ? record->m_groupId : nullTagId;
+}
+
+std::string_view CatalogSnapshot::getBookTagName(TagIdType id) const {
+    auto record = m_getTag(id, m_header.m_bookTags);
+    return record ? m_getString(record->m_nameOffset, record->m_nameLength) : std::string_view();
+}
+
+std::string_view CatalogSnapshot::getGroupTagName(TagIdType id) const {
+    auto record = m_getTag(id, m_header.m_groupTags);
+    return record ? m_getString(record->m_nameOffset, record->m_nameLength) : std::string_view();
+}
+
+bool CatalogSnapshot::checkTagId(TagIdType id) const {
+    return m_getTag(id, m_header.m_bookTags) != nullptr;
+}
+
+bool CatalogSnapshot::checkGroupTagId(TagIdType id) const {
+    return m_getTag(id, m_header.m_groupTags) != nullptr;
+}
+
+std::size_t CatalogSnapshot::getSumOfBookTags() const {
+    return m_header.m_sumOfBookTags;
+}
+
+std::size_t CatalogSnapshot::getSumOfGroupTags() const {
+    return m_header.m_sumOfGroupTags;
+}
+
+std::size_t CatalogSnapshot::getSumOfBooks() const {
+    return m_header.m_sumOfBooks;
+}
+
+bool CatalogSnapshot::checkBookId(BookIdType id) const {
+    auto books = m_getSection<BookRecord>(m_header.m_books);
+    return id != nullBookId && id < books.size() && books[id].m_id == id;
+}
+
+BookView CatalogSnapshot::getBook(BookIdType id) const {
+    if (!checkBookId(id)) return BookView();
+    return BookView(this, &m_getSection<BookRecord>(m_header.m_books)[id]);
+}
+
+BookIdList CatalogSnapshot::getBooks() const {
+    BookIdList ret;
+    ret.reserve(m_header.m_sumOfBooks);
+    auto books = m_getSection<BookRecord>(m_header.m_books);
+    for (std::size_t i = 1; i < books.size(); ++i) {
+        if (books[i].m_id == i) ret.emplace_back(books[i].m_id);
+    }
+    return ret;
+}
+
+// 私有函数
+template<typename T>
+std::span<const T> CatalogSnapshot::m_getSection(const Section &section) const {
+    if (!isOpen()) return {};
+    return std::span(reinterpret_cast<const T *>(m_file.getData().data() + section.m_offset), section.m_count);
+}
+
+std::string_view CatalogSnapshot::m_getString(std::uint64_t offset, std::uint64_t length) const {
+    auto strings = m_getSection<char>(m_header.m_strings);
+    if (offset > strings.size() || length > strings.size() - offset) return {};
+    return std::string_view(strings.data() + offset, length);
+}
+
+TagIdType CatalogSnapshot::m_findTag(std::string_view name, const Section &tags, const Section &order) const {
+    auto ids = m_getSection<TagIdType>(order);
+    auto getName = [this, &tags](TagIdType id) {
+        auto record = m_getTag(id, tags);
+        return record ? m_getString(record->m_nameOffset, record->m_nameLength) : std::string_view();
+    };
+    auto it = std::ranges::lower_bound(ids, name, {}, getName);
+    return it != ids.end() && getName(*it) == name ? *it : nullTagId;
+}
+
+const TagRecord *CatalogSnapshot::m_getTag(TagIdType id, const Section &tags) const {
+    auto records = m_getSection<TagRecord>(tags);
+    if (id == nullTagId || id >= records.size() || records[id].m_id != id) return nullptr;
+    return &records[id];
+}
+/* ====== END ====== */
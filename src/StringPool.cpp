@@ -0,0 +1,57 @@
+#include "StringPool.h"
+#include <cstring>
+#include <mutex>
+
+using namespace book;
+
+/* class StringPool */
+/* ===== BEGIN ===== */
+StringPool &StringPool::global() {
+    static StringPool pool;
+    return pool;
+}
+
+std::string_view StringPool::intern(std::string_view str) {
+    if (str.empty()) return {};
+    {
+        std::shared_lock lock(m_mutex);
+        auto it = m_strings.find(str);
+        if (it != m_strings.end()) return *it;
+    }
+    std::unique_lock lock(m_mutex);
+    // 释放共享锁之后可能已被其他线程驻留
+    auto it = m_strings.find(str);
+    if (it != m_strings.end()) return *it;
+
+    char *data;
+    if (str.size() > chunkSize / 4U) {
+        // 较长的字符串单独成块，插在最后一块之前，不浪费最后一块的剩余空间
+        auto chunk = std::make_unique<char[]>(str.size());
+        data = chunk.get();
+        m_chunks.insert(m_chunks.empty() ? m_chunks.end() : m_chunks.end() - 1, std::move(chunk));
+        m_bytes += str.size();
+    } else {
+        if (chunkSize - m_used < str.size()) {
+            m_chunks.emplace_back(std::make_unique<char[]>(chunkSize));
+            m_used = 0U;
+            m_bytes += chunkSize;
+        }
+        data = m_chunks.back().get() + m_used;
+        m_used += str.size();
+    }
+    std::memcpy(data, str.data(), str.size());
+    return *m_strings.emplace(data, str.size()).first;
+}
+
+std::size_t StringPool::size() const {
+    std::shared_lock lock(m_mutex);
+    return m_strings.size();
+}
+
+std::size_t StringPool::getMemoryUsage() const {
+    std::shared_lock lock(m_mutex);
+    // 哈希表每个节点储存一个视图与下一节点的指针，另有桶数组
+    return m_bytes + m_chunks.capacity() * sizeof(std::unique_ptr<char[]>) +
+        m_strings.size() * (sizeof(std::string_view) + sizeof(void *)) + m_strings.bucket_count() * sizeof(void *);
+}
+/* ====== END ====== */
@@ -1,4 +1,7 @@
 #include "Tag.h"
+#include "Journal.h"
+#include "Profiler.h"
+#include <algorithm>
 
 using namespace book;
 
@@ -11,26 +14,41 @@ const auto nullbtag = BookTag();
 const auto nullgtag = GroupTag();
 /* ====== END ====== */
 
+/* 标签ID的读取 */
+/* ===== BEGIN ===== */
+bool book::checkTagIdSize(std::size_t idSize) {
+    return idSize == sizeof(std::uint16_t) || idSize == sizeof(TagIdType);
+}
+
+bool book::readTagId(BinaryReader &in, TagIdType &id, std::size_t idSize) {
+    if (idSize == sizeof(TagIdType)) return in.getFixed(id);
+    std::uint16_t narrow = 0U;
+    if (idSize != sizeof(narrow) || !in.getFixed(narrow)) {
+        in.setFail();
+        return false;
+    }
+    id = narrow;
+    return true;
+}
+/* ====== END ====== */
+
 /* class Tag */
 /* ===== BEGIN ===== */
 // 构造函数
 Tag::Tag() : m_id(nullTagId), m_name() {}
-Tag::Tag(TagIdType id, std::string_view name) : m_id(id), m_name(name) {}
+Tag::Tag(TagIdType id, std::string_view name) : m_id(id), m_name(StringPool::global().intern(name)) {}
 
 // 类内方法
-void Tag::read(std::ifstream &in) {
-    in.read(reinterpret_cast<char *>(&m_id), sizeof(m_id));
-    std::size_t len;
-    in.read(reinterpret_cast<char *>(&len), sizeof(len));
-    m_name.resize(len);
-    in.read(reinterpret_cast<char *>(&m_name[0]), len);
+bool Tag::read(BinaryReader &in, std::size_t idSize) {
+    std::string_view name;
+    if (!readTagId(in, m_id, idSize) || !in.getStringView(name)) return false;
+    m_name = StringPool::global().intern(name);
+    return true;
 }
 
-void Tag::write(std::ofstream &out) const {
-    out.write(reinterpret_cast<const char *>(&m_id), sizeof(m_id));
-    auto len = m_name.length();
-    out.write(reinterpret_cast<const char *>(&len), sizeof(len));
-    out.write(m_name.c_str(), len);
+void Tag::write(BinaryWriter &out) const {
+    out.putFixed(m_id);
+    out.putString(m_name);
 }
 
 TagIdType Tag::getId() const {
@@ -59,14 +77,13 @@ TagIdType BookTag::getGroupId() const {
     return m_groupId;
 }
 
-void BookTag::read(std::ifstream &in) {
-    Tag::read(in);
-    in.read(reinterpret_cast<char *>(&m_groupId), sizeof(m_groupId));
+bool BookTag::read(BinaryReader &in, std::size_t idSize) {
+    return Tag::read(in, idSize) && readTagId(in, m_groupId, idSize);
 }
 
-void BookTag::write(std::ofstream &out) const {
+void BookTag::write(BinaryWriter &out) const {
     Tag::write(out);
-    out.write(reinterpret_cast<const char *>(&m_groupId), sizeof(m_groupId));
+    out.putFixed(m_groupId);
 }
 /* ====== END ====== */
 
@@ -100,31 +117,41 @@ TagManager::TagsInfo<TagType>::TagsInfo() :
 void TagManager::clear() {
     m_clearTagsInfo(m_bookTags);
     m_clearTagsInfo(m_groupTags);
+    m_groupMembers.clear();
 }
 
-void TagManager::read(std::string_view path) {
-    constexpr auto readMethod = std::ios::in | std::ios::binary;
-
+bool TagManager::read(std::string_view path) {
     clear();
-    std::ifstream fin(path.begin(), readMethod);
-    read(fin);
-    fin.close();
+    FileHeader header;
+    std::string buffer;
+    std::span<const std::byte> body;
+    if (!readDataFile(fs::path(path), fileMagic, fileVersion, header, buffer, body)) return false;
+    // 头部记录写入时的标签ID字节数，较窄的旧文件在读入时扩宽
+    if (!checkTagIdSize(header.m_flags)) return false;
+    BinaryReader in(body);
+    return read(in, header.m_flags) && in.atEnd();
 }
 
-void TagManager::write(std::string_view path) const {
-    constexpr auto writeMethod = std::ios::out | std::ios::binary;
-
-    std::ofstream fout(path.begin(), writeMethod);
-    write(fout);
-    fout.close();
+bool TagManager::write(std::string_view path) const {
+    BinaryWriter out;
+    write(out);
+    FileHeader header{ fileMagic, fileVersion, std::uint16_t(sizeof(TagIdType)) };
+    return writeDataFile(fs::path(path), header, out);
 }
 
-void TagManager::read(std::ifstream &in) {
-    m_readInfo(in, m_bookTags);
-    m_readInfo(in, m_groupTags);
+bool TagManager::read(BinaryReader &in, std::size_t idSize) {
+    ScopedTimer timer(ProbeId::TagRead);
+    clear();
+    if (m_readInfo(in, m_bookTags, idSize) && m_readInfo(in, m_groupTags, idSize) && m_checkGroupIds()) {
+        m_rebuildGroupMembers();
+        return true;
+    }
+    clear();
+    in.setFail();
+    return false;
 }
 
-void TagManager::write(std::ofstream &out) const {
+void TagManager::write(BinaryWriter &out) const {
     m_writeInfo(out, m_bookTags);
     m_writeInfo(out, m_groupTags);
 }
@@ -160,9 +187,15 @@ bool TagManager::checkGroupTagId(TagIdType id) const {
 TagIdType TagManager::createBookTag(std::string_view name, TagIdType groupId) {
     auto id = m_getTagId(name, m_bookTags);
     if (id != nullTagId) return id;
+    if (!checkGroupTagId(groupId)) return nullTagId;
     id = m_getNewId(m_bookTags);
     if (id == nullTagId) return id;
     m_bookTags.m_Tags[id] = BookTag(id, groupId, name);
+    m_indexName(m_bookTags.m_Tags[id], m_bookTags);
+    if (m_groupMembers.size() <= groupId) m_groupMembers.resize(std::size_t(groupId) + 1U);
+    auto &members = m_groupMembers[groupId];
+    members.insert(std::lower_bound(members.begin(), members.end(), id), id);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::CreateBookTag, .m_tagId = id, .m_groupId = groupId, .m_name = std::string(name) });
     return id;
 }
 
@@ -172,15 +205,40 @@ TagIdType TagManager::createGroupTag(std::string_view name) {
     id = m_getNewId(m_groupTags);
     if (id == nullTagId) return id;
     m_groupTags.m_Tags[id] = GroupTag(id, name);
+    m_indexName(m_groupTags.m_Tags[id], m_groupTags);
+    if (m_journal) m_journal->append({ .m_op = JournalOp::CreateGroupTag, .m_tagId = id, .m_name = std::string(name) });
     return id;
 }
 
 bool TagManager::eraseBookTag(TagIdType id) {
-    return m_eraseTag(id, m_bookTags);
+    auto groupId = getGroupTagId(id);
+    if (!m_eraseTag(id, m_bookTags)) return false;
+    auto &members = m_groupMembers[groupId];
+    members.erase(std::lower_bound(members.begin(), members.end(), id));
+    if (m_journal) m_journal->append({ .m_op = JournalOp::EraseBookTag, .m_tagId = id });
+    return true;
 }
 
 bool TagManager::eraseGroupTag(TagIdType id) {
-    return m_eraseTag(id, m_groupTags);
+    if (!m_eraseTag(id, m_groupTags)) return false;
+    if (m_journal) m_journal->append({ .m_op = JournalOp::EraseGroupTag, .m_tagId = id });
+    return true;
+}
+
+bool TagManager::renameBookTag(TagIdType id, std::string_view name) {
+    if (!m_renameTag(id, name, m_bookTags)) return false;
+    if (m_journal) m_journal->append({ .m_op = JournalOp::RenameBookTag, .m_tagId = id, .m_name = std::string(name) });
+    return true;
+}
+
+bool TagManager::renameGroupTag(TagIdType id, std::string_view name) {
+    if (!m_renameTag(id, name, m_groupTags)) return false;
+    if (m_journal) m_journal->append({ .m_op = JournalOp::RenameGroupTag, .m_tagId = id, .m_name = std::string(name) });
+    return true;
+}
+
+void TagManager::setJournal(Journal *journal) {
+    m_journal = journal;
 }
 
 std::size_t TagManager::getSumOfBookTags() const {
@@ -192,20 +250,37 @@ std::size_t TagManager::getSumOfGroupTags() const {
 }
 
 std::size_t TagManager::getSumOfTagsFromGroup(TagIdType groupId) const {
-    std::size_t ret = 0U;
-    for (const auto &tag : m_bookTags.m_Tags) {
-        if (tag.isNull()) continue;
-        if (tag.getGroupId() == groupId) ++ret;
-    }
-    return ret;
+    return getGroupMembers(groupId).size();
 }
 
 std::unique_ptr<TagIdList> TagManager::getBookTags(TagIdType groupId) const {
-    std::unique_ptr<TagIdList> ret(new std::vector<TagIdType>());
-    for (const auto &tag : m_bookTags.m_Tags) {
+    auto members = getGroupMembers(groupId);
+    return std::make_unique<TagIdList>(members.begin(), members.end());
+}
+
+std::span<const TagIdType> TagManager::getGroupMembers(TagIdType groupId) const {
+    if (groupId >= m_groupMembers.size()) return {};
+    return m_groupMembers[groupId];
+}
+
+TagIdList TagManager::compactBookTags() {
+    auto &info = m_bookTags;
+    if (info.m_erasedTags.empty()) return {};
+    TagIdList ret(info.m_Tags.size(), nullTagId);
+    TagsInfo<BookTag>::TagList tags(1);
+    tags.reserve(info.m_curSumOfTags + 1U);
+    for (auto &tag : info.m_Tags) {
         if (tag.isNull()) continue;
-        if (tag.getGroupId() == groupId) ret->emplace_back(tag.getId());
+        auto id = static_cast<TagIdType>(tags.size());
+        ret[tag.getId()] = id;
+        tag.m_id = id;
+        tags.emplace_back(std::move(tag));
     }
+    info.m_Tags = std::move(tags);
+    info.m_curMaxTag = static_cast<TagIdType>(info.m_Tags.size() - 1U);
+    info.m_erasedTags.clear();
+    m_rebuildNameIndex(info);
+    m_rebuildGroupMembers();
     return ret;
 }
 
@@ -217,13 +292,41 @@ std::unique_ptr<TagIdList> TagManager::getGroupTags() const {
     return m_getTags(m_groupTags);
 }
 
+TagSuggestionList TagManager::suggestBookTags(std::string_view prefix, std::size_t limit,
+    unsigned maxDistance, TagIdType groupTagId) const {
+    auto scope = groupTagId == nullTagId ? NameTrie::anyScope : std::uint32_t(groupTagId);
+    return m_suggest(prefix, limit, maxDistance, scope, m_bookTags);
+}
+
+TagSuggestionList TagManager::suggestGroupTags(std::string_view prefix, std::size_t limit, unsigned maxDistance) const {
+    return m_suggest(prefix, limit, maxDistance, NameTrie::anyScope, m_groupTags);
+}
+
 // 私有方法
+void TagManager::m_rebuildGroupMembers() {
+    m_groupMembers.clear();
+    // 按ID升序遍历，各组内自然有序
+    for (const auto &tag : m_bookTags.m_Tags) {
+        if (tag.isNull()) continue;
+        if (m_groupMembers.size() <= tag.getGroupId()) m_groupMembers.resize(std::size_t(tag.getGroupId()) + 1U);
+        m_groupMembers[tag.getGroupId()].emplace_back(tag.getId());
+    }
+}
+
+bool TagManager::m_checkGroupIds() const {
+    // 组标签被删除后其书标签仍保留原组ID，因此只要求不超出组标签ID的范围
+    return std::all_of(m_bookTags.m_Tags.begin(), m_bookTags.m_Tags.end(),
+        [this](const BookTag &tag) { return tag.isNull() || tag.getGroupId() <= m_groupTags.m_curMaxTag; });
+}
+
 template<isTagType TagType>
 void TagManager::m_clearTagsInfo(TagsInfo<TagType> &info) {
     info.m_curSumOfTags = std::size_t(0U);
     info.m_curMaxTag = nullTagId;
-    info.m_Tags.clear();
-    info.m_erasedTags = TagIdHeap();
+    info.m_Tags.assign(1, TagType());      // 保留下标为 nullTagId 的空标签
+    info.m_erasedTags.clear();
+    info.m_nameIndex.clear();
+    info.m_nameTrie.clear();
 }
 
 template<isTagType TagType>
@@ -233,10 +336,37 @@ bool TagManager::m_checkId(TagIdType id, const TagsInfo<TagType> &info) const {
 
 template<isTagType TagType>
 TagIdType TagManager::m_getTagId(std::string_view name, const TagsInfo<TagType> &info) const {
+    auto it = info.m_nameIndex.find(name);
+    if (it == info.m_nameIndex.end()) return nullTagId;
+    return it->second;
+}
+
+template<isTagType TagType>
+void TagManager::m_rebuildNameIndex(TagsInfo<TagType> &info) {
+    info.m_nameIndex.clear();
+    info.m_nameIndex.reserve(info.m_curSumOfTags);
+    info.m_nameTrie.clear();
     for (const auto &tag : info.m_Tags) {
-        if (name == tag.getName()) return tag.getId();
+        if (tag.isNull()) continue;
+        m_indexName(tag, info);
     }
-    return nullTagId;
+}
+
+template<isTagType TagType>
+void TagManager::m_indexName(const TagType &tag, TagsInfo<TagType> &info) {
+    info.m_nameIndex.emplace(tag.getName(), tag.getId());
+    if constexpr (std::is_same_v<TagType, BookTag>) info.m_nameTrie.insert(tag.getName(), tag.getId(), tag.getGroupId());
+    else info.m_nameTrie.insert(tag.getName(), tag.getId(), nullTagId);
+}
+
+template<isTagType TagType>
+TagSuggestionList TagManager::m_suggest(std::string_view prefix, std::size_t limit, unsigned maxDistance,
+    std::uint32_t scope, const TagsInfo<TagType> &info) const {
+    TagSuggestionList ret;
+    for (const auto &match : info.m_nameTrie.match(prefix, maxDistance, limit, scope)) {
+        ret.emplace_back(TagSuggestion{ static_cast<TagIdType>(match.m_value), match.m_distance });
+    }
+    return ret;
 }
 
 template<isTagType TagType>
@@ -246,51 +376,56 @@ const TagType &TagManager::m_getTag(TagIdType id, const TagsInfo<TagType> &info)
 }
 
 template<isTagType TagType>
-void TagManager::m_readInfo(std::ifstream &in, TagsInfo<TagType> &info) {
-    in.read(reinterpret_cast<char *>(&info.m_curSumOfTags), sizeof(info.m_curSumOfTags));
-    in.read(reinterpret_cast<char *>(&info.m_curMaxTag), sizeof(info.m_curMaxTag));
+bool TagManager::m_readInfo(BinaryReader &in, TagsInfo<TagType> &info, std::size_t idSize) {
+    std::uint64_t sum;
     std::size_t size;
-    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    if (!in.getVarint(sum) || !readTagId(in, info.m_curMaxTag, idSize)) return false;
+    info.m_curSumOfTags = static_cast<std::size_t>(sum);
+    // 每个标签至少包含 ID 与名字长度
+    if (!in.getCount(size, idSize + 1U) || size != std::size_t(info.m_curMaxTag) + 1U) return false;
     info.m_Tags.resize(size);
-    // for (decltype(size) i = 0; i < size; ++i) {
-    //     info.m_Tags[i].read();
-    // }
+    std::size_t sumOfTags = 0U;
     for (auto &tag : info.m_Tags) {
-        tag.read(in);
+        if (!tag.read(in, idSize)) return false;
+        if (!tag.isNull()) ++sumOfTags;
     }
-    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    if (sumOfTags != info.m_curSumOfTags) return false;
+    if (!in.getCount(size, idSize)) return false;
     TagIdType tmp;
     for (decltype(size) i = 0; i < size; ++i) {
-        in.read(reinterpret_cast<char *>(&tmp), sizeof(tmp));
-        info.m_erasedTags.push(tmp);
+        if (!readTagId(in, tmp, idSize)) return false;
+        // 被删除的ID必须在范围内、对应空标签且不重复
+        if (tmp > info.m_curMaxTag || !info.m_Tags[tmp].isNull() || !info.m_erasedTags.release(tmp)) return false;
     }
+    if (info.m_erasedTags.size() != std::size_t(info.m_curMaxTag) - info.m_curSumOfTags) return false;
+    m_rebuildNameIndex(info);
+    return true;
 }
 
 template<isTagType TagType>
-void TagManager::m_writeInfo(std::ofstream &out, const TagsInfo<TagType> &info) const {
-    out.write(reinterpret_cast<const char *>(&info.m_curSumOfTags), sizeof(info.m_curSumOfTags));
-    out.write(reinterpret_cast<const char *>(&info.m_curMaxTag), sizeof(info.m_curMaxTag));
-    auto size = info.m_Tags.size();
-    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+void TagManager::m_writeInfo(BinaryWriter &out, const TagsInfo<TagType> &info) const {
+    out.putVarint(info.m_curSumOfTags);
+    out.putFixed(info.m_curMaxTag);
+    out.putVarint(info.m_Tags.size());
     for (const auto &tag : info.m_Tags) {
         tag.write(out);
     }
-    auto tmp_heap = info.m_erasedTags;
-    while (!info.m_erasedTags.empty()) {
-        auto tmp = tmp_heap.top(); tmp_heap.pop();
-        out.write(reinterpret_cast<const char *>(&tmp), sizeof(tmp));
-    }
+    auto erasedTags = info.m_erasedTags.toList();
+    out.putVarint(erasedTags.size());
+    for (auto id : erasedTags) out.putFixed(static_cast<TagIdType>(id));
 }
 
 template<isTagType TagType>
 TagIdType TagManager::m_getNewId(TagsInfo<TagType> &info) {
     if (!info.m_erasedTags.empty()) {
         ++info.m_curSumOfTags;
-        auto id = info.m_erasedTags.top(); info.m_erasedTags.pop();
-        return id;
+        return static_cast<TagIdType>(info.m_erasedTags.acquire());
     } else if (info.m_curMaxTag < maxTagId) {
         ++info.m_curSumOfTags;
-        return ++info.m_curMaxTag;
+        ++info.m_curMaxTag;
+        // 保证新 ID 在 m_Tags 中有对应的位置
+        if (info.m_Tags.size() <= info.m_curMaxTag) info.m_Tags.resize(info.m_curMaxTag + 1U);
+        return info.m_curMaxTag;
     } else {
         return nullTagId;
     }
@@ -301,14 +436,31 @@ bool TagManager::m_eraseTag(TagIdType id, TagsInfo<TagType> &info) {
     if (!m_checkId(id, info)) return false;
     --info.m_curSumOfTags;
     auto &tag = info.m_Tags[id];
-    info.m_erasedTags.emplace(tag.getId());
+    auto it = info.m_nameIndex.find(tag.getName());
+    if (it != info.m_nameIndex.end()) info.m_nameIndex.erase(it);
+    info.m_nameTrie.erase(tag.getName(), id);
+    info.m_erasedTags.release(tag.getId());
     tag.m_id = nullTagId;
     return true;
 }
 
+template<isTagType TagType>
+bool TagManager::m_renameTag(TagIdType id, std::string_view name, TagsInfo<TagType> &info) {
+    if (!m_checkId(id, info)) return false;
+    auto oldId = m_getTagId(name, info);
+    if (oldId != nullTagId) return oldId == id;
+    auto &tag = info.m_Tags[id];
+    auto it = info.m_nameIndex.find(tag.getName());
+    if (it != info.m_nameIndex.end()) info.m_nameIndex.erase(it);
+    info.m_nameTrie.erase(tag.getName(), id);
+    tag.m_name = StringPool::global().intern(name);
+    m_indexName(tag, info);
+    return true;
+}
+
 template<isTagType TagType>
 std::size_t TagManager::m_getSumOfTags(const TagsInfo<TagType> &info) const {
-    return info.m_curMaxTag - info.m_erasedTags.size();
+    return info.m_curSumOfTags;
 }
 
 template<isTagType TagType>
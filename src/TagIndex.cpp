@@ -0,0 +1,86 @@
+#include "TagIndex.h"
+#include <algorithm>
+
+using namespace book;
+
+/* class TagIndex */
+/* ===== BEGIN ===== */
+const IdBitmap TagIndex::m_emptyBitmap;
+
+// 公有函数
+void TagIndex::clear() {
+    m_tagBooks.clear();
+    m_allBooks.clear();
+}
+
+void TagIndex::addBook(BookIdType bookId, std::span<const TagIdType> tags) {
+    if (bookId == nullBookId) return ;
+    m_allBooks.add(bookId);
+    for (auto tagId : tags) add(tagId, bookId);
+}
+
+void TagIndex::removeBook(BookIdType bookId, std::span<const TagIdType> tags) {
+    for (auto tagId : tags) remove(tagId, bookId);
+    m_allBooks.remove(bookId);
+}
+
+void TagIndex::add(TagIdType tagId, BookIdType bookId) {
+    if (tagId == nullTagId || bookId == nullBookId) return ;
+    if (m_tagBooks.size() <= tagId) m_tagBooks.resize(std::size_t(tagId) + 1U);
+    m_tagBooks[tagId].add(bookId);
+}
+
+void TagIndex::remove(TagIdType tagId, BookIdType bookId) {
+    if (tagId >= m_tagBooks.size()) return ;
+    m_tagBooks[tagId].remove(bookId);
+}
+
+void TagIndex::eraseTag(TagIdType tagId) {
+    if (tagId >= m_tagBooks.size()) return ;
+    m_tagBooks[tagId].clear();
+}
+
+const IdBitmap &TagIndex::getBooks(TagIdType tagId) const {
+    if (tagId >= m_tagBooks.size()) return m_emptyBitmap;
+    return m_tagBooks[tagId];
+}
+
+const IdBitmap &TagIndex::getAllBooks() const {
+    return m_allBooks;
+}
+
+IdBitmap TagIndex::query(const TagQuery &query) const {
+    IdBitmap ret;
+    if (!query.m_all.empty()) {
+        // 从最小的位图开始求交集，结果为空时提前结束
+        std::vector<const IdBitmap *> bitmaps;
+        bitmaps.reserve(query.m_all.size());
+        for (auto tagId : query.m_all) bitmaps.push_back(&getBooks(tagId));
+        std::sort(bitmaps.begin(), bitmaps.end(),
+            [](const IdBitmap *a, const IdBitmap *b) { return a->size() < b->size(); });
+        ret = *bitmaps.front();
+        for (auto it = bitmaps.begin() + 1; it != bitmaps.end() && !ret.empty(); ++it) {
+            ret &= **it;
+        }
+    } else if (query.m_any.empty()) {
+        ret = m_allBooks;
+    }
+
+    if (!query.m_any.empty() && (query.m_all.empty() || !ret.empty())) {
+        IdBitmap any;
+        for (auto tagId : query.m_any) any |= getBooks(tagId);
+        if (query.m_all.empty()) ret = std::move(any);
+        else ret &= any;
+    }
+
+    for (auto tagId : query.m_none) {
+        if (ret.empty()) break;
+        ret -= getBooks(tagId);
+    }
+    return ret;
+}
+
+BookIdList TagIndex::search(const TagQuery &q) const {
+    return query(q).toList();
+}
+/* ====== END ====== */
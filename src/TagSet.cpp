@@ -0,0 +1,284 @@
+#include "TagSet.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BOOK_TAG_SET_SSE2 1
+#endif
+
+using namespace book;
+
+/* 标签集合辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr std::size_t laneCount = 16U / sizeof(TagIdType);   // 一次 SIMD 比较的标签个数（128 位）
+    constexpr std::size_t maxBitsetWords = 1024U;                   // 位图最多的字数，最大ID超出时不建立位图
+
+    // 在升序的 ids[0, size) 内二分查找 tagId，返回下标，不存在时返回 size
+    std::size_t searchId(const TagIdType *ids, std::size_t size, TagIdType tagId) {
+        auto it = std::lower_bound(ids, ids + size, tagId);
+        return it != ids + size && *it == tagId ? static_cast<std::size_t>(it - ids) : size;
+    }
+
+#ifdef BOOK_TAG_SET_SSE2
+    // 按 TagIdType 的宽度逐通道比较，相等的通道全部置位
+    __m128i compareLanes(__m128i lanes, TagIdType tagId) {
+        if constexpr (sizeof(TagIdType) == 2U) return _mm_cmpeq_epi16(lanes, _mm_set1_epi16(static_cast<short>(tagId)));
+        else return _mm_cmpeq_epi32(lanes, _mm_set1_epi32(static_cast<int>(tagId)));
+    }
+#endif
+
+    /*
+     * 在 ids[0, size) 内查找 tagId，返回下标，不存在时返回 size
+     * 储存区的容量总是 laneCount 的倍数，因此可以整组读取，超出 size 的部分由掩码排除
+     */
+    std::size_t findId(const TagIdType *ids, std::size_t size, TagIdType tagId) {
+#ifdef BOOK_TAG_SET_SSE2
+        for (std::size_t i = 0; i < size; i += laneCount) {
+            auto lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ids + i));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(compareLanes(lanes, tagId)));
+            if (size - i < laneCount) mask &= (1U << (sizeof(TagIdType) * (size - i))) - 1U;
+            if (mask != 0U) return i + static_cast<std::size_t>(std::countr_zero(mask)) / sizeof(TagIdType);
+        }
+        return size;
+#else
+        return searchId(ids, size, tagId);
+#endif
+    }
+
+    // 储存区内各数组的序号
+    constexpr std::size_t tagArray = 0U;        // 标签ID
+    constexpr std::size_t tagGroupArray = 1U;   // 标签的组ID
+    constexpr std::size_t groupArray = 2U;      // 出现过的组ID
+    constexpr std::size_t countArray = 3U;      // 组内标签个数
+    constexpr std::size_t sumOfArrays = 4U;
+
+    // 不小于 size 的最小的 laneCount 的倍数
+    std::size_t roundCapacity(std::size_t size) {
+        return (size + laneCount - 1U) / laneCount * laneCount;
+    }
+}
+/* ====== END ====== */
+
+/* class TagSet */
+/* ===== BEGIN ===== */
+TagSet::TagSet(const TagSet &other) {
+    *this = other;
+}
+
+TagSet::TagSet(TagSet &&other) noexcept {
+    *this = std::move(other);
+}
+
+TagSet &TagSet::operator=(const TagSet &other) {
+    if (this == &other) return *this;
+    clear();
+    m_reserve(other.m_size);
+    for (std::size_t i = 0; i < sumOfArrays; ++i) {
+        auto size = i < groupArray ? other.m_size : other.m_sumOfGroups;
+        std::copy_n(other.m_array(i), size, m_array(i));
+    }
+    m_size = other.m_size;
+    m_sumOfGroups = other.m_sumOfGroups;
+    m_bits = other.m_bits;
+    return *this;
+}
+
+TagSet &TagSet::operator=(TagSet &&other) noexcept {
+    if (this == &other) return *this;
+    m_inline = other.m_inline;
+    m_heap = std::move(other.m_heap);
+    m_size = other.m_size;
+    m_sumOfGroups = other.m_sumOfGroups;
+    m_capacity = other.m_capacity;
+    m_bits = std::move(other.m_bits);
+    other.clear();
+    return *this;
+}
+
+bool TagSet::insert(TagIdType tagId, TagIdType groupId) {
+    if (contains(tagId)) return false;
+    if (m_size == m_capacity) m_reserve(std::size_t(m_capacity) * 2U);
+    auto ids = m_array(tagArray), groupIds = m_array(tagGroupArray);
+    auto pos = static_cast<std::size_t>(std::lower_bound(ids, ids + m_size, tagId) - ids);
+    std::copy_backward(ids + pos, ids + m_size, ids + m_size + 1U);
+    std::copy_backward(groupIds + pos, groupIds + m_size, groupIds + m_size + 1U);
+    ids[pos] = tagId;
+    groupIds[pos] = groupId;
+    ++m_size;
+    m_countGroup(groupId, 1);
+    if (!m_bits.empty()) {
+        // 超出位图上限的ID使位图失效，之后回到二分查找，直到标签个数重新越过阈值
+        if (tagId / 64U >= maxBitsetWords) m_bits = {};
+        else if (tagId / 64U >= m_bits.size()) m_bits.resize(tagId / 64U + 1U);
+        if (!m_bits.empty()) m_bits[tagId / 64U] |= std::uint64_t(1U) << (tagId % 64U);
+    } else if (m_size == bitsetThreshold + 1U) {
+        m_rebuildBits();
+    }
+    return true;
+}
+
+bool TagSet::erase(TagIdType tagId) {
+    if (!contains(tagId)) return false;
+    auto ids = m_array(tagArray), groupIds = m_array(tagGroupArray);
+    auto pos = m_find(tagId);
+    m_countGroup(groupIds[pos], -1);
+    std::copy(ids + pos + 1U, ids + m_size, ids + pos);
+    std::copy(groupIds + pos + 1U, groupIds + m_size, groupIds + pos);
+    --m_size;
+    if (!m_bits.empty()) {
+        if (m_size <= bitsetThreshold / 2U) m_rebuildBits();
+        else m_bits[tagId / 64U] &= ~(std::uint64_t(1U) << (tagId % 64U));
+    }
+    if (m_heap && m_size <= inlineCapacity / 2U) m_reserve(inlineCapacity);
+    return true;
+}
+
+std::size_t TagSet::eraseGroup(TagIdType groupId) {
+    auto count = getSumOfTags(groupId);
+    if (count == 0U) return 0U;
+    auto ids = m_array(tagArray), groupIds = m_array(tagGroupArray);
+    std::size_t size = 0U;
+    for (std::size_t i = 0; i < m_size; ++i) {
+        if (groupIds[i] == groupId) continue;
+        ids[size] = ids[i];
+        groupIds[size++] = groupIds[i];
+    }
+    m_size = static_cast<std::uint32_t>(size);
+    m_countGroup(groupId, -static_cast<int>(count));
+    if (!m_bits.empty()) m_rebuildBits();
+    if (m_heap && m_size <= inlineCapacity / 2U) m_reserve(inlineCapacity);
+    return count;
+}
+
+void TagSet::clear() {
+    m_heap.reset();
+    m_size = 0U;
+    m_sumOfGroups = 0U;
+    m_capacity = inlineCapacity;
+    m_bits = {};
+}
+
+void TagSet::remap(std::span<const TagIdType> table) {
+    std::vector<std::pair<TagIdType, TagIdType>> tags;
+    tags.reserve(m_size);
+    auto ids = m_array(tagArray), groupIds = m_array(tagGroupArray);
+    for (std::size_t i = 0; i < m_size; ++i) {
+        auto tagId = ids[i] < table.size() ? table[ids[i]] : nullTagId;
+        if (tagId != nullTagId) tags.emplace_back(tagId, groupIds[i]);
+    }
+    std::ranges::sort(tags);
+    clear();
+    for (const auto &[tagId, groupId] : tags) insert(tagId, groupId);
+}
+
+bool TagSet::contains(TagIdType tagId) const {
+    if (!m_bits.empty()) return tagId / 64U < m_bits.size() && (m_bits[tagId / 64U] >> (tagId % 64U) & 1U);
+    return m_find(tagId) != m_size;
+}
+
+std::size_t TagSet::size() const {
+    return m_size;
+}
+
+bool TagSet::empty() const {
+    return m_size == 0U;
+}
+
+std::span<const TagIdType> TagSet::getTags() const {
+    return { m_array(tagArray), m_size };
+}
+
+TagIdList TagSet::getTags(TagIdType groupId) const {
+    TagIdList ret;
+    ret.reserve(getSumOfTags(groupId));
+    auto ids = m_array(tagArray), groupIds = m_array(tagGroupArray);
+    for (std::size_t i = 0; ret.size() < ret.capacity() && i < m_size; ++i) {
+        if (groupIds[i] == groupId) ret.emplace_back(ids[i]);
+    }
+    return ret;
+}
+
+std::size_t TagSet::getSumOfTags(TagIdType groupId) const {
+    auto pos = m_findGroup(groupId);
+    return pos != m_sumOfGroups ? m_array(countArray)[pos] : 0U;
+}
+
+std::span<const TagIdType> TagSet::getGroups() const {
+    return { m_array(groupArray), m_sumOfGroups };
+}
+
+std::size_t TagSet::getMemoryUsage() const {
+    return (m_heap ? m_capacity * sumOfArrays * sizeof(TagIdType) : 0U) + m_bits.capacity() * sizeof(std::uint64_t);
+}
+
+// 私有函数
+TagIdType *TagSet::m_array(std::size_t index) {
+    return (m_heap ? m_heap.get() : m_inline.data()) + index * m_capacity;
+}
+
+const TagIdType *TagSet::m_array(std::size_t index) const {
+    return (m_heap ? m_heap.get() : m_inline.data()) + index * m_capacity;
+}
+
+std::size_t TagSet::m_find(TagIdType tagId) const {
+    if (m_size > bitsetThreshold) return searchId(m_array(tagArray), m_size, tagId);
+    return findId(m_array(tagArray), m_size, tagId);
+}
+
+std::size_t TagSet::m_findGroup(TagIdType groupId) const {
+    return findId(m_array(groupArray), m_sumOfGroups, groupId);
+}
+
+void TagSet::m_reserve(std::size_t capacity) {
+    capacity = roundCapacity(std::max<std::size_t>(capacity, m_size));
+    if (capacity <= inlineCapacity && !m_heap) return;
+    // 超出个数的部分也会被整组读取，需要初始化
+    Storage buffer{};
+    std::unique_ptr<TagIdType[]> heap;
+    if (capacity <= inlineCapacity) capacity = inlineCapacity;
+    else heap = std::make_unique<TagIdType[]>(capacity * sumOfArrays);
+    auto data = heap ? heap.get() : buffer.data();
+    for (std::size_t i = 0; i < sumOfArrays; ++i) {
+        std::copy_n(m_array(i), i < groupArray ? m_size : m_sumOfGroups, data + i * capacity);
+    }
+    if (!heap) m_inline = buffer;
+    m_heap = std::move(heap);
+    m_capacity = static_cast<std::uint32_t>(capacity);
+}
+
+void TagSet::m_countGroup(TagIdType groupId, int delta) {
+    auto groups = m_array(groupArray), counts = m_array(countArray);
+    auto pos = m_findGroup(groupId);
+    if (pos == m_sumOfGroups) {
+        // 组的个数不超过标签个数，储存区总能容纳
+        pos = static_cast<std::size_t>(std::lower_bound(groups, groups + m_sumOfGroups, groupId) - groups);
+        std::copy_backward(groups + pos, groups + m_sumOfGroups, groups + m_sumOfGroups + 1U);
+        std::copy_backward(counts + pos, counts + m_sumOfGroups, counts + m_sumOfGroups + 1U);
+        groups[pos] = groupId;
+        counts[pos] = 0U;
+        ++m_sumOfGroups;
+    }
+    counts[pos] = static_cast<TagIdType>(counts[pos] + delta);
+    if (counts[pos] != 0U) return;
+    std::copy(groups + pos + 1U, groups + m_sumOfGroups, groups + pos);
+    std::copy(counts + pos + 1U, counts + m_sumOfGroups, counts + pos);
+    --m_sumOfGroups;
+}
+
+void TagSet::m_rebuildBits() {
+    m_bits.clear();
+    if (m_size <= bitsetThreshold / 2U) {
+        m_bits.shrink_to_fit();
+        return;
+    }
+    auto ids = m_array(tagArray);
+    if (ids[m_size - 1U] / 64U >= maxBitsetWords) {
+        m_bits.shrink_to_fit();
+        return;
+    }
+    m_bits.resize(ids[m_size - 1U] / 64U + 1U);
+    for (std::size_t i = 0; i < m_size; ++i) m_bits[ids[i] / 64U] |= std::uint64_t(1U) << (ids[i] % 64U);
+}
+/* ====== END ====== */
@@ -0,0 +1,143 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace book;
+
+namespace {
+    // 当前线程所属的线程池与其工作线程编号，用于在工作线程内提交任务时放入自己的队列
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local std::size_t currentIndex = 0U;
+}
+
+/* class ThreadPool */
+/* ===== BEGIN ===== */
+// 构造函数
+ThreadPool::ThreadPool(std::size_t sumOfThreads) {
+    if (sumOfThreads == 0U) sumOfThreads = std::max(1U, std::thread::hardware_concurrency());
+    m_queues.reserve(sumOfThreads);
+    for (std::size_t i = 0; i < sumOfThreads; ++i) m_queues.emplace_back(new WorkQueue());
+    m_workers.reserve(sumOfThreads);
+    for (std::size_t i = 0; i < sumOfThreads; ++i) {
+        m_workers.emplace_back(&ThreadPool::m_workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskReady.notify_all();
+    for (auto &worker : m_workers) worker.join();
+}
+
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// 公有函数
+void ThreadPool::submit(Task task) {
+    auto index = currentPool == this ? currentIndex
+        : m_nextQueue.fetch_add(1U, std::memory_order_relaxed) % m_queues.size();
+    {
+        // 先计数再放入队列，否则任务可能在计数前就被执行完毕，使计数回绕；
+        // 持有 m_mutex 放入队列，等待中的工作线程不会错过通知
+        std::lock_guard lock(m_mutex);
+        ++m_sumOfPending;
+        std::lock_guard queueLock(m_queues[index]->m_mutex);
+        m_queues[index]->m_tasks.emplace_back(std::move(task));
+    }
+    m_taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(m_mutex);
+    m_allDone.wait(lock, [this] { return m_sumOfPending == 0U; });
+}
+
+std::size_t ThreadPool::getSumOfThreads() const {
+    return m_workers.size();
+}
+
+// 私有函数
+void ThreadPool::m_workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    Task task;
+    while (true) {
+        if (m_takeTask(index, task)) {
+            task();
+            task = nullptr;
+            std::lock_guard lock(m_mutex);
+            if (--m_sumOfPending == 0U) m_allDone.notify_all();
+            continue;
+        }
+        std::unique_lock lock(m_mutex);
+        // 队列中的任务数量不少于 m_sumOfPending 减去正在执行的任务数，这里只需判断是否有剩余
+        m_taskReady.wait(lock, [this, index] {
+            if (m_stop) return true;
+            for (std::size_t i = 0; i < m_queues.size(); ++i) {
+                auto &queue = *m_queues[(index + i) % m_queues.size()];
+                std::lock_guard queueLock(queue.m_mutex);
+                if (!queue.m_tasks.empty()) return true;
+            }
+            return false;
+        });
+        if (m_stop && m_sumOfPending == 0U) return;
+    }
+}
+
+bool ThreadPool::m_takeTask(std::size_t index, Task &task) {
+    {
+        // 从自己队列的尾部取任务
+        auto &queue = *m_queues[index];
+        std::lock_guard lock(queue.m_mutex);
+        if (!queue.m_tasks.empty()) {
+            task = std::move(queue.m_tasks.back());
+            queue.m_tasks.pop_back();
+            return true;
+        }
+    }
+    // 从其他队列的头部窃取任务
+    for (std::size_t i = 1; i < m_queues.size(); ++i) {
+        auto &queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard lock(queue.m_mutex);
+        if (!queue.m_tasks.empty()) {
+            task = std::move(queue.m_tasks.front());
+            queue.m_tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+/* ====== END ====== */
+
+/* class TaskGroup */
+/* ===== BEGIN ===== */
+// 构造函数
+TaskGroup::TaskGroup(ThreadPool &pool) : m_pool(&pool) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+// 公有函数
+void TaskGroup::submit(ThreadPool::Task task) {
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_sumOfPending;
+    }
+    m_pool->submit([this, task = std::move(task)] {
+        task();
+        std::lock_guard lock(m_mutex);
+        if (--m_sumOfPending == 0U) m_allDone.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    std::unique_lock lock(m_mutex);
+    m_allDone.wait(lock, [this] { return m_sumOfPending == 0U; });
+}
+/* ====== END ====== */
@@ -0,0 +1,505 @@
+#include "TitleIndex.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+using namespace book;
+
+/* 标题索引辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+    constexpr char32_t invalidCodePoint = 0xffffffffU;
+    constexpr std::uint64_t bigramFlag = std::uint64_t(1U) << 42U;     // 码位不超过 21 位，bigram 的键带此标记
+    constexpr std::uint64_t titleStartFlag = std::uint64_t(1U) << 43U; // 标题开头的 n-gram 另外登记一次，带此标记
+    constexpr std::uint64_t wordStartFlag = std::uint64_t(1U) << 44U;  // 词开头的 n-gram 另外登记一次，带此标记
+
+    // 从 str 的 pos 处解码一个 UTF-8 字符，pos 移到下一个字符，不合法时返回 invalidCodePoint 并跳过一个字节
+    char32_t decodeUtf8(std::string_view str, std::size_t &pos) {
+        auto lead = static_cast<unsigned char>(str[pos++]);
+        if (lead < 0x80U) return lead;
+        std::size_t length;
+        char32_t cp;
+        if ((lead & 0xe0U) == 0xc0U) { length = 1U; cp = lead & 0x1fU; }
+        else if ((lead & 0xf0U) == 0xe0U) { length = 2U; cp = lead & 0x0fU; }
+        else if ((lead & 0xf8U) == 0xf0U) { length = 3U; cp = lead & 0x07U; }
+        else return invalidCodePoint;
+        if (str.size() - pos < length) return invalidCodePoint;
+        for (std::size_t i = 0; i < length; ++i) {
+            auto byte = static_cast<unsigned char>(str[pos + i]);
+            if ((byte & 0xc0U) != 0x80U) return invalidCodePoint;
+            cp = (cp << 6U) | (byte & 0x3fU);
+        }
+        // 拒绝过长编码、代理项与超出范围的码位
+        static constexpr char32_t minValue[] = { 0U, 0x80U, 0x800U, 0x10000U };
+        if (cp < minValue[length] || cp > 0x10ffffU || (cp >= 0xd800U && cp <= 0xdfffU)) return invalidCodePoint;
+        pos += length;
+        return cp;
+    }
+
+    void appendUtf8(std::string &str, char32_t cp) {
+        if (cp < 0x80U) {
+            str.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800U) {
+            str.push_back(static_cast<char>(0xc0U | (cp >> 6U)));
+            str.push_back(static_cast<char>(0x80U | (cp & 0x3fU)));
+        } else if (cp < 0x10000U) {
+            str.push_back(static_cast<char>(0xe0U | (cp >> 12U)));
+            str.push_back(static_cast<char>(0x80U | ((cp >> 6U) & 0x3fU)));
+            str.push_back(static_cast<char>(0x80U | (cp & 0x3fU)));
+        } else {
+            str.push_back(static_cast<char>(0xf0U | (cp >> 18U)));
+            str.push_back(static_cast<char>(0x80U | ((cp >> 12U) & 0x3fU)));
+            str.push_back(static_cast<char>(0x80U | ((cp >> 6U) & 0x3fU)));
+            str.push_back(static_cast<char>(0x80U | (cp & 0x3fU)));
+        }
+    }
+
+    // 全角转半角，大写转小写（拉丁、希腊、西里尔字母）
+    char32_t foldCase(char32_t cp) {
+        if (cp >= 0xff01U && cp <= 0xff5eU) cp -= 0xfee0U;
+        else if (cp == 0x3000U) cp = U' ';
+        if (cp >= U'A' && cp <= U'Z') return cp + 0x20U;
+        if (cp < 0xc0U) return cp;
+        if (cp >= 0xc0U && cp <= 0xdeU && cp != 0xd7U) return cp + 0x20U;
+        if (cp >= 0x391U && cp <= 0x3a9U && cp != 0x3a2U) return cp + 0x20U;
+        if (cp >= 0x410U && cp <= 0x42fU) return cp + 0x20U;
+        if (cp >= 0x400U && cp <= 0x40fU) return cp + 0x50U;
+        return cp;
+    }
+
+    // 是否为分隔符：空白、控制字符与标点
+    bool isSeparator(char32_t cp) {
+        if (cp < 0x80U) {
+            return !((cp >= U'0' && cp <= U'9') || (cp >= U'a' && cp <= U'z') || (cp >= U'A' && cp <= U'Z'));
+        }
+        return cp < 0xc0U || cp == 0xd7U || cp == 0xf7U ||
+            (cp >= 0x2000U && cp <= 0x206fU) ||     // 通用标点
+            (cp >= 0x3000U && cp <= 0x3004U) ||     // 中日文空格与句读
+            (cp >= 0x3008U && cp <= 0x3011U) ||     // 括号
+            (cp >= 0x3014U && cp <= 0x301fU) ||
+            cp == 0x30fbU ||                        // 中点
+            (cp >= 0xfe10U && cp <= 0xfe1fU) ||     // 竖排标点
+            (cp >= 0xfe30U && cp <= 0xfe6fU) ||     // 兼容形式
+            (cp >= 0xff5fU && cp <= 0xff65U) ||     // 半角标点
+            cp == 0xfeffU;
+    }
+
+    // 将规范化的标题（合法 UTF-8）解码为码位，词之间保留空格
+    std::u32string toCodePoints(std::string_view title) {
+        std::u32string ret;
+        ret.reserve(title.size());
+        for (std::size_t pos = 0; pos < title.size(); ) ret.push_back(decodeUtf8(title, pos));
+        return ret;
+    }
+
+    std::uint64_t makeBigram(char32_t first, char32_t second) {
+        return bigramFlag | (std::uint64_t(first) << 21U) | second;
+    }
+
+    /*
+     * 规范化标题内所有不重复的 n-gram，已排序
+     * 每个字符的 unigram 与词内相邻字符的 bigram；每个词开头的 unigram 与 bigram 再带上词首标记登记一次，
+     * 标题开头的再带上标题开头标记，用于查询时先找出匹配程度高的书籍
+     */
+    std::vector<std::uint64_t> getIndexGrams(std::string_view title) {
+        auto cps = toCodePoints(title);
+        std::vector<std::uint64_t> ret;
+        ret.reserve(cps.size() * 3U);
+        for (std::size_t i = 0; i < cps.size(); ++i) {
+            if (cps[i] == U' ') continue;
+            auto hasNext = i + 1U < cps.size() && cps[i + 1U] != U' ';
+            std::uint64_t grams[] = { cps[i], hasNext ? makeBigram(cps[i], cps[i + 1U]) : 0U };
+            for (auto gram : grams) {
+                if (gram == 0U) continue;
+                ret.emplace_back(gram);
+                if (i == 0U || cps[i - 1U] == U' ') ret.emplace_back(gram | wordStartFlag);
+                if (i == 0U) ret.emplace_back(gram | titleStartFlag);
+            }
+        }
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+        return ret;
+    }
+
+    // 查询所需的 n-gram：多字符的词只需 bigram，单字符的词使用 unigram
+    std::vector<std::uint64_t> getQueryGrams(std::string_view query) {
+        auto cps = toCodePoints(query);
+        std::vector<std::uint64_t> ret;
+        for (std::size_t i = 0; i < cps.size(); ++i) {
+            if (cps[i] == U' ') continue;
+            auto prevSpace = i == 0U || cps[i - 1U] == U' ';
+            auto nextSpace = i + 1U == cps.size() || cps[i + 1U] == U' ';
+            if (prevSpace && nextSpace) ret.emplace_back(cps[i]);
+            else if (!nextSpace) ret.emplace_back(makeBigram(cps[i], cps[i + 1U]));
+        }
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+        return ret;
+    }
+
+    // 查询开头的 n-gram：第一个词只有一个字符时为 unigram，否则为 bigram
+    std::uint64_t getFirstGram(std::string_view query) {
+        std::size_t pos = 0U;
+        auto first = decodeUtf8(query, pos);
+        if (pos == query.size() || query[pos] == ' ') return first;
+        return makeBigram(first, decodeUtf8(query, pos));
+    }
+
+    void putVarint(std::vector<std::uint8_t> &out, std::uint32_t value) {
+        while (value >= 0x80U) {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80U));
+            value >>= 7U;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    // 倒排表只在内存中由 putVarint 写入，不需要检查越界
+    const std::uint8_t *getVarint(const std::uint8_t *p, std::uint32_t &value) {
+        std::uint32_t byte = *p++;
+        value = byte & 0x7fU;
+        for (unsigned shift = 7U; byte & 0x80U; shift += 7U) {
+            byte = *p++;
+            value |= (byte & 0x7fU) << shift;
+        }
+        return p;
+    }
+}
+
+std::string book::normalizeTitle(std::string_view title) {
+    std::string ret;
+    ret.reserve(title.size());
+    bool pendingSpace = false;
+    for (std::size_t pos = 0; pos < title.size(); ) {
+        auto cp = decodeUtf8(title, pos);
+        if (cp == invalidCodePoint) continue;
+        cp = foldCase(cp);
+        if (isSeparator(cp)) {
+            pendingSpace = !ret.empty();
+            continue;
+        }
+        if (pendingSpace) ret.push_back(' ');
+        pendingSpace = false;
+        appendUtf8(ret, cp);
+    }
+    return ret;
+}
+/* ====== END ====== */
+
+/* class PostingList */
+/* ===== BEGIN ===== */
+// 公有函数
+bool PostingList::add(BookIdType id) {
+    if (m_size == 0U || id > m_last) {
+        // 追加到末尾：最后一块未满时只写入差值
+        if (m_skips.empty() || m_skips.back().m_count >= blockSize) {
+            m_skips.emplace_back(Skip{ id, static_cast<std::uint32_t>(m_data.size()), 1U });
+        } else {
+            putVarint(m_data, id - m_last);
+            ++m_skips.back().m_count;
+        }
+        m_last = id;
+        ++m_size;
+        return true;
+    }
+    auto block = m_findBlock(id);
+    BookIdList ids;
+    m_decodeBlock(block, ids);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id) return false;
+    ids.insert(it, id);
+    m_encodeBlock(block, ids);
+    ++m_size;
+    return true;
+}
+
+bool PostingList::remove(BookIdType id) {
+    if (m_size == 0U || id > m_last) return false;
+    auto block = m_findBlock(id);
+    BookIdList ids;
+    m_decodeBlock(block, ids);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) return false;
+    ids.erase(it);
+    m_encodeBlock(block, ids);
+    --m_size;
+    if (id == m_last) {
+        ids.clear();
+        if (!m_skips.empty()) m_decodeBlock(m_skips.size() - 1U, ids);
+        m_last = ids.empty() ? nullBookId : ids.back();
+    }
+    return true;
+}
+
+std::size_t PostingList::size() const {
+    return m_size;
+}
+
+bool PostingList::empty() const {
+    return m_size == 0U;
+}
+
+BookIdList PostingList::toList() const {
+    BookIdList ret;
+    ret.reserve(m_size);
+    for (std::size_t i = 0; i < m_skips.size(); ++i) m_decodeBlock(i, ret);
+    return ret;
+}
+
+void PostingList::intersect(BookIdList &ids) const {
+    if (m_size == 0U) {
+        ids.clear();
+        return ;
+    }
+    // ids 与跳表都有序，只解码包含候选ID的块
+    BookIdList block;
+    std::size_t current = m_skips.size(), blockIndex = 0U, pos = 0U, out = 0U;
+    for (auto id : ids) {
+        if (id > m_last) break;
+        if (id < m_skips.front().m_first) continue;
+        if (blockIndex + 1U < m_skips.size() && m_skips[blockIndex + 1U].m_first <= id) {
+            auto it = std::upper_bound(m_skips.begin() + static_cast<std::ptrdiff_t>(blockIndex) + 1, m_skips.end(), id,
+                [](BookIdType value, const Skip &skip) { return value < skip.m_first; });
+            blockIndex = static_cast<std::size_t>(it - m_skips.begin()) - 1U;
+        }
+        if (blockIndex != current) {
+            block.clear();
+            m_decodeBlock(blockIndex, block);
+            current = blockIndex;
+            pos = 0U;
+        }
+        while (pos < block.size() && block[pos] < id) ++pos;
+        if (pos < block.size() && block[pos] == id) ids[out++] = id;
+    }
+    ids.resize(out);
+}
+
+std::size_t PostingList::getMemoryUsage() const {
+    return m_data.capacity() + m_skips.capacity() * sizeof(Skip);
+}
+
+// 私有函数
+std::size_t PostingList::m_getBlockEnd(std::size_t block) const {
+    return block + 1U < m_skips.size() ? m_skips[block + 1U].m_offset : m_data.size();
+}
+
+void PostingList::m_decodeBlock(std::size_t block, BookIdList &out) const {
+    const auto &skip = m_skips[block];
+    auto id = skip.m_first;
+    out.push_back(id);
+    auto p = m_data.data() + skip.m_offset;
+    for (std::uint32_t i = 1U; i < skip.m_count; ++i) {
+        std::uint32_t delta;
+        p = getVarint(p, delta);
+        id += delta;
+        out.push_back(id);
+    }
+}
+
+void PostingList::m_encodeBlock(std::size_t block, const BookIdList &ids) {
+    // 元素超过 2 * blockSize 时拆成每块 blockSize 个
+    std::vector<std::uint8_t> bytes;
+    std::vector<Skip> skips;
+    auto base = m_skips[block].m_offset;
+    auto chunk = ids.size() > 2U * blockSize ? blockSize : ids.size();
+    for (std::size_t first = 0; first < ids.size(); first += chunk) {
+        auto last = std::min(ids.size(), first + chunk);
+        skips.emplace_back(Skip{ ids[first], static_cast<std::uint32_t>(base + bytes.size()),
+            static_cast<std::uint32_t>(last - first) });
+        for (auto i = first + 1U; i < last; ++i) putVarint(bytes, ids[i] - ids[i - 1U]);
+    }
+
+    // 替换原有的编码，之后各块的偏移整体平移
+    auto begin = m_data.begin() + base, end = m_data.begin() + static_cast<std::ptrdiff_t>(m_getBlockEnd(block));
+    auto oldSize = static_cast<std::size_t>(end - begin);
+    if (bytes.size() <= oldSize) {
+        std::copy(bytes.begin(), bytes.end(), begin);
+        m_data.erase(begin + static_cast<std::ptrdiff_t>(bytes.size()), end);
+    } else {
+        std::copy(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(oldSize), begin);
+        m_data.insert(end, bytes.begin() + static_cast<std::ptrdiff_t>(oldSize), bytes.end());
+    }
+    auto shift = static_cast<std::uint32_t>(bytes.size() - oldSize);
+    for (auto i = block + 1U; i < m_skips.size(); ++i) m_skips[i].m_offset += shift;
+    auto pos = m_skips.erase(m_skips.begin() + static_cast<std::ptrdiff_t>(block));
+    m_skips.insert(pos, skips.begin(), skips.end());
+}
+
+std::size_t PostingList::m_findBlock(BookIdType id) const {
+    auto it = std::upper_bound(m_skips.begin(), m_skips.end(), id,
+        [](BookIdType value, const Skip &skip) { return value < skip.m_first; });
+    return it == m_skips.begin() ? 0U : static_cast<std::size_t>(it - m_skips.begin()) - 1U;
+}
+/* ====== END ====== */
+
+/* class TitleIndex */
+/* ===== BEGIN ===== */
+// 公有函数
+void TitleIndex::clear() {
+    m_postings.clear();
+    m_titles.clear();
+    m_lengths.clear();
+    m_sumOfBooks = 0U;
+}
+
+void TitleIndex::addBook(BookIdType bookId, std::string_view title) {
+    if (bookId == nullBookId) return ;
+    auto normalized = normalizeTitle(title);
+    if (m_titles.size() <= bookId) {
+        m_titles.resize(std::size_t(bookId) + 1U);
+        m_lengths.resize(std::size_t(bookId) + 1U);
+    }
+    auto &current = m_titles[bookId];
+    if (current == normalized) return ;
+
+    // 改名时只增删新旧标题不同的 n-gram
+    auto oldGrams = getIndexGrams(current), newGrams = getIndexGrams(normalized);
+    std::vector<std::uint64_t> removed, added;
+    std::set_difference(oldGrams.begin(), oldGrams.end(), newGrams.begin(), newGrams.end(), std::back_inserter(removed));
+    std::set_difference(newGrams.begin(), newGrams.end(), oldGrams.begin(), oldGrams.end(), std::back_inserter(added));
+    for (auto gram : removed) {
+        auto it = m_postings.find(gram);
+        if (it == m_postings.end()) continue;
+        it->second.remove(bookId);
+        if (it->second.empty()) m_postings.erase(it);
+    }
+    for (auto gram : added) m_postings[gram].add(bookId);
+
+    if (current.empty()) ++m_sumOfBooks;
+    if (normalized.empty()) --m_sumOfBooks;
+    m_lengths[bookId] = static_cast<std::uint16_t>(std::min<std::size_t>(normalized.size(), std::numeric_limits<std::uint16_t>::max()));
+    current = std::move(normalized);
+}
+
+void TitleIndex::removeBook(BookIdType bookId) {
+    if (bookId >= m_titles.size() || m_titles[bookId].empty()) return ;
+    addBook(bookId, {});
+    std::string().swap(m_titles[bookId]);
+}
+
+std::string_view TitleIndex::getTitle(BookIdType bookId) const {
+    return bookId < m_titles.size() ? std::string_view(m_titles[bookId]) : std::string_view();
+}
+
+std::size_t TitleIndex::getSumOfBooks() const {
+    return m_sumOfBooks;
+}
+
+std::size_t TitleIndex::getMemoryUsage() const {
+    std::size_t ret = 0U;
+    for (const auto &[gram, list] : m_postings) ret += sizeof(gram) + sizeof(list) + list.getMemoryUsage();
+    return ret;
+}
+
+std::vector<TitleMatch> TitleIndex::search(std::string_view query, std::size_t limit) const {
+    auto normalized = normalizeTitle(query);
+    if (normalized.empty()) return {};
+    auto first = getFirstGram(normalized);
+    std::vector<const PostingList *> lists;
+    const PostingList *firstList = nullptr;
+    for (auto gram : getQueryGrams(normalized)) {
+        auto it = m_postings.find(gram);
+        if (it == m_postings.end()) return {};
+        lists.push_back(&it->second);
+        if (gram == first) firstList = &it->second;
+    }
+    std::vector<std::string_view> terms;
+    for (std::size_t pos = 0; pos < normalized.size(); ) {
+        auto end = std::min(normalized.find(' ', pos), normalized.size());
+        terms.emplace_back(std::string_view(normalized).substr(pos, end - pos));
+        pos = end + 1U;
+    }
+
+    /*
+     * 含有全部 n-gram 的书籍，seed 不为空时还须在 seed 内；从最短的倒排表开始求交集
+     * seed 为带标记的开头 n-gram，是其本身倒排表的子集，不必再与之求交集
+     */
+    auto collect = [&lists, firstList](const PostingList *seed) {
+        auto sources = lists;
+        if (seed) *std::find(sources.begin(), sources.end(), firstList) = seed;
+        std::sort(sources.begin(), sources.end(),
+            [](const PostingList *a, const PostingList *b) { return a->size() < b->size(); });
+        auto ids = sources.front()->toList();
+        for (auto it = sources.begin() + 1; it != sources.end() && !ids.empty(); ++it) (*it)->intersect(ids);
+        return ids;
+    };
+    // n-gram 都出现不代表词都出现，验证后评级，不匹配时返回 false
+    auto getRank = [&normalized, &terms](std::string_view title, TitleMatchRank &rank) {
+        auto pos = title.find(normalized);
+        if (pos == std::string_view::npos) {
+            rank = TitleMatchRank::AllTerms;
+            return terms.size() > 1U && std::all_of(terms.begin(), terms.end(),
+                [title](std::string_view term) { return title.find(term) != std::string_view::npos; });
+        }
+        if (pos == 0U) {
+            rank = title.size() == normalized.size() ? TitleMatchRank::Exact : TitleMatchRank::Prefix;
+            return true;
+        }
+        rank = TitleMatchRank::Phrase;
+        for (; pos != std::string_view::npos; pos = title.find(normalized, pos + 1U)) {
+            if (title[pos - 1U] == ' ') {
+                rank = TitleMatchRank::WordPrefix;
+                break;
+            }
+        }
+        return true;
+    };
+
+    // limit 不为 0 时只保留最好的 limit 个，堆顶为其中最差的
+    struct Candidate {
+        TitleMatchRank m_rank;
+        std::uint32_t m_length;
+        BookIdType m_bookId;
+        auto operator<=>(const Candidate &) const = default;
+    };
+    std::vector<Candidate> candidates;
+    auto isFull = [&] { return limit != 0U && candidates.size() >= limit; };
+    auto queryLength = std::min<std::size_t>(normalized.size(), std::numeric_limits<std::uint16_t>::max());
+    // 评级 ids 内的书籍，只接受 [minRank, maxRank] 内的结果，其他等级的结果由其他批次负责
+    auto evaluate = [&](const BookIdList &ids, TitleMatchRank minRank, TitleMatchRank maxRank) {
+        for (auto id : ids) {
+            // 先用等级与长度的下界判断能否进入前 limit 个，不能时不必读取标题；长度不同不可能完全相同
+            Candidate candidate{ minRank, m_lengths[id], id };
+            if (minRank == TitleMatchRank::Exact && candidate.m_length != queryLength) candidate.m_rank = TitleMatchRank::Prefix;
+            if (isFull() && !(candidate < candidates.front())) continue;
+            std::string_view title = m_titles[id];
+            candidate.m_length = static_cast<std::uint32_t>(title.size());
+            if (!getRank(title, candidate.m_rank) || candidate.m_rank < minRank || candidate.m_rank > maxRank) continue;
+            if (limit == 0U) {
+                candidates.emplace_back(candidate);
+                continue;
+            }
+            if (isFull()) {
+                if (!(candidate < candidates.front())) continue;
+                std::pop_heap(candidates.begin(), candidates.end());
+                candidates.back() = candidate;
+            } else {
+                candidates.emplace_back(candidate);
+            }
+            std::push_heap(candidates.begin(), candidates.end());
+        }
+    };
+
+    if (limit == 0U) {
+        evaluate(collect(nullptr), TitleMatchRank::Exact, TitleMatchRank::AllTerms);
+    } else {
+        // 依次处理以查询开头、查询出现在词首与其余的书籍，前面的批次已凑满 limit 个更好的结果时提前结束
+        auto findSeed = [this](std::uint64_t gram) {
+            auto it = m_postings.find(gram);
+            return it == m_postings.end() ? nullptr : &it->second;
+        };
+        if (auto seed = findSeed(first | titleStartFlag)) evaluate(collect(seed), TitleMatchRank::Exact, TitleMatchRank::Prefix);
+        if (!isFull() || candidates.front().m_rank > TitleMatchRank::Prefix) {
+            if (auto seed = findSeed(first | wordStartFlag)) evaluate(collect(seed), TitleMatchRank::WordPrefix, TitleMatchRank::WordPrefix);
+            if (!isFull() || candidates.front().m_rank > TitleMatchRank::WordPrefix) {
+                evaluate(collect(nullptr), TitleMatchRank::Phrase, TitleMatchRank::AllTerms);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<TitleMatch> ret;
+    ret.reserve(candidates.size());
+    for (const auto &candidate : candidates) ret.emplace_back(TitleMatch{ candidate.m_bookId, candidate.m_rank });
+    return ret;
+}
+/* ====== END ====== */
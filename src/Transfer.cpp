@@ -0,0 +1,244 @@
+#include "Transfer.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include "Profiler.h"
+
+#ifdef __linux
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace book;
+
+/* 传输辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+#ifdef __linux
+    constexpr std::size_t streamBufferSize = 1U << 20;     // 普通读写时的缓冲区大小
+
+    std::error_code lastError() {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    // 用 copy_file_range 复制，文件系统不支持时返回 false 且不设置 ec
+    bool copyRange(int in, int out, std::uint64_t size, std::uint64_t &bytes, std::error_code &ec) {
+        while (bytes < size) {
+            auto n = ::copy_file_range(in, nullptr, out, nullptr, static_cast<std::size_t>(size - bytes), 0U);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (bytes == 0U && (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+                    errno == EOPNOTSUPP || errno == EBADF)) return false;
+                ec = lastError();
+                return true;
+            }
+            if (n == 0) break;     // 源文件在复制过程中变短
+            bytes += static_cast<std::uint64_t>(n);
+        }
+        return true;
+    }
+
+    // 普通读写复制
+    void copyStream(int in, int out, std::uint64_t &bytes, std::error_code &ec) {
+        ::posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+        auto buffer = std::make_unique<char[]>(streamBufferSize);
+        for (;;) {
+            auto n = ::read(in, buffer.get(), streamBufferSize);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ec = lastError();
+                return;
+            }
+            if (n == 0) return;
+            for (auto p = buffer.get(), end = buffer.get() + n; p < end; ) {
+                auto m = ::write(out, p, static_cast<std::size_t>(end - p));
+                if (m < 0) {
+                    if (errno == EINTR) continue;
+                    ec = lastError();
+                    return;
+                }
+                p += m;
+            }
+            bytes += static_cast<std::uint64_t>(n);
+        }
+    }
+#endif
+}
+/* ====== END ====== */
+
+/* class TransferEngine */
+/* ===== BEGIN ===== */
+// 构造函数
+TransferEngine::TransferEngine(ThreadPool *pool, std::size_t maxInFlight)
+    : m_pool(pool ? pool : &ThreadPool::global()), m_maxInFlight(std::max<std::size_t>(maxInFlight, 1U)) {}
+
+// 公有函数
+void TransferEngine::setCallback(TransferCallback callback) {
+    m_callback = std::move(callback);
+}
+
+bool TransferEngine::run(const std::vector<TransferItem> &items, TransferMode mode,
+    std::vector<TransferResult> *results) const {
+    auto n = items.size();
+    std::vector<TransferResult> localResults;
+    auto &res = results ? *results : localResults;
+    res.assign(n, TransferResult());
+    std::vector<fs::path> parts(n);     // 复制数据时使用的临时文件，改名移动的文件为空
+
+    // 同一批次内目标不能重复，否则并发改名时后者会覆盖前者
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    std::ranges::sort(order, {}, [&items](std::size_t i) -> const fs::path & { return items[i].m_dest; });
+    for (std::size_t i = 1; i < n; ++i) {
+        if (items[order[i]].m_dest != items[order[i - 1]].m_dest) continue;
+        res[order[i]].m_error = std::make_error_code(std::errc::file_exists);
+        return false;
+    }
+
+    // 先串行创建目标目录，同一目录只创建一次
+    fs::path lastParent;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto parent = items[i].m_dest.parent_path();
+        if (parent.empty() || parent == lastParent) continue;
+        fs::create_directories(parent, res[i].m_error);
+        if (res[i].m_error) return false;
+        lastParent = std::move(parent);
+    }
+
+    // 各个工作任务从同一个计数器领取文件，同时进行的传输不超过 m_maxInFlight 个
+    std::atomic<std::size_t> next = 0U;
+    std::atomic<bool> failed = false;
+    std::mutex progressMutex;
+    TransferProgress progress{ n, 0U, 0U };
+    auto transferOne = [&](std::size_t i) {
+        auto &item = items[i];
+        auto &result = res[i];
+        if (fs::exists(item.m_dest, result.m_error) || result.m_error) {
+            if (!result.m_error) result.m_error = std::make_error_code(std::errc::file_exists);
+            return;
+        }
+        if (mode == TransferMode::Move) {
+            fs::rename(item.m_src, item.m_dest, result.m_error);
+            if (!result.m_error) {
+                result.m_method = TransferMethod::Rename;
+                result.m_bytes = fs::file_size(item.m_dest, result.m_error);
+                result.m_error.clear();
+                return;
+            }
+            // 跨文件系统时退化为复制
+            if (result.m_error != std::errc::cross_device_link) return;
+            result.m_error.clear();
+        }
+        parts[i] = item.m_dest;
+        parts[i] += ".part";
+        result.m_method = copyFile(item.m_src, parts[i], result.m_bytes, result.m_error);
+        if (result.m_method == TransferMethod::None) parts[i].clear();
+    };
+    auto worker = [&] {
+        for (auto i = next++; i < n && !failed; i = next++) {
+            transferOne(i);
+            if (res[i].m_error) failed = true;
+            if (m_callback) {
+                std::lock_guard lock(progressMutex);
+                ++progress.m_doneFiles;
+                progress.m_doneBytes += res[i].m_bytes;
+                m_callback(progress, i, res[i]);
+            }
+        }
+    };
+    {
+        TaskGroup group(*m_pool);
+        for (std::size_t k = std::min(n, m_maxInFlight); k; --k) group.submit(worker);
+        group.wait();
+    }
+
+    // 全部成功后将临时文件依次改名为目标文件
+    std::vector<bool> committed(n, false);
+    for (std::size_t i = 0; i < n && !failed; ++i) {
+        if (parts[i].empty()) continue;
+        fs::rename(parts[i], items[i].m_dest, res[i].m_error);
+        if (res[i].m_error) failed = true;
+        else committed[i] = true;
+    }
+
+    if (failed) {
+        // 回滚：删除临时文件与已就位的目标，改名移动的文件移回原处
+        std::error_code ec;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (committed[i]) fs::remove(items[i].m_dest, ec);
+            else if (!parts[i].empty()) fs::remove(parts[i], ec);
+            else if (res[i].m_method == TransferMethod::Rename) fs::rename(items[i].m_dest, items[i].m_src, ec);
+            res[i].m_method = TransferMethod::None;
+            res[i].m_bytes = 0U;
+        }
+        return false;
+    }
+
+    if (mode == TransferMode::Move) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (committed[i]) fs::remove(items[i].m_src, res[i].m_error);
+        }
+    }
+    return true;
+}
+
+TransferMethod TransferEngine::copyFile(const fs::path &src, const fs::path &dest,
+    std::uint64_t &bytes, std::error_code &ec) {
+    ScopedTimer timer(ProbeId::FileCopy);
+    bytes = 0U;
+    ec.clear();
+#ifdef __linux
+    errno = 0;
+    int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        ec = lastError();
+        return TransferMethod::None;
+    }
+    struct stat st;
+    if (::fstat(in, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ec = errno ? lastError() : std::make_error_code(std::errc::not_supported);
+        ::close(in);
+        return TransferMethod::None;
+    }
+    int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+    if (out < 0) {
+        ec = lastError();
+        ::close(in);
+        return TransferMethod::None;
+    }
+
+    auto size = static_cast<std::uint64_t>(st.st_size);
+    auto method = TransferMethod::Stream;
+#ifdef FICLONE
+    if (::ioctl(out, FICLONE, in) == 0) {
+        bytes = size;
+        method = TransferMethod::Reflink;
+    }
+#endif
+    if (method != TransferMethod::Reflink) {
+        if (copyRange(in, out, size, bytes, ec)) method = TransferMethod::CopyRange;
+        else copyStream(in, out, bytes, ec);
+    }
+    ::close(in);
+    if (::close(out) != 0 && !ec) ec = lastError();
+    if (ec) {
+        ::unlink(dest.c_str());
+        bytes = 0U;
+        return TransferMethod::None;
+    }
+    Profiler::count(CounterId::FileBytesCopied, bytes);
+    return method;
+#else
+    if (!fs::copy_file(src, dest, ec)) return TransferMethod::None;
+    bytes = fs::file_size(dest, ec);
+    ec.clear();
+    Profiler::count(CounterId::FileBytesCopied, bytes);
+    return TransferMethod::Stream;
+#endif
+}
+/* ====== END ====== */
@@ -0,0 +1,389 @@
+#include "Watcher.h"
+#include <algorithm>
+#include <unordered_set>
+
+#ifdef __linux
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace book;
+
+/* 监视器辅助函数 */
+/* ===== BEGIN ===== */
+namespace {
+#ifdef __linux
+    // 目录监视关心的事件；IN_CREATE 与 IN_MODIFY 表示文件被打开写入，IN_CLOSE_WRITE 表示写入结束
+    constexpr std::uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+        IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+
+    // 以点号开头的目录（如 .data）不监视
+    bool isHidden(const fs::path &path) {
+        auto name = path.filename().native();
+        return !name.empty() && name.front() == '.';
+    }
+
+    // 在书籍内查找文件名为 name 的页面，不存在时返回页数
+    std::size_t findPage(const Book &book, const fs::path &name) {
+        for (std::size_t i = 0; i < book.getSumOfImages(); ++i) {
+            if (book.getImagePath(i).filename() == name) return i;
+        }
+        return book.getSumOfImages();
+    }
+}
+/* ====== END ====== */
+
+/* class LibraryWatcher */
+/* ===== BEGIN ===== */
+// 构造函数
+LibraryWatcher::LibraryWatcher(Library &library, std::chrono::milliseconds settleTime)
+    : m_library(library), m_settleTime(settleTime) {}
+
+LibraryWatcher::~LibraryWatcher() {
+    stop();
+}
+
+// 公有函数
+bool LibraryWatcher::start() {
+#ifdef __linux
+    if (m_fd >= 0) return true;
+    std::error_code ec;
+    auto root = fs::weakly_canonical(m_library.getRoot(), ec);
+    if (ec || !fs::is_directory(root, ec)) return false;
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) return false;
+    m_watchTree(root);
+    if (m_watches.empty()) {
+        stop();
+        return false;
+    }
+    refreshBooks();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LibraryWatcher::stop() {
+#ifdef __linux
+    if (m_fd >= 0) ::close(m_fd);
+#endif
+    m_fd = -1;
+    m_watches.clear();
+    m_pending.clear();
+}
+
+bool LibraryWatcher::isRunning() const {
+    return m_fd >= 0;
+}
+
+int LibraryWatcher::getFd() const {
+    return m_fd;
+}
+
+void LibraryWatcher::setAutoAddBooks(bool enable) {
+    m_autoAddBooks = enable;
+}
+
+std::size_t LibraryWatcher::poll(std::chrono::milliseconds timeout) {
+#ifdef __linux
+    if (m_fd < 0) return 0U;
+    auto next = getNextTimeout();
+    if (next && (timeout.count() < 0 || *next < timeout)) timeout = *next;
+    pollfd fds{ m_fd, POLLIN, 0 };
+    if (::poll(&fds, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(timeout.count(), -1))) > 0) m_readEvents();
+    return m_applySettled(Clock::now());
+#else
+    (void)timeout;
+    return 0U;
+#endif
+}
+
+std::optional<std::chrono::milliseconds> LibraryWatcher::getNextTimeout() const {
+    std::optional<Clock::time_point> earliest;
+    for (const auto &[path, pending] : m_pending) {
+        // 仍在写入的文件要等到关闭事件，不设超时
+        if (pending.m_writing) continue;
+        if (!earliest || pending.m_deadline < *earliest) earliest = pending.m_deadline;
+    }
+    if (!earliest) return std::nullopt;
+    auto now = Clock::now();
+    if (*earliest <= now) return std::chrono::milliseconds(0);
+    return std::chrono::ceil<std::chrono::milliseconds>(*earliest - now);
+}
+
+std::size_t LibraryWatcher::getPendingCount() const {
+    return m_pending.size();
+}
+
+std::size_t LibraryWatcher::resync() {
+    refreshBooks();
+    std::vector<fs::path> dirs;
+    for (const auto &[path, id] : m_bookDirs) {
+        if (!isArchiveFile(path)) dirs.emplace_back(path);
+    }
+    std::size_t ret = 0U;
+    for (const auto &dir : dirs) ret += m_resyncDirectory(dir);
+    return ret;
+}
+
+void LibraryWatcher::refreshBooks() {
+    m_bookDirs.clear();
+    auto books = m_library.getBooks();
+    for (auto id : *books) {
+        const auto *book = m_library.getBook(id);
+        fs::path path;
+        if (book->isArchive()) path = book->getArchivePath();
+        else if (book->getSumOfImages() != 0U) path = book->getImagePath(0).parent_path();
+        else continue;
+        std::error_code ec;
+        path = fs::weakly_canonical(path, ec);
+        if (!ec) m_bookDirs.emplace(path.string(), id);
+    }
+    m_sumOfBooks = m_library.getSumOfBooks();
+}
+
+const WatchStats &LibraryWatcher::getStats() const {
+    return m_stats;
+}
+
+// 私有函数
+void LibraryWatcher::m_watchTree(const fs::path &dir, bool touch) {
+#ifdef __linux
+    auto wd = inotify_add_watch(m_fd, dir.c_str(), watchMask);
+    if (wd < 0) return ;
+    m_watches[wd] = dir;
+    if (touch) m_touch(dir, true, Clock::now());
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_symlink(ec) || !it->is_directory(ec) || isHidden(it->path())) continue;
+        m_watchTree(it->path(), touch);
+    }
+#else
+    (void)dir;
+    (void)touch;
+#endif
+}
+
+void LibraryWatcher::m_unwatchTree(const fs::path &dir) {
+#ifdef __linux
+    auto prefix = dir.native() + fs::path::preferred_separator;
+    for (auto it = m_watches.begin(); it != m_watches.end(); ) {
+        const auto &path = it->second.native();
+        if (path == dir.native() || path.starts_with(prefix)) {
+            inotify_rm_watch(m_fd, it->first);
+            it = m_watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+#else
+    (void)dir;
+#endif
+}
+
+bool LibraryWatcher::m_readEvents() {
+#ifdef __linux
+    alignas(inotify_event) char buffer[16U * 1024U];
+    bool ret = false;
+    auto now = Clock::now();
+    for (;;) {
+        auto size = ::read(m_fd, buffer, sizeof(buffer));
+        if (size <= 0) break;
+        ret = true;
+        for (auto ptr = buffer; ptr < buffer + size; ) {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // 事件丢失，补上遗漏的新目录，所有目录都与书籍重新比对
+                ++m_stats.m_overflows;
+                std::error_code ec;
+                auto root = fs::weakly_canonical(m_library.getRoot(), ec);
+                if (!ec) m_watchTree(root);
+                for (const auto &[wd, dir] : m_watches) m_touch(dir, true, now);
+                continue;
+            }
+            auto it = m_watches.find(event->wd);
+            if (it == m_watches.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                m_watches.erase(it);
+                continue;
+            }
+            if (event->len == 0U) continue;
+            auto path = it->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (isHidden(path)) continue;
+                // 新目录及其子目录在建立监视之前可能已经写入了文件，都比对一次
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) m_watchTree(path, true);
+                // 在监视范围内改名的目录保留原有监视，监视描述符重新对应到新路径
+                if (event->mask & IN_MOVED_FROM) m_movedDirs[event->cookie] = path;
+                if (event->mask & IN_MOVED_TO) {
+                    auto moved = m_movedDirs.find(event->cookie);
+                    if (moved != m_movedDirs.end()) {
+                        m_moveBookDirs(moved->second, path);
+                        m_movedDirs.erase(moved);
+                    }
+                }
+                m_touch(path, true, now);
+                continue;
+            }
+            if (!isImageFile(path) && !isArchiveFile(path)) continue;
+            auto &pending = m_touch(path, false, now);
+            // inotify 不报告打开方式，新建的文件总是以写方式打开，截断已有文件时产生 IN_MODIFY
+            if (event->mask & (IN_CREATE | IN_MODIFY)) pending.m_writing = true;
+            // 写入结束，或者完整的文件被移入；删除与移出后该路径已不对应仍打开的文件
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)) pending.m_writing = false;
+        }
+    }
+    // 改名的两个事件总是相邻写入，没有配对的是移出了监视范围
+    for (const auto &[cookie, path] : m_movedDirs) m_unwatchTree(path);
+    m_movedDirs.clear();
+    return ret;
+#else
+    return false;
+#endif
+}
+
+void LibraryWatcher::m_moveBookDirs(const fs::path &from, const fs::path &to) {
+    if (m_sumOfBooks != m_library.getSumOfBooks()) refreshBooks();
+    auto prefix = from.native() + fs::path::preferred_separator;
+    std::vector<std::pair<std::string, BookIdType>> moved;
+    for (auto it = m_bookDirs.begin(); it != m_bookDirs.end(); ) {
+        if (it->first == from.native()) {
+            moved.emplace_back(to.string(), it->second);
+            it = m_bookDirs.erase(it);
+        } else if (it->first.starts_with(prefix)) {
+            moved.emplace_back((to / fs::path(it->first).lexically_relative(from)).string(), it->second);
+            it = m_bookDirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto &[path, id] : moved) {
+        m_bookDirs[path] = id;
+        // 子目录内的书籍没有单独的目录事件，同样需要比对
+        m_touch(path, true, Clock::now());
+    }
+}
+
+LibraryWatcher::Pending &LibraryWatcher::m_touch(const fs::path &path, bool isDirectory, Clock::time_point now) {
+    auto &pending = m_pending[path.string()];
+    pending.m_deadline = now + m_settleTime;
+    pending.m_isDirectory = pending.m_isDirectory || isDirectory;
+    return pending;
+}
+
+std::size_t LibraryWatcher::m_applySettled(Clock::time_point now) {
+    std::vector<std::pair<std::string, Pending>> ready;
+    for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+        if (it->second.m_deadline <= now && !it->second.m_writing) {
+            ready.emplace_back(std::move(*it));
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // 目录先于文件，父目录先于子目录，使新书先登记、之后的文件事件只做比对
+    std::sort(ready.begin(), ready.end(), [](const auto &a, const auto &b) {
+        if (a.second.m_isDirectory != b.second.m_isDirectory) return a.second.m_isDirectory;
+        return a.first < b.first;
+    });
+    std::size_t ret = 0U;
+    for (const auto &[path, pending] : ready) {
+        ret += pending.m_isDirectory ? m_resyncDirectory(path) : m_applyFile(path);
+    }
+    return ret;
+}
+
+std::size_t LibraryWatcher::m_applyFile(const fs::path &path) {
+    std::error_code ec;
+    bool exists = fs::is_regular_file(path, ec);
+    if (isArchiveFile(path)) {
+        // 压缩包只用于登记新书，已登记的压缩包被改写或删除时不处理
+        if (exists && m_autoAddBooks && !m_findBook(path)) m_addBook(path);
+        return 0U;
+    }
+    auto book = m_findBook(path.parent_path());
+    if (!book) {
+        if (exists && m_autoAddBooks) m_addBook(path.parent_path());
+        return 0U;
+    }
+    auto index = findPage(*book, path.filename());
+    bool found = index < book->getSumOfImages();
+    if (exists && !found) {
+        if (!book->addPage(path)) return 0U;
+        ++m_stats.m_pagesAdded;
+    } else if (exists) {
+        book->refresh(index);
+        ++m_stats.m_pagesRefreshed;
+    } else if (found) {
+        book->removePage(index);
+        ++m_stats.m_pagesRemoved;
+    } else {
+        return 0U;
+    }
+    return 1U;
+}
+
+std::size_t LibraryWatcher::m_resyncDirectory(const fs::path &dir) {
+    std::error_code ec;
+    std::vector<fs::path> images;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        if (isImageFile(it->path())) images.emplace_back(it->path());
+        else if (isArchiveFile(it->path()) && m_autoAddBooks && !m_findBook(it->path())) m_addBook(it->path());
+    }
+    auto book = m_findBook(dir);
+    if (!book) {
+        if (!images.empty() && m_autoAddBooks) m_addBook(dir);
+        return 0U;
+    }
+    if (book->isArchive()) return 0U;
+
+    /*
+     * 按文件名比对：书籍内多余的页面删除，磁盘上多出的图像按自然顺序插入
+     * 书籍目录改名后旧页面的路径都已失效，全部换成新目录下的路径
+     */
+    std::size_t ret = 0U;
+    bool moved = book->getSumOfImages() != 0U && fs::weakly_canonical(book->getImagePath(0).parent_path(), ec) != dir;
+    std::unordered_set<fs::path::string_type> names;
+    if (!moved) {
+        for (const auto &image : images) names.emplace(image.filename().native());
+    }
+    for (auto i = book->getSumOfImages(); i-- > 0U; ) {
+        if (names.erase(book->getImagePath(i).filename().native()) != 0U) continue;
+        book->removePage(i);
+        ++m_stats.m_pagesRemoved;
+        ++ret;
+    }
+    if (!moved) std::erase_if(images, [&names](const fs::path &image) { return !names.contains(image.filename().native()); });
+    sortNatural(images);
+    for (const auto &image : images) {
+        if (!book->addPage(image)) continue;
+        ++m_stats.m_pagesAdded;
+        ++ret;
+    }
+    return ret;
+}
+
+Book *LibraryWatcher::m_findBook(const fs::path &path) {
+    if (m_sumOfBooks != m_library.getSumOfBooks()) refreshBooks();
+    auto it = m_bookDirs.find(path.string());
+    if (it == m_bookDirs.end()) return nullptr;
+    return m_library.getBook(it->second);
+}
+
+BookIdType LibraryWatcher::m_addBook(const fs::path &path) {
+    auto id = m_library.addBook(path);
+    if (id == nullBookId) return id;
+    ++m_stats.m_booksAdded;
+    if (m_sumOfBooks + 1U == m_library.getSumOfBooks()) {
+        // 只登记新书本身，不必重建整个表
+        m_bookDirs[path.string()] = id;
+        m_sumOfBooks = m_library.getSumOfBooks();
+    }
+    return id;
+}
+/* ====== END ====== */
@@ -0,0 +1,104 @@
+// 压缩包索引、解压与 CRC 校验测试，输入由 ZipWriter 生成
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Archive.h"
+#include "TempDir.h"
+#include "ZipWriter.h"
+
+using namespace book;
+
+namespace {
+    std::string makeContent(char c, std::size_t size) {
+        std::string ret;
+        for (std::size_t i = 0; i < size; ++i) ret += static_cast<char>(c + i % 7U);
+        return ret;
+    }
+}
+
+TEST(ArchiveTest, IndexesImagesInNaturalOrder) {
+    TempDir dir("archive-index");
+    auto path = dir.m_path / "book.cbz";
+    auto data = writeZip(path, {
+        { "10.png", makeContent('a', 300U), true },
+        { "sub/", "", false },
+        { "readme.txt", "not an image", false },
+        { "2.jpg", makeContent('b', 200U), false },
+        { "sub/1.png", makeContent('c', 100U), true },
+    });
+
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(readZipIndex(std::as_bytes(std::span(data.data(), data.size())), entries));
+    ASSERT_EQ(entries.size(), 3U);
+    EXPECT_EQ(entries[0].m_name, "2.jpg");
+    EXPECT_EQ(entries[1].m_name, "10.png");
+    EXPECT_EQ(entries[2].m_name, "sub/1.png");
+    EXPECT_EQ(entries[0].m_method, ArchiveMethod::Stored);
+    EXPECT_EQ(entries[0].m_size, 200U);
+    EXPECT_EQ(entries[0].m_compressedSize, 200U);
+    EXPECT_EQ(entries[1].m_method, ArchiveMethod::Deflate);
+    EXPECT_EQ(entries[1].m_size, 300U);
+    EXPECT_LT(entries[1].m_compressedSize, 300U);
+
+    // 从文件解析的结果与从内存解析的一致
+    std::vector<ArchiveEntry> fromFile;
+    ASSERT_TRUE(readZipIndex(path, fromFile));
+    EXPECT_EQ(fromFile, entries);
+
+    std::string garbage(100U, 'x');
+    EXPECT_FALSE(readZipIndex(std::as_bytes(std::span(garbage.data(), garbage.size())), entries));
+    EXPECT_FALSE(readZipIndex(dir.m_path / "missing.cbz", entries));
+}
+
+TEST(ArchiveTest, ReadsStoredAndDeflatedEntries) {
+    TempDir dir("archive-read");
+    auto path = dir.m_path / "book.cbz";
+    std::vector<ZipItem> items = {
+        { "1.png", makeContent('a', 5000U), false },
+        { "2.png", makeContent('k', 7000U), true },
+    };
+    writeZip(path, items);
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(readZipIndex(path, entries));
+    ASSERT_EQ(entries.size(), 2U);
+
+    for (std::size_t i = 0; i < 2U; ++i) {
+        auto content = readArchiveEntry(path, entries[i]);
+        ASSERT_TRUE(content) << entries[i].m_name;
+        EXPECT_EQ(*content, items[i].m_content);
+        // 只读取开头时同样可以解压
+        auto head = readArchiveEntry(path, entries[i], 64U);
+        ASSERT_TRUE(head) << entries[i].m_name;
+        EXPECT_EQ(*head, items[i].m_content.substr(0, 64U));
+
+        auto mapped = mapArchiveEntry(path, entries[i]);
+        ASSERT_TRUE(mapped.isOpen()) << entries[i].m_name;
+        EXPECT_EQ(std::string(reinterpret_cast<const char *>(mapped.getData().data()), mapped.getData().size()),
+            items[i].m_content);
+    }
+}
+
+TEST(ArchiveTest, RejectsCrcMismatch) {
+    TempDir dir("archive-crc");
+    auto path = dir.m_path / "book.cbz";
+    writeZip(path, { { "1.png", makeContent('a', 1000U), false }, { "2.png", makeContent('a', 1000U), true } });
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(readZipIndex(path, entries));
+    ASSERT_EQ(entries.size(), 2U);
+
+    // 改写未压缩条目数据中的一个字节，索引不变但内容校验失败
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(entries[0].m_offset + 500U));
+        file.put('#');
+    }
+    EXPECT_FALSE(readArchiveEntry(path, entries[0]));
+    // 只读取开头时不校验
+    EXPECT_TRUE(readArchiveEntry(path, entries[0], 100U));
+    EXPECT_TRUE(readArchiveEntry(path, entries[1]));
+
+    auto wrongCrc = entries[1];
+    wrongCrc.m_crc ^= 1U;
+    EXPECT_FALSE(readArchiveEntry(path, wrongCrc));
+}
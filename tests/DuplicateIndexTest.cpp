@@ -0,0 +1,170 @@
+// DuplicateIndex 多索引哈希查找测试，结果与线性扫描比较
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "DuplicateIndex.h"
+#include "ImageWriter.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    // 由 sumOfClusters 个随机哈希及其翻转了至多 maxFlips 位的变体组成的哈希
+    std::vector<std::uint64_t> makeHashes(std::mt19937_64 &random, std::size_t sumOfClusters,
+        std::size_t perCluster, int maxFlips) {
+        std::vector<std::uint64_t> ret;
+        for (std::size_t i = 0; i < sumOfClusters; ++i) {
+            auto base = random();
+            for (std::size_t j = 0; j < perCluster; ++j) {
+                auto hash = base;
+                auto flips = std::uniform_int_distribution<int>(0, maxFlips)(random);
+                for (int k = 0; k < flips; ++k) hash ^= std::uint64_t(1U) << (random() % 64U);
+                ret.emplace_back(hash);
+            }
+        }
+        std::shuffle(ret.begin(), ret.end(), random);
+        return ret;
+    }
+
+    DuplicateIndex makeIndex(const std::vector<std::uint64_t> &hashes) {
+        DuplicateIndex index;
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            index.add(PageRef{ static_cast<BookIdType>(i / 10U + 1U), static_cast<std::uint32_t>(i % 10U) }, hashes[i], i + 1U);
+        }
+        index.reindex();
+        return index;
+    }
+
+    std::vector<std::uint32_t> bruteForce(const std::vector<std::uint64_t> &hashes, std::uint64_t query, int maxDistance) {
+        std::vector<std::uint32_t> ret;
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            if (hammingDistance(hashes[i], query) <= maxDistance) ret.emplace_back(static_cast<std::uint32_t>(i));
+        }
+        return ret;
+    }
+
+    // 平滑的明暗图案，与 PerceptualHashTest 相同
+    GrayImage makePage(int seed) {
+        return GrayImage(160U, 240U, [seed](std::uint32_t x, std::uint32_t y) {
+            double u = x / 160.0, v = y / 240.0;
+            double value = 128.0 + 60.0 * std::sin(u * (3.0 + seed % 5) + seed) + 50.0 * std::cos(v * (4.0 + seed % 3) * (1.0 + u) + seed * 0.7);
+            return static_cast<std::uint8_t>(std::clamp(value, 0.0, 255.0));
+        });
+    }
+}
+
+TEST(DuplicateIndexTest, HammingScanMatchesBruteForce) {
+    std::mt19937_64 random(1U);
+    auto hashes = makeHashes(random, 300U, 10U, 12);
+    for (int i = 0; i < 20; ++i) {
+        auto query = i % 2 ? hashes[random() % hashes.size()] : random();
+        for (int distance : { -1, 0, 3, 10, 32, 64 }) {
+            std::vector<std::uint32_t> out;
+            hammingScan(hashes, query, distance, out);
+            EXPECT_EQ(out, bruteForce(hashes, query, distance)) << distance;
+        }
+    }
+}
+
+TEST(DuplicateIndexTest, SearchMatchesBruteForce) {
+    std::mt19937_64 random(2U);
+    auto hashes = makeHashes(random, 200U, 8U, 10);
+    auto index = makeIndex(hashes);
+    ASSERT_EQ(index.getSumOfPages(), hashes.size());
+    for (int i = 0; i < 40; ++i) {
+        auto query = hashes[random() % hashes.size()] ^ (i % 3 ? 0U : random() & random());
+        for (int distance = 0; distance <= DuplicateIndex::maxIndexedDistance + 2; ++distance) {
+            EXPECT_EQ(index.search(query, distance), bruteForce(hashes, query, distance)) << "distance " << distance;
+        }
+    }
+}
+
+TEST(DuplicateIndexTest, FindPairsMatchesBruteForce) {
+    std::mt19937_64 random(3U);
+    auto hashes = makeHashes(random, 120U, 6U, 8);
+    auto index = makeIndex(hashes);
+    ThreadPool pool(2U);
+    for (int distance : { 0, 3, 8, 20 }) {
+        std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> expected, actual;
+        for (std::uint32_t i = 0; i < hashes.size(); ++i) {
+            for (std::uint32_t j = i + 1U; j < hashes.size(); ++j) {
+                auto d = hammingDistance(hashes[i], hashes[j]);
+                if (d <= distance) expected.emplace_back(i, j, static_cast<std::uint32_t>(d));
+            }
+        }
+        for (const auto &pair : index.findPairs(distance, &pool)) actual.emplace_back(pair.m_first, pair.m_second, pair.m_distance);
+        EXPECT_EQ(actual, expected) << "distance " << distance;
+    }
+}
+
+TEST(DuplicateIndexTest, ScoresSimilarBooks) {
+    DuplicateIndex index;
+    std::uint64_t a = 0x0123456789abcdefULL, b = 0x33cc33cc00ff00ffULL, c = 0x0f0f0f0f0f0f0f0fULL, d = 0x5555aaaa5555aaaaULL;
+    // 书 1 四页，书 2 有三页与其相似，书 3 的两页彼此相同但与其他书无关
+    for (auto hash : { a, b, c, d }) index.add(PageRef{ 1U, 0U }, hash);
+    for (auto hash : { a ^ 1U, b ^ 6U, c, ~a }) index.add(PageRef{ 2U, 0U }, hash);
+    for (auto hash : { 0xff00ff00ff00ff00ULL, 0xff00ff00ff00ff00ULL }) index.add(PageRef{ 3U, 0U }, hash);
+    index.reindex();
+
+    auto similar = index.findSimilarBooks(4, 0.5);
+    ASSERT_EQ(similar.size(), 1U);
+    EXPECT_EQ(similar[0].m_first, 1U);
+    EXPECT_EQ(similar[0].m_second, 2U);
+    EXPECT_EQ(similar[0].m_sharedPages, 3U);
+    EXPECT_DOUBLE_EQ(similar[0].m_score, 0.75);
+    EXPECT_TRUE(index.findSimilarBooks(4, 0.8).empty());
+    EXPECT_EQ(index.findSimilarBooks(0, 0.0)[0].m_sharedPages, 1U);
+}
+
+TEST(DuplicateIndexTest, UpdatesIncrementally) {
+    TempDir dir("duplicate-index");
+    // 书 A 为 PNG，书 B 为同样页面的 JPEG 加一页纯色页面，书 C 的页面各不相同
+    for (int i = 1; i <= 4; ++i) writeBytes(dir.m_path / "A" / (std::to_string(i) + ".png"), encodePng(makePage(i)));
+    for (int i = 1; i <= 3; ++i) writeBytes(dir.m_path / "B" / (std::to_string(i) + ".jpg"), encodeJpeg(makePage(i), 80));
+    writeBytes(dir.m_path / "B" / "4.png", encodePng(GrayImage(100U, 100U, [](std::uint32_t, std::uint32_t) { return 200; })));
+    for (int i = 1; i <= 3; ++i) writeBytes(dir.m_path / "C" / (std::to_string(i) + ".png"), encodePng(makePage(i + 10)));
+    Library library(dir.m_path);
+    auto a = library.addBook(dir.m_path / "A"), b = library.addBook(dir.m_path / "B"), c = library.addBook(dir.m_path / "C");
+    ASSERT_NE(c, nullBookId);
+
+    ThreadPool pool(2U);
+    DuplicateIndex index;
+    EXPECT_EQ(index.update(library, &pool), 11U);
+    EXPECT_EQ(index.getSumOfPages(), 10U);
+    auto similar = index.findSimilarBooks(6, 0.5, &pool);
+    ASSERT_EQ(similar.size(), 1U);
+    EXPECT_EQ(similar[0].m_first, a);
+    EXPECT_EQ(similar[0].m_second, b);
+    EXPECT_EQ(similar[0].m_sharedPages, 3U);
+    EXPECT_DOUBLE_EQ(similar[0].m_score, 1.0);
+
+    // 路径未变的页面与计算失败的页面都不重新解码
+    EXPECT_EQ(index.update(library, &pool), 0U);
+    writeBytes(dir.m_path / "C" / "4.png", encodePng(makePage(1)));
+    ASSERT_TRUE(library.getBook(c)->addPage(dir.m_path / "C" / "4.png"));
+    EXPECT_EQ(index.update(library, &pool), 1U);
+    EXPECT_EQ(index.getSumOfPages(), 11U);
+    auto matches = index.search(index.getHash(0), 6);
+    EXPECT_EQ(matches.size(), 3U);
+
+    // 删除书籍后其页面从索引内移除
+    ASSERT_TRUE(library.eraseBook(b));
+    EXPECT_EQ(index.update(library, &pool), 0U);
+    EXPECT_EQ(index.getSumOfPages(), 8U);
+    for (std::size_t i = 0; i < index.getSumOfPages(); ++i) EXPECT_NE(index.getPage(i).m_book, b);
+    EXPECT_TRUE(index.findSimilarBooks(6, 0.5, &pool).empty());
+
+    // 写入后读回，查找结果不变
+    ASSERT_TRUE(index.write(library.getPerceptualHashPath()));
+    DuplicateIndex copy;
+    ASSERT_TRUE(copy.read(library.getPerceptualHashPath()));
+    ASSERT_EQ(copy.getSumOfPages(), index.getSumOfPages());
+    for (std::size_t i = 0; i < index.getSumOfPages(); ++i) {
+        EXPECT_EQ(copy.getPage(i), index.getPage(i));
+        EXPECT_EQ(copy.search(index.getHash(i), 4), index.search(index.getHash(i), 4));
+    }
+    EXPECT_EQ(copy.update(library, &pool), 0U);
+}
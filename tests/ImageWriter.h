@@ -0,0 +1,120 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <jpeglib.h>
+#include <zlib.h>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 测试用灰度图像，按行存放
+    struct GrayImage {
+        std::uint32_t m_width = 0U;
+        std::uint32_t m_height = 0U;
+        std::vector<std::uint8_t> m_pixels;
+
+        // 以 pixel(x, y) 生成 width×height 的图像
+        GrayImage(std::uint32_t width, std::uint32_t height,
+            const std::function<std::uint8_t(std::uint32_t, std::uint32_t)> &pixel) :
+            m_width(width), m_height(height), m_pixels(std::size_t(width) * height) {
+            for (std::uint32_t y = 0; y < height; ++y) {
+                for (std::uint32_t x = 0; x < width; ++x) m_pixels[std::size_t(y) * width + x] = pixel(x, y);
+            }
+        }
+    };
+
+    // 编码为 8 位灰度 PNG，rgb 为 true 时每个像素重复为三个通道；每行使用 Sub 过滤
+    inline std::string encodePng(const GrayImage &image, bool rgb = false) {
+        auto putBE32 = [](std::string &out, std::uint32_t value) {
+            for (int shift = 24; shift >= 0; shift -= 8) out += static_cast<char>((value >> shift) & 0xffU);
+        };
+        auto putChunk = [&putBE32](std::string &out, const char *type, const std::string &data) {
+            putBE32(out, static_cast<std::uint32_t>(data.size()));
+            auto begin = out.size();
+            out.append(type, 4U);
+            out += data;
+            putBE32(out, static_cast<std::uint32_t>(crc32(0UL, reinterpret_cast<const Bytef *>(out.data() + begin),
+                static_cast<uInt>(out.size() - begin))));
+        };
+        std::size_t channels = rgb ? 3U : 1U;
+        std::string raw;
+        for (std::uint32_t y = 0; y < image.m_height; ++y) {
+            raw += '\x01';
+            std::uint8_t prev[3] = {};
+            for (std::uint32_t x = 0; x < image.m_width; ++x) {
+                auto value = image.m_pixels[std::size_t(y) * image.m_width + x];
+                for (std::size_t c = 0; c < channels; ++c) {
+                    raw += static_cast<char>(static_cast<std::uint8_t>(value - prev[c]));
+                    prev[c] = value;
+                }
+            }
+        }
+        std::string compressed(compressBound(static_cast<uLong>(raw.size())), '\0');
+        auto size = static_cast<uLongf>(compressed.size());
+        compress(reinterpret_cast<Bytef *>(compressed.data()), &size, reinterpret_cast<const Bytef *>(raw.data()),
+            static_cast<uLong>(raw.size()));
+        compressed.resize(size);
+
+        std::string header;
+        putBE32(header, image.m_width);
+        putBE32(header, image.m_height);
+        header += '\x08';
+        header += rgb ? '\x02' : '\x00';
+        header.append(3U, '\0');
+        std::string ret("\x89PNG\r\n\x1a\n", 8U);
+        putChunk(ret, "IHDR", header);
+        putChunk(ret, "IDAT", compressed);
+        putChunk(ret, "IEND", "");
+        return ret;
+    }
+
+    // 以 libjpeg 编码为 JPEG，rgb 为 true 时编码为 YCbCr 三分量（4:2:0 采样）
+    inline std::string encodeJpeg(const GrayImage &image, int quality = 90, bool progressive = false, bool rgb = false) {
+        jpeg_compress_struct info;
+        jpeg_error_mgr error;
+        info.err = jpeg_std_error(&error);
+        jpeg_create_compress(&info);
+        unsigned char *buffer = nullptr;
+        unsigned long size = 0;
+        jpeg_mem_dest(&info, &buffer, &size);
+        info.image_width = image.m_width;
+        info.image_height = image.m_height;
+        info.input_components = rgb ? 3 : 1;
+        info.in_color_space = rgb ? JCS_RGB : JCS_GRAYSCALE;
+        jpeg_set_defaults(&info);
+        jpeg_set_quality(&info, quality, TRUE);
+        if (progressive) jpeg_simple_progression(&info);
+        jpeg_start_compress(&info, TRUE);
+        std::vector<std::uint8_t> row(std::size_t(image.m_width) * (rgb ? 3U : 1U));
+        while (info.next_scanline < info.image_height) {
+            auto src = image.m_pixels.data() + std::size_t(info.next_scanline) * image.m_width;
+            for (std::uint32_t x = 0; x < image.m_width; ++x) {
+                if (rgb) row[3U * x] = row[3U * x + 1U] = row[3U * x + 2U] = src[x];
+                else row[x] = src[x];
+            }
+            JSAMPROW rows[] = { row.data() };
+            jpeg_write_scanlines(&info, rows, 1);
+        }
+        jpeg_finish_compress(&info);
+        jpeg_destroy_compress(&info);
+        std::string ret(reinterpret_cast<const char *>(buffer), size);
+        std::free(buffer);
+        return ret;
+    }
+
+    // 将 data 写入 path，目录不存在时创建
+    inline void writeBytes(const fs::path &path, const std::string &data) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::out | std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+}
+
+#endif
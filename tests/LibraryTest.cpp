@@ -0,0 +1,277 @@
+// Library 的数据文件、日志重放、快照与标签ID压缩测试，输入由合成漫画库生成
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include "Snapshot.h"
+#include "SyntheticLibrary.h"
+#include "TempDir.h"
+#include "ZipWriter.h"
+
+using namespace book;
+
+namespace {
+    SyntheticOptions getSmallOptions() {
+        SyntheticOptions options;
+        options.m_sumOfMangas = 20U;
+        options.m_chaptersPerManga = 3U;
+        options.m_pagesPerChapter = 4U;
+        options.m_sumOfTags = 100U;
+        options.m_tagsPerManga = 6U;
+        return options;
+    }
+
+    // 以名字比较两个漫画库的全部书籍，标签ID可以不同
+    void expectSameBooks(const Library &expected, const Library &actual) {
+        ASSERT_EQ(expected.getSumOfBooks(), actual.getSumOfBooks());
+        auto expectedIds = expected.getBooks(), actualIds = actual.getBooks();
+        ASSERT_EQ(*expectedIds, *actualIds);
+        for (auto id : *expectedIds) {
+            auto lhs = expected.getBook(id), rhs = actual.getBook(id);
+            ASSERT_EQ(lhs->getSumOfImages(), rhs->getSumOfImages());
+            for (std::size_t i = 0; i < lhs->getSumOfImages(); ++i) EXPECT_EQ(lhs->getImagePath(i), rhs->getImagePath(i));
+            EXPECT_EQ(lhs->getTitle(), rhs->getTitle());
+            std::vector<std::string> lhsTags, rhsTags;
+            for (auto tag : lhs->getTags()) lhsTags.emplace_back(expected.getTagManager().getBookTag(tag).getName());
+            for (auto tag : rhs->getTags()) rhsTags.emplace_back(actual.getTagManager().getBookTag(tag).getName());
+            std::sort(lhsTags.begin(), lhsTags.end());
+            std::sort(rhsTags.begin(), rhsTags.end());
+            EXPECT_EQ(lhsTags, rhsTags) << "book " << id;
+        }
+    }
+}
+
+TEST(LibraryTest, DataFileRoundTrips) {
+    TempDir dir("library-data-file");
+    SyntheticLibrary synthetic(getSmallOptions());
+    Library library(dir.m_path);
+    ASSERT_TRUE(synthetic.fill(library));
+    ASSERT_EQ(library.getSumOfBooks(), synthetic.getSumOfBooks());
+    ASSERT_TRUE(library.write());
+
+    Library copy(dir.m_path);
+    ASSERT_TRUE(copy.read());
+    expectSameBooks(library, copy);
+    EXPECT_EQ(copy.getTagManager().getSumOfBookTags(), synthetic.getTagNames().size());
+}
+
+TEST(LibraryTest, RejectsDuplicateBookIds) {
+    TempDir dir("library-duplicate-ids");
+    fs::create_directories(dir.m_path / "Manga");
+    std::ofstream(dir.m_path / "Manga" / "1.jpg") << "page 1";
+    // 按数据文件格式拼出两本ID相同的书籍
+    auto encode = [&dir](BookIdType secondId) {
+        TagManager tags;
+        BinaryWriter out;
+        out.putVarint(std::uint64_t(0U));
+        tags.write(out);
+        out.putVarint(std::uint64_t(2U));
+        out.putFixed(BookIdType(2U));
+        out.putVarint(std::uint64_t(0U));
+        for (auto id : { BookIdType(1U), secondId }) {
+            Book book(std::vector<fs::path>{ dir.m_path / "Manga" / "1.jpg" }, &tags, id, {});
+            EXPECT_TRUE(book.write(out));
+        }
+        FileHeader header{ Library::fileMagic, Library::fileVersion, std::uint16_t(sizeof(TagIdType)) };
+        EXPECT_TRUE(writeDataFile(dir.m_path / "list.dat", header, out));
+    };
+
+    Library library(dir.m_path);
+    encode(2U);
+    ASSERT_TRUE(library.read(dir.m_path / "list.dat"));
+    EXPECT_EQ(library.getSumOfBooks(), 2U);
+    encode(1U);
+    EXPECT_FALSE(library.read(dir.m_path / "list.dat"));
+    EXPECT_EQ(library.getSumOfBooks(), 0U);
+}
+
+TEST(LibraryTest, JournalReplaysChanges) {
+    TempDir dir("library-journal");
+    SyntheticLibrary synthetic(getSmallOptions());
+    Library library(dir.m_path);
+    ASSERT_TRUE(library.read());
+    ASSERT_TRUE(synthetic.fill(library));
+    auto &manager = library.getTagManager();
+    auto tag = manager.getBookTagId(synthetic.getTagNames()[5]);
+    library.getBook(1)->addTag(tag);
+    library.getBook(2)->setTitle("第二话");
+    ASSERT_TRUE(library.eraseBook(3));
+    ASSERT_TRUE(library.eraseBookTag(manager.getBookTagId(synthetic.getTagNames()[0])));
+
+    // 没有写入数据文件，全部修改都来自日志
+    Library replayed(dir.m_path);
+    ASSERT_TRUE(replayed.read());
+    expectSameBooks(library, replayed);
+
+    // 合并日志后重新读入，结果不变
+    ASSERT_TRUE(replayed.compact(false));
+    Library compacted(dir.m_path);
+    ASSERT_TRUE(compacted.read());
+    expectSameBooks(library, compacted);
+}
+
+TEST(LibraryTest, AddedPagesUseCanonicalPaths) {
+    TempDir dir("library-add-page");
+    auto bookDir = dir.m_path / "Manga" / "capture 1";
+    fs::create_directories(bookDir);
+    for (int page : { 1, 3, 4 }) std::ofstream(bookDir / (std::to_string(page) + ".jpg")) << "page " << page;
+    fs::create_directory_symlink(bookDir, dir.m_path / "link");
+    Library library(dir.m_path);
+    ASSERT_TRUE(library.read());
+    auto id = library.addBook(bookDir);
+    ASSERT_NE(id, nullBookId);
+
+    // 经由符号链接与 . 添加的页面与 add 读入的页面一样储存规范路径
+    std::ofstream(bookDir / "2.jpg") << "page 2";
+    ASSERT_TRUE(library.getBook(id)->addPage(dir.m_path / "link" / "." / "2.jpg"));
+    auto *book = library.getBook(id);
+    ASSERT_EQ(book->getSumOfImages(), 4U);
+    EXPECT_EQ(book->getImagePath(1), fs::canonical(bookDir / "2.jpg"));
+    EXPECT_EQ(book->getImagePath(1).parent_path(), book->getImagePath(0).parent_path());
+
+    Library replayed(dir.m_path);
+    ASSERT_TRUE(replayed.read());
+    expectSameBooks(library, replayed);
+}
+
+TEST(LibraryTest, AddedPagesKeepNaturalOrder) {
+    TempDir dir("library-page-order");
+    auto bookDir = dir.m_path / "Manga";
+    fs::create_directories(bookDir);
+    for (auto name : { "1.jpg", "3.jpg", "10.jpg" }) std::ofstream(bookDir / name) << name;
+    Library library(dir.m_path);
+    auto id = library.addBook(bookDir);
+    ASSERT_NE(id, nullBookId);
+    auto *book = library.getBook(id);
+    auto getNames = [book] {
+        std::vector<std::string> ret;
+        for (std::size_t i = 0; i < book->getSumOfImages(); ++i) ret.emplace_back(book->getImagePath(i).filename().string());
+        return ret;
+    };
+
+    for (auto name : { "2.jpg", "20.jpg", "05.jpg" }) ASSERT_TRUE(book->addPage(bookDir / name));
+    EXPECT_EQ(getNames(), (std::vector<std::string>{ "1.jpg", "2.jpg", "3.jpg", "05.jpg", "10.jpg", "20.jpg" }));
+    ASSERT_TRUE(book->removePage(0));
+    ASSERT_TRUE(book->addPage(bookDir / "4.jpg"));
+    EXPECT_EQ(getNames(), (std::vector<std::string>{ "2.jpg", "3.jpg", "4.jpg", "05.jpg", "10.jpg", "20.jpg" }));
+
+    // 手动调换顺序后页面无序，仍插入到第一个自然顺序更靠后的页面之前
+    book->swap(0U, 5U);
+    ASSERT_TRUE(book->addPage(bookDir / "6.jpg"));
+    EXPECT_EQ(getNames(), (std::vector<std::string>{ "6.jpg", "20.jpg", "3.jpg", "4.jpg", "05.jpg", "10.jpg", "2.jpg" }));
+}
+
+TEST(LibraryTest, SnapshotRoundTrips) {
+    TempDir dir("library-snapshot");
+    SyntheticLibrary synthetic(getSmallOptions());
+    Library library(dir.m_path);
+    ASSERT_TRUE(synthetic.fill(library));
+    // 压缩包书籍的条目索引同样写入快照
+    fs::create_directories(dir.m_path / "Archive");
+    auto archivePath = dir.m_path / "Archive" / "book.cbz";
+    writeZip(archivePath, { { "1.png", "first page", false }, { "2.png", std::string(500U, 'p'), true } });
+    auto archiveId = library.addBook(archivePath, { library.getTagManager().getBookTagId(synthetic.getTagNames()[1]) });
+    ASSERT_NE(archiveId, nullBookId);
+    // 被删除的书籍在快照内留下空位
+    ASSERT_TRUE(library.eraseBook(3));
+
+    ASSERT_TRUE(CatalogSnapshot::write(library, library.getSnapshotPath()));
+    CatalogSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(library.getSnapshotPath()));
+    ASSERT_TRUE(snapshot.verify());
+    auto ids = library.getBooks();
+    EXPECT_EQ(snapshot.getBooks(), *ids);
+    EXPECT_FALSE(snapshot.checkBookId(3));
+    EXPECT_TRUE(snapshot.getBook(3).isNull());
+    EXPECT_EQ(snapshot.getSumOfBookTags(), library.getTagManager().getSumOfBookTags());
+    for (auto id : *ids) {
+        const auto *book = library.getBook(id);
+        auto view = snapshot.getBook(id);
+        ASSERT_FALSE(view.isNull()) << "book " << id;
+        EXPECT_EQ(view.getTitle(), book->getTitle());
+        ASSERT_EQ(view.getSumOfImages(), book->getSumOfImages());
+        for (std::size_t i = 0; i < book->getSumOfImages(); ++i) EXPECT_EQ(view.getImagePath(i), book->getImagePath(i).native());
+        ASSERT_EQ(view.getSumOfTags(), book->getSumOfTags());
+        for (auto tag : view.getTags()) {
+            EXPECT_EQ(snapshot.getBookTagName(tag), library.getTagManager().getBookTag(tag).getName());
+            EXPECT_TRUE(book->hasTag(tag));
+        }
+    }
+    EXPECT_EQ(snapshot.getBook(archiveId).getArchivePath(), archivePath.native());
+
+    Library materialized(dir.m_path);
+    ASSERT_TRUE(snapshot.materialize(materialized));
+    expectSameBooks(library, materialized);
+    auto *archive = materialized.getBook(archiveId);
+    ASSERT_TRUE(archive->isArchive());
+    auto content = archive->getImageContent(1);
+    ASSERT_TRUE(content);
+    EXPECT_EQ(*content, std::string(500U, 'p'));
+
+    // 快照被改写后校验失败
+    {
+        std::fstream file(library.getSnapshotPath(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-16, std::ios::end);
+        auto byte = static_cast<char>(file.get() ^ 1);
+        file.seekp(-16, std::ios::end);
+        file.put(byte);
+    }
+    CatalogSnapshot corrupted(library.getSnapshotPath());
+    EXPECT_FALSE(corrupted.isOpen() && corrupted.verify());
+}
+
+TEST(LibraryTest, SnapshotRejectsInvalidGroupIds) {
+    TempDir dir("library-snapshot-groups");
+    SyntheticLibrary synthetic(getSmallOptions());
+    Library library(dir.m_path);
+    ASSERT_TRUE(synthetic.fill(library));
+    ASSERT_TRUE(CatalogSnapshot::write(library, library.getSnapshotPath()));
+
+    // 把第一个书标签的组ID改为最大的标签ID，头部校验值不变
+    {
+        std::fstream file(library.getSnapshotPath(), std::ios::in | std::ios::out | std::ios::binary);
+        snapshot::Header header;
+        file.seekg(8);
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        snapshot::TagRecord record;
+        auto offset = static_cast<std::streamoff>(header.m_bookTags.m_offset + sizeof(record));
+        file.seekg(offset);
+        file.read(reinterpret_cast<char *>(&record), sizeof(record));
+        ASSERT_EQ(record.m_id, 1);
+        record.m_groupId = maxTagId;
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    CatalogSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(library.getSnapshotPath()));
+    Library materialized(dir.m_path);
+    EXPECT_FALSE(snapshot.materialize(materialized));
+    EXPECT_EQ(materialized.getSumOfBooks(), 0U);
+    EXPECT_EQ(materialized.getTagManager().getSumOfBookTags(), 0U);
+}
+
+TEST(LibraryTest, CompactTagsKeepsBookTags) {
+    TempDir dir("library-compact-tags");
+    SyntheticLibrary synthetic(getSmallOptions());
+    Library library(dir.m_path);
+    ASSERT_TRUE(library.read());
+    ASSERT_TRUE(synthetic.fill(library));
+    auto &names = synthetic.getTagNames();
+    for (std::size_t i = 0; i < names.size(); i += 3)
+        ASSERT_TRUE(library.eraseBookTag(library.getTagManager().getBookTagId(names[i])));
+
+    Library before(dir.m_path);
+    ASSERT_TRUE(before.read());
+    TagIdList remap;
+    ASSERT_TRUE(library.compactTags(&remap));
+    EXPECT_FALSE(remap.empty());
+    auto ids = library.getTagManager().getBookTags();
+    ASSERT_FALSE(ids->empty());
+    EXPECT_EQ(ids->back(), static_cast<TagIdType>(ids->size()));
+    expectSameBooks(before, library);
+
+    // 压缩后的日志与数据文件只含新ID
+    Library after(dir.m_path);
+    ASSERT_TRUE(after.read());
+    expectSameBooks(library, after);
+}
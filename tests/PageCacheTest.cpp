@@ -0,0 +1,93 @@
+// PageCache 单元测试
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "Img.h"
+#include "PageCache.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    PageKey makeKey(std::size_t i) {
+        return PageKey{ 1U, "page-" + std::to_string(i) };
+    }
+
+    PageContent makeContent(std::size_t size) {
+        return std::make_shared<const std::string>(size, 'x');
+    }
+}
+
+TEST(PageCacheTest, KeepsJustInsertedPage) {
+    PageCache cache(1000U, 16U);
+    for (std::size_t i = 0; i < 200U; ++i) {
+        cache.put(makeKey(i), makeContent(100U));
+        EXPECT_TRUE(cache.get(makeKey(i))) << "page " << i;
+    }
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.m_entries, 10U);
+    EXPECT_EQ(stats.m_bytes, 1000U);
+    EXPECT_EQ(stats.m_evictions, 190U);
+    EXPECT_EQ(stats.m_hits, 200U);
+}
+
+TEST(PageCacheTest, EvictsLeastRecentlyUsedAcrossShards) {
+    PageCache cache(1000U, 16U);
+    for (std::size_t i = 0; i < 10U; ++i) cache.put(makeKey(i), makeContent(100U));
+    // 使用过的偶数页变为最近使用，之后放入的页面应依次淘汰未使用的奇数页
+    for (std::size_t i = 0; i < 10U; i += 2U) ASSERT_TRUE(cache.get(makeKey(i)));
+    for (std::size_t i = 10U; i < 15U; ++i) cache.put(makeKey(i), makeContent(100U));
+    for (std::size_t i = 0; i < 10U; ++i) EXPECT_EQ(static_cast<bool>(cache.get(makeKey(i))), i % 2U == 0U) << "page " << i;
+    for (std::size_t i = 10U; i < 15U; ++i) EXPECT_TRUE(cache.get(makeKey(i))) << "page " << i;
+
+    // 再放入一页时淘汰最久未使用的第 0 页
+    cache.put(makeKey(15U), makeContent(100U));
+    EXPECT_FALSE(cache.get(makeKey(0U)));
+    EXPECT_TRUE(cache.get(makeKey(2U)));
+}
+
+TEST(PageCacheTest, SkipsPageLargerThanBudget) {
+    PageCache cache(1000U, 4U);
+    cache.put(makeKey(0U), makeContent(100U));
+    cache.put(makeKey(1U), makeContent(2000U));
+    EXPECT_TRUE(cache.get(makeKey(0U)));
+    EXPECT_FALSE(cache.get(makeKey(1U)));
+    EXPECT_EQ(cache.getStats().m_evictions, 0U);
+}
+
+TEST(PageCacheTest, CountsHitsMissesAndLoads) {
+    PageCache cache(1000U, 4U);
+    int loads = 0;
+    auto loader = [&loads] { ++loads; return makeContent(10U); };
+    EXPECT_FALSE(cache.get(makeKey(0U)));
+    ASSERT_TRUE(cache.getOrLoad(makeKey(0U), loader));
+    ASSERT_TRUE(cache.getOrLoad(makeKey(0U), loader));
+    EXPECT_EQ(loads, 1);
+
+    cache.setBudget(0U);
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.m_hits, 1U);
+    EXPECT_EQ(stats.m_misses, 2U);
+    EXPECT_EQ(stats.m_evictions, 1U);
+    EXPECT_EQ(stats.m_entries, 0U);
+    EXPECT_EQ(stats.m_bytes, 0U);
+}
+
+TEST(PageCacheTest, ServesImageContentFromGlobalCache) {
+    TempDir dir("page-cache");
+    auto path = dir.m_path / "1.jpg";
+    std::ofstream(path) << "page 1";
+    ImagesManager manager(std::vector<fs::path>{ path });
+    auto content = manager.getImageContent(0U);
+    ASSERT_TRUE(content);
+    EXPECT_EQ(*content, "page 1");
+    EXPECT_TRUE(PageCache::global().get(manager.getPageKey(0U)));
+
+    // 再次读取命中缓存，不再访问文件
+    fs::remove(path);
+    content = manager.getImageContent(0U);
+    ASSERT_TRUE(content);
+    EXPECT_EQ(*content, "page 1");
+    EXPECT_FALSE(manager.getImageContent(1U));
+}
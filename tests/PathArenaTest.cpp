@@ -0,0 +1,108 @@
+// PathArena 与 StringPool 单元测试
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PathArena.h"
+#include "StringPool.h"
+
+using namespace book;
+
+TEST(PathArenaTest, StoresPathsRelativeToRoot) {
+    PathArena arena;
+    fs::path root = fs::path("library") / "Manga 1";
+    arena.add(root / "1.png");
+    arena.add(root / "2.png");
+    arena.add(fs::path("elsewhere") / "3.png");
+    EXPECT_EQ(arena.getRoot(), root);
+    EXPECT_EQ(fs::path(arena.getName(0)), fs::path("1.png"));
+    EXPECT_EQ(arena.getPath(1), root / "2.png");
+    EXPECT_EQ(arena.getPath(2), fs::path("elsewhere") / "3.png");
+
+    // 更换基准目录只移动相对名字
+    arena.setRoot("moved");
+    EXPECT_EQ(arena.getPath(0), fs::path("moved") / "1.png");
+    EXPECT_EQ(arena.getPath(2), fs::path("elsewhere") / "3.png");
+}
+
+TEST(PathArenaTest, InsertRemoveAndSwapKeepOrder) {
+    PathArena arena;
+    arena.setRoot("root");
+    for (int i = 0; i < 100; ++i) arena.addRelative(std::to_string(i) + ".png");
+    arena.insert(0, fs::path("root") / "first.png");
+    arena.swap(1, 2);
+    EXPECT_EQ(arena.getPath(0), fs::path("root") / "first.png");
+    EXPECT_EQ(arena.getPath(1), fs::path("root") / "1.png");
+    EXPECT_EQ(arena.getPath(2), fs::path("root") / "0.png");
+
+    // 删除过半后整理空洞，剩余路径不变
+    while (arena.size() > 10U) arena.remove(3);
+    ASSERT_EQ(arena.size(), 10U);
+    EXPECT_EQ(arena.getPath(9), fs::path("root") / "99.png");
+    EXPECT_EQ(arena.getPath(3), fs::path("root") / "93.png");
+    arena.clear();
+    EXPECT_TRUE(arena.empty());
+}
+
+TEST(PathArenaTest, ChangesRevisionOnEveryModification) {
+    PathArena arena, other;
+    auto revision = arena.getRevision();
+    arena.add(fs::path("root") / "1.png");
+    EXPECT_NE(arena.getRevision(), revision);
+    other.add(fs::path("root") / "1.png");
+    EXPECT_NE(other.getRevision(), arena.getRevision());
+    // 读取不改变修订号
+    revision = arena.getRevision();
+    EXPECT_EQ(arena.getPath(0), fs::path("root") / "1.png");
+    EXPECT_EQ(arena.getRevision(), revision);
+
+    arena.add(fs::path("root") / "2.png");
+    auto added = arena.getRevision();
+    arena.swap(0, 1);
+    auto swapped = arena.getRevision();
+    arena.remove(0);
+    EXPECT_NE(added, revision);
+    EXPECT_NE(swapped, added);
+    EXPECT_NE(arena.getRevision(), swapped);
+}
+
+TEST(StringPoolTest, InternsEqualStringsOnce) {
+    StringPool pool;
+    std::string a = "artist", b = "artist";
+    auto first = pool.intern(a), second = pool.intern(b);
+    EXPECT_EQ(first, "artist");
+    EXPECT_EQ(first.data(), second.data());
+    EXPECT_EQ(pool.size(), 1U);
+
+    // 超长字符串单独成块，仍然可以被查到
+    std::string longName(StringPool::chunkSize, 'x');
+    auto interned = pool.intern(longName);
+    EXPECT_EQ(interned, longName);
+    EXPECT_EQ(pool.intern(longName).data(), interned.data());
+    EXPECT_EQ(pool.size(), 2U);
+}
+
+TEST(StringPoolTest, InternsConcurrently) {
+    StringPool pool;
+    std::vector<std::string> names;
+    for (int i = 0; i < 1000; ++i) names.emplace_back("tag " + std::to_string(i));
+    // 各线程以不同顺序驻留同一批名字，结果都指向同一份；步长与名字个数互素，每个名字恰好驻留一次
+    constexpr std::size_t steps[] = { 1U, 3U, 7U, 9U };
+    std::vector<std::vector<std::string_view>> results(std::size(steps));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&names, &pool, &result = results[t], step = steps[t]] {
+            result.resize(names.size());
+            for (std::size_t i = 0; i < names.size(); ++i) {
+                auto index = (i * step) % names.size();
+                result[index] = pool.intern(names[index]);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    EXPECT_EQ(pool.size(), names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        EXPECT_EQ(results[0][i], names[i]);
+        for (const auto &result : results) EXPECT_EQ(result[i].data(), results[0][i].data());
+    }
+}
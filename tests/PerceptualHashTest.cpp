@@ -0,0 +1,128 @@
+// 感知哈希与图像元数据探测测试，图像由 ImageWriter 生成
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <string>
+#include "ImageProbe.h"
+#include "ImageWriter.h"
+#include "PerceptualHash.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    // 平滑的明暗图案，seed 不同时图案不同；坐标按比例计算，不同尺寸的同一图案内容相同
+    GrayImage makePage(std::uint32_t width, std::uint32_t height, int seed, int noise = 0) {
+        std::mt19937 random(static_cast<unsigned>(seed) * 7919U + width);
+        return GrayImage(width, height, [&](std::uint32_t x, std::uint32_t y) {
+            double u = double(x) / width, v = double(y) / height;
+            double value = 128.0 + 60.0 * std::sin(u * (3.0 + seed % 5) + seed) + 50.0 * std::cos(v * (4.0 + seed % 3) * (1.0 + u) + seed * 0.7);
+            if (noise) value += std::uniform_int_distribution<int>(-noise, noise)(random);
+            return static_cast<std::uint8_t>(std::clamp(value, 0.0, 255.0));
+        });
+    }
+
+    GrayImage makeSolid(std::uint32_t width, std::uint32_t height, std::uint8_t value) {
+        return GrayImage(width, height, [value](std::uint32_t, std::uint32_t) { return value; });
+    }
+
+    std::uint64_t hashOf(const std::string &data) {
+        std::uint64_t hash = 0U;
+        EXPECT_TRUE(dhashImage(std::as_bytes(std::span(data.data(), data.size())), hash));
+        return hash;
+    }
+
+    bool canHash(const std::string &data) {
+        std::uint64_t hash;
+        return dhashImage(std::as_bytes(std::span(data.data(), data.size())), hash);
+    }
+
+    ImageInfo probe(const std::string &data) {
+        return probeImage(std::as_bytes(std::span(data.data(), data.size())));
+    }
+}
+
+TEST(PerceptualHashTest, NearDuplicatesHaveCloseHashes) {
+    auto page = makePage(360U, 512U, 1);
+    auto png = hashOf(encodePng(page));
+    // 同一页面的 RGB PNG、各种质量与编码方式的 JPEG、缩放后与加噪后的版本
+    EXPECT_EQ(hashOf(encodePng(page, true)), png);
+    EXPECT_LE(hammingDistance(hashOf(encodeJpeg(page, 95)), png), 4);
+    EXPECT_LE(hammingDistance(hashOf(encodeJpeg(page, 30)), png), 6);
+    EXPECT_LE(hammingDistance(hashOf(encodeJpeg(page, 80, true)), png), 4);
+    EXPECT_LE(hammingDistance(hashOf(encodeJpeg(page, 80, false, true)), png), 6);
+    EXPECT_LE(hammingDistance(hashOf(encodeJpeg(page, 80, true, true)), png), 6);
+    EXPECT_LE(hammingDistance(hashOf(encodePng(makePage(180U, 256U, 1))), png), 4);
+    EXPECT_LE(hammingDistance(hashOf(encodePng(makePage(360U, 512U, 1, 20))), png), 6);
+    // 渐进式与基线编码的 DC 系数相同
+    EXPECT_EQ(hashOf(encodeJpeg(page, 80, true)), hashOf(encodeJpeg(page, 80)));
+
+    for (int seed = 2; seed < 8; ++seed) {
+        EXPECT_GT(hammingDistance(hashOf(encodePng(makePage(360U, 512U, seed))), png), 12) << seed;
+    }
+}
+
+TEST(PerceptualHashTest, RejectsUnhashableImages) {
+    // 纯色页面没有可比较的明暗
+    EXPECT_FALSE(canHash(encodePng(makeSolid(100U, 100U, 255U))));
+    EXPECT_FALSE(canHash(encodePng(makeSolid(100U, 100U, 0U), true)));
+    EXPECT_FALSE(canHash(encodeJpeg(makeSolid(200U, 200U, 128U))));
+    // 小于 9×8 的 PNG 与缩略图小于 9×8 的 JPEG
+    EXPECT_FALSE(canHash(encodePng(makePage(8U, 8U, 1))));
+    EXPECT_FALSE(canHash(encodeJpeg(makePage(64U, 64U, 1))));
+    EXPECT_TRUE(canHash(encodeJpeg(makePage(72U, 64U, 1))));
+    EXPECT_FALSE(canHash("GIF89a not supported"));
+
+    // 截断的数据
+    auto png = encodePng(makePage(100U, 100U, 1));
+    EXPECT_FALSE(canHash(png.substr(0, png.size() / 2U)));
+    auto jpeg = encodeJpeg(makePage(200U, 200U, 1));
+    EXPECT_FALSE(canHash(jpeg.substr(0, jpeg.size() / 2U)));
+
+    // SOF 声明 65535×65535 但数据很少，解码失败且不按声明的尺寸分配
+    auto sof = jpeg.find("\xff\xc0", 0, 2U);
+    ASSERT_NE(sof, std::string::npos);
+    jpeg.replace(sof + 5U, 4U, "\xff\xff\xff\xff", 4U);
+    EXPECT_FALSE(canHash(jpeg));
+    EXPECT_EQ(probe(jpeg), (ImageInfo{ 65535U, 65535U, ImageFormat::Jpeg }));
+}
+
+TEST(PerceptualHashTest, HashesFiles) {
+    TempDir dir("perceptual-hash");
+    auto page = makePage(200U, 300U, 3);
+    writeBytes(dir.m_path / "1.png", encodePng(page));
+    writeBytes(dir.m_path / "2.jpg", encodeJpeg(page));
+    std::uint64_t png = 0U, jpeg = 0U;
+    ASSERT_TRUE(dhashImageFile(dir.m_path / "1.png", png));
+    ASSERT_TRUE(dhashImageFile(dir.m_path / "2.jpg", jpeg));
+    EXPECT_LE(hammingDistance(png, jpeg), 4);
+    EXPECT_FALSE(dhashImageFile(dir.m_path / "missing.png", png));
+}
+
+TEST(ImageProbeTest, ReadsDimensions) {
+    auto page = makePage(123U, 45U, 1);
+    EXPECT_EQ(probe(encodePng(page)), (ImageInfo{ 123U, 45U, ImageFormat::Png }));
+    EXPECT_EQ(probe(encodeJpeg(page)), (ImageInfo{ 123U, 45U, ImageFormat::Jpeg }));
+    EXPECT_EQ(probe(encodeJpeg(page, 80, true)), (ImageInfo{ 123U, 45U, ImageFormat::Jpeg }));
+    EXPECT_EQ(probe(std::string("GIF89a\x7b\x00\x2d\x00", 10U)), (ImageInfo{ 123U, 45U, ImageFormat::Gif }));
+    // VP8X：24 位 (宽 - 1) 与 (高 - 1)
+    std::string webp("RIFF\0\0\0\0WEBPVP8X\x0a\0\0\0\0\0\0\0\x7a\0\0\x2c\0\0", 30U);
+    EXPECT_EQ(probe(webp), (ImageInfo{ 123U, 45U, ImageFormat::Webp }));
+    EXPECT_EQ(probe("not an image").m_format, ImageFormat::Invalid);
+    auto jpeg = encodeJpeg(page);
+    EXPECT_EQ(probe(jpeg.substr(0, 20U)).m_format, ImageFormat::Invalid);
+}
+
+TEST(ImageProbeTest, SeeksPastLargeSegments) {
+    TempDir dir("image-probe");
+    auto jpeg = encodeJpeg(makePage(200U, 100U, 1));
+    // 在 SOI 之后插入一个 60000 字节的 APP1 段，SOF 超出一次读入的头部
+    std::string app1("\xff\xe1\xea\x60", 4U);
+    app1.append(60000U - 2U, 'x');
+    jpeg.insert(2U, app1);
+    writeBytes(dir.m_path / "1.jpg", jpeg);
+    EXPECT_EQ(probeImageFile(dir.m_path / "1.jpg"), (ImageInfo{ 200U, 100U, ImageFormat::Jpeg }));
+    std::uint64_t hash;
+    EXPECT_TRUE(dhashImageFile(dir.m_path / "1.jpg", hash));
+    EXPECT_EQ(probeImageFile(dir.m_path / "missing.jpg").m_format, ImageFormat::Invalid);
+}
@@ -0,0 +1,61 @@
+// PagePrefetcher 单元测试
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Prefetcher.h"
+#include "TempDir.h"
+#include "ZipWriter.h"
+
+using namespace book;
+
+namespace {
+    // 第 i 页的内容，各页互不相同
+    std::string makePage(std::size_t i) {
+        return "page " + std::to_string(i) + ":" + std::string(4096U + i * 100U, static_cast<char>('a' + i));
+    }
+}
+
+TEST(PrefetcherTest, PrefetchesArchivePages) {
+    TempDir dir("prefetcher-cbz");
+    // 未压缩与 Deflate 压缩的条目交替出现
+    std::vector<ZipItem> items;
+    for (std::size_t i = 0; i < 5U; ++i) items.emplace_back(ZipItem{ std::to_string(i + 1U) + ".png", makePage(i), i % 2U == 1U });
+    auto path = dir.m_path / "book.cbz";
+    writeZip(path, items);
+
+    ImagesManager images(path);
+    ASSERT_TRUE(images.isArchive());
+    ASSERT_EQ(images.getSumOfImages(), 5U);
+    PageCache::global().clear();
+    ThreadPool pool(2U);
+    PagePrefetcher prefetcher(images, 3U, &pool);
+    for (std::size_t i = 0; i < 5U; ++i) {
+        auto content = prefetcher.getPage(i).get();
+        ASSERT_TRUE(content) << "page " << i;
+        EXPECT_EQ(*content, items[i].m_content) << "page " << i;
+    }
+    PageCache::global().clear();
+}
+
+TEST(PrefetcherTest, PrefetchesFollowingFilePages) {
+    TempDir dir("prefetcher-files");
+    std::vector<fs::path> paths;
+    for (std::size_t i = 0; i < 6U; ++i) {
+        paths.emplace_back(dir.m_path / (std::to_string(i + 1U) + ".png"));
+        std::ofstream(paths.back(), std::ios::binary) << makePage(i);
+    }
+    ImagesManager images(paths);
+    PageCache::global().clear();
+    ThreadPool pool(2U);
+    PagePrefetcher prefetcher(images, 2U, &pool);
+    ASSERT_TRUE(prefetcher.getPage(0).get());
+    EXPECT_EQ(prefetcher.getSumOfPending(), 2U);
+    auto second = prefetcher.getPage(1).get();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*second, makePage(1));
+    // 跳到窗口之外后，之前的预读全部取消
+    ASSERT_TRUE(prefetcher.getPage(5).get());
+    EXPECT_EQ(prefetcher.getSumOfPending(), 0U);
+    PageCache::global().clear();
+}
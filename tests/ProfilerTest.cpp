@@ -0,0 +1,107 @@
+// Profiler 单元测试：采样器是全局唯一的，每个测试开始时清空
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "Profiler.h"
+#include "SyntheticLibrary.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    class ProfilerTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Profiler::global().reset();
+            Profiler::setEnabled(true);
+        }
+        void TearDown() override {
+            Profiler::setEnabled(false);
+            Profiler::global().setTracing(false);
+            Profiler::global().reset();
+        }
+    };
+}
+
+TEST_F(ProfilerTest, DisabledRecordsNothing) {
+    Profiler::setEnabled(false);
+    { ScopedTimer timer(ProbeId::ImageRead); }
+    Profiler::count(CounterId::ImageBytesRead, 100U);
+    auto stats = Profiler::global().snapshot();
+    EXPECT_EQ(stats.get(ProbeId::ImageRead).m_count, 0U);
+    EXPECT_EQ(stats.get(CounterId::ImageBytesRead), 0U);
+}
+
+TEST_F(ProfilerTest, HistogramBucketsByPowerOfTwo) {
+    auto &profiler = Profiler::global();
+    for (std::uint64_t ns : { 0ULL, 1ULL, 3ULL, 1000ULL, 1000000ULL }) profiler.record(ProbeId::TagRead, 10U, 10U + ns);
+    auto stats = profiler.snapshot().get(ProbeId::TagRead);
+    EXPECT_EQ(stats.m_count, 5U);
+    EXPECT_EQ(stats.m_totalNs, 1001004U);
+    EXPECT_EQ(stats.m_maxNs, 1000000U);
+    EXPECT_EQ(stats.m_buckets[0], 1U);
+    EXPECT_EQ(stats.m_buckets[1], 1U);
+    EXPECT_EQ(stats.m_buckets[2], 1U);
+    EXPECT_EQ(stats.m_buckets[10], 1U);
+    EXPECT_EQ(stats.m_buckets[20], 1U);
+    EXPECT_EQ(stats.getPercentileNs(0.0), 0U);
+    EXPECT_EQ(stats.getPercentileNs(0.5), 3U);
+    EXPECT_EQ(stats.getPercentileNs(0.7), 1023U);
+    EXPECT_EQ(stats.getPercentileNs(1.0), 1000000U);
+}
+
+TEST_F(ProfilerTest, SumsAllThreads) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 1000; ++j) {
+                ScopedTimer timer(ProbeId::JournalAppend);
+                Profiler::count(CounterId::FileBytesCopied, 2U);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    auto stats = Profiler::global().snapshot();
+    EXPECT_EQ(stats.get(ProbeId::JournalAppend).m_count, 4000U);
+    EXPECT_EQ(stats.get(CounterId::FileBytesCopied), 8000U);
+}
+
+TEST_F(ProfilerTest, ExportsChromeTrace) {
+    auto &profiler = Profiler::global();
+    profiler.setTracing(true);
+    profiler.record(ProbeId::LibraryRead, 1500U, 4000U);
+    profiler.record(ProbeId::LibraryWrite, 1000U, 1200U);
+    auto events = profiler.getTraceEvents();
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events[0].first.m_probe, ProbeId::LibraryWrite);
+
+    auto trace = profiler.exportChromeTrace();
+    EXPECT_EQ(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0U);
+    EXPECT_NE(trace.find("\"name\":\"Library::read\",\"cat\":\"book\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"ts\":1.500,\"dur\":2.500"), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"imageBytesRead\",\"ph\":\"C\""), std::string::npos);
+    EXPECT_EQ(trace.substr(trace.size() - 4U), "\n]}\n");
+}
+
+TEST_F(ProfilerTest, InstrumentsLibraryHotPaths) {
+    TempDir dir("profiler");
+    SyntheticOptions options;
+    options.m_sumOfMangas = 2U;
+    options.m_chaptersPerManga = 1U;
+    options.m_pagesPerChapter = 3U;
+    options.m_pageSize = 64U;
+    SyntheticLibrary synthetic(options);
+    ASSERT_TRUE(synthetic.createFiles());
+    Library library(dir.m_path);
+    ASSERT_TRUE(synthetic.fill(library));
+    ASSERT_TRUE(library.write());
+    ASSERT_TRUE(library.read(library.getDataPath()));
+    ASSERT_TRUE(library.getBook(1)->getImageContent(0));
+
+    auto stats = Profiler::global().snapshot();
+    EXPECT_EQ(stats.get(ProbeId::LibraryWrite).m_count, 1U);
+    EXPECT_EQ(stats.get(ProbeId::LibraryRead).m_count, 1U);
+    EXPECT_EQ(stats.get(ProbeId::TagRead).m_count, 1U);
+    EXPECT_EQ(stats.get(ProbeId::ImageRead).m_count, 1U);
+    EXPECT_EQ(stats.get(CounterId::ImageBytesRead), 64U);
+}
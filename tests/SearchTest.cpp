@@ -0,0 +1,216 @@
+// TitleIndex 与 NameTrie 搜索测试，结果与逐个检查的结果比较
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "NameTrie.h"
+#include "TitleIndex.h"
+
+using namespace book;
+
+namespace {
+    // 标题与名字由这些词拼接而成，含全角、大小写与中日文字符，词之间有大量共同的子串
+    const std::vector<std::string> words = {
+        "one", "tone", "on", "ONE", "Ｏｎｅ", "piece", "pie", "海", "海贼", "贼王", "王", "の", "ワンピース", "2",
+    };
+    const std::vector<std::string> separators = { " ", "", "・", "-", "! " };
+
+    std::string randomName(std::mt19937 &random, std::size_t maxWords) {
+        auto count = std::uniform_int_distribution<std::size_t>(1U, maxWords)(random);
+        std::string ret;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i != 0U) ret += separators[std::uniform_int_distribution<std::size_t>(0U, separators.size() - 1U)(random)];
+            ret += words[std::uniform_int_distribution<std::size_t>(0U, words.size() - 1U)(random)];
+        }
+        return ret;
+    }
+
+    // 将合法的 UTF-8 解码为码位
+    std::u32string decode(std::string_view text) {
+        std::u32string ret;
+        for (std::size_t pos = 0; pos < text.size(); ) {
+            auto lead = static_cast<unsigned char>(text[pos]);
+            std::size_t length = lead < 0x80U ? 1U : lead < 0xE0U ? 2U : lead < 0xF0U ? 3U : 4U;
+            char32_t cp = length == 1U ? lead : lead & (0x7FU >> length);
+            for (std::size_t i = 1; i < length; ++i) cp = (cp << 6) | (static_cast<unsigned char>(text[pos + i]) & 0x3FU);
+            ret += cp;
+            pos += length;
+        }
+        return ret;
+    }
+
+    // 逐本检查标题，按 TitleIndex::search 的规则评级排序
+    std::vector<std::tuple<TitleMatchRank, std::size_t, BookIdType>> searchTitles(
+        const std::map<BookIdType, std::string> &titles, std::string_view query) {
+        std::vector<std::tuple<TitleMatchRank, std::size_t, BookIdType>> ret;
+        auto normalized = normalizeTitle(query);
+        if (normalized.empty()) return ret;
+        std::vector<std::string> terms;
+        for (std::size_t pos = 0; pos <= normalized.size(); ) {
+            auto end = std::min(normalized.find(' ', pos), normalized.size());
+            terms.emplace_back(normalized.substr(pos, end - pos));
+            pos = end + 1U;
+        }
+        for (const auto &[id, raw] : titles) {
+            auto title = normalizeTitle(raw);
+            auto pos = title.find(normalized);
+            TitleMatchRank rank;
+            if (pos == 0U) {
+                rank = title == normalized ? TitleMatchRank::Exact : TitleMatchRank::Prefix;
+            } else if (pos != std::string::npos) {
+                rank = TitleMatchRank::Phrase;
+                for (; pos != std::string::npos; pos = title.find(normalized, pos + 1U)) {
+                    if (title[pos - 1U] == ' ') rank = TitleMatchRank::WordPrefix;
+                }
+            } else if (terms.size() > 1U && std::all_of(terms.begin(), terms.end(),
+                [&title](const std::string &term) { return title.find(term) != std::string::npos; })) {
+                rank = TitleMatchRank::AllTerms;
+            } else {
+                continue;
+            }
+            ret.emplace_back(rank, title.size(), id);
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    // 查询 query 与 name 的某个前缀之间的最小编辑距离
+    std::uint32_t prefixDistance(const std::u32string &query, const std::u32string &name) {
+        std::vector<std::uint32_t> row(query.size() + 1U);
+        for (std::size_t j = 0; j < row.size(); ++j) row[j] = static_cast<std::uint32_t>(j);
+        auto ret = row.back();
+        for (auto cp : name) {
+            auto diagonal = row[0]++;
+            for (std::size_t j = 1; j < row.size(); ++j) {
+                auto value = std::min({ row[j] + 1U, row[j - 1U] + 1U, diagonal + (query[j - 1U] != cp ? 1U : 0U) });
+                diagonal = row[j];
+                row[j] = value;
+            }
+            ret = std::min(ret, row.back());
+        }
+        return ret;
+    }
+
+    struct NameEntry {
+        std::string m_name;
+        std::uint32_t m_scope;
+    };
+
+    // 逐个检查名字，按 NameTrie::match 的规则排序
+    std::vector<std::tuple<std::uint32_t, std::size_t, std::uint32_t>> matchNames(
+        const std::map<std::uint32_t, NameEntry> &names, std::string_view query, unsigned distance, std::uint32_t scope) {
+        std::vector<std::tuple<std::uint32_t, std::size_t, std::uint32_t>> ret;
+        auto key = decode(normalizeTitle(query));
+        for (const auto &[value, entry] : names) {
+            if (scope != NameTrie::anyScope && entry.m_scope != scope) continue;
+            auto name = decode(normalizeTitle(entry.m_name));
+            auto d = prefixDistance(key, name);
+            if (d <= distance) ret.emplace_back(d, name.size(), value);
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+}
+
+TEST(TitleIndexTest, NormalizesTitles) {
+    EXPECT_EQ(normalizeTitle("  One  Piece!! "), "one piece");
+    EXPECT_EQ(normalizeTitle("ＯＮＥ・ＰＩＥＣＥ１"), "one piece1");
+    EXPECT_EQ(normalizeTitle("海贼王-第2卷"), "海贼王 第2卷");
+    EXPECT_EQ(normalizeTitle("!!!"), "");
+}
+
+TEST(TitleIndexTest, MatchesBruteForce) {
+    std::mt19937 random(7U);
+    TitleIndex index;
+    std::map<BookIdType, std::string> titles;
+    for (BookIdType id = 1U; id <= 600U; ++id) {
+        auto title = randomName(random, 4U);
+        index.addBook(id, title);
+        if (!normalizeTitle(title).empty()) titles[id] = title;
+    }
+    // 改名与删除
+    for (BookIdType id = 1U; id <= 600U; id += 7U) {
+        auto title = randomName(random, 3U);
+        index.addBook(id, title);
+        titles[id] = title;
+    }
+    for (BookIdType id = 3U; id <= 600U; id += 11U) {
+        index.removeBook(id);
+        titles.erase(id);
+    }
+    ASSERT_EQ(index.getSumOfBooks(), titles.size());
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) queries.emplace_back(randomName(random, 2U));
+    // 标题中间的一段，常常跨越词的边界
+    for (int i = 0; i < 100; ++i) {
+        auto title = normalizeTitle(std::next(titles.begin(), i * 5)->second);
+        auto codepoints = decode(title);
+        auto begin = std::uniform_int_distribution<std::size_t>(0U, codepoints.size() - 1U)(random);
+        auto length = std::uniform_int_distribution<std::size_t>(1U, codepoints.size() - begin)(random);
+        std::string query;
+        for (std::size_t j = 0, pos = 0; pos < title.size(); ++j) {
+            auto next = pos + 1U;
+            while (next < title.size() && (static_cast<unsigned char>(title[next]) & 0xC0U) == 0x80U) ++next;
+            if (j >= begin && j < begin + length) query += title.substr(pos, next - pos);
+            pos = next;
+        }
+        queries.emplace_back(query);
+    }
+
+    for (const auto &query : queries) {
+        auto expected = searchTitles(titles, query);
+        for (std::size_t limit : { 0U, 1U, 5U }) {
+            auto matches = index.search(query, limit);
+            auto count = limit == 0U ? expected.size() : std::min(limit, expected.size());
+            ASSERT_EQ(matches.size(), count) << query << " limit " << limit;
+            for (std::size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(matches[i].m_bookId, std::get<2>(expected[i])) << query << " limit " << limit << " #" << i;
+                EXPECT_EQ(matches[i].m_rank, std::get<0>(expected[i])) << query << " limit " << limit << " #" << i;
+            }
+        }
+    }
+}
+
+TEST(NameTrieTest, MatchesBruteForce) {
+    std::mt19937 random(11U);
+    NameTrie trie;
+    std::map<std::uint32_t, NameEntry> names;
+    for (std::uint32_t value = 1U; value <= 400U; ++value) {
+        auto name = randomName(random, 2U);
+        if (normalizeTitle(name).empty()) continue;
+        auto scope = std::uniform_int_distribution<std::uint32_t>(1U, 3U)(random);
+        trie.insert(name, value, scope);
+        names[value] = NameEntry{ name, scope };
+    }
+    for (std::uint32_t value = 1U; value <= 400U; value += 5U) {
+        auto it = names.find(value);
+        if (it == names.end()) continue;
+        ASSERT_TRUE(trie.erase(it->second.m_name, value));
+        names.erase(it);
+    }
+    EXPECT_FALSE(trie.erase("no such name", 1U));
+    ASSERT_EQ(trie.size(), names.size());
+
+    std::vector<std::string> queries = { "o", "on", "pei", "oen pice", "海王", "ワンピ", "ｐｉ" };
+    for (int i = 0; i < 40; ++i) queries.emplace_back(randomName(random, 2U));
+    for (const auto &query : queries) {
+        for (unsigned distance : { 0U, 1U, 2U }) {
+            for (std::uint32_t scope : { NameTrie::anyScope, 2U }) {
+                auto expected = matchNames(names, query, distance, scope);
+                for (std::size_t limit : { 0U, 3U }) {
+                    auto matches = distance == 0U ? trie.complete(query, limit, scope) : trie.match(query, distance, limit, scope);
+                    auto count = limit == 0U ? expected.size() : std::min(limit, expected.size());
+                    ASSERT_EQ(matches.size(), count) << query << " distance " << distance << " limit " << limit;
+                    for (std::size_t j = 0; j < count; ++j) {
+                        EXPECT_EQ(matches[j].m_value, std::get<2>(expected[j])) << query << " distance " << distance << " #" << j;
+                        EXPECT_EQ(matches[j].m_distance, std::get<0>(expected[j])) << query << " distance " << distance << " #" << j;
+                    }
+                }
+            }
+        }
+    }
+}
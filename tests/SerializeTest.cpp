@@ -0,0 +1,153 @@
+// 二进制编码、数据文件与修改日志单元测试
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include "Journal.h"
+#include "Serialize.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    std::span<const std::byte> asBytes(std::string_view str) {
+        return std::as_bytes(std::span(str.data(), str.size()));
+    }
+}
+
+TEST(SerializeTest, Crc32cMatchesKnownValue) {
+    EXPECT_EQ(crc32c(asBytes("123456789")), 0xe3069283U);
+    // 分段计算与一次计算结果相同
+    EXPECT_EQ(crc32c(asBytes("6789"), crc32c(asBytes("12345"))), 0xe3069283U);
+    std::string large(100000U, 'a');
+    EXPECT_EQ(crc32c(asBytes(large).subspan(1000U), crc32c(asBytes(large).first(1000U))), crc32c(asBytes(large)));
+}
+
+TEST(SerializeTest, RoundTripsValues) {
+    BinaryWriter out;
+    out.putFixed<std::uint16_t>(0xbeefU);
+    for (std::uint64_t value : { 0ULL, 127ULL, 128ULL, 300ULL, ~0ULL }) out.putVarint(value);
+    out.putString("漫画");
+
+    BinaryReader in(out.getData());
+    std::uint16_t fixed = 0U;
+    ASSERT_TRUE(in.getFixed(fixed));
+    EXPECT_EQ(fixed, 0xbeefU);
+    for (std::uint64_t expected : { 0ULL, 127ULL, 128ULL, 300ULL, ~0ULL }) {
+        std::uint64_t value = 0U;
+        ASSERT_TRUE(in.getVarint(value));
+        EXPECT_EQ(value, expected);
+    }
+    std::string str;
+    ASSERT_TRUE(in.getString(str));
+    EXPECT_EQ(str, "漫画");
+    EXPECT_TRUE(in.atEnd());
+    // 读过末尾后保持失败状态
+    EXPECT_FALSE(in.getFixed(fixed));
+    EXPECT_TRUE(in.fail());
+}
+
+TEST(SerializeTest, RejectsImpossibleCounts) {
+    BinaryWriter out;
+    out.putVarint(1000U);
+    out.putFixed<std::uint32_t>(0U);
+    BinaryReader in(out.getData());
+    std::size_t count = 0U;
+    EXPECT_FALSE(in.getCount(count, 4U));
+    EXPECT_TRUE(in.fail());
+}
+
+TEST(SerializeTest, DataFileDetectsCorruption) {
+    TempDir dir("data-file");
+    auto path = dir.m_path / "test.dat";
+    FileHeader header{ { 'T', 'E', 'S', 'T' }, 2U, 0U };
+    BinaryWriter body;
+    body.putString("hello");
+    ASSERT_TRUE(writeDataFile(path, header, body));
+
+    FileHeader readHeader;
+    std::string buffer;
+    std::span<const std::byte> data;
+    ASSERT_TRUE(readDataFile(path, header.m_magic, 2U, readHeader, buffer, data));
+    EXPECT_EQ(readHeader.m_version, 2U);
+    std::string str;
+    BinaryReader in(data);
+    ASSERT_TRUE(in.getString(str));
+    EXPECT_EQ(str, "hello");
+    // 版本过新
+    EXPECT_FALSE(readDataFile(path, header.m_magic, 1U, readHeader, buffer, data));
+
+    // 翻转 body 内的一个字节后校验失败
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(10);
+        file.put('X');
+    }
+    EXPECT_FALSE(readDataFile(path, header.m_magic, 2U, readHeader, buffer, data));
+}
+
+TEST(SerializeTest, ReplacesFilesWhole) {
+    TempDir dir("replace-file");
+    auto path = dir.m_path / "test.dat";
+    auto read = [](const fs::path &file) {
+        std::ifstream fin(file, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    };
+    ASSERT_TRUE(replaceFile(path, asBytes("first version")));
+    ASSERT_TRUE(replaceFile(path, asBytes("second")));
+    EXPECT_EQ(read(path), "second");
+    EXPECT_FALSE(fs::exists(dir.m_path / "test.dat.tmp"));
+
+    // 临时文件无法创建时原文件不变
+    EXPECT_FALSE(replaceFile(dir.m_path / "missing" / "test.dat", asBytes("lost")));
+    fs::create_directory(dir.m_path / "test.dat.tmp");
+    EXPECT_FALSE(replaceFile(path, asBytes("third")));
+    EXPECT_EQ(read(path), "second");
+}
+
+TEST(JournalTest, ReplaysRecordsAndDropsTornTail) {
+    TempDir dir("journal");
+    auto path = dir.m_path / "list.journal";
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        JournalRecord record;
+        record.m_op = JournalOp::CreateGroupTag;
+        record.m_tagId = 1;
+        record.m_name = "作者";
+        ASSERT_TRUE(journal.append(record));
+        record.m_op = JournalOp::AddBook;
+        record.m_bookId = 1;
+        record.m_images = { dir.m_path / "1.png", dir.m_path / "2.png" };
+        record.m_tags = { 3, 4 };
+        ASSERT_TRUE(journal.append(record));
+        EXPECT_EQ(journal.getSequence(), 2U);
+    }
+    // 模拟写入中途崩溃留下的残缺记录
+    std::ofstream(path, std::ios::binary | std::ios::app).write("\x40\x00\x00\x00partial", 11);
+
+    std::vector<JournalRecord> records;
+    std::uint64_t lastSeq = 0U;
+    ASSERT_TRUE(Journal::replay(path, 0U, [&](const JournalRecord &record) {
+        records.emplace_back(record);
+        return true;
+    }, lastSeq));
+    ASSERT_EQ(records.size(), 2U);
+    EXPECT_EQ(lastSeq, 2U);
+    EXPECT_EQ(records[0].m_name, "作者");
+    EXPECT_EQ(records[1].m_op, JournalOp::AddBook);
+    EXPECT_EQ(records[1].m_images.size(), 2U);
+    EXPECT_EQ(records[1].m_tags, (TagIdList{ 3, 4 }));
+
+    // 只重放序号更大的记录，重新打开后残缺记录被截掉、序号继续递增
+    records.clear();
+    ASSERT_TRUE(Journal::replay(path, 1U, [&](const JournalRecord &record) {
+        records.emplace_back(record);
+        return true;
+    }, lastSeq));
+    EXPECT_EQ(records.size(), 1U);
+    Journal journal;
+    ASSERT_TRUE(journal.open(path));
+    EXPECT_EQ(journal.getSequence(), 2U);
+    ASSERT_TRUE(journal.append(JournalRecord{ .m_op = JournalOp::EraseBook, .m_bookId = 1 }));
+    EXPECT_EQ(journal.getSequence(), 3U);
+}
@@ -0,0 +1,175 @@
+// TransferEngine 与 ContentStore 测试
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "ContentStore.h"
+#include "TempDir.h"
+#include "Transfer.h"
+
+using namespace book;
+
+namespace {
+    void writeFile(const fs::path &path, const std::string &content) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    std::string readFile(const fs::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // 目录 dir 下（含子目录）的普通文件个数
+    std::size_t countFiles(const fs::path &dir) {
+        std::size_t ret = 0U;
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file()) ++ret;
+        }
+        return ret;
+    }
+}
+
+TEST(TransferTest, CopiesAndMovesAll) {
+    TempDir dir("transfer-ok");
+    ThreadPool pool(2U);
+    TransferEngine engine(&pool, 2U);
+    std::vector<TransferItem> items;
+    for (int i = 0; i < 5; ++i) {
+        auto name = std::to_string(i) + ".jpg";
+        writeFile(dir.m_path / "src" / name, std::string(1000U * (i + 1), static_cast<char>('a' + i)));
+        items.emplace_back(TransferItem{ dir.m_path / "src" / name, dir.m_path / "copy" / "nested" / name });
+    }
+    std::size_t calls = 0U;
+    engine.setCallback([&calls](const TransferProgress &progress, std::size_t, const TransferResult &) {
+        ++calls;
+        EXPECT_EQ(progress.m_doneFiles, calls);
+        EXPECT_EQ(progress.m_sumOfFiles, 5U);
+    });
+    std::vector<TransferResult> results;
+    ASSERT_TRUE(engine.run(items, TransferMode::Copy, &results));
+    EXPECT_EQ(calls, 5U);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        EXPECT_EQ(readFile(items[i].m_dest), readFile(items[i].m_src));
+        EXPECT_EQ(results[i].m_bytes, 1000U * (i + 1U));
+        EXPECT_NE(results[i].m_method, TransferMethod::None);
+    }
+
+    engine.setCallback(nullptr);
+    for (auto &item : items) item = TransferItem{ item.m_dest, dir.m_path / "moved" / item.m_dest.filename() };
+    ASSERT_TRUE(engine.run(items, TransferMode::Move));
+    for (auto &item : items) {
+        EXPECT_FALSE(fs::exists(item.m_src));
+        EXPECT_TRUE(fs::exists(item.m_dest));
+    }
+}
+
+TEST(TransferTest, RollsBackOnFailedItem) {
+    TempDir dir("transfer-rollback");
+    ThreadPool pool(2U);
+    TransferEngine engine(&pool, 2U);
+    std::vector<TransferItem> items;
+    for (int i = 0; i < 6; ++i) {
+        auto name = std::to_string(i) + ".jpg";
+        writeFile(dir.m_path / "src" / name, std::string(4096U, static_cast<char>('a' + i)));
+        items.emplace_back(TransferItem{ dir.m_path / "src" / name, dir.m_path / "dest" / name });
+    }
+    // 中间一项的源文件不存在
+    items[3].m_src = dir.m_path / "src" / "missing.jpg";
+
+    for (auto mode : { TransferMode::Copy, TransferMode::Move }) {
+        std::vector<TransferResult> results;
+        EXPECT_FALSE(engine.run(items, mode, &results));
+        ASSERT_EQ(results.size(), items.size());
+        EXPECT_TRUE(results[3].m_error);
+        // 已完成的目标与临时文件全部删除，移动的源文件回到原处
+        EXPECT_EQ(countFiles(dir.m_path / "dest"), 0U);
+        EXPECT_EQ(countFiles(dir.m_path / "src"), 6U);
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (i == 3U) continue;
+            EXPECT_EQ(readFile(items[i].m_src), std::string(4096U, static_cast<char>('a' + i)));
+        }
+    }
+
+    // 目标已存在时同样失败，已存在的目标不被删除
+    items[3].m_src = items[2].m_src;
+    items[3].m_dest = dir.m_path / "dest" / "existing.jpg";
+    writeFile(items[3].m_dest, "keep");
+    EXPECT_FALSE(engine.run(items, TransferMode::Copy));
+    EXPECT_EQ(countFiles(dir.m_path / "dest"), 1U);
+    EXPECT_EQ(readFile(items[3].m_dest), "keep");
+}
+
+TEST(ContentStoreTest, ImportsDuplicatesOnce) {
+    TempDir dir("content-store-import");
+    ThreadPool pool(2U);
+    ContentStore store(dir.m_path / "objects", &pool);
+    std::vector<fs::path> images;
+    for (int i = 0; i < 4; ++i) {
+        images.emplace_back(dir.m_path / "src" / (std::to_string(i) + ".png"));
+        writeFile(images.back(), i % 2 == 0 ? "same content" : "other content " + std::to_string(i));
+    }
+    auto sources = images;
+    ASSERT_TRUE(store.import(images));
+    EXPECT_EQ(countFiles(store.getRoot()), 3U);
+    EXPECT_EQ(images[0], images[2]);
+    EXPECT_NE(images[1], images[3]);
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        EXPECT_TRUE(store.isObject(images[i]));
+        EXPECT_EQ(images[i].extension(), ".png");
+        EXPECT_EQ(readFile(images[i]), readFile(sources[i]));
+    }
+    // 导入不增加引用数
+    EXPECT_EQ(store.getRefCount(images[0]), 0U);
+
+    // 再次导入已有内容时不再复制，移动时源文件被删除
+    std::vector<fs::path> again = { dir.m_path / "src2" / "a.png" };
+    writeFile(again[0], "same content");
+    ASSERT_TRUE(store.import(again, true));
+    EXPECT_EQ(again[0], images[0]);
+    EXPECT_FALSE(fs::exists(dir.m_path / "src2" / "a.png"));
+    EXPECT_EQ(countFiles(store.getRoot()), 3U);
+
+    // 源文件不存在时整批失败，新对象回滚，images 不变
+    std::vector<fs::path> broken = { dir.m_path / "src" / "new.png", dir.m_path / "src" / "missing.png" };
+    writeFile(broken[0], "new content");
+    auto before = broken;
+    EXPECT_FALSE(store.import(broken));
+    EXPECT_EQ(broken, before);
+    EXPECT_EQ(countFiles(store.getRoot()), 3U);
+}
+
+TEST(ContentStoreTest, ReleasesObjectsWithoutReferences) {
+    TempDir dir("content-store-refs");
+    ContentStore store(dir.m_path / "objects");
+    std::vector<fs::path> images = { dir.m_path / "src" / "1.png", dir.m_path / "src" / "2.png" };
+    writeFile(images[0], "shared");
+    writeFile(images[1], "shared");
+    ASSERT_TRUE(store.import(images));
+    ASSERT_EQ(images[0], images[1]);
+    auto object = images[0];
+
+    // 两本书引用同一对象
+    store.retain(object);
+    store.retain(object);
+    store.retain(dir.m_path / "src" / "1.png");
+    EXPECT_EQ(store.getRefCount(object), 2U);
+    EXPECT_EQ(store.getSumOfObjects(), 1U);
+    EXPECT_FALSE(store.release(object));
+    EXPECT_TRUE(fs::exists(object));
+    EXPECT_TRUE(store.release(object));
+    EXPECT_FALSE(fs::exists(object));
+    EXPECT_EQ(store.getSumOfObjects(), 0U);
+
+    // 不删除时留给 collect 回收
+    std::vector<fs::path> more = { dir.m_path / "src" / "3.png" };
+    writeFile(more[0], "collected");
+    ASSERT_TRUE(store.import(more));
+    store.retain(more[0]);
+    EXPECT_TRUE(store.release(more[0], false));
+    EXPECT_TRUE(fs::exists(more[0]));
+    EXPECT_EQ(store.collect(), 1U);
+    EXPECT_FALSE(fs::exists(more[0]));
+}
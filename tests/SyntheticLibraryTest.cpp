@@ -0,0 +1,83 @@
+// 合成漫画库生成器测试：相同选项必须生成相同的漫画库
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "Scanner.h"
+#include "SyntheticLibrary.h"
+
+using namespace book;
+
+TEST(SyntheticLibraryTest, IsDeterministic) {
+    SyntheticOptions options;
+    options.m_sumOfMangas = 50U;
+    SyntheticLibrary a(options), b(options);
+    EXPECT_EQ(a.getTagNames(), b.getTagNames());
+    for (std::size_t manga = 0; manga < options.m_sumOfMangas; ++manga) {
+        EXPECT_EQ(a.getMangaTags(manga), b.getMangaTags(manga));
+        EXPECT_EQ(a.getMangaTags(manga).size(), options.m_tagsPerManga);
+    }
+
+    options.m_seed = 2U;
+    SyntheticLibrary c(options);
+    bool differs = false;
+    for (std::size_t manga = 0; manga < options.m_sumOfMangas; ++manga) differs |= a.getMangaTags(manga) != c.getMangaTags(manga);
+    EXPECT_TRUE(differs);
+}
+
+TEST(SyntheticLibraryTest, TagPopularityIsSkewed) {
+    SyntheticOptions options;
+    options.m_sumOfMangas = 1000U;
+    options.m_sumOfTags = 1000U;
+    SyntheticLibrary synthetic(options);
+    std::vector<std::size_t> counts(options.m_sumOfTags);
+    for (std::size_t manga = 0; manga < options.m_sumOfMangas; ++manga)
+        for (auto tag : synthetic.getMangaTags(manga)) ++counts[tag];
+    // 热度排名靠前的标签远多于排名靠后的标签
+    std::size_t head = 0U, tail = 0U;
+    for (std::size_t i = 0; i < 10U; ++i) head += counts[i];
+    for (std::size_t i = 990U; i < 1000U; ++i) tail += counts[i];
+    EXPECT_GT(head, tail * 10U);
+}
+
+TEST(SyntheticLibraryTest, CreatesScannableFiles) {
+    SyntheticOptions options;
+    options.m_sumOfMangas = 3U;
+    options.m_chaptersPerManga = 2U;
+    options.m_pagesPerChapter = 12U;
+    options.m_pageSize = 100U;
+    SyntheticLibrary synthetic(options);
+    ASSERT_TRUE(synthetic.createFiles());
+    // 已生成时直接返回
+    ASSERT_TRUE(synthetic.createFiles());
+
+    auto mangas = LibraryScanner().scan(synthetic.getRoot());
+    ASSERT_EQ(mangas.size(), options.m_sumOfMangas);
+    for (std::size_t manga = 0; manga < mangas.size(); ++manga) {
+        ASSERT_EQ(mangas[manga].m_chapters.size(), options.m_chaptersPerManga);
+        for (std::size_t chapter = 0; chapter < options.m_chaptersPerManga; ++chapter)
+            EXPECT_EQ(mangas[manga].m_chapters[chapter].m_images, synthetic.getPagePaths(manga, chapter));
+    }
+
+    ImagesManager images(synthetic.getPagePaths(0, 0));
+    auto info = images.getImageInfo(0);
+    EXPECT_GE(info.m_width, 800U);
+    EXPECT_GE(info.m_height, 1100U);
+    EXPECT_EQ(fs::file_size(images.getImagePath(0)), options.m_pageSize);
+}
+
+TEST(SyntheticLibraryTest, ParsesCommandLineOptions) {
+    char program[] = "bench", mangas[] = "--synthetic_mangas=7", other[] = "--benchmark_filter=Tag",
+        skew[] = "--synthetic_skew=1.5";
+    char *argv[] = { program, mangas, other, skew, nullptr };
+    int argc = 4;
+    SyntheticOptions options;
+    ASSERT_TRUE(parseSyntheticOptions(argc, argv, options));
+    EXPECT_EQ(options.m_sumOfMangas, 7U);
+    EXPECT_DOUBLE_EQ(options.m_tagSkew, 1.5);
+    ASSERT_EQ(argc, 2);
+    EXPECT_STREQ(argv[1], "--benchmark_filter=Tag");
+
+    char bad[] = "--synthetic_pages=many";
+    char *badArgv[] = { program, bad, nullptr };
+    argc = 2;
+    EXPECT_FALSE(parseSyntheticOptions(argc, badArgv, options));
+}
@@ -0,0 +1,90 @@
+// TagIndex 多标签查询测试，结果与逐本检查的结果比较
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include "TagIndex.h"
+
+using namespace book;
+
+namespace {
+    using BookTags = std::map<BookIdType, std::set<TagIdType>>;
+
+    // 逐本检查所有书籍是否满足 query
+    BookIdList bruteForce(const BookTags &books, const TagQuery &query) {
+        BookIdList ret;
+        for (const auto &[id, tags] : books) {
+            auto has = [&tags](TagIdType tag) { return tags.contains(tag); };
+            if (!std::all_of(query.m_all.begin(), query.m_all.end(), has)) continue;
+            if (!query.m_any.empty() && std::none_of(query.m_any.begin(), query.m_any.end(), has)) continue;
+            if (std::any_of(query.m_none.begin(), query.m_none.end(), has)) continue;
+            ret.push_back(id);
+        }
+        return ret;
+    }
+
+    TagIdList randomTags(std::mt19937 &random, std::size_t maxCount, TagIdType maxTag) {
+        TagIdList ret(std::uniform_int_distribution<std::size_t>(0U, maxCount)(random));
+        for (auto &tag : ret) tag = static_cast<TagIdType>(std::uniform_int_distribution<unsigned>(1U, maxTag)(random));
+        return ret;
+    }
+}
+
+TEST(TagIndexTest, CombinesAllAnyAndNone) {
+    TagIndex index;
+    TagIdList first = { 1, 2 }, second = { 2, 3 }, third = { 3 };
+    index.addBook(1U, first);
+    index.addBook(2U, second);
+    index.addBook(3U, third);
+    index.addBook(4U, {});
+
+    EXPECT_EQ(index.search({}), (BookIdList{ 1U, 2U, 3U, 4U }));
+    EXPECT_EQ(index.search({ { 2 }, {}, {} }), (BookIdList{ 1U, 2U }));
+    EXPECT_EQ(index.search({ { 2, 3 }, {}, {} }), (BookIdList{ 2U }));
+    EXPECT_EQ(index.search({ {}, { 1, 3 }, {} }), (BookIdList{ 1U, 2U, 3U }));
+    EXPECT_EQ(index.search({ { 3 }, { 1, 2 }, {} }), (BookIdList{ 2U }));
+    EXPECT_EQ(index.search({ {}, {}, { 3 } }), (BookIdList{ 1U, 4U }));
+    EXPECT_EQ(index.search({ { 2 }, {}, { 1 } }), (BookIdList{ 2U }));
+    // 不存在的标签
+    EXPECT_TRUE(index.search({ { 2, 100 }, {}, {} }).empty());
+    EXPECT_EQ(index.search({ {}, {}, { 100 } }).size(), 4U);
+
+    index.remove(2, 1U);
+    EXPECT_EQ(index.search({ { 2 }, {}, {} }), (BookIdList{ 2U }));
+    index.eraseTag(3);
+    EXPECT_TRUE(index.getBooks(3).empty());
+    index.removeBook(2U, second);
+    EXPECT_EQ(index.getAllBooks().toList(), (BookIdList{ 1U, 3U, 4U }));
+}
+
+TEST(TagIndexTest, MatchesBruteForce) {
+    std::mt19937 random(2024U);
+    TagIndex index;
+    BookTags books;
+    // 书籍ID稀疏，跨越多个位图容器
+    for (BookIdType id = 1U; id <= 3000U; ++id) {
+        auto bookId = id * 37U;
+        auto tags = randomTags(random, 6U, 12);
+        std::sort(tags.begin(), tags.end());
+        tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+        index.addBook(bookId, tags);
+        books[bookId].insert(tags.begin(), tags.end());
+    }
+    // 增量修改
+    for (int i = 0; i < 500; ++i) {
+        auto it = std::next(books.begin(), std::uniform_int_distribution<std::size_t>(0U, books.size() - 1U)(random));
+        auto tag = static_cast<TagIdType>(std::uniform_int_distribution<unsigned>(1U, 12U)(random));
+        if (it->second.erase(tag)) {
+            index.remove(tag, it->first);
+        } else {
+            it->second.insert(tag);
+            index.add(tag, it->first);
+        }
+    }
+
+    for (int i = 0; i < 300; ++i) {
+        TagQuery query{ randomTags(random, 2U, 12), randomTags(random, 3U, 12), randomTags(random, 2U, 12) };
+        EXPECT_EQ(index.search(query), bruteForce(books, query)) << "query " << i;
+    }
+}
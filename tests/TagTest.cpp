@@ -0,0 +1,136 @@
+// TagManager、TagSet 与 IdAllocator 单元测试
+#include <gtest/gtest.h>
+#include "IdAllocator.h"
+#include "Serialize.h"
+#include "Tag.h"
+#include "TagSet.h"
+
+using namespace book;
+
+TEST(IdAllocatorTest, AcquiresSmallestFreeId) {
+    IdAllocator allocator;
+    EXPECT_EQ(allocator.acquire(), IdAllocator::nullId);
+    EXPECT_FALSE(allocator.release(IdAllocator::nullId));
+    for (IdAllocator::ValueType id : { 70000U, 5U, 300U }) EXPECT_TRUE(allocator.release(id));
+    EXPECT_FALSE(allocator.release(5U));
+    EXPECT_EQ(allocator.size(), 3U);
+    EXPECT_EQ(allocator.toList(), (IdAllocator::ValueList{ 5U, 300U, 70000U }));
+    EXPECT_EQ(allocator.acquire(), 5U);
+    EXPECT_EQ(allocator.acquire(), 300U);
+    EXPECT_FALSE(allocator.isFree(300U));
+    EXPECT_TRUE(allocator.isFree(70000U));
+    EXPECT_EQ(allocator.acquire(), 70000U);
+    EXPECT_TRUE(allocator.empty());
+}
+
+TEST(TagSetTest, TracksTagsAndGroups) {
+    TagSet tags;
+    EXPECT_TRUE(tags.insert(7, 2));
+    EXPECT_TRUE(tags.insert(3, 1));
+    EXPECT_TRUE(tags.insert(5, 2));
+    EXPECT_FALSE(tags.insert(5, 2));
+    EXPECT_EQ(TagIdList(tags.getTags().begin(), tags.getTags().end()), (TagIdList{ 3, 5, 7 }));
+    EXPECT_EQ(TagIdList(tags.getGroups().begin(), tags.getGroups().end()), (TagIdList{ 1, 2 }));
+    EXPECT_EQ(tags.getSumOfTags(2), 2U);
+    EXPECT_EQ(tags.getTags(2), (TagIdList{ 5, 7 }));
+
+    EXPECT_TRUE(tags.erase(3));
+    EXPECT_FALSE(tags.erase(3));
+    EXPECT_EQ(tags.getSumOfTags(1), 0U);
+    EXPECT_EQ(tags.eraseGroup(2), 2U);
+    EXPECT_TRUE(tags.empty());
+}
+
+TEST(TagSetTest, LargeSetsMatchSmallSets) {
+    // 足够多的标签会使集合改用位图查找，结果必须与逐个检查一致
+    TagSet tags;
+    for (TagIdType id = 2; id < 2000; id += 3) tags.insert(id, static_cast<TagIdType>(id % 5 + 1));
+    for (TagIdType id = 1; id < 2000; ++id) EXPECT_EQ(tags.contains(id), id % 3 == 2) << id;
+    auto copy = tags;
+    for (TagIdType id = 2; id < 1000; id += 3) EXPECT_TRUE(copy.erase(id));
+    EXPECT_FALSE(copy.contains(500));
+    EXPECT_TRUE(copy.contains(1001));
+    EXPECT_TRUE(tags.contains(500));
+}
+
+TEST(TagManagerTest, CreatesRenamesAndErasesTags) {
+    TagManager manager;
+    auto author = manager.createGroupTag("作者");
+    ASSERT_NE(author, nullTagId);
+    EXPECT_EQ(manager.createGroupTag("作者"), nullTagId);
+
+    auto a = manager.createBookTag("a", author), b = manager.createBookTag("b", author);
+    ASSERT_NE(a, nullTagId);
+    ASSERT_NE(b, nullTagId);
+    EXPECT_EQ(manager.getBookTagId("b"), b);
+    EXPECT_EQ(manager.getGroupTagId(b), author);
+    EXPECT_EQ(manager.getSumOfTagsFromGroup(author), 2U);
+
+    EXPECT_TRUE(manager.renameBookTag(a, "c"));
+    EXPECT_EQ(manager.getBookTagId("a"), nullTagId);
+    EXPECT_EQ(manager.getBookTag(a).getName(), "c");
+    EXPECT_FALSE(manager.renameBookTag(b, "c"));
+
+    // 删除后的ID被优先重新分配
+    EXPECT_TRUE(manager.eraseBookTag(a));
+    EXPECT_FALSE(manager.checkTagId(a));
+    EXPECT_EQ(manager.createBookTag("d", author), a);
+}
+
+TEST(TagManagerTest, RejectsInvalidGroups) {
+    TagManager manager;
+    auto group = manager.createGroupTag("作者");
+    EXPECT_EQ(manager.createBookTag("a", nullTagId), nullTagId);
+    EXPECT_EQ(manager.createBookTag("a", group + 1), nullTagId);
+    EXPECT_EQ(manager.createBookTag("a", maxTagId), nullTagId);
+    EXPECT_EQ(manager.getSumOfBookTags(), 0U);
+    EXPECT_NE(manager.createBookTag("a", group), nullTagId);
+
+    // 手工编码一个书标签与一个组标签，书标签的组ID为 groupId
+    auto encode = [](TagIdType groupId) {
+        BinaryWriter out;
+        out.putVarint(1U); out.putFixed(TagIdType(1)); out.putVarint(2U);
+        out.putFixed(nullTagId); out.putString(""); out.putFixed(nullTagId);
+        out.putFixed(TagIdType(1)); out.putString("tag"); out.putFixed(groupId);
+        out.putVarint(0U);
+        out.putVarint(1U); out.putFixed(TagIdType(1)); out.putVarint(2U);
+        out.putFixed(nullTagId); out.putString("");
+        out.putFixed(TagIdType(1)); out.putString("group");
+        out.putVarint(0U);
+        return out;
+    };
+    auto valid = encode(1);
+    BinaryReader validIn(valid.getData());
+    ASSERT_TRUE(manager.read(validIn));
+    EXPECT_EQ(manager.getSumOfTagsFromGroup(1), 1U);
+    // 超出组标签ID范围的组ID使读入失败，不按其分配组索引
+    for (TagIdType groupId : { TagIdType(2), maxTagId }) {
+        auto corrupted = encode(groupId);
+        BinaryReader in(corrupted.getData());
+        EXPECT_FALSE(manager.read(in)) << groupId;
+        EXPECT_EQ(manager.getSumOfBookTags(), 0U);
+    }
+}
+
+TEST(TagManagerTest, CompactsIdsAndRoundTrips) {
+    TagManager manager;
+    auto group = manager.createGroupTag("类型");
+    TagIdList ids;
+    for (int i = 0; i < 10; ++i) ids.emplace_back(manager.createBookTag("tag " + std::to_string(i), group));
+    for (int i = 0; i < 10; i += 2) manager.eraseBookTag(ids[i]);
+
+    auto remap = manager.compactBookTags();
+    ASSERT_FALSE(remap.empty());
+    EXPECT_EQ(remap[ids[0]], nullTagId);
+    for (int i = 1; i < 10; i += 2) EXPECT_EQ(manager.getBookTag(remap[ids[i]]).getName(), "tag " + std::to_string(i));
+    EXPECT_TRUE(manager.compactBookTags().empty());
+
+    BinaryWriter out;
+    manager.write(out);
+    TagManager copy;
+    BinaryReader in(out.getData());
+    ASSERT_TRUE(copy.read(in));
+    EXPECT_EQ(copy.getSumOfBookTags(), 5U);
+    EXPECT_EQ(copy.getBookTagId("tag 9"), manager.getBookTagId("tag 9"));
+    EXPECT_EQ(copy.getGroupTagId(copy.getBookTagId("tag 9")), group);
+}
@@ -0,0 +1,123 @@
+// 标签ID宽度兼容测试：16 位构建写入数据文件、标签文件与日志，32 位构建读入并检查标签ID不变
+// 夹具目录由 CMake 以 BOOK_TAG_WIDTH_FIXTURE_DIR 传入，两种宽度的构建共用（见 tests/CMakeLists.txt）
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Library.h"
+#include "TempDir.h"
+
+using namespace book;
+
+namespace {
+    fs::path getFixtureDir() {
+        return fs::path(BOOK_TAG_WIDTH_FIXTURE_DIR);
+    }
+
+    // 文件头部 magic(4) + version(2) 之后的 flags，即标签ID的字节数
+    std::uint16_t readIdSize(const fs::path &path) {
+        char bytes[8] = {};
+        std::ifstream(path, std::ios::binary).read(bytes, sizeof(bytes));
+        return static_cast<std::uint16_t>(static_cast<unsigned char>(bytes[6]) | (static_cast<unsigned char>(bytes[7]) << 8));
+    }
+
+    // 按ID列出所有标签，与构建的宽度无关
+    std::string describe(const TagManager &manager) {
+        std::ostringstream out;
+        auto groups = manager.getGroupTags(), tags = manager.getBookTags();
+        for (auto id : *groups) out << "group " << id << ' ' << manager.getGroupTag(id).getName() << '\n';
+        for (auto id : *tags) {
+            out << "tag " << id << ' ' << manager.getGroupTagId(id) << ' ' << manager.getBookTag(id).getName() << '\n';
+        }
+        return out.str();
+    }
+
+    // 所有标签与每本书的标签
+    std::string describe(const Library &library) {
+        std::ostringstream out;
+        out << describe(library.getTagManager());
+        auto books = library.getBooks();
+        for (auto id : *books) {
+            auto tags = library.getBook(id)->getTags();
+            TagIdList sorted(tags.begin(), tags.end());
+            std::sort(sorted.begin(), sorted.end());
+            out << "book " << id;
+            for (auto tag : sorted) out << ' ' << tag;
+            out << '\n';
+        }
+        return out.str();
+    }
+}
+
+// 只在 16 位构建中生成夹具；数据文件之后的修改只在日志内，标签ID超过 255 以检查高字节
+TEST(TagWidthTest, WritesNarrowFixtures) {
+    if (sizeof(TagIdType) != sizeof(std::uint16_t)) GTEST_SKIP() << "夹具由 16 位构建生成";
+    auto dir = getFixtureDir();
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "Book");
+    std::vector<fs::path> pages;
+    for (int i = 1; i <= 3; ++i) {
+        pages.emplace_back(dir / "Book" / (std::to_string(i) + ".jpg"));
+        std::ofstream(pages.back()) << "page " << i;
+    }
+
+    Library library(dir);
+    ASSERT_TRUE(library.read());
+    auto &manager = library.getTagManager();
+    auto author = manager.createGroupTag("作者"), language = manager.createGroupTag("语言");
+    TagIdList tags;
+    for (int i = 0; i < 300; ++i) tags.emplace_back(manager.createBookTag("作者 " + std::to_string(i), author));
+    auto chinese = manager.createBookTag("中文", language);
+    auto first = library.addBook(std::vector<fs::path>(pages), { tags[0], tags[299], chinese });
+    auto second = library.addBook(std::vector<fs::path>(pages), { tags[1] });
+    ASSERT_NE(second, nullBookId);
+    ASSERT_TRUE(library.eraseBookTag(tags[5]));
+    ASSERT_TRUE(library.compact(false));
+
+    auto english = manager.createBookTag("英文", language);
+    library.getBook(second)->addTag(english);
+    library.getBook(first)->removeTag(tags[0]);
+    ASSERT_TRUE(library.eraseBookTag(tags[7]));
+    ASSERT_TRUE(manager.renameGroupTag(author, "作家"));
+    ASSERT_NE(library.addBook(std::vector<fs::path>(pages), { tags[298], english }), nullBookId);
+    ASSERT_TRUE(manager.write((dir / "tags.dat").string()));
+
+    EXPECT_EQ(readIdSize(library.getDataPath()), 2U);
+    EXPECT_EQ(readIdSize(library.getJournalPath()), 2U);
+    EXPECT_EQ(readIdSize(dir / "tags.dat"), 2U);
+    std::ofstream(dir / "manifest.txt") << tags[7] << '\n' << describe(library);
+}
+
+// 16 位构建中同宽读入，32 位构建中检查扩宽；没有夹具时跳过
+TEST(TagWidthTest, ReadsNarrowFixtures) {
+    auto fixture = getFixtureDir();
+    std::ifstream fin(fixture / "manifest.txt");
+    if (!fin) GTEST_SKIP() << "没有 16 位夹具";
+    TagIdType erased = nullTagId;
+    fin >> erased;
+    fin.ignore();
+    std::string expected((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    // 读入会改写日志，在副本上进行
+    TempDir dir("tag-width");
+    fs::copy(fixture, dir.m_path, fs::copy_options::recursive);
+    TagManager tagFile;
+    ASSERT_TRUE(tagFile.read((dir.m_path / "tags.dat").string()));
+    Library library(dir.m_path);
+    ASSERT_TRUE(library.read());
+    EXPECT_EQ(describe(library), expected);
+    EXPECT_EQ(describe(tagFile), describe(library.getTagManager()));
+    // 日志在打开时改写为当前宽度，被删除的ID仍然可以复用
+    EXPECT_EQ(readIdSize(library.getJournalPath()), sizeof(TagIdType));
+    auto language = library.getTagManager().getGroupTagId("语言");
+    EXPECT_EQ(library.getTagManager().createBookTag("日文", language), erased);
+
+    // 合并后以当前宽度写回，重新读入结果不变
+    ASSERT_TRUE(library.compact(false));
+    EXPECT_EQ(readIdSize(library.getDataPath()), sizeof(TagIdType));
+    Library reread(dir.m_path);
+    ASSERT_TRUE(reread.read());
+    EXPECT_EQ(describe(reread), describe(library));
+}
@@ -0,0 +1,29 @@
+#ifndef TEMP_DIR_H
+#define TEMP_DIR_H
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 每个测试独占的临时目录，构造时清空，析构时删除
+    struct TempDir {
+        fs::path m_path;
+
+        TempDir(const std::string &name) : m_path(fs::temp_directory_path() / "manga-manager-tests" / name) {
+            std::error_code ec;
+            fs::remove_all(m_path, ec);
+            fs::create_directories(m_path);
+        }
+        ~TempDir() {
+            std::error_code ec;
+            fs::remove_all(m_path, ec);
+        }
+        TempDir(const TempDir &) = delete;
+        TempDir &operator=(const TempDir &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,57 @@
+// ThreadPool 单元测试
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ThreadPool.h"
+
+using namespace book;
+
+TEST(ThreadPoolTest, WaitsForConcurrentSubmits) {
+    ThreadPool pool(4U);
+    std::atomic<std::size_t> done = 0U;
+    for (int round = 0; round < 20; ++round) {
+        // 外部线程与工作线程同时提交，任务很短，常在提交者返回前就已执行完毕
+        std::vector<std::thread> submitters;
+        for (int i = 0; i < 4; ++i) {
+            submitters.emplace_back([&] {
+                for (int j = 0; j < 250; ++j) {
+                    pool.submit([&] {
+                        done.fetch_add(1U, std::memory_order_relaxed);
+                        pool.submit([&] { done.fetch_add(1U, std::memory_order_relaxed); });
+                    });
+                }
+            });
+        }
+        for (auto &submitter : submitters) submitter.join();
+        pool.wait();
+        ASSERT_EQ(done.load(), (round + 1U) * 2000U);
+    }
+}
+
+TEST(ThreadPoolTest, WaitsWhileOthersSubmit) {
+    ThreadPool pool(2U);
+    std::atomic<std::size_t> done = 0U;
+    std::atomic<bool> stop = false;
+    std::thread submitter([&] {
+        while (!stop.load()) pool.submit([&] { done.fetch_add(1U, std::memory_order_relaxed); });
+    });
+    // 提交不断进行时 wait 也能在任务清空的间隙返回，不会因计数错误而挂起
+    while (done.load() < 10000U) pool.wait();
+    stop.store(true);
+    submitter.join();
+    pool.wait();
+}
+
+TEST(ThreadPoolTest, TaskGroupWaitsForNestedTasks) {
+    ThreadPool pool(3U);
+    std::atomic<std::size_t> done = 0U;
+    TaskGroup group(pool);
+    for (int i = 0; i < 100; ++i) {
+        group.submit([&] {
+            for (int j = 0; j < 10; ++j) group.submit([&] { done.fetch_add(1U, std::memory_order_relaxed); });
+        });
+    }
+    group.wait();
+    EXPECT_EQ(done.load(), 1000U);
+}
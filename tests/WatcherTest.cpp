@@ -0,0 +1,145 @@
+// LibraryWatcher 增量同步测试
+#include <gtest/gtest.h>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <string>
+#include "TempDir.h"
+#include "Watcher.h"
+
+using namespace book;
+using namespace std::chrono_literals;
+
+namespace {
+    // 在 root 下生成一本 sumOfPages 页的书，返回书籍目录
+    fs::path makeBook(const fs::path &root, const std::string &name, int sumOfPages) {
+        auto dir = root / name / "capture 1";
+        fs::create_directories(dir);
+        for (int page = 1; page <= sumOfPages; ++page) std::ofstream(dir / (std::to_string(page) + ".jpg")) << "page " << page;
+        return dir;
+    }
+
+    // 书籍所有页面相对于 root 的路径
+    std::set<std::string> getPages(const Book &book, const fs::path &root) {
+        std::set<std::string> ret;
+        for (std::size_t i = 0; i < book.getSumOfImages(); ++i) ret.emplace(book.getImagePath(i).lexically_relative(root).generic_string());
+        return ret;
+    }
+
+    // 读取事件直到全部生效，返回增删与刷新的页面数
+    std::size_t settle(LibraryWatcher &watcher) {
+        std::size_t ret = 0U;
+        for (int i = 0; i < 20; ++i) {
+            ret += watcher.poll(20ms);
+            if (ret != 0U && watcher.getPendingCount() == 0U) break;
+        }
+        return ret;
+    }
+}
+
+TEST(WatcherTest, AppliesAddRemoveAndRename) {
+    TempDir dir("watcher-events");
+    auto bookDir = makeBook(dir.m_path, "Manga 1", 3);
+    Library library(dir.m_path);
+    auto id = library.addBook(bookDir);
+    ASSERT_NE(id, nullBookId);
+    LibraryWatcher watcher(library, 0ms);
+    if (!watcher.start()) GTEST_SKIP() << "inotify unavailable";
+
+    std::ofstream(bookDir / "4.jpg") << "page 4";
+    EXPECT_EQ(settle(watcher), 1U);
+    EXPECT_EQ(getPages(*library.getBook(id), dir.m_path),
+        (std::set<std::string>{ "Manga 1/capture 1/1.jpg", "Manga 1/capture 1/2.jpg", "Manga 1/capture 1/3.jpg", "Manga 1/capture 1/4.jpg" }));
+
+    fs::remove(bookDir / "2.jpg");
+    EXPECT_EQ(settle(watcher), 1U);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 3U);
+
+    // 页面改名为一删一增
+    fs::rename(bookDir / "3.jpg", bookDir / "5.jpg");
+    EXPECT_EQ(settle(watcher), 2U);
+    EXPECT_EQ(getPages(*library.getBook(id), dir.m_path),
+        (std::set<std::string>{ "Manga 1/capture 1/1.jpg", "Manga 1/capture 1/4.jpg", "Manga 1/capture 1/5.jpg" }));
+
+    // 不是图像的文件与写入后又删除的图像都不产生增量
+    std::ofstream(bookDir / "notes.txt") << "ignored";
+    std::ofstream(bookDir / "6.jpg") << "page 6";
+    fs::remove(bookDir / "6.jpg");
+    settle(watcher);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 3U);
+
+    // 书籍目录改名后页面路径迁移到新目录
+    fs::rename(dir.m_path / "Manga 1", dir.m_path / "Manga One");
+    settle(watcher);
+    EXPECT_EQ(getPages(*library.getBook(id), dir.m_path),
+        (std::set<std::string>{ "Manga One/capture 1/1.jpg", "Manga One/capture 1/4.jpg", "Manga One/capture 1/5.jpg" }));
+    std::ofstream(dir.m_path / "Manga One" / "capture 1" / "7.jpg") << "page 7";
+    EXPECT_EQ(settle(watcher), 1U);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 4U);
+
+    auto &stats = watcher.getStats();
+    EXPECT_EQ(stats.m_overflows, 0U);
+    EXPECT_GE(stats.m_pagesAdded, 3U);
+    EXPECT_GE(stats.m_pagesRemoved, 2U);
+}
+
+TEST(WatcherTest, WaitsForOpenFiles) {
+    TempDir dir("watcher-open");
+    auto bookDir = makeBook(dir.m_path, "Manga 1", 2);
+    Library library(dir.m_path);
+    auto id = library.addBook(bookDir);
+    ASSERT_NE(id, nullBookId);
+    LibraryWatcher watcher(library, 20ms);
+    if (!watcher.start()) GTEST_SKIP() << "inotify unavailable";
+
+    // 新建后尚未写入也未关闭的文件超过 settleTime 也不加入
+    std::ofstream file(bookDir / "3.jpg");
+    ASSERT_TRUE(file.is_open());
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(watcher.poll(20ms), 0U);
+    EXPECT_EQ(watcher.getPendingCount(), 1U);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 2U);
+
+    // 写入一部分后仍不加入，关闭后才生效
+    file << "page 3" << std::flush;
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(watcher.poll(20ms), 0U);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 2U);
+    file.close();
+    EXPECT_EQ(settle(watcher), 1U);
+    EXPECT_EQ(library.getBook(id)->getSumOfImages(), 3U);
+}
+
+TEST(WatcherTest, AddsNewBooksWhenEnabled) {
+    TempDir dir("watcher-new-books");
+    fs::create_directories(dir.m_path);
+    Library library(dir.m_path);
+    LibraryWatcher watcher(library, 0ms);
+    watcher.setAutoAddBooks(true);
+    if (!watcher.start()) GTEST_SKIP() << "inotify unavailable";
+
+    makeBook(dir.m_path, "Manga 2", 2);
+    settle(watcher);
+    for (int i = 0; i < 20 && library.getSumOfBooks() == 0U; ++i) watcher.poll(20ms);
+    ASSERT_EQ(library.getSumOfBooks(), 1U);
+    EXPECT_EQ(watcher.getStats().m_booksAdded, 1U);
+    EXPECT_EQ(library.getBook(library.getBooks()->front())->getSumOfImages(), 2U);
+}
+
+TEST(WatcherTest, ResyncAppliesOnlyDifferences) {
+    TempDir dir("watcher-resync");
+    auto first = makeBook(dir.m_path, "Manga 1", 4);
+    auto second = makeBook(dir.m_path, "Manga 2", 2);
+    Library library(dir.m_path);
+    auto firstId = library.addBook(first), secondId = library.addBook(second);
+    LibraryWatcher watcher(library);
+    EXPECT_EQ(watcher.resync(), 0U);
+
+    fs::remove(first / "1.jpg");
+    fs::rename(first / "2.jpg", first / "9.jpg");
+    std::ofstream(second / "3.jpg") << "page 3";
+    // 删除两页、增加两页
+    EXPECT_EQ(watcher.resync(), 4U);
+    EXPECT_EQ(getPages(*library.getBook(firstId), dir.m_path),
+        (std::set<std::string>{ "Manga 1/capture 1/3.jpg", "Manga 1/capture 1/4.jpg", "Manga 1/capture 1/9.jpg" }));
+    EXPECT_EQ(library.getBook(secondId)->getSumOfImages(), 3U);
+    EXPECT_EQ(watcher.resync(), 0U);
+}
@@ -0,0 +1,84 @@
+#ifndef ZIP_WRITER_H
+#define ZIP_WRITER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "Serialize.h"
+
+namespace book {
+    namespace fs = std::filesystem;
+
+    // 测试用 ZIP 文件中的一个条目
+    struct ZipItem {
+        std::string m_name;         // 条目名
+        std::string m_content;      // 解压后的内容
+        bool m_deflate = false;     // 是否以 Deflate 压缩
+    };
+
+    // 以原始 Deflate 流压缩 content
+    inline std::string deflateRaw(const std::string &content) {
+        z_stream stream{};
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        std::string ret(deflateBound(&stream, static_cast<uLong>(content.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(content.data()));
+        stream.avail_in = static_cast<uInt>(content.size());
+        stream.next_out = reinterpret_cast<Bytef *>(ret.data());
+        stream.avail_out = static_cast<uInt>(ret.size());
+        deflate(&stream, Z_FINISH);
+        ret.resize(stream.total_out);
+        deflateEnd(&stream);
+        return ret;
+    }
+
+    // 将 items 按顺序写为 path 处的 ZIP 文件（无 ZIP64），返回写入的字节
+    inline std::string writeZip(const fs::path &path, const std::vector<ZipItem> &items) {
+        BinaryWriter body, central;
+        for (auto &item : items) {
+            auto data = item.m_deflate ? deflateRaw(item.m_content) : item.m_content;
+            auto crc = static_cast<std::uint32_t>(crc32(0UL, reinterpret_cast<const Bytef *>(item.m_content.data()),
+                static_cast<uInt>(item.m_content.size())));
+            std::uint16_t method = item.m_deflate ? 8U : 0U;
+            auto offset = static_cast<std::uint32_t>(body.getSize());
+            auto name = std::as_bytes(std::span(item.m_name.data(), item.m_name.size()));
+
+            body.putFixed(std::uint32_t(0x04034b50U));
+            body.putFixed(std::uint16_t(20U)); body.putFixed(std::uint16_t(0U)); body.putFixed(method);
+            body.putFixed(std::uint32_t(0U)); body.putFixed(crc);
+            body.putFixed(static_cast<std::uint32_t>(data.size())); body.putFixed(static_cast<std::uint32_t>(item.m_content.size()));
+            body.putFixed(static_cast<std::uint16_t>(item.m_name.size())); body.putFixed(std::uint16_t(0U));
+            body.putBytes(name);
+            body.putBytes(std::as_bytes(std::span(data.data(), data.size())));
+
+            central.putFixed(std::uint32_t(0x02014b50U));
+            central.putFixed(std::uint16_t(20U)); central.putFixed(std::uint16_t(20U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(method);
+            central.putFixed(std::uint32_t(0U)); central.putFixed(crc);
+            central.putFixed(static_cast<std::uint32_t>(data.size())); central.putFixed(static_cast<std::uint32_t>(item.m_content.size()));
+            central.putFixed(static_cast<std::uint16_t>(item.m_name.size())); central.putFixed(std::uint16_t(0U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(std::uint16_t(0U));
+            central.putFixed(std::uint16_t(0U)); central.putFixed(std::uint32_t(0U));
+            central.putFixed(offset);
+            central.putBytes(name);
+        }
+        BinaryWriter end;
+        end.putFixed(std::uint32_t(0x06054b50U));
+        end.putFixed(std::uint16_t(0U)); end.putFixed(std::uint16_t(0U));
+        end.putFixed(static_cast<std::uint16_t>(items.size())); end.putFixed(static_cast<std::uint16_t>(items.size()));
+        end.putFixed(static_cast<std::uint32_t>(central.getSize())); end.putFixed(static_cast<std::uint32_t>(body.getSize()));
+        end.putFixed(std::uint16_t(0U));
+
+        std::string ret;
+        for (auto *part : { &body, &central, &end }) {
+            auto data = part->getData();
+            ret.append(reinterpret_cast<const char *>(data.data()), data.size());
+        }
+        std::ofstream(path, std::ios::out | std::ios::binary).write(ret.data(), static_cast<std::streamsize>(ret.size()));
+        return ret;
+    }
+}
+
+#endif